@@ -0,0 +1,37 @@
+# Creates a C++ source file with the contents of all OpenCL source files (.cl) in KERNEL_SOURCE_DIR.
+# The files are stored as byte arrays together with their relative path and SHA1 hash,
+# and are accessed at runtime with the KernelSourceRegistry.
+#
+# Usage: cmake -DKERNEL_SOURCE_DIR=<dir> -DOUTPUT_FILE=<file.cpp> -P EmbedKernelSources.cmake
+
+file(GLOB_RECURSE KERNEL_FILES RELATIVE "${KERNEL_SOURCE_DIR}" "${KERNEL_SOURCE_DIR}/*.cl")
+list(SORT KERNEL_FILES)
+
+set(ARRAYS "")
+set(ENTRIES "")
+set(COUNTER 0)
+foreach(KERNEL_FILE ${KERNEL_FILES})
+    file(READ "${KERNEL_SOURCE_DIR}/${KERNEL_FILE}" CONTENT HEX)
+    file(SHA1 "${KERNEL_SOURCE_DIR}/${KERNEL_FILE}" HASH)
+    string(LENGTH "${CONTENT}" LENGTH)
+    math(EXPR LENGTH "${LENGTH} / 2")
+    # Byte arrays are used instead of string literals because of the string literal length limit of some compilers
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," CONTENT "${CONTENT}")
+    set(ARRAYS "${ARRAYS}// ${KERNEL_FILE}\nstatic const unsigned char kernel${COUNTER}[] = {${CONTENT}0x00};\n")
+    set(ENTRIES "${ENTRIES}    {\"${KERNEL_FILE}\", (const char*)kernel${COUNTER}, ${LENGTH}, \"${HASH}\"},\n")
+    math(EXPR COUNTER "${COUNTER} + 1")
+endforeach()
+
+set(RESULT "// This file is generated by EmbedKernelSources.cmake. Do not edit.\n")
+set(RESULT "${RESULT}#include \"FAST/KernelSourceRegistry.hpp\"\n\nnamespace fast {\n\n")
+set(RESULT "${RESULT}${ARRAYS}\n")
+set(RESULT "${RESULT}const EmbeddedKernelSource embeddedKernelSources[] = {\n${ENTRIES}    {NULL, NULL, 0, NULL}\n};\n\n")
+set(RESULT "${RESULT}} // end namespace fast\n")
+
+# Only write the file if it has changed to avoid recompiling it
+if(EXISTS "${OUTPUT_FILE}")
+    file(READ "${OUTPUT_FILE}" PREVIOUS_RESULT)
+endif()
+if(NOT "${PREVIOUS_RESULT}" STREQUAL "${RESULT}")
+    file(WRITE "${OUTPUT_FILE}" "${RESULT}")
+endif()
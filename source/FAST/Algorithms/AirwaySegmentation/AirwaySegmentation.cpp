@@ -178,7 +178,6 @@ void regionGrowing(Image::pointer volume, Segmentation::pointer segmentation, Ve
 Image::pointer AirwaySegmentation::convertToHU(Image::pointer image) {
 	// TODO need support for no 3d write
 	OpenCLDevice::pointer device = getMainDevice();
-	cl::Program program = getOpenCLProgram(device);
 
 	OpenCLImageAccess::pointer input = image->getOpenCLImageAccess(ACCESS_READ, device);
 	Image::pointer newImage = Image::New();
@@ -186,7 +185,7 @@ Image::pointer AirwaySegmentation::convertToHU(Image::pointer image) {
 	newImage->setSpacing(image->getSpacing());
 	SceneGraph::setParentNode(newImage, image);
 
-	cl::Kernel kernel(program, "convertToHU");
+	cl::Kernel kernel = getOpenCLKernel(device, "convertToHU");
 
 	kernel.setArg(0, *input->get3DImage());
 	if(device->isWritingTo3DTexturesSupported()) {
@@ -214,7 +213,6 @@ void AirwaySegmentation::morphologicalClosing(Segmentation::pointer segmentation
 
 	// TODO need support for no 3d write
 	OpenCLDevice::pointer device = getMainDevice();
-	cl::Program program = getOpenCLProgram(device);
 
 	Segmentation::pointer segmentation2 = Segmentation::New();
 	segmentation2->create(segmentation->getSize(), TYPE_UINT8, 1);
@@ -223,8 +221,8 @@ void AirwaySegmentation::morphologicalClosing(Segmentation::pointer segmentation
 	memset(data, 0, width*height*depth);
 	access->release();
 
-	cl::Kernel dilateKernel(program, "dilate");
-	cl::Kernel erodeKernel(program, "erode");
+	cl::Kernel dilateKernel = getOpenCLKernel(device, "dilate");
+	cl::Kernel erodeKernel = getOpenCLKernel(device, "erode");
 
 	if(device->isWritingTo3DTexturesSupported()) {
 		OpenCLImageAccess::pointer input = segmentation->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
@@ -1,5 +1,8 @@
 #include "BinaryThresholding.hpp"
 #include "FAST/Data/Segmentation.hpp"
+#include "FAST/SlabSplitter.hpp"
+#include "FAST/WorkGroupSizeTuner.hpp"
+#include <boost/bind.hpp>
 
 namespace fast {
 
@@ -35,54 +38,81 @@ void BinaryThresholding::execute() {
     output->createFromImage(input);
 
     if(getMainDevice()->isHost()) {
-        throw Exception("Not implemented yet.");
-    } else {
-        OpenCLDevice::pointer device = OpenCLDevice::pointer(getMainDevice());
-        cl::Program program;
-        if(input->getDimensions() == 3) {
-            program = getOpenCLProgram(device, "3D");
-        } else {
-            program = getOpenCLProgram(device, "2D");
-        }
-        cl::Kernel kernel;
-        if(mLowerThresholdSet && mUpperThresholdSet) {
-            kernel = cl::Kernel(program, "tresholding");
-            kernel.setArg(3, mLowerThreshold);
-            kernel.setArg(4, mUpperThreshold);
-        } else if(mLowerThresholdSet) {
-            kernel = cl::Kernel(program, "thresholdingWithOnlyLower");
-            kernel.setArg(3, mLowerThreshold);
-        } else {
-            kernel = cl::Kernel(program, "thresholdingWithOnlyUpper");
-            kernel.setArg(3, mUpperThreshold);
+        if(input->getNrOfComponents() != 1)
+            throw Exception("BinaryThresholding on host only supports images with one component.");
+        ImageAccess::pointer inputAccess = input->getImageAccess(ACCESS_READ);
+        void* inputData = inputAccess->get();
+        switch(input->getDataType()) {
+            fastSwitchTypeMacro(executeOnHost<FAST_TYPE>((FAST_TYPE*)inputData, output));
         }
-        cl::NDRange globalSize;
-        OpenCLImageAccess::pointer access = input->getOpenCLImageAccess(ACCESS_READ, device);
-        if(input->getDimensions() == 2) {
-            OpenCLImageAccess::pointer access2 = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
-            kernel.setArg(0, *access->get2DImage());
-            kernel.setArg(1, *access2->get2DImage());
-            globalSize = cl::NDRange(output->getWidth(), output->getHeight());
+    } else {
+        std::vector<OpenCLDevice::pointer> devices = getSplitDevices();
+        if(devices.size() > 1) {
+            // Thresholding is point-wise, so no halo is needed
+            SlabSplitter::execute(input, output, devices, 0,
+                    boost::bind(&BinaryThresholding::executeOnDevice, this, _1, _2, _3));
         } else {
-            // TODO no 3d image write support
-            OpenCLImageAccess::pointer access2 = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
-            kernel.setArg(0, *access->get3DImage());
-            kernel.setArg(1, *access2->get3DImage());
-            globalSize = cl::NDRange(output->getWidth(), output->getHeight(), output->getDepth());
+            executeOnDevice(input, output, getMainDevice());
         }
-        kernel.setArg(2, (uchar)mLabel);
+    }
+}
+
+template <class T>
+void BinaryThresholding::executeOnHost(T* input, Image::pointer output) {
+    ImageAccess::pointer outputAccess = output->getImageAccess(ACCESS_READ_WRITE);
+    uchar* outputData = (uchar*)outputAccess->get();
+    const uchar label = (uchar)mLabel;
+    const int nrOfVoxels = output->getWidth()*output->getHeight()*output->getDepth();
 
-        cl::CommandQueue queue = device->getCommandQueue();
-        queue.enqueueNDRangeKernel(
-                kernel,
-                cl::NullRange,
-                globalSize,
-                cl::NullRange
-        );
+    // Same inclusive comparisons as the kernels
+    #pragma omp parallel for
+    for(int i = 0; i < nrOfVoxels; i++) {
+        const float value = input[i];
+        bool inside = true;
+        if(mLowerThresholdSet && value < mLowerThreshold)
+            inside = false;
+        if(mUpperThresholdSet && value > mUpperThreshold)
+            inside = false;
+        outputData[i] = inside ? label : 0;
     }
 }
 
+void BinaryThresholding::executeOnDevice(Image::pointer input, Image::pointer output, OpenCLDevice::pointer device) {
+    std::string programName = input->getDimensions() == 3 ? "3D" : "2D";
+    cl::Kernel kernel;
+    if(mLowerThresholdSet && mUpperThresholdSet) {
+        kernel = getOpenCLKernel(device, "thresholding", programName);
+        kernel.setArg(3, mLowerThreshold);
+        kernel.setArg(4, mUpperThreshold);
+    } else if(mLowerThresholdSet) {
+        kernel = getOpenCLKernel(device, "thresholdingWithOnlyLower", programName);
+        kernel.setArg(3, mLowerThreshold);
+    } else {
+        kernel = getOpenCLKernel(device, "thresholdingWithOnlyUpper", programName);
+        kernel.setArg(3, mUpperThreshold);
+    }
+    cl::NDRange globalSize;
+    OpenCLImageAccess::pointer access = input->getOpenCLImageAccess(ACCESS_READ, device);
+    if(input->getDimensions() == 2) {
+        OpenCLImageAccess::pointer access2 = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
+        kernel.setArg(0, *access->get2DImage());
+        kernel.setArg(1, *access2->get2DImage());
+        globalSize = cl::NDRange(output->getWidth(), output->getHeight());
+    } else {
+        // TODO no 3d image write support
+        OpenCLImageAccess::pointer access2 = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
+        kernel.setArg(0, *access->get3DImage());
+        kernel.setArg(1, *access2->get3DImage());
+        globalSize = cl::NDRange(output->getWidth(), output->getHeight(), output->getDepth());
+    }
+    kernel.setArg(2, (uchar)mLabel);
+
+    WorkGroupSizeTuner::enqueueNDRangeKernel(device, kernel, globalSize);
+}
+
 void BinaryThresholding::waitToFinish() {
+    if(getMainDevice()->isHost())
+        return;
     OpenCLDevice::pointer device = OpenCLDevice::pointer(getMainDevice());
     device->getCommandQueue().finish();
 }
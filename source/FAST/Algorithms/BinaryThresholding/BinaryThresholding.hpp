@@ -14,6 +14,9 @@ class BinaryThresholding : public SegmentationAlgorithm {
         BinaryThresholding();
         void execute();
         void waitToFinish();
+        template <class T>
+        void executeOnHost(T* input, Image::pointer output);
+        void executeOnDevice(Image::pointer input, Image::pointer output, OpenCLDevice::pointer device);
 
         float mLowerThreshold;
         float mUpperThreshold;
@@ -2,9 +2,13 @@
 #include "FAST/Data/Segmentation.hpp"
 #include "FAST/Data/LineSet.hpp"
 #include "FAST/Utility.hpp"
-#include <boost/shared_array.hpp>
-#include <unordered_set>
+#include "FAST/WorkGroupSizeTuner.hpp"
+#include "FAST/Algorithms/DistanceTransform/DistanceTransform.hpp"
 #include <stack>
+#include <queue>
+#include <functional>
+#include <algorithm>
+#include <limits>
 #include "FAST/Exporters/MetaImageExporter.hpp"
 
 namespace fast {
@@ -16,144 +20,6 @@ CenterlineExtraction::CenterlineExtraction() {
 	createOpenCLProgram(std::string(FAST_SOURCE_DIR) + "Algorithms/CenterlineExtraction/CenterlineExtraction.cl");
 }
 
-Image::pointer CenterlineExtraction::calculateDistanceTransform(Image::pointer input) {
-	OpenCLDevice::pointer device = getMainDevice();
-	cl::Program program = getOpenCLProgram(device);
-	cl::CommandQueue queue = device->getCommandQueue();
-	const int width = input->getWidth();
-	const int height = input->getHeight();
-	const int depth = input->getDepth();
-
-	Image::pointer distance = Image::New();
-	distance->create(input->getSize(), TYPE_INT16, 1);
-
-
-	// First initialize
-	cl::Kernel initializeKernel(program, "initialize");
-
-	if(device->isWritingTo3DTexturesSupported()) {
-		OpenCLImageAccess::pointer distanceAccess = distance->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
-		OpenCLImageAccess::pointer inputAccess = input->getOpenCLImageAccess(ACCESS_READ, device);
-		initializeKernel.setArg(0, *inputAccess->get3DImage());
-		initializeKernel.setArg(1, *distanceAccess->get3DImage());
-	} else {
-		OpenCLImageAccess::pointer inputAccess = input->getOpenCLImageAccess(ACCESS_READ, device);
-		OpenCLBufferAccess::pointer distanceAccess = distance->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
-		initializeKernel.setArg(0, *inputAccess->get3DImage());
-		initializeKernel.setArg(1, *distanceAccess->get());
-	}
-
-	queue.enqueueNDRangeKernel(
-			initializeKernel,
-			cl::NullRange,
-			cl::NDRange(width, height, depth),
-			cl::NullRange
-    );
-
-	// Iteratively calculate distance
-	Image::pointer distance2 = Image::New();
-	distance2->create(input->getSize(), TYPE_INT16, 1);
-
-	cl::Buffer changedBuffer(
-			device->getContext(),
-			CL_MEM_READ_WRITE,
-			sizeof(char)
-    );
-
-	// TODO no 3D write support
-	cl::Kernel distanceKernel(program, "calculateDistance");
-	distanceKernel.setArg(2, changedBuffer);
-	int counter = 0;
-	if(device->isWritingTo3DTexturesSupported()) {
-		OpenCLImageAccess::pointer distanceAccess = distance->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
-		OpenCLImageAccess::pointer distance2Access = distance2->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
-		cl::Image3D* clDistance = distanceAccess->get3DImage();
-		cl::Image3D* clDistance2 = distance2Access->get3DImage();
-
-		queue.enqueueCopyImage(
-				*clDistance,
-				*clDistance2,
-				createOrigoRegion(),
-				createOrigoRegion(),
-				createRegion(input->getSize())
-		);
-
-		while(true) {
-			// Write 0 to changedBuffer
-			char zero = 0;
-			queue.enqueueWriteBuffer(changedBuffer,CL_FALSE,0,sizeof(char),&zero);
-
-			if(counter % 2 == 0) {
-				distanceKernel.setArg(0, *clDistance);
-				distanceKernel.setArg(1, *clDistance2);
-			} else {
-				distanceKernel.setArg(1, *clDistance);
-				distanceKernel.setArg(0, *clDistance2);
-			}
-			counter++;
-			queue.enqueueNDRangeKernel(
-				distanceKernel,
-				cl::NullRange,
-				cl::NDRange(width, height, depth),
-				cl::NullRange
-			);
-
-			queue.enqueueReadBuffer(changedBuffer,CL_TRUE,0,sizeof(char),&zero);
-			if(zero == 0) {
-				break;
-			}
-		}
-	} else {
-
-		OpenCLBufferAccess::pointer distanceAccess = distance->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
-		OpenCLBufferAccess::pointer distance2Access = distance2->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
-		cl::Buffer* clDistance = distanceAccess->get();
-		cl::Buffer* clDistance2 = distance2Access->get();
-
-		queue.enqueueCopyBuffer(
-				*clDistance,
-				*clDistance2,
-				0,
-				0,
-				input->getSize().x()*input->getSize().y()*input->getSize().z()*sizeof(short)
-		);
-
-		while(true) {
-			// Write 0 to changedBuffer
-			char zero = 0;
-			queue.enqueueWriteBuffer(changedBuffer,CL_FALSE,0,sizeof(char),&zero);
-
-			if(counter % 2 == 0) {
-				distanceKernel.setArg(0, *clDistance);
-				distanceKernel.setArg(1, *clDistance2);
-			} else {
-				distanceKernel.setArg(1, *clDistance);
-				distanceKernel.setArg(0, *clDistance2);
-			}
-			counter++;
-			queue.enqueueNDRangeKernel(
-				distanceKernel,
-				cl::NullRange,
-				cl::NDRange(width, height, depth),
-				cl::NullRange
-			);
-
-			queue.enqueueReadBuffer(changedBuffer,CL_TRUE,0,sizeof(char),&zero);
-			if(zero == 0) {
-				break;
-			}
-		}
-	}
-	reportInfo() << "Calculated distance in " << counter << " steps" << reportEnd();
-
-
-	if(counter % 2 == 0) {
-		return distance;
-	} else {
-		return distance2;
-	}
-}
-
 inline uint linearPosition(Vector3i pos, Vector3i size) {
 	return pos.x() + pos.y()*size.x() + pos.z()*size.x()*size.y();
 }
@@ -168,25 +34,41 @@ inline Vector3i position3D(int pos, Vector3i size) {
 	return Vector3i(x,y,z);
 }
 
-inline double solveQuadratic(boost::shared_array<double> G, boost::shared_array<double> speed, Vector3i pos, Vector3i size) {
+inline bool isInBounds(Vector3i pos, Vector3i size) {
+	return pos.x() >= 0 && pos.y() >= 0 && pos.z() >= 0 &&
+			pos.x() < size.x() && pos.y() < size.y() && pos.z() < size.z();
+}
 
-	std::vector<double> abc = {
-            std::min(G[linearPosition(pos + Vector3i(1,0,0), size)], G[linearPosition(pos - Vector3i(1,0,0), size)]),
-            std::min(G[linearPosition(pos + Vector3i(0,1,0), size)], G[linearPosition(pos - Vector3i(0,1,0), size)]),
-            std::min(G[linearPosition(pos + Vector3i(0,0,1), size)], G[linearPosition(pos - Vector3i(0,0,1), size)])
-	};
+// States of the voxels during fast marching
+enum {
+	FAR = 0,	// Inside the object, G not calculated yet
+	TRIAL = 1,	// In the narrow band
+	FROZEN = 2,	// G is final
+	OUTSIDE = 3	// Outside the object, G stays infinite
+};
+
+/*
+ * Solve the discrete Eikonal equation at pos from the smallest frozen neighbor along each axis
+ */
+inline double solveQuadratic(const double* G, const uchar* state, double f, Vector3i pos, Vector3i size) {
+	const int offsets[3] = {1, size.x(), size.x()*size.y()};
+	const int linearPos = linearPosition(pos, size);
+	double abc[3];
+	for(int axis = 0; axis < 3; ++axis) {
+		abc[axis] = std::numeric_limits<double>::infinity();
+		if(pos[axis] > 0 && state[linearPos - offsets[axis]] == FROZEN)
+			abc[axis] = G[linearPos - offsets[axis]];
+		if(pos[axis] < size[axis] - 1 && state[linearPos + offsets[axis]] == FROZEN)
+			abc[axis] = std::min(abc[axis], G[linearPos + offsets[axis]]);
+	}
 
-	std::sort(abc.begin(), abc.end());
-	double a = abc[2];
+	// Sort so that a >= b >= c
+	if(abc[0] < abc[1]) std::swap(abc[0], abc[1]);
+	if(abc[1] < abc[2]) std::swap(abc[1], abc[2]);
+	if(abc[0] < abc[1]) std::swap(abc[0], abc[1]);
+	double a = abc[0];
 	double b = abc[1];
-	double c = abc[0];
-
-	double f = speed[linearPosition(pos, size)];
-
-	if(f == 0) {
-		std::cout << "speed is zero!" << std::endl;
-		exit(0);
-	}
+	double c = abc[2];
 
 	double u = c + 1.0 / f;
 	if(u <= b) {
@@ -214,41 +96,91 @@ inline double solveQuadratic(boost::shared_array<double> G, boost::shared_array<
 	}
 }
 
-inline void growFromPointsAdded(std::vector<Vector3i> points, boost::shared_array<double> G, std::unordered_set<int>& Sc, std::unordered_set<int>& processed, Vector3i size) {
+/*
+ * Fast marching from the seed with a binary heap as the narrow band.
+ * Heap entries whose value is no longer the G of their voxel are stale and skipped.
+ */
+static void fastMarching(double* G, uchar* state, const float* speed, Vector3i seed, Vector3i size) {
+	typedef std::pair<double, int> HeapEntry;
+	std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry> > narrowBand;
+	const Vector3i neighbors[6] = {
+            Vector3i(1, 0, 0),
+            Vector3i(-1, 0, 0),
+            Vector3i(0, 1, 0),
+            Vector3i(0, -1, 0),
+            Vector3i(0, 0, 1),
+            Vector3i(0, 0, -1)
+	};
 
-	std::stack<Vector3i> stack;
-	stack.push(points[0]);
+	G[linearPosition(seed, size)] = 0;
+	narrowBand.push(HeapEntry(0, linearPosition(seed, size)));
+	while(!narrowBand.empty()) {
+		HeapEntry entry = narrowBand.top();
+		narrowBand.pop();
+		const int current = entry.second;
+		if(state[current] == FROZEN || entry.first != G[current])
+			continue;
+		state[current] = FROZEN;
+
+		const Vector3i currentPos = position3D(current, size);
+		for(int i = 0; i < 6; ++i) {
+			const Vector3i xn = currentPos + neighbors[i];
+			if(!isInBounds(xn, size))
+				continue;
+			const int n = linearPosition(xn, size);
+			if(state[n] == FROZEN || state[n] == OUTSIDE)
+				continue;
+			const double q = solveQuadratic(G, state, speed[n], xn, size);
+			if(q < G[n]) {
+				G[n] = q;
+				state[n] = TRIAL;
+				narrowBand.push(HeapEntry(q, n));
+			}
+		}
+	}
+}
 
-	std::vector<Vector3i> neighbors2;
-    for(int a = -1; a <= 1;  ++a) {
-    for(int b = -1; b <= 1;  ++b) {
-    for(int c = -1; c <= 1;  ++c) {
-    	if(a == 0 && b == 0 && c == 0)
-    		continue;
-    	neighbors2.push_back(Vector3i(a,b,c));
-    }}}
+/*
+ * Remove the candidate centerpoints which are reached by going downhill in G from the new centerline points
+ */
+inline void growFromPointsAdded(const std::vector<Vector3i>& points, const double* G, uchar* isCandidate, uchar* processed, Vector3i size) {
+
+	std::stack<int> stack;
+	stack.push(linearPosition(points[0], size));
 
 	while(!stack.empty()) {
-		Vector3i current = stack.top();
+		const int current = stack.top();
 		stack.pop();
-        std::unordered_set<int>::iterator it = Sc.find(linearPosition(current, size));
-        if(it != Sc.end()) {
-            Sc.erase(it);
-        }
+		isCandidate[current] = 0;
 
 		// Add neighbors
-        for(Vector3i neighbor : neighbors2) {
-            Vector3i xn = current + neighbor;
-            if(G[linearPosition(xn, size)] < G[linearPosition(current, size)]) {
-            	if(processed.count(linearPosition(xn, size)) == 0) {
-                    stack.push(xn);
-                    processed.insert(linearPosition(xn, size));
-            	}
+		const Vector3i currentPos = position3D(current, size);
+        for(int a = -1; a <= 1;  ++a) {
+        for(int b = -1; b <= 1;  ++b) {
+        for(int c = -1; c <= 1;  ++c) {
+            const Vector3i xn = currentPos + Vector3i(a,b,c);
+            if((a == 0 && b == 0 && c == 0) || !isInBounds(xn, size))
+                continue;
+            const int n = linearPosition(xn, size);
+            if(G[n] < G[current] && processed[n] == 0) {
+                stack.push(n);
+                processed[n] = 1;
             }
-        }
+        }}}
 	}
 }
 
+// Orders candidate centerpoints by decreasing G
+class DecreasingG {
+	public:
+		DecreasingG(const double* G) : mG(G) {};
+		bool operator()(int a, int b) const {
+			return mG[a] > mG[b];
+		}
+	private:
+		const double* mG;
+};
+
 void CenterlineExtraction::execute() {
 	Image::pointer input = getStaticInputData<Image>();
 	Vector3f spacing = input->getSpacing();
@@ -257,13 +189,11 @@ void CenterlineExtraction::execute() {
 	LineSetAccess::pointer outputAccess = output->getAccess(ACCESS_READ_WRITE);
 
 	// Do distance transform
-	Image::pointer distance = calculateDistanceTransform(input);
-	/*
-	MetaImageExporter::pointer exporter = MetaImageExporter::New();
-	exporter->setInputData(distance);
-	exporter->setFilename("/home/smistad/distance.mhd");
-	exporter->update();
-	*/
+	DistanceTransform::pointer distanceTransform = DistanceTransform::New();
+	distanceTransform->setInputData(input);
+	distanceTransform->setMainDevice(getMainDevice());
+	distanceTransform->update();
+	Image::pointer distance = distanceTransform->getOutputData<Image>();
 
 	// Extract candidate centerlines, and get max distance
 	const Vector3i size = input->getSize().cast<int>();
@@ -277,13 +207,11 @@ void CenterlineExtraction::execute() {
 
 	{
         OpenCLDevice::pointer device = getMainDevice();
-        cl::Program program = getOpenCLProgram(device);
-        cl::CommandQueue queue = device->getCommandQueue();
         OpenCLImageAccess::pointer distanceAccess = distance->getOpenCLImageAccess(ACCESS_READ, device);
         OpenCLImageAccess::pointer inputAccess = input->getOpenCLImageAccess(ACCESS_READ, device);
 
         // First initialize
-        cl::Kernel candidateKernel(program, "findCandidateCenterpoints");
+        cl::Kernel candidateKernel = getOpenCLKernel(device, "findCandidateCenterpoints");
         candidateKernel.setArg(0, *inputAccess->get3DImage());
         candidateKernel.setArg(1, *distanceAccess->get3DImage());
 
@@ -295,105 +223,57 @@ void CenterlineExtraction::execute() {
 			candidateKernel.setArg(2, *candidateAccess->get());
         }
 
-        queue.enqueueNDRangeKernel(
-            candidateKernel,
-            cl::NullRange,
-            cl::NDRange(width, height, depth),
-            cl::NullRange
-        );
+        WorkGroupSizeTuner::enqueueNDRangeKernel(device, candidateKernel, cl::NDRange(width, height, depth));
 	}
-	/*
-	MetaImageExporter::pointer exporter2 = MetaImageExporter::New();
-	exporter2->setInputData(candidateCenterpointsImage);
-	exporter2->setFilename("/home/smistad/candidates.mhd");
-	exporter2->update();
-	*/
 
 	ImageAccess::pointer inputAccess = input->getImageAccess(ACCESS_READ);
 	ImageAccess::pointer distanceAccess = distance->getImageAccess(ACCESS_READ);
 	ImageAccess::pointer candidateAccess = candidateCenterpointsImage->getImageAccess(ACCESS_READ);
-	short* distanceArray = (short*)distanceAccess->get();
+	float* distanceArray = (float*)distanceAccess->get();
 	uchar* inputArray = (uchar*)inputAccess->get();
 	uchar* candidateArray = (uchar*)candidateAccess->get();
-	int maxDistance = 0;
+	float maxDistance = 0;
 	int maxIndex = 0;
-	boost::shared_array<bool> isInL(new bool[totalSize]);
-	std::unordered_set<int> Sc;
+	std::vector<uchar> state(totalSize);
+	std::vector<uchar> isCandidate(totalSize, 0);
+	std::vector<int> candidates;
 	for(int i = 0; i < totalSize; ++i) {
 		if(inputArray[i] == 1) {
 			// Inside object
-			isInL[i] = false;
+			state[i] = FAR;
 
 			// Get max distance
             if(candidateArray[i] == 1) {
-                short distance = distanceArray[i];
+                float distance = distanceArray[i];
                 if(distance > maxDistance) {
                     maxDistance = distance;
                     maxIndex = i;
                 }
-                Sc.insert(i);
+                isCandidate[i] = 1;
+                candidates.push_back(i);
             }
 		} else {
-			isInL[i] = true;
+			state[i] = OUTSIDE;
 		}
 	}
 	Vector3i maxPosition = position3D(maxIndex, size);
 	reportInfo() << "Max position found at " << maxPosition.transpose() << " with value " << maxDistance << reportEnd();
 
-	// Calculate speed term
+	// Calculate speed term. G is kept in double precision because the speed spans many orders of magnitude.
 	double beta = 1.0 / (0.02*maxDistance);
-	boost::shared_array<double> speed(new double[totalSize]);
-	boost::shared_array<double> G(new double[totalSize]);
-	for(int i = 0; i < totalSize; ++i) {
+	std::vector<float> speed(totalSize);
+	std::vector<double> G(totalSize, std::numeric_limits<double>::infinity());
+	for(int i = 0; i < totalSize; ++i)
 		speed[i] = exp(beta*distanceArray[i]);
-		G[i] = std::numeric_limits<double>::infinity();
-	}
-
-	G[linearPosition(maxPosition, size)] = 0;
-	Vector3i neigbhors[6] = {
-            {1, 0, 0},
-            {-1, 0, 0},
-            {0, 1, 0},
-            {0, -1, 0},
-            {0, 0, 1},
-            {0, 0, -1}
-	};
-	std::vector<Vector3i> L;
-	for(int i = 0; i < 6; ++i) {
-		Vector3i nPos = maxPosition + neigbhors[i];
-		L.push_back(nPos);
-		isInL[linearPosition(nPos, size)] = true;
-	}
 
 	// Do fast marching
-	const double threshold = 0;
-	while(L.size() > 0) {
-		std::vector<Vector3i> L2;
-		for(Vector3i x : L) {
-			double p = G[linearPosition(x, size)];
-			double q = solveQuadratic(G, speed, x, size);
-            G[linearPosition(x, size)] = q;
-            if(fabs(p-q) <= threshold) {
-                for(int i = 0; i < 6; ++i) {
-                    Vector3i xn = x + neigbhors[i];
-                    if(!isInL[linearPosition(xn, size)]) {
-                        double p = G[linearPosition(xn, size)];
-                        double q = solveQuadratic(G, speed, xn, size);
-                        if(p > q) {
-                            G[linearPosition(x, size)] = q;
-                            L2.push_back(xn);
-                            isInL[linearPosition(xn, size)] = true;
-                        }
-                    }
-                }// For all neighbors
-            } else {
-                L2.push_back(x);
-            } // fabs(p-q)
-		} // for all x in L
-		L = L2;
-	} // while L.size() > 0
+	fastMarching(&G[0], &state[0], &speed[0], maxPosition, size);
 	reportInfo() << "Finished fast marching" << reportEnd();
 
+	// G doesn't change anymore, so the candidates can be visited in order of decreasing G
+	std::sort(candidates.begin(), candidates.end(), DecreasingG(&G[0]));
+	std::vector<int>::const_iterator nextCandidate = candidates.begin();
+
 	std::vector<Vector3i> neighbors2;
     for(int a = -1; a <= 1;  ++a) {
     for(int b = -1; b <= 1;  ++b) {
@@ -403,52 +283,48 @@ void CenterlineExtraction::execute() {
     	neighbors2.push_back(Vector3i(a,b,c));
     }}}
 
-    std::unordered_set<int> refinedCenterline;
-    std::unordered_set<int> processed;
+    std::vector<uchar> isInRefinedCenterline(totalSize, 0);
+    std::vector<uchar> processed(totalSize, 0);
 	// Do backtrace
-	while(Sc.size() > 0) {
+	while(true) {
 		// Find candidate centerline point with highest G
-		double maxG = 0.0;
-		int maxLinearPosition = -1;
-		for(int linearPosition : Sc) {
-			if(G[linearPosition] > maxG && !std::isinf(G[linearPosition])) {
-				maxG = G[linearPosition];
-				maxLinearPosition = linearPosition;
-			}
-		}
+		while(nextCandidate != candidates.end() &&
+				(isCandidate[*nextCandidate] == 0 || std::isinf(G[*nextCandidate])))
+			++nextCandidate;
+		if(nextCandidate == candidates.end() || G[*nextCandidate] <= 0.0)
+			break;
+		const int maxLinearPosition = *nextCandidate;
+		const double maxG = G[maxLinearPosition];
 
 		// Convert maxPosition to 3D
 		Vector3i maxPosition = position3D(maxLinearPosition, size);
 		reportInfo() << "Max position found at " << maxPosition.transpose() << " with G: " << maxG << reportEnd();
 
-		if(maxLinearPosition == -1)
-			break;
-
 		std::vector<Vector3i> pointsToAdd;
 		Vector3i current = maxPosition;
 		Vector3i previous = Vector3i::Zero();
 		Vector3i previous2 = Vector3i::Zero();
 		while(true) {
-			std::unordered_set<int>::iterator it = Sc.find(linearPosition(current, size));
-			if(it != Sc.end()) {
-                Sc.erase(it);
-			}
+			isCandidate[linearPosition(current, size)] = 0;
 
 			// Find neighbor point with min G
 			double minG = std::numeric_limits<double>::infinity();
 			Vector3i bestPos;
 			Vector3i bestDPos;
 			double maxD = -1;
-			for(Vector3i n : neighbors2) {
-				Vector3i xn = current + n;
-				if(refinedCenterline.count(linearPosition(xn, size)) > 0) {
-                    if(distanceArray[linearPosition(xn, size)] > maxD) {
-                    	maxD = distanceArray[linearPosition(xn, size)];
+			for(int i = 0; i < neighbors2.size(); ++i) {
+				Vector3i xn = current + neighbors2[i];
+				if(!isInBounds(xn, size))
+					continue;
+				const int n = linearPosition(xn, size);
+				if(isInRefinedCenterline[n] == 1) {
+                    if(distanceArray[n] > maxD) {
+                    	maxD = distanceArray[n];
                     	bestDPos = xn;
                     }
 				}
-				if(G[linearPosition(xn, size)] < minG) {
-					minG = G[linearPosition(xn, size)];
+				if(G[n] < minG) {
+					minG = G[n];
 					bestPos = xn;
 				}
 			}
@@ -471,19 +347,19 @@ void CenterlineExtraction::execute() {
 			if(minG == 0) {
 				break;
 			}
-			if(refinedCenterline.count(linearPosition(current,size)) > 0) {
+			if(isInRefinedCenterline[linearPosition(current,size)] == 1) {
 				// Bifurcation
 				break;
 			}
 		}
 
 		if(pointsToAdd.size() > 10) { // minimum length
-			growFromPointsAdded(pointsToAdd, G, Sc, processed, size);
+			growFromPointsAdded(pointsToAdd, &G[0], &isCandidate[0], &processed[0], size);
 			int counter = outputAccess->getNrOfPoints();
             outputAccess->addPoint(pointsToAdd[0].cast<float>().cwiseProduct(spacing));
-            refinedCenterline.insert(linearPosition(pointsToAdd[0], size));
+            isInRefinedCenterline[linearPosition(pointsToAdd[0], size)] = 1;
 			for(int i = 1; i < pointsToAdd.size(); ++i) {
-                refinedCenterline.insert(linearPosition(pointsToAdd[i], size));
+                isInRefinedCenterline[linearPosition(pointsToAdd[i], size)] = 1;
 				outputAccess->addPoint(pointsToAdd[i].cast<float>().cwiseProduct(spacing));
 				outputAccess->addLine(counter, counter+1);
 				counter += 1;
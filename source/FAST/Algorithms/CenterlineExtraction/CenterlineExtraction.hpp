@@ -13,7 +13,6 @@ class CenterlineExtraction : public ProcessObject {
     private:
 		CenterlineExtraction();
 		void execute();
-        SharedPointer<Image> calculateDistanceTransform(SharedPointer<Image> input);
 };
 
 }
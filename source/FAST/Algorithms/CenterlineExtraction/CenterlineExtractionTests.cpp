@@ -0,0 +1,127 @@
+#include "FAST/Testing.hpp"
+#include "FAST/Algorithms/CenterlineExtraction/CenterlineExtraction.hpp"
+#include "FAST/Algorithms/DistanceTransform/DistanceTransform.hpp"
+#include "FAST/Data/Segmentation.hpp"
+#include "FAST/Data/LineSet.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace fast {
+
+// Distance in mm from point to the line segment from a to b
+static float getDistanceToSegment(Vector3f point, Vector3f a, Vector3f b) {
+	const Vector3f ab = b - a;
+	const float t = std::max(0.0f, std::min(1.0f, (point - a).dot(ab) / ab.dot(ab)));
+	return (point - (a + t*ab)).norm();
+}
+
+// A trunk going down along z, which splits into two thinner branches. The spacing is anisotropic.
+static const Vector3f spacing(0.8, 0.8, 1.2);
+static const float radius = 2.6;
+static const float trunkRadius = 1.5f*radius;
+static const Vector3f topEnd(18, 10, 4*1.2);
+static const Vector3f bifurcation(18, 10, 20*1.2);
+static const Vector3f leftEnd(6, 10, 43);
+static const Vector3f rightEnd(30, 10, 43);
+
+static float getDistanceToAxis(Vector3f point) {
+	return std::min(getDistanceToSegment(point, topEnd, bifurcation),
+			std::min(getDistanceToSegment(point, bifurcation, leftEnd), getDistanceToSegment(point, bifurcation, rightEnd)));
+}
+
+static Segmentation::pointer createYBifurcation() {
+	const uint width = 45, height = 25, depth = 40;
+	std::vector<uchar> values(width*height*depth);
+	for(int z = 0; z < depth; z++) {
+	for(int y = 0; y < height; y++) {
+	for(int x = 0; x < width; x++) {
+		const Vector3f point = Vector3f(x, y, z).cwiseProduct(spacing);
+		const bool inside = getDistanceToSegment(point, topEnd, bifurcation) < trunkRadius ||
+				getDistanceToSegment(point, bifurcation, leftEnd) < radius ||
+				getDistanceToSegment(point, bifurcation, rightEnd) < radius;
+		values[x + y*width + z*width*height] = inside ? 1 : 0;
+	}}}
+	Segmentation::pointer segmentation = Segmentation::New();
+	segmentation->create(width, height, depth, TYPE_UINT8, 1, Host::getInstance(), &values[0]);
+	segmentation->setSpacing(spacing);
+	return segmentation;
+}
+
+TEST_CASE("CenterlineExtraction of a Y bifurcation", "[fast][CenterlineExtraction]") {
+	Segmentation::pointer segmentation = createYBifurcation();
+
+	CenterlineExtraction::pointer extraction = CenterlineExtraction::New();
+	extraction->setInputData(segmentation);
+	extraction->update();
+	LineSet::pointer centerlines = extraction->getOutputData<LineSet>();
+	LineSetAccess::pointer access = centerlines->getAccess(ACCESS_READ);
+
+	// Each centerline is a chain of points, so there is one line less than points per centerline.
+	// Fast marching starts in the thick trunk. The first centerline goes from the end of one branch
+	// to the trunk, the second from the end of the other branch to the bifurcation.
+	const int nrOfCenterlines = access->getNrOfPoints() - access->getNrOfLines();
+	CHECK(nrOfCenterlines == 2);
+
+	float maxDistanceToAxis = 0;
+	float distanceToLeft = std::numeric_limits<float>::max();
+	float distanceToRight = std::numeric_limits<float>::max();
+	float distanceToTop = std::numeric_limits<float>::max();
+	for(uint i = 0; i < access->getNrOfPoints(); i++) {
+		const Vector3f point = access->getPoint(i);
+		maxDistanceToAxis = std::max(maxDistanceToAxis, getDistanceToAxis(point));
+		distanceToLeft = std::min(distanceToLeft, (point - leftEnd).norm());
+		distanceToRight = std::min(distanceToRight, (point - rightEnd).norm());
+		distanceToTop = std::min(distanceToTop, (point - topEnd).norm());
+	}
+
+	// The points lie within one voxel of the axis, and reach within a radius of each end
+	CHECK(maxDistanceToAxis < spacing.maxCoeff());
+	CHECK(distanceToLeft < radius + spacing.maxCoeff());
+	CHECK(distanceToRight < radius + spacing.maxCoeff());
+	CHECK(distanceToTop < radius + spacing.maxCoeff());
+}
+
+TEST_CASE("Distances used by CenterlineExtraction are in millimeters", "[fast][CenterlineExtraction]") {
+	Segmentation::pointer segmentation = createYBifurcation();
+	DistanceTransform::pointer transform = DistanceTransform::New();
+	transform->setInputData(segmentation);
+	transform->update();
+	Image::pointer distance = transform->getOutputData<Image>();
+
+	const int width = segmentation->getWidth();
+	const int height = segmentation->getHeight();
+	const int depth = segmentation->getDepth();
+	ImageAccess::pointer segmentationAccess = segmentation->getImageAccess(ACCESS_READ);
+	ImageAccess::pointer distanceAccess = distance->getImageAccess(ACCESS_READ);
+	const uchar* values = (const uchar*)segmentationAccess->get();
+	const float* distances = (const float*)distanceAccess->get();
+	float maxDistance = 0;
+	float minBoundaryDistance = std::numeric_limits<float>::max();
+	float maxBoundaryDistance = 0;
+	for(int z = 0; z < depth; z++) {
+	for(int y = 0; y < height; y++) {
+	for(int x = 0; x < width; x++) {
+		const int i = x + y*width + z*width*height;
+		if(values[i] == 0)
+			continue;
+		maxDistance = std::max(maxDistance, distances[i]);
+		const bool isBoundary = x == 0 || y == 0 || z == 0 || x == width-1 || y == height-1 || z == depth-1 ||
+				values[i-1] == 0 || values[i+1] == 0 ||
+				values[i-width] == 0 || values[i+width] == 0 ||
+				values[i-width*height] == 0 || values[i+width*height] == 0;
+		if(isBoundary) {
+			minBoundaryDistance = std::min(minBoundaryDistance, distances[i]);
+			maxBoundaryDistance = std::max(maxBoundaryDistance, distances[i]);
+		}
+	}}}
+
+	// Voxels next to the background are one spacing from it, not 0
+	CHECK(minBoundaryDistance > spacing.minCoeff() - 0.0001f);
+	CHECK(maxBoundaryDistance < spacing.maxCoeff() + 0.0001f);
+
+	// The largest distance is the radius of the trunk, which determines the speed in fast marching
+	CHECK(maxDistance > trunkRadius - spacing.maxCoeff());
+	CHECK(maxDistance <= trunkRadius);
+}
+
+} // end namespace fast
@@ -0,0 +1,39 @@
+#define LPOS(pos) pos.x+pos.y*get_global_size(0)+pos.z*get_global_size(0)*get_global_size(1)
+
+// Squared distance is 0 in the background and unknown in the object
+__kernel void initialize(
+        __global const TYPE* input,
+        __global float* output
+    ) {
+    const int4 pos = {get_global_id(0), get_global_id(1), get_global_id(2), 0};
+    output[LPOS(pos)] = input[LPOS(pos)] != 0 ? INFINITY : 0.0f;
+}
+
+// Squared distance transform along one axis: min over q of input(q) + ((p - q)*spacing)^2.
+// Voxels outside the image are background, which bounds the distance. The search stops when
+// the distance along the axis alone is larger than the best squared distance found.
+__kernel void transformAxis(
+        __global const float* input,
+        __global float* output,
+        __private int axis,
+        __private float spacing,
+        __private int isLastPass
+    ) {
+    const int4 pos = {get_global_id(0), get_global_id(1), get_global_id(2), 0};
+    const int position = axis == 0 ? pos.x : (axis == 1 ? pos.y : pos.z);
+    const int n = get_global_size(axis);
+    const int stride = axis == 0 ? 1 : (axis == 1 ? get_global_size(0) : get_global_size(0)*get_global_size(1));
+    const int i = LPOS(pos);
+
+    const float outside = min(position + 1, n - position)*spacing;
+    float best = min(input[i], outside*outside);
+    for(int k = 1; (k*spacing)*(k*spacing) < best; ++k) {
+        const float distance = (k*spacing)*(k*spacing);
+        if(position - k >= 0)
+            best = min(best, input[i - k*stride] + distance);
+        if(position + k < n)
+            best = min(best, input[i + k*stride] + distance);
+    }
+
+    output[i] = isLastPass ? sqrt(best) : best;
+}
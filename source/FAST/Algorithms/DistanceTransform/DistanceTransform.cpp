@@ -0,0 +1,180 @@
+#include "FAST/Algorithms/DistanceTransform/DistanceTransform.hpp"
+#include "FAST/Algorithms/SeparableConvolution.hpp"
+#include "FAST/DeviceManager.hpp"
+#include "FAST/SceneGraph.hpp"
+#include "FAST/OpenCLMemoryPool.hpp"
+#include "FAST/WorkGroupSizeTuner.hpp"
+#include <vector>
+#include <limits>
+#include <cmath>
+
+namespace fast {
+
+DistanceTransform::DistanceTransform() {
+    createInputPort<Image>(0);
+    createOutputPort<Image>(0, OUTPUT_DEPENDS_ON_INPUT, 0);
+    createOpenCLProgram(std::string(FAST_SOURCE_DIR) + "Algorithms/DistanceTransform/DistanceTransform.cl");
+}
+
+void DistanceTransform::execute() {
+    Image::pointer input = getStaticInputData<Image>(0);
+    if(input->getNrOfComponents() != 1)
+        throw Exception("DistanceTransform doesn't support images with several components.");
+
+    Image::pointer output = getStaticOutputData<Image>(0);
+    if(input->getDimensions() == 2) {
+        output->create(input->getWidth(), input->getHeight(), TYPE_FLOAT, 1);
+    } else {
+        output->create(input->getWidth(), input->getHeight(), input->getDepth(), TYPE_FLOAT, 1);
+    }
+    output->setSpacing(input->getSpacing());
+    SceneGraph::setParentNode(output, input);
+
+    if(getMainDevice()->isHost()) {
+        executeOnHost(input, output);
+    } else {
+        executeOnDevice(input, output, getMainDevice());
+    }
+}
+
+// Squared distance transform of one line: d(p) = min over q of ((p - q)*spacing)^2 + f(q), where f is infinite
+// in the object. The lower envelope of the parabolas of the finite sites is found first, and then sampled at each p.
+// Voxels outside the line are background, so the sites -1 and n with f = 0 are always included.
+// v and z are scratch arrays with room for n + 2 and n + 3 elements.
+static void transformLine(const float* f, float* d, int n, float spacing, int* v, float* z) {
+    const float spacing2 = spacing*spacing;
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    // Sites of the parabolas in the envelope, and the boundaries between them
+    int k = 0;
+    v[0] = -1;
+    z[0] = -infinity;
+    z[1] = infinity;
+    for(int q = 0; q <= n; ++q) {
+        const float fq = q < n ? f[q] : 0.0f;
+        if(std::isinf(fq))
+            continue;
+        // Remove the parabolas which are hidden by the one of q
+        float s;
+        while(true) {
+            const int r = v[k];
+            const float fr = r >= 0 ? f[r] : 0.0f;
+            s = ((fq - fr)/spacing2 + (float)(q*q - r*r)) / (2.0f*(q - r));
+            if(s > z[k])
+                break;
+            --k;
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k+1] = infinity;
+    }
+
+    k = 0;
+    for(int p = 0; p < n; ++p) {
+        while(z[k+1] < p)
+            ++k;
+        const int r = v[k];
+        const float fr = r >= 0 && r < n ? f[r] : 0.0f;
+        d[p] = (float)((p - r)*(p - r))*spacing2 + fr;
+    }
+}
+
+// Transform each line along axis, where the lines are gathered to contiguous memory first
+static void transformAxis(const float* input, float* output, const Vector3ui& size, int axis, float spacing) {
+    const int n = size[axis];
+    const std::size_t stride = axis == 0 ? 1 : (axis == 1 ? size.x() : (std::size_t)size.x()*size.y());
+    const int nrOfLines = (std::size_t)size.x()*size.y()*size.z() / n;
+    #pragma omp parallel
+    {
+        std::vector<float> f(n);
+        std::vector<float> d(n);
+        std::vector<int> v(n + 2);
+        std::vector<float> z(n + 3);
+        #pragma omp for
+        for(int line = 0; line < nrOfLines; ++line) {
+            std::size_t start;
+            if(axis == 0) {
+                start = (std::size_t)line*n;
+            } else if(axis == 1) {
+                start = (line % size.x()) + (std::size_t)(line / size.x())*size.x()*size.y();
+            } else {
+                start = line;
+            }
+            for(int i = 0; i < n; ++i)
+                f[i] = input[start + i*stride];
+            transformLine(&f[0], &d[0], n, spacing, &v[0], &z[0]);
+            for(int i = 0; i < n; ++i)
+                output[start + i*stride] = d[i];
+        }
+    }
+}
+
+void DistanceTransform::executeOnHost(Image::pointer input, Image::pointer output) {
+    const Vector3ui size(input->getWidth(), input->getHeight(), input->getDepth());
+    const Vector3f spacing = input->getSpacing();
+    const int totalSize = size.x()*size.y()*size.z();
+    std::vector<float> buffer(totalSize);
+    std::vector<float> buffer2(totalSize);
+
+    SeparableConvolution::getFirstComponent(input, &buffer[0]);
+    #pragma omp parallel for
+    for(int i = 0; i < totalSize; ++i)
+        buffer[i] = buffer[i] != 0 ? std::numeric_limits<float>::infinity() : 0.0f;
+
+    float* source = &buffer[0];
+    float* destination = &buffer2[0];
+    for(int axis = 0; axis < (int)input->getDimensions(); ++axis) {
+        transformAxis(source, destination, size, axis, spacing[axis]);
+        std::swap(source, destination);
+    }
+
+    ImageAccess::pointer access = output->getImageAccess(ACCESS_READ_WRITE);
+    float* outputData = (float*)access->get();
+    #pragma omp parallel for
+    for(int i = 0; i < totalSize; ++i)
+        outputData[i] = std::sqrt(source[i]);
+}
+
+void DistanceTransform::executeOnDevice(Image::pointer input, Image::pointer output, OpenCLDevice::pointer device) {
+    const uint width = input->getWidth();
+    const uint height = input->getHeight();
+    const uint depth = input->getDepth();
+    const Vector3f spacing = input->getSpacing();
+    const std::string buildOptions = "-DTYPE=" + getCTypeAsString(input->getDataType());
+
+    OpenCLBufferAccess::pointer inputAccess = input->getOpenCLBufferAccess(ACCESS_READ, device);
+    OpenCLBufferAccess::pointer outputAccess = output->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
+    OpenCLMemoryPool::pointer pool = OpenCLMemoryPool::getInstance(device);
+    cl::Buffer buffers[2];
+    buffers[0] = pool->acquireBuffer(sizeof(cl_float)*width*height*depth);
+    buffers[1] = pool->acquireBuffer(sizeof(cl_float)*width*height*depth);
+    const cl::NDRange globalSize(width, height, depth);
+
+    cl::Kernel initializeKernel = getOpenCLKernel(device, "initialize", "", buildOptions);
+    initializeKernel.setArg(0, *inputAccess->get());
+    initializeKernel.setArg(1, buffers[0]);
+    WorkGroupSizeTuner::enqueueNDRangeKernel(device, initializeKernel, globalSize);
+
+    // The last pass takes the square root and writes to the output
+    cl::Kernel transformKernel = getOpenCLKernel(device, "transformAxis", "", buildOptions);
+    const int dimensions = input->getDimensions();
+    for(int axis = 0; axis < dimensions; ++axis) {
+        const bool isLastPass = axis == dimensions - 1;
+        transformKernel.setArg(0, buffers[axis % 2]);
+        if(isLastPass) {
+            transformKernel.setArg(1, *outputAccess->get());
+        } else {
+            transformKernel.setArg(1, buffers[(axis + 1) % 2]);
+        }
+        transformKernel.setArg(2, axis);
+        transformKernel.setArg(3, spacing[axis]);
+        transformKernel.setArg(4, (int)isLastPass);
+        WorkGroupSizeTuner::enqueueNDRangeKernel(device, transformKernel, globalSize);
+    }
+
+    pool->release(buffers[0]);
+    pool->release(buffers[1]);
+}
+
+} // end namespace fast
@@ -0,0 +1,32 @@
+#ifndef DISTANCE_TRANSFORM_HPP_
+#define DISTANCE_TRANSFORM_HPP_
+
+#include "FAST/ProcessObject.hpp"
+#include "FAST/Data/Image.hpp"
+
+namespace fast {
+
+/**
+ * Exact Euclidean distance transform of a segmentation.
+ *
+ * The output is a float image where each voxel of the object (non-zero input) holds the distance in millimeters
+ * to the closest background voxel, using the spacing of the input. Background voxels are 0,
+ * and voxels outside the image count as background.
+ *
+ * The squared distance is separable, so it is calculated with one pass along each axis. The host finds the
+ * lower envelope of the parabolas of each line in linear time (Felzenszwalb and Huttenlocher), while on
+ * OpenCL devices each voxel searches its line outwards until no voxel further away can be closer.
+ */
+class DistanceTransform : public ProcessObject {
+    FAST_OBJECT(DistanceTransform)
+    public:
+    private:
+        DistanceTransform();
+        void execute();
+        void executeOnHost(Image::pointer input, Image::pointer output);
+        void executeOnDevice(Image::pointer input, Image::pointer output, OpenCLDevice::pointer device);
+};
+
+} // end namespace fast
+
+#endif
@@ -0,0 +1,100 @@
+#include "FAST/Testing.hpp"
+#include "FAST/Algorithms/DistanceTransform/DistanceTransform.hpp"
+#include "FAST/DeviceManager.hpp"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace fast {
+
+// An ellipsoid with holes in it, touching the image border along x
+static Image::pointer createSegmentation(uint width, uint height, uint depth, Vector3f spacing) {
+    std::vector<uchar> values(width*height*depth);
+    for(int z = 0; z < depth; z++) {
+    for(int y = 0; y < height; y++) {
+    for(int x = 0; x < width; x++) {
+        const float dx = (x - width*0.5f) / (width*0.5f);
+        const float dy = (y - height*0.5f) / (height*0.4f);
+        const float dz = depth > 1 ? (z - depth*0.5f) / (depth*0.4f) : 0.0f;
+        const bool isHole = (x*7 + y*13 + z*5) % 37 == 0;
+        values[x + y*width + z*width*height] = dx*dx + dy*dy + dz*dz < 1.0f && !isHole ? 1 : 0;
+    }}}
+
+    Image::pointer image = Image::New();
+    if(depth == 1) {
+        image->create(width, height, TYPE_UINT8, 1, Host::getInstance(), &values[0]);
+    } else {
+        image->create(width, height, depth, TYPE_UINT8, 1, Host::getInstance(), &values[0]);
+    }
+    image->setSpacing(spacing);
+    return image;
+}
+
+// Largest difference between the distance transform and the distance to the closest background voxel found by brute force
+static float getMaxError(Image::pointer segmentation, ExecutionDevice::pointer device) {
+    DistanceTransform::pointer transform = DistanceTransform::New();
+    transform->setInputData(segmentation);
+    transform->setMainDevice(device);
+    transform->update();
+    Image::pointer result = transform->getOutputData<Image>();
+    CHECK(result->getDataType() == TYPE_FLOAT);
+
+    const int width = segmentation->getWidth();
+    const int height = segmentation->getHeight();
+    const int depth = segmentation->getDepth();
+    const Vector3f spacing = segmentation->getSpacing();
+    ImageAccess::pointer segmentationAccess = segmentation->getImageAccess(ACCESS_READ);
+    ImageAccess::pointer resultAccess = result->getImageAccess(ACCESS_READ);
+    const uchar* values = (const uchar*)segmentationAccess->get();
+    const float* distances = (const float*)resultAccess->get();
+
+    // Voxels outside the image are background
+    const int minZ = depth > 1 ? -1 : 0;
+    const int maxZ = depth > 1 ? depth : 0;
+    float maxError = 0;
+    for(int z = 0; z < depth; z++) {
+    for(int y = 0; y < height; y++) {
+    for(int x = 0; x < width; x++) {
+        float expected = 0;
+        if(values[x + y*width + z*width*height] == 1) {
+            expected = std::numeric_limits<float>::max();
+            for(int c = minZ; c <= maxZ; c++) {
+            for(int b = -1; b <= height; b++) {
+            for(int a = -1; a <= width; a++) {
+                const bool isOutside = a < 0 || b < 0 || c < 0 || a >= width || b >= height || c >= depth;
+                if(!isOutside && values[a + b*width + c*width*height] == 1)
+                    continue;
+                const Vector3f difference = Vector3f(x - a, y - b, z - c).cwiseProduct(spacing);
+                expected = std::min(expected, difference.norm());
+            }}}
+        }
+        maxError = std::max(maxError, std::fabs(expected - distances[x + y*width + z*width*height]));
+    }}}
+    return maxError;
+}
+
+TEST_CASE("DistanceTransform on host matches brute force", "[fast][DistanceTransform]") {
+    CHECK(getMaxError(createSegmentation(40, 30, 1, Vector3f(0.5, 1.5, 1)), Host::getInstance()) < 0.0001);
+    CHECK(getMaxError(createSegmentation(24, 20, 16, Vector3f(0.7, 1.3, 2.1)), Host::getInstance()) < 0.0001);
+}
+
+TEST_CASE("DistanceTransform on OpenCL device matches brute force", "[fast][DistanceTransform]") {
+    std::vector<OpenCLDevice::pointer> devices = DeviceManager::getInstance().getAllDevices();
+    for(int i = 0; i < devices.size(); i++) {
+        INFO("Device " << devices[i]->getName());
+        CHECK(getMaxError(createSegmentation(40, 30, 1, Vector3f(0.5, 1.5, 1)), devices[i]) < 0.0001);
+        CHECK(getMaxError(createSegmentation(24, 20, 16, Vector3f(0.7, 1.3, 2.1)), devices[i]) < 0.0001);
+    }
+}
+
+TEST_CASE("DistanceTransform of image with several components throws", "[fast][DistanceTransform]") {
+    std::vector<float> values(8*8*2, 1);
+    Image::pointer image = Image::New();
+    image->create(8, 8, TYPE_FLOAT, 2, Host::getInstance(), &values[0]);
+
+    DistanceTransform::pointer transform = DistanceTransform::New();
+    transform->setInputData(image);
+    CHECK_THROWS(transform->update());
+}
+
+} // end namespace fast
@@ -2,6 +2,13 @@
 #include "FAST/Exception.hpp"
 #include "FAST/DeviceManager.hpp"
 #include "FAST/Data/Image.hpp"
+#include "FAST/OpenCLProgram.hpp"
+#include "FAST/OpenCLMemoryPool.hpp"
+#include "FAST/SlabSplitter.hpp"
+#include "FAST/Algorithms/SeparableConvolution.hpp"
+#include "FAST/WorkGroupSizeTuner.hpp"
+#include <boost/bind.hpp>
+#include <cmath>
 using namespace fast;
 
 void GaussianSmoothingFilter::setMaskSize(unsigned char maskSize) {
@@ -21,6 +28,15 @@ void GaussianSmoothingFilter::setOutputType(DataType type) {
     mIsModified = true;
 }
 
+void GaussianSmoothingFilter::setRecursiveFilterThreshold(float stdDev) {
+    mRecursiveFilterThreshold = stdDev;
+    mIsModified = true;
+}
+
+bool GaussianSmoothingFilter::useRecursiveFilter() const {
+    return mStdDev >= mRecursiveFilterThreshold;
+}
+
 void GaussianSmoothingFilter::setStandardDeviation(float stdDev) {
     if(stdDev <= 0)
         throw Exception("Standard deviation of GaussianSmoothingFilter can't be less than 0.");
@@ -35,12 +51,17 @@ GaussianSmoothingFilter::GaussianSmoothingFilter() {
     createOutputPort<Image>(0, OUTPUT_DEPENDS_ON_INPUT, 0);
     createOpenCLProgram(std::string(FAST_SOURCE_DIR) + "Algorithms/GaussianSmoothingFilter/GaussianSmoothingFilter2D.cl", "2D");
     createOpenCLProgram(std::string(FAST_SOURCE_DIR) + "Algorithms/GaussianSmoothingFilter/GaussianSmoothingFilter3D.cl", "3D");
+    // A variant is compiled for each mask size, keep only the most recently used ones
+    setMaximumNumberOfOpenCLProgramVariants(8, "2D");
+    setMaximumNumberOfOpenCLProgramVariants(8, "3D");
+    createOpenCLProgram(std::string(FAST_SOURCE_DIR) + "Algorithms/GaussianSmoothingFilter/RecursiveGaussian.cl", "Recursive");
     mStdDev = 0.5f;
+    mRecursiveFilterThreshold = 4.0f;
     mMaskSize = -1;
     mIsModified = true;
     mRecreateMask = true;
-    mDimensionCLCodeCompiledFor = 0;
     mMask = NULL;
+    mMaskIsSeparable = false;
     mOutputTypeSet = false;
 }
 
@@ -50,9 +71,11 @@ GaussianSmoothingFilter::~GaussianSmoothingFilter() {
 
 // TODO have to set mRecreateMask to true if input change dimension
 void GaussianSmoothingFilter::createMask(Image::pointer input, uchar maskSize, bool useSeperableFilter) {
-    if(!mRecreateMask)
+    if(!mRecreateMask && useSeperableFilter == mMaskIsSeparable)
         return;
 
+    delete[] mMask;
+
     unsigned char halfSize = (maskSize-1)/2;
     float sum = 0.0f;
 
@@ -97,116 +120,200 @@ void GaussianSmoothingFilter::createMask(Image::pointer input, uchar maskSize, b
         }
     }
 
-    ExecutionDevice::pointer device = getMainDevice();
-    if(!device->isHost()) {
-        OpenCLDevice::pointer clDevice = device;
-        uint bufferSize;
-        if(useSeperableFilter) {
-            bufferSize = maskSize;
-        } else {
-            bufferSize = input->getDimensions() == 2 ? maskSize*maskSize : maskSize*maskSize*maskSize;
-        }
-        mCLMask = cl::Buffer(
-                clDevice->getContext(),
+    // The OpenCL buffers are created for each device when needed
+    mCLMasks.clear();
+    if(useSeperableFilter) {
+        mMaskLength = maskSize;
+    } else {
+        mMaskLength = input->getDimensions() == 2 ? maskSize*maskSize : maskSize*maskSize*maskSize;
+    }
+    mMaskIsSeparable = useSeperableFilter;
+    mRecreateMask = false;
+}
+
+cl::Buffer GaussianSmoothingFilter::getMaskBuffer(OpenCLDevice::pointer device) {
+    if(mCLMasks.count(device) == 0) {
+        mCLMasks[device] = cl::Buffer(
+                device->getContext(),
                 CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
-                sizeof(float)*bufferSize,
+                sizeof(float)*mMaskLength,
                 mMask
         );
     }
-
-    mRecreateMask = false;
+    return mCLMasks[device];
 }
 
-void GaussianSmoothingFilter::recompileOpenCLCode(Image::pointer input) {
-    // Check if there is a need to recompile OpenCL code
-    if(input->getDimensions() == mDimensionCLCodeCompiledFor &&
-            input->getDataType() == mTypeCLCodeCompiledFor)
-        return;
+uchar GaussianSmoothingFilter::getMaskSize() const {
+    char maskSize = mMaskSize;
+    if(maskSize <= 0) // If mask size is not set calculate it instead
+        maskSize = ceil(2*mStdDev)*2+1;
 
-    OpenCLDevice::pointer device = getMainDevice();
-    std::string buildOptions = "";
+    if(maskSize > 19)
+        maskSize = 19;
+
+    return maskSize;
+}
+
+std::string GaussianSmoothingFilter::getOpenCLBuildOptions(DataType outputType, OpenCLDevice::pointer device, uchar maskSize) {
+    OpenCLDefines constants;
+    constants.set("MASK_SIZE", (int)maskSize);
     if(!device->isWritingTo3DTexturesSupported()) {
-        buildOptions = "-DTYPE=" + getCTypeAsString(mOutputType);
+        constants.set("TYPE", getCTypeAsString(outputType));
     }
-    cl::Program program;
-    if(input->getDimensions() == 2) {
-        program = getOpenCLProgram(device, "2D", buildOptions);
+    return getSpecializedBuildOptions(constants);
+}
+
+static std::string getRecursiveBuildOptions(DataType outputType) {
+    std::string buildOptions = "-DTYPE=" + getCTypeAsString(outputType);
+    if(outputType != TYPE_FLOAT)
+        buildOptions += " -DROUND";
+    return buildOptions;
+}
+
+std::vector<std::pair<std::string, std::string> > GaussianSmoothingFilter::getOpenCLProgramVariants(DataType type, uint dimensions) {
+    std::vector<std::pair<std::string, std::string> > variants;
+    if(useRecursiveFilter()) {
+        variants.push_back(getOpenCLProgramVariant("Recursive", getRecursiveBuildOptions(mOutputTypeSet ? mOutputType : type)));
+    } else {
+        std::string buildOptions = getOpenCLBuildOptions(mOutputTypeSet ? mOutputType : type, getMainDevice(), getMaskSize());
+        variants.push_back(getOpenCLProgramVariant(dimensions == 2 ? "2D" : "3D", buildOptions));
+    }
+    return variants;
+}
+
+// Normalized 1D Gaussian mask. The 2D and 3D masks are outer products of this mask with itself.
+static std::vector<float> createSeparableMask(float stdDev, uchar maskSize) {
+    const int halfSize = (maskSize-1)/2;
+    std::vector<float> mask(maskSize);
+    float sum = 0.0f;
+    for(int x = -halfSize; x <= halfSize; x++) {
+        float value = exp(-(float)(x*x)/(2.0f*stdDev*stdDev));
+        mask[x+halfSize] = value;
+        sum += value;
+    }
+    for(int i = 0; i < maskSize; ++i)
+        mask[i] /= sum;
+    return mask;
+}
+
+// Coefficients of the recursive Gaussian filter by Young and van Vliet (1995),
+// "Recursive implementation of the Gaussian filter". b1, b2 and b3 are divided by b0.
+struct RecursiveGaussianCoefficients {
+    float B, b1, b2, b3;
+};
+
+static RecursiveGaussianCoefficients getRecursiveGaussianCoefficients(float stdDev) {
+    float q;
+    if(stdDev >= 2.5f) {
+        q = 0.98711f*stdDev - 0.96330f;
     } else {
-        program = getOpenCLProgram(device, "3D", buildOptions);
+        q = 3.97156f - 4.14554f*sqrt(1.0f - 0.26891f*stdDev);
     }
-    mKernel = cl::Kernel(program, "gaussianSmoothing");
-    mDimensionCLCodeCompiledFor = input->getDimensions();
-    mTypeCLCodeCompiledFor = input->getDataType();
+    const float b0 = 1.57825f + 2.44413f*q + 1.4281f*q*q + 0.422205f*q*q*q;
+    const float b1 = 2.44413f*q + 2.85619f*q*q + 1.26661f*q*q*q;
+    const float b2 = -(1.4281f*q*q + 1.26661f*q*q*q);
+    const float b3 = 0.422205f*q*q*q;
+
+    RecursiveGaussianCoefficients coefficients;
+    coefficients.B = 1.0f - (b1 + b2 + b3)/b0;
+    coefficients.b1 = b1/b0;
+    coefficients.b2 = b2/b0;
+    coefficients.b3 = b3/b0;
+    return coefficients;
 }
 
-template <class T>
-void executeAlgorithmOnHost(Image::pointer input, Image::pointer output, float * mask, unsigned char maskSize) {
-    // TODO: this method currently only processes the first component
-    unsigned int nrOfComponents = input->getNrOfComponents();
-    ImageAccess::pointer inputAccess = input->getImageAccess(ACCESS_READ);
-    ImageAccess::pointer outputAccess = output->getImageAccess(ACCESS_READ_WRITE);
+// Apply the recursive filter in place on nrOfLines lines which start at consecutive elements, and which have
+// length elements that are stride apart. The lines are filtered together, so that the inner loops are contiguous.
+// The values outside a line are equal to its edge values, as in RecursiveGaussian.cl.
+static void recursiveFilterLines(float* data, uint length, std::size_t stride, uint nrOfLines, const RecursiveGaussianCoefficients& c) {
+    // Causal pass
+    std::vector<float> edge(data, data + nrOfLines);
+    for(uint n = 0; n < length; ++n) {
+        float* current = data + n*stride;
+        const float* previous1 = n >= 1 ? data + (n-1)*stride : &edge[0];
+        const float* previous2 = n >= 2 ? data + (n-2)*stride : &edge[0];
+        const float* previous3 = n >= 3 ? data + (n-3)*stride : &edge[0];
+        for(uint i = 0; i < nrOfLines; ++i)
+            current[i] = c.B*current[i] + c.b1*previous1[i] + c.b2*previous2[i] + c.b3*previous3[i];
+    }
 
-    T * inputData = (T*)inputAccess->get();
-    T * outputData = (T*)outputAccess->get();
+    // Anti-causal pass
+    edge.assign(data + (length-1)*stride, data + (length-1)*stride + nrOfLines);
+    for(int n = length-1; n >= 0; --n) {
+        float* current = data + n*stride;
+        const float* next1 = n+1 < (int)length ? data + (n+1)*stride : &edge[0];
+        const float* next2 = n+2 < (int)length ? data + (n+2)*stride : &edge[0];
+        const float* next3 = n+3 < (int)length ? data + (n+3)*stride : &edge[0];
+        for(uint i = 0; i < nrOfLines; ++i)
+            current[i] = c.B*current[i] + c.b1*next1[i] + c.b2*next2[i] + c.b3*next3[i];
+    }
+}
 
-    const unsigned char halfSize = (maskSize-1)/2;
-    unsigned int width = input->getWidth();
-    unsigned int height = input->getHeight();
+// Recursive filtering on the host, one pass for each dimension
+static void executeRecursiveAlgorithmOnHost(Image::pointer input, Image::pointer output, float stdDev) {
+    const RecursiveGaussianCoefficients coefficients = getRecursiveGaussianCoefficients(stdDev);
+    const uint width = input->getWidth();
+    const uint height = input->getHeight();
+    const uint depth = input->getDimensions() == 3 ? input->getDepth() : 1;
+    std::vector<float> buffer((std::size_t)width*height*depth);
+    float* data = &buffer[0];
+
+    SeparableConvolution::getFirstComponent(input, data);
+
+    // Along x, one line at a time
+    #pragma omp parallel for
+    for(int row = 0; row < (int)(height*depth); ++row)
+        recursiveFilterLines(data + (std::size_t)row*width, width, 1, 1, coefficients);
+
+    // Along y and z, blocks of lines which are next to each other along x
+    const uint blockSize = 256;
+    const int nrOfBlocks = (width + blockSize - 1)/blockSize;
+    #pragma omp parallel for
+    for(int i = 0; i < (int)depth*nrOfBlocks; ++i) {
+        const uint z = i / nrOfBlocks;
+        const uint x = (i % nrOfBlocks)*blockSize;
+        recursiveFilterLines(data + x + (std::size_t)z*width*height, height, width, std::min(blockSize, width - x), coefficients);
+    }
     if(input->getDimensions() == 3) {
-        unsigned int depth = input->getDepth();
-        for(unsigned int z = 0; z < depth; z++) {
-        for(unsigned int y = 0; y < height; y++) {
-        for(unsigned int x = 0; x < width; x++) {
-
-            if(x < halfSize || x >= width-halfSize ||
-            y < halfSize || y >= height-halfSize ||
-            z < halfSize || z >= depth-halfSize) {
-                // on border only copy values
-                outputData[x*nrOfComponents+y*nrOfComponents*width+z*nrOfComponents*width*height] = inputData[x*nrOfComponents+y*nrOfComponents*width+z*nrOfComponents*width*height];
-                continue;
-            }
+        #pragma omp parallel for
+        for(int i = 0; i < (int)height*nrOfBlocks; ++i) {
+            const uint y = i / nrOfBlocks;
+            const uint x = (i % nrOfBlocks)*blockSize;
+            recursiveFilterLines(data + x + (std::size_t)y*width, depth, (std::size_t)width*height, std::min(blockSize, width - x), coefficients);
+        }
+    }
 
-            double sum = 0.0;
-            for(int c = -halfSize; c <= halfSize; c++) {
-            for(int b = -halfSize; b <= halfSize; b++) {
-            for(int a = -halfSize; a <= halfSize; a++) {
-                sum += mask[a+halfSize+(b+halfSize)*maskSize+(c+halfSize)*maskSize*maskSize]*
-                        inputData[(x+a)*nrOfComponents+(y+b)*nrOfComponents*width+(z+c)*nrOfComponents*width*height];
-            }}}
-            outputData[x*nrOfComponents+y*nrOfComponents*width+z*nrOfComponents*width*height] = (T)sum;
-        }}}
-    } else {
-        for(unsigned int y = halfSize; y < height-halfSize; y++) {
-        for(unsigned int x = halfSize; x < width-halfSize; x++) {
-
-            if(x < halfSize || x >= width-halfSize ||
-            y < halfSize || y >= height-halfSize) {
-                // on border only copy values
-                outputData[x*nrOfComponents+y*nrOfComponents*width] = inputData[x*nrOfComponents+y*nrOfComponents*width];
-                continue;
-            }
+    SeparableConvolution::setFirstComponent(data, output);
+}
 
-            double sum = 0.0;
-            for(int b = -halfSize; b <= halfSize; b++) {
-            for(int a = -halfSize; a <= halfSize; a++) {
-                sum += mask[a+halfSize+(b+halfSize)*maskSize]*
-                        inputData[(x+a)*nrOfComponents+(y+b)*nrOfComponents*width];
-            }}
-            outputData[x*nrOfComponents+y*nrOfComponents*width] = (T)sum;
-        }}
+// Separable filtering, one pass for each dimension
+// TODO: this method currently only processes the first component
+static void executeAlgorithmOnHost(Image::pointer input, Image::pointer output, float stdDev, uchar maskSize) {
+    const std::vector<float> mask = createSeparableMask(stdDev, maskSize);
+    const uint width = input->getWidth();
+    const uint height = input->getHeight();
+    const uint depth = input->getDimensions() == 3 ? input->getDepth() : 1;
+    std::vector<float> buffer((std::size_t)width*height*depth);
+    std::vector<float> buffer2((std::size_t)width*height*depth);
+
+    SeparableConvolution::getFirstComponent(input, &buffer[0]);
+
+    SeparableConvolution::convolveX(&buffer[0], &buffer2[0], width, height*depth, mask);
+    SeparableConvolution::convolveRows(&buffer2[0], &buffer[0], width, height, depth, false, mask);
+    float* result = &buffer[0];
+    if(input->getDimensions() == 3) {
+        SeparableConvolution::convolveRows(&buffer[0], &buffer2[0], width, height, depth, true, mask);
+        result = &buffer2[0];
     }
+
+    SeparableConvolution::setFirstComponent(result, output);
 }
 
 void GaussianSmoothingFilter::execute() {
     Image::pointer input = getStaticInputData<Image>(0);
     Image::pointer output = getStaticOutputData<Image>(0);
 
-    char maskSize = mMaskSize;
-    if(maskSize <= 0) // If mask size is not set calculate it instead
-        maskSize = ceil(2*mStdDev)*2+1;
-
-    if(maskSize > 19)
-        maskSize = 19;
+    uchar maskSize = getMaskSize();
 
     // Initialize output image
     ExecutionDevice::pointer device = getMainDevice();
@@ -221,88 +328,159 @@ void GaussianSmoothingFilter::execute() {
 
 
     if(device->isHost()) {
-        createMask(input, maskSize, false);
-        switch(input->getDataType()) {
-            fastSwitchTypeMacro(executeAlgorithmOnHost<FAST_TYPE>(input, output, mMask, maskSize));
+        if(useRecursiveFilter()) {
+            executeRecursiveAlgorithmOnHost(input, output, mStdDev);
+        } else {
+            executeAlgorithmOnHost(input, output, mStdDev, maskSize);
         }
+    } else if(useRecursiveFilter()) {
+        // The recursive filter has no finite halo, so it is not split across devices
+        executeRecursiveOnDevice(input, output, getMainDevice());
     } else {
-        OpenCLDevice::pointer clDevice = device;
+        std::vector<OpenCLDevice::pointer> devices = getSplitDevices();
+        if(devices.size() > 1) {
+            if(input->getDimensions() == 3) {
+                for(uint i = 1; i < devices.size(); ++i) {
+                    if(devices[i]->isWritingTo3DTexturesSupported() != devices[0]->isWritingTo3DTexturesSupported())
+                        throw Exception("All split devices of GaussianSmoothingFilter must either support or not support writing to 3D images");
+                }
+            }
+            SlabSplitter::execute(input, output, devices, (maskSize-1)/2,
+                    boost::bind(&GaussianSmoothingFilter::executeOnDevice, this, _1, _2, _3, maskSize));
+        } else {
+            executeOnDevice(input, output, getMainDevice(), maskSize);
+        }
+    }
+}
 
-        recompileOpenCLCode(input);
+void GaussianSmoothingFilter::executeOnDevice(Image::pointer input, Image::pointer output, OpenCLDevice::pointer device, uchar maskSize) {
+    std::string buildOptions = getOpenCLBuildOptions(mOutputType, device, maskSize);
+    cl::Kernel kernel = getOpenCLKernel(device, "gaussianSmoothing", input->getDimensions() == 2 ? "2D" : "3D", buildOptions);
+    cl::NDRange globalSize;
 
-        cl::NDRange globalSize;
+    OpenCLImageAccess::pointer inputAccess = input->getOpenCLImageAccess(ACCESS_READ, device);
+    if(input->getDimensions() == 2) {
+        createMask(input, maskSize, false);
+        kernel.setArg(1, getMaskBuffer(device));
+        kernel.setArg(3, maskSize);
+        globalSize = cl::NDRange(input->getWidth(),input->getHeight());
+
+        OpenCLImageAccess::pointer outputAccess = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
+        kernel.setArg(0, *inputAccess->get2DImage());
+        kernel.setArg(2, *outputAccess->get2DImage());
+        WorkGroupSizeTuner::enqueueNDRangeKernel(device, kernel, globalSize);
+    } else {
+        // Create an auxilliary image
+        Image::pointer output2 = Image::New();
+        output2->createFromImage(output);
 
-        OpenCLImageAccess::pointer inputAccess = input->getOpenCLImageAccess(ACCESS_READ, device);
-        if(input->getDimensions() == 2) {
-            createMask(input, maskSize, false);
-            mKernel.setArg(1, mCLMask);
-            mKernel.setArg(3, maskSize);
-            globalSize = cl::NDRange(input->getWidth(),input->getHeight());
+        globalSize = cl::NDRange(input->getWidth(),input->getHeight(),input->getDepth());
 
+        if(device->isWritingTo3DTexturesSupported()) {
+            createMask(input, maskSize, true);
+            kernel.setArg(1, getMaskBuffer(device));
+            kernel.setArg(3, maskSize);
             OpenCLImageAccess::pointer outputAccess = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
-            mKernel.setArg(0, *inputAccess->get2DImage());
-            mKernel.setArg(2, *outputAccess->get2DImage());
-            clDevice->getCommandQueue().enqueueNDRangeKernel(
-                    mKernel,
-                    cl::NullRange,
-                    globalSize,
-                    cl::NullRange
-            );
-        } else {
-            // Create an auxilliary image
-            Image::pointer output2 = Image::New();
-            output2->createFromImage(output);
-
-            globalSize = cl::NDRange(input->getWidth(),input->getHeight(),input->getDepth());
-
-            if(clDevice->isWritingTo3DTexturesSupported()) {
-                createMask(input, maskSize, true);
-                mKernel.setArg(1, mCLMask);
-                mKernel.setArg(3, maskSize);
-                OpenCLImageAccess::pointer outputAccess = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
-                OpenCLImageAccess::pointer outputAccess2 = output2->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
-
-                cl::Image3D* image2;
-                cl::Image3D* image;
-                image = outputAccess->get3DImage();
-                image2 = outputAccess->get3DImage();
-                for(uchar direction = 0; direction < input->getDimensions(); ++direction) {
-                    if(direction == 0) {
-                        mKernel.setArg(0, *inputAccess->get3DImage());
-                        mKernel.setArg(2, *image);
-                    } else if(direction == 1) {
-                        mKernel.setArg(0, *image);
-                        mKernel.setArg(2, *image2);
-                    } else {
-                        mKernel.setArg(0, *image2);
-                        mKernel.setArg(2, *image);
-                    }
-                    mKernel.setArg(4, direction);
-                    clDevice->getCommandQueue().enqueueNDRangeKernel(
-                            mKernel,
-                            cl::NullRange,
-                            globalSize,
-                            cl::NullRange
-                    );
+            OpenCLImageAccess::pointer outputAccess2 = output2->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
+
+            cl::Image3D* image2;
+            cl::Image3D* image;
+            image = outputAccess->get3DImage();
+            image2 = outputAccess2->get3DImage();
+            for(uchar direction = 0; direction < input->getDimensions(); ++direction) {
+                if(direction == 0) {
+                    kernel.setArg(0, *inputAccess->get3DImage());
+                    kernel.setArg(2, *image);
+                } else if(direction == 1) {
+                    kernel.setArg(0, *image);
+                    kernel.setArg(2, *image2);
+                } else {
+                    kernel.setArg(0, *image2);
+                    kernel.setArg(2, *image);
                 }
-            } else {
-                createMask(input, maskSize, false);
-                mKernel.setArg(1, mCLMask);
-                mKernel.setArg(3, maskSize);
-                OpenCLBufferAccess::pointer outputAccess = output->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
-                mKernel.setArg(0, *inputAccess->get3DImage());
-                mKernel.setArg(2, *outputAccess->get());
-                clDevice->getCommandQueue().enqueueNDRangeKernel(
-                        mKernel,
+                kernel.setArg(4, direction);
+                device->getCommandQueue().enqueueNDRangeKernel(
+                        kernel,
                         cl::NullRange,
                         globalSize,
                         cl::NullRange
                 );
             }
+        } else {
+            createMask(input, maskSize, false);
+            kernel.setArg(1, getMaskBuffer(device));
+            kernel.setArg(3, maskSize);
+            OpenCLBufferAccess::pointer outputAccess = output->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
+            kernel.setArg(0, *inputAccess->get3DImage());
+            kernel.setArg(2, *outputAccess->get());
+            WorkGroupSizeTuner::enqueueNDRangeKernel(device, kernel, globalSize);
+        }
+    }
+}
+
+void GaussianSmoothingFilter::executeRecursiveOnDevice(Image::pointer input, Image::pointer output, OpenCLDevice::pointer device) {
+    const RecursiveGaussianCoefficients coefficients = getRecursiveGaussianCoefficients(mStdDev);
+    const std::string buildOptions = getRecursiveBuildOptions(output->getDataType());
+    const uint width = input->getWidth();
+    const uint height = input->getHeight();
+    const uint depth = input->getDimensions() == 3 ? input->getDepth() : 1;
+    cl::CommandQueue queue = device->getCommandQueue();
 
+    OpenCLMemoryPool::pointer pool = OpenCLMemoryPool::getInstance(device);
+    cl::Buffer buffer = pool->acquireBuffer(sizeof(float)*width*height*depth);
 
+    OpenCLImageAccess::pointer inputAccess = input->getOpenCLImageAccess(ACCESS_READ, device);
+    if(input->getDimensions() == 2) {
+        cl::Kernel kernel = getOpenCLKernel(device, "imageToBuffer2D", "Recursive", buildOptions);
+        kernel.setArg(0, *inputAccess->get2DImage());
+        kernel.setArg(1, buffer);
+        queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(width, height), cl::NullRange);
+    } else {
+        cl::Kernel kernel = getOpenCLKernel(device, "imageToBuffer3D", "Recursive", buildOptions);
+        kernel.setArg(0, *inputAccess->get3DImage());
+        kernel.setArg(1, buffer);
+        queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(width, height, depth), cl::NullRange);
+    }
+
+    // One work-item for each line. Lines along x are numbered by (y,z), along y by (x,z) and along z by (x,y).
+    cl::Kernel kernel = getOpenCLKernel(device, "recursiveGaussian", "Recursive", buildOptions);
+    kernel.setArg(0, buffer);
+    kernel.setArg(5, coefficients.B);
+    kernel.setArg(6, coefficients.b1);
+    kernel.setArg(7, coefficients.b2);
+    kernel.setArg(8, coefficients.b3);
+    for(uint direction = 0; direction < input->getDimensions(); ++direction) {
+        cl::NDRange globalSize;
+        if(direction == 0) {
+            kernel.setArg(1, width);
+            kernel.setArg(2, 1);
+            kernel.setArg(3, width);
+            kernel.setArg(4, width*height);
+            globalSize = cl::NDRange(height, depth);
+        } else if(direction == 1) {
+            kernel.setArg(1, height);
+            kernel.setArg(2, width);
+            kernel.setArg(3, 1);
+            kernel.setArg(4, width*height);
+            globalSize = cl::NDRange(width, depth);
+        } else {
+            kernel.setArg(1, depth);
+            kernel.setArg(2, width*height);
+            kernel.setArg(3, 1);
+            kernel.setArg(4, width);
+            globalSize = cl::NDRange(width, height);
         }
+        queue.enqueueNDRangeKernel(kernel, cl::NullRange, globalSize, cl::NullRange);
     }
+
+    OpenCLBufferAccess::pointer outputAccess = output->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
+    cl::Kernel outputKernel = getOpenCLKernel(device, "bufferToOutput", "Recursive", buildOptions);
+    outputKernel.setArg(0, buffer);
+    outputKernel.setArg(1, *outputAccess->get());
+    outputKernel.setArg(2, output->getNrOfComponents());
+    queue.enqueueNDRangeKernel(outputKernel, cl::NullRange, cl::NDRange(width*height*depth), cl::NullRange);
+
+    pool->release(buffer);
 }
 
 void GaussianSmoothingFilter::waitToFinish() {
@@ -13,24 +13,35 @@ class GaussianSmoothingFilter : public ProcessObject {
         void setMaskSize(unsigned char maskSize);
         void setStandardDeviation(float stdDev);
         void setOutputType(DataType type);
+        /**
+         * For standard deviations of at least this value (default 4), a recursive filter is used instead of a mask.
+         * Its runtime does not depend on the standard deviation, and the mask size is ignored.
+         */
+        void setRecursiveFilterThreshold(float stdDev);
+        std::vector<std::pair<std::string, std::string> > getOpenCLProgramVariants(DataType type, uint dimensions);
         ~GaussianSmoothingFilter();
     private:
         GaussianSmoothingFilter();
         void execute();
         void waitToFinish();
+        void executeOnDevice(Image::pointer input, Image::pointer output, OpenCLDevice::pointer device, uchar maskSize);
+        void executeRecursiveOnDevice(Image::pointer input, Image::pointer output, OpenCLDevice::pointer device);
+        bool useRecursiveFilter() const;
         void createMask(Image::pointer input, uchar maskSize, bool useSeperableFilter);
-        void recompileOpenCLCode(Image::pointer input);
+        cl::Buffer getMaskBuffer(OpenCLDevice::pointer device);
+        std::string getOpenCLBuildOptions(DataType outputType, OpenCLDevice::pointer device, uchar maskSize);
+        uchar getMaskSize() const;
 
         char mMaskSize;
         float mStdDev;
+        float mRecursiveFilterThreshold;
 
-        cl::Buffer mCLMask;
+        boost::unordered_map<OpenCLDevice::pointer, cl::Buffer> mCLMasks;
         float * mMask;
+        uint mMaskLength;
+        bool mMaskIsSeparable;
         bool mRecreateMask;
 
-        cl::Kernel mKernel;
-        unsigned char mDimensionCLCodeCompiledFor;
-        DataType mTypeCLCodeCompiledFor;
         DataType mOutputType;
         bool mOutputTypeSet;
 
@@ -8,6 +8,7 @@ class GaussianSmoothingFilter : public ProcessObject {
     	static SharedPointer<GaussianSmoothingFilter> New();
         void setMaskSize(unsigned char maskSize);
         void setStandardDeviation(float stdDev);
+        void setRecursiveFilterThreshold(float stdDev);
 	private:
 		GaussianSmoothingFilter();
 //        void setOutputType(DataType type);
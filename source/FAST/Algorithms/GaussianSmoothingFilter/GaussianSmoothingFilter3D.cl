@@ -1,3 +1,11 @@
+// Specialized variants are compiled with a constant MASK_SIZE, see GaussianSmoothingFilter2D.cl
+#ifdef MASK_SIZE
+#define MASK_SIZE_ARGUMENT unusedMaskSize
+#define maskSize MASK_SIZE
+#else
+#define MASK_SIZE_ARGUMENT maskSize
+#endif
+
 __constant sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP_TO_EDGE | CLK_FILTER_NEAREST;
 
 #ifdef cl_khr_3d_image_writes
@@ -5,7 +13,7 @@ __kernel void gaussianSmoothing(
         __read_only image3d_t input,
         __constant float * mask,
         __write_only image3d_t output,
-        __private unsigned char maskSize,
+        __private unsigned char MASK_SIZE_ARGUMENT,
         __private unsigned char direction
         ) {
 
@@ -48,7 +56,7 @@ __kernel void gaussianSmoothing(
         __read_only image3d_t input,
         __constant float * mask,
         __global TYPE* output,
-        __private unsigned char maskSize
+        __private unsigned char MASK_SIZE_ARGUMENT
         ) {
 
     const int4 pos = {get_global_id(0), get_global_id(1), get_global_id(2), 0};
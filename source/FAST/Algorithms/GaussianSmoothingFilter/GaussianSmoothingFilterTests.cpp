@@ -1,6 +1,8 @@
 #include "FAST/Testing.hpp"
 #include "FAST/Algorithms/GaussianSmoothingFilter/GaussianSmoothingFilter.hpp"
 #include "FAST/DeviceManager.hpp"
+#include "FAST/SlabSplitter.hpp"
+#include "FAST/Algorithms/SeparableConvolution.hpp"
 
 namespace fast {
 
@@ -24,6 +26,245 @@ TEST_CASE("Even input as mask size throws exception in GaussianSmoothingFilter",
     CHECK_THROWS(filter->setMaskSize(2));
 }
 
+TEST_CASE("Warm up OpenCL programs of GaussianSmoothingFilter pipeline", "[fast][GaussianSmoothingFilter]") {
+    GaussianSmoothingFilter::pointer filter = GaussianSmoothingFilter::New();
+    filter->setMaskSize(3);
+    filter->setStandardDeviation(1.0);
+    GaussianSmoothingFilter::pointer filter2 = GaussianSmoothingFilter::New();
+    filter2->setInputConnection(filter->getOutputPort());
+
+    std::vector<ProcessObject::pointer> processObjects;
+    processObjects.push_back(filter2);
+    std::vector<DataType> types;
+    types.push_back(TYPE_UINT8);
+    types.push_back(TYPE_FLOAT);
+    std::vector<uint> dimensions;
+    dimensions.push_back(2);
+    dimensions.push_back(3);
+    CHECK_NOTHROW(DeviceManager::getInstance().warmUpOpenCLPrograms(processObjects, types, dimensions));
+
+    // Programs are now already built
+    Image::pointer image = Image::New();
+    image->create(16,16,TYPE_FLOAT,1);
+    ImageAccess::pointer access = image->getImageAccess(ACCESS_READ_WRITE);
+    memset(access->get(), 0, sizeof(float)*16*16);
+    access->release();
+    filter->setInputData(image);
+    CHECK_NOTHROW(filter2->update());
+}
+
+TEST_CASE("SlabSplitter gives slabs which cover the image with halos", "[fast][GaussianSmoothingFilter][SlabSplitter]") {
+    uint start, end, haloStart, haloEnd;
+    SlabSplitter::getSlab(10, 3, 0, 2, &start, &end, &haloStart, &haloEnd);
+    CHECK(start == 0);
+    CHECK(end == 4);
+    CHECK(haloStart == 0);
+    CHECK(haloEnd == 6);
+    SlabSplitter::getSlab(10, 3, 1, 2, &start, &end, &haloStart, &haloEnd);
+    CHECK(start == 4);
+    CHECK(end == 7);
+    CHECK(haloStart == 2);
+    CHECK(haloEnd == 9);
+    SlabSplitter::getSlab(10, 3, 2, 2, &start, &end, &haloStart, &haloEnd);
+    CHECK(start == 7);
+    CHECK(end == 10);
+    CHECK(haloStart == 5);
+    CHECK(haloEnd == 10);
+}
+
+TEST_CASE("GaussianSmoothingFilter split across devices gives same result as on one device", "[fast][GaussianSmoothingFilter][SlabSplitter]") {
+    OpenCLDevice::pointer device = DeviceManager::getInstance().getDefaultComputationDevice();
+    const uint width = 32, height = 32, depth = 21;
+    Image::pointer image = Image::New();
+    image->create(width, height, depth, TYPE_FLOAT, 1);
+    {
+        ImageAccess::pointer access = image->getImageAccess(ACCESS_READ_WRITE);
+        float* data = (float*)access->get();
+        for(uint i = 0; i < width*height*depth; ++i)
+            data[i] = (float)((i*7919) % 255);
+    }
+
+    GaussianSmoothingFilter::pointer filter = GaussianSmoothingFilter::New();
+    filter->setMainDevice(device);
+    filter->setMaskSize(5);
+    filter->setStandardDeviation(1.5);
+    filter->setInputData(image);
+    Image::pointer output = filter->getOutputData<Image>();
+    filter->update();
+
+    // Use the same device three times to get three slabs
+    std::vector<OpenCLDevice::pointer> devices(3, device);
+    GaussianSmoothingFilter::pointer splitFilter = GaussianSmoothingFilter::New();
+    splitFilter->setMainDevice(device);
+    splitFilter->setSplitDevices(devices);
+    splitFilter->setMaskSize(5);
+    splitFilter->setStandardDeviation(1.5);
+    splitFilter->setInputData(image);
+    Image::pointer splitOutput = splitFilter->getOutputData<Image>();
+    splitFilter->update();
+
+    ImageAccess::pointer access = output->getImageAccess(ACCESS_READ);
+    ImageAccess::pointer splitAccess = splitOutput->getImageAccess(ACCESS_READ);
+    float* data = (float*)access->get();
+    float* splitData = (float*)splitAccess->get();
+    bool success = true;
+    for(uint i = 0; i < width*height*depth; ++i) {
+        if(fabs(data[i] - splitData[i]) > 0.0001f) {
+            success = false;
+            break;
+        }
+    }
+    CHECK(success == true);
+}
+
+// Runs the filter on the given device and returns the output
+static Image::pointer runGaussianSmoothingFilter(ExecutionDevice::pointer device, Image::pointer image, uchar maskSize, float stdDev) {
+    GaussianSmoothingFilter::pointer filter = GaussianSmoothingFilter::New();
+    filter->setMainDevice(device);
+    filter->setMaskSize(maskSize);
+    filter->setStandardDeviation(stdDev);
+    filter->setInputData(image);
+    filter->update();
+    return filter->getOutputData<Image>();
+}
+
+TEST_CASE("GaussianSmoothingFilter on Host gives same result as on OpenCL device", "[fast][GaussianSmoothingFilter]") {
+    OpenCLDevice::pointer device = DeviceManager::getInstance().getDefaultComputationDevice();
+    for(uint dimensions = 2; dimensions <= 3; ++dimensions) {
+    for(uchar maskSize = 3; maskSize <= 7; maskSize += 4) {
+    for(uint t = 0; t < 2; ++t) {
+        DataType type = t == 0 ? TYPE_FLOAT : TYPE_UINT8;
+        const uint width = 37, height = 29, depth = dimensions == 3 ? 11 : 1;
+        Image::pointer image = Image::New();
+        if(dimensions == 2) {
+            image->create(width, height, type, 1);
+        } else {
+            image->create(width, height, depth, type, 1);
+        }
+        {
+            ImageAccess::pointer access = image->getImageAccess(ACCESS_READ_WRITE);
+            for(uint i = 0; i < width*height*depth; ++i) {
+                uchar value = (i*7919) % 256;
+                if(type == TYPE_FLOAT) {
+                    ((float*)access->get())[i] = value;
+                } else {
+                    ((uchar*)access->get())[i] = value;
+                }
+            }
+        }
+
+        Image::pointer hostOutput = runGaussianSmoothingFilter(Host::getInstance(), image, maskSize, 1.5f);
+        Image::pointer deviceOutput = runGaussianSmoothingFilter(device, image, maskSize, 1.5f);
+        ImageAccess::pointer hostAccess = hostOutput->getImageAccess(ACCESS_READ);
+        ImageAccess::pointer deviceAccess = deviceOutput->getImageAccess(ACCESS_READ);
+        float maxDifference = 0;
+        for(uint i = 0; i < width*height*depth; ++i) {
+            float difference;
+            if(type == TYPE_FLOAT) {
+                difference = fabs(((float*)hostAccess->get())[i] - ((float*)deviceAccess->get())[i]);
+            } else {
+                difference = abs((int)((uchar*)hostAccess->get())[i] - (int)((uchar*)deviceAccess->get())[i]);
+            }
+            maxDifference = std::max(maxDifference, difference);
+        }
+        // Integer images are rounded after each pass on the device
+        CHECK(maxDifference <= (type == TYPE_FLOAT ? 0.01f : 1.0f));
+    }}}
+}
+
+TEST_CASE("GaussianSmoothingFilter on Host runtime", "[fast][GaussianSmoothingFilter][benchmark]") {
+    const uint width = 256, height = 256, depth = 128;
+    for(uint t = 0; t < 2; ++t) {
+        DataType type = t == 0 ? TYPE_FLOAT : TYPE_UINT8;
+        Image::pointer image = Image::New();
+        image->create(width, height, depth, type, 1);
+        {
+            ImageAccess::pointer access = image->getImageAccess(ACCESS_READ_WRITE);
+            memset(access->get(), 0, getSizeOfDataType(type, 1)*width*height*depth);
+        }
+        for(uchar maskSize = 3; maskSize <= 19; maskSize += 4) {
+            GaussianSmoothingFilter::pointer filter = GaussianSmoothingFilter::New();
+            filter->setMainDevice(Host::getInstance());
+            filter->setMaskSize(maskSize);
+            filter->setStandardDeviation(maskSize/4.0f);
+            filter->setInputData(image);
+            filter->enableRuntimeMeasurements();
+            filter->update();
+            Reporter::info() << "Mask size " << (int)maskSize << (type == TYPE_FLOAT ? " float" : " uint8") << ": " <<
+                    filter->getRuntime()->getSum() << " ms" << Reporter::end;
+        }
+    }
+}
+
+TEST_CASE("SeparableConvolution saturates values outside the range of integer types", "[fast][GaussianSmoothingFilter]") {
+    const float values[5] = {-3.0f, 1.4f, 254.6f, 300.0f, 1e10f};
+    Image::pointer image = Image::New();
+    image->create(5, 1, TYPE_UINT8, 1);
+    SeparableConvolution::setFirstComponent(values, image);
+    {
+        ImageAccess::pointer access = image->getImageAccess(ACCESS_READ);
+        uchar* data = (uchar*)access->get();
+        CHECK((int)data[0] == 0);
+        CHECK((int)data[1] == 1);
+        CHECK((int)data[2] == 255);
+        CHECK((int)data[3] == 255);
+        CHECK((int)data[4] == 255);
+    }
+
+    Image::pointer shortImage = Image::New();
+    shortImage->create(5, 1, TYPE_INT16, 1);
+    SeparableConvolution::setFirstComponent(values, shortImage);
+    ImageAccess::pointer access = shortImage->getImageAccess(ACCESS_READ);
+    short* data = (short*)access->get();
+    CHECK(data[0] == -3);
+    CHECK(data[2] == 255);
+    CHECK(data[3] == 300);
+    CHECK(data[4] == 32767);
+}
+
+TEST_CASE("Recursive GaussianSmoothingFilter gives same result on Host and OpenCL device and approximates a Gaussian", "[fast][GaussianSmoothingFilter]") {
+    OpenCLDevice::pointer device = DeviceManager::getInstance().getDefaultComputationDevice();
+    const float stdDev = 6.0f;
+    for(uint dimensions = 2; dimensions <= 3; ++dimensions) {
+        const uint size = 65, depth = dimensions == 3 ? size : 1;
+        const uint center = size/2;
+        // A unit impulse in the center
+        Image::pointer image = Image::New();
+        if(dimensions == 2) {
+            image->create(size, size, TYPE_FLOAT, 1);
+        } else {
+            image->create(size, size, size, TYPE_FLOAT, 1);
+        }
+        {
+            ImageAccess::pointer access = image->getImageAccess(ACCESS_READ_WRITE);
+            float* data = (float*)access->get();
+            memset(data, 0, sizeof(float)*size*size*depth);
+            data[center+center*size+(dimensions == 3 ? center*size*size : 0)] = 1.0f;
+        }
+
+        GaussianSmoothingFilter::pointer filter = GaussianSmoothingFilter::New();
+        filter->setStandardDeviation(stdDev);
+        filter->setInputData(image);
+        filter->setMainDevice(Host::getInstance());
+        filter->update();
+        Image::pointer hostOutput = filter->getOutputData<Image>();
+        Image::pointer deviceOutput = runGaussianSmoothingFilter(device, image, 3, stdDev);
+
+        ImageAccess::pointer hostAccess = hostOutput->getImageAccess(ACCESS_READ);
+        ImageAccess::pointer deviceAccess = deviceOutput->getImageAccess(ACCESS_READ);
+        float* hostData = (float*)hostAccess->get();
+        float* deviceData = (float*)deviceAccess->get();
+        double sum = 0;
+        for(uint i = 0; i < size*size*depth; ++i) {
+            CHECK(hostData[i] == Approx(deviceData[i]).epsilon(0.001));
+            sum += hostData[i];
+        }
+        CHECK(sum == Approx(1.0).epsilon(0.01));
+        float truth = 1.0f/pow(sqrt(2.0f*M_PI)*stdDev, (float)dimensions);
+        CHECK(hostData[center+center*size+(dimensions == 3 ? center*size*size : 0)] == Approx(truth).epsilon(0.05));
+    }
+}
+
 /*
 TEST_CASE("Correct output with small 3x3 2D image as input to GaussianSmoothingFilter on OpenCLDevice", "[fast][GaussianSmoothingFilter]") {
     DeviceManager& deviceManager = DeviceManager::getInstance();
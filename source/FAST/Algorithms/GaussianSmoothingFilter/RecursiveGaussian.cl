@@ -0,0 +1,95 @@
+// Recursive Gaussian filter (Young and van Vliet 1995) on a float buffer, with one work-item per line.
+// TYPE is the data type of the output buffer, and ROUND is defined if it is an integer type.
+
+__constant sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP_TO_EDGE | CLK_FILTER_NEAREST;
+
+float readFirstComponent2D(__read_only image2d_t input, int2 pos) {
+    int dataType = get_image_channel_data_type(input);
+    if(dataType == CLK_FLOAT) {
+        return read_imagef(input, sampler, pos).x;
+    } else if(dataType == CLK_UNSIGNED_INT8 || dataType == CLK_UNSIGNED_INT16) {
+        return read_imageui(input, sampler, pos).x;
+    } else {
+        return read_imagei(input, sampler, pos).x;
+    }
+}
+
+float readFirstComponent3D(__read_only image3d_t input, int4 pos) {
+    int dataType = get_image_channel_data_type(input);
+    if(dataType == CLK_FLOAT) {
+        return read_imagef(input, sampler, pos).x;
+    } else if(dataType == CLK_UNSIGNED_INT8 || dataType == CLK_UNSIGNED_INT16) {
+        return read_imageui(input, sampler, pos).x;
+    } else {
+        return read_imagei(input, sampler, pos).x;
+    }
+}
+
+__kernel void imageToBuffer2D(
+        __read_only image2d_t input,
+        __global float* output
+        ) {
+    const int2 pos = {get_global_id(0), get_global_id(1)};
+    output[pos.x+pos.y*get_global_size(0)] = readFirstComponent2D(input, pos);
+}
+
+__kernel void imageToBuffer3D(
+        __read_only image3d_t input,
+        __global float* output
+        ) {
+    const int4 pos = {get_global_id(0), get_global_id(1), get_global_id(2), 0};
+    output[pos.x+pos.y*get_global_size(0)+pos.z*get_global_size(0)*get_global_size(1)] = readFirstComponent3D(input, pos);
+}
+
+// Filters the line which starts at get_global_id(0)*lineStride + get_global_id(1)*lineStride2
+// and has length elements which are elementStride apart. The coefficients are divided by b0.
+__kernel void recursiveGaussian(
+        __global float* data,
+        __private uint length,
+        __private uint elementStride,
+        __private uint lineStride,
+        __private uint lineStride2,
+        __private float B,
+        __private float b1,
+        __private float b2,
+        __private float b3
+        ) {
+    __global float* line = data + get_global_id(0)*lineStride + get_global_id(1)*lineStride2;
+
+    // Causal pass, with the values before the line equal to the first value
+    float previous1 = line[0];
+    float previous2 = previous1;
+    float previous3 = previous1;
+    for(uint n = 0; n < length; ++n) {
+        const float value = B*line[n*elementStride] + b1*previous1 + b2*previous2 + b3*previous3;
+        line[n*elementStride] = value;
+        previous3 = previous2;
+        previous2 = previous1;
+        previous1 = value;
+    }
+
+    // Anti-causal pass, with the values after the line equal to the last value
+    float next1 = line[(length-1)*elementStride];
+    float next2 = next1;
+    float next3 = next1;
+    for(int n = length-1; n >= 0; --n) {
+        const float value = B*line[n*elementStride] + b1*next1 + b2*next2 + b3*next3;
+        line[n*elementStride] = value;
+        next3 = next2;
+        next2 = next1;
+        next1 = value;
+    }
+}
+
+__kernel void bufferToOutput(
+        __global float* input,
+        __global TYPE* output,
+        __private uint nrOfComponents
+        ) {
+    const uint i = get_global_id(0);
+#ifdef ROUND
+    output[i*nrOfComponents] = round(input[i]);
+#else
+    output[i*nrOfComponents] = input[i];
+#endif
+}
@@ -1,6 +1,7 @@
 #include "EulerGradientVectorFlow.hpp"
 #include "FAST/Data/Image.hpp"
 #include "FAST/Utility.hpp"
+#include "FAST/OpenCLMemoryPool.hpp"
 
 namespace fast {
 
@@ -73,9 +74,7 @@ void EulerGradientVectorFlow::set32bitStorageFormat() {
 
 void EulerGradientVectorFlow::execute2DGVF(Image::pointer input, Image::pointer output, uint iterations) {
     OpenCLDevice::pointer device = getMainDevice();
-    cl::Program program = getOpenCLProgram(device);
 
-    cl::Context context = device->getContext();
     cl::CommandQueue queue = device->getCommandQueue();
     const uint width = input->getWidth();
     const uint height = input->getHeight();
@@ -110,17 +109,18 @@ void EulerGradientVectorFlow::execute2DGVF(Image::pointer input, Image::pointer
     reportInfo() << "Euler GVF using a maximum of " <<
             getPeakMemoryUsage(input, storageFormat.image_channel_data_type == CL_SNORM_INT16, device->isWritingTo3DTexturesSupported()) / (1024*1024) << " MB" << Reporter::end;
 
-    cl::Kernel iterationKernel(program, "GVF2DIteration");
+    cl::Kernel iterationKernel = getOpenCLKernel(device, "GVF2DIteration");
     OpenCLImageAccess::pointer access = input->getOpenCLImageAccess(ACCESS_READ, device);
     cl::Image2D* inputVectorField = access->get2DImage();
 
     // Copy input vector field and create double buffer
-    cl::Image2D vectorField(context, CL_MEM_READ_WRITE, storageFormat, width, height);
-    cl::Image2D vectorField2(context, CL_MEM_READ_WRITE, storageFormat, width, height);
+    OpenCLMemoryPool::pointer pool = OpenCLMemoryPool::getInstance(device);
+    cl::Image2D vectorField = pool->acquireImage2D(storageFormat, width, height);
+    cl::Image2D vectorField2 = pool->acquireImage2D(storageFormat, width, height);
 
     if(storageFormat.image_channel_data_type == CL_SNORM_INT16  && input->getDataType() != TYPE_SNORM_INT16) {
         // Must run init kernel to copy values to 16 bit texture
-        cl::Kernel initKernel(program, "GVF2DCopy");
+        cl::Kernel initKernel = getOpenCLKernel(device, "GVF2DCopy");
         initKernel.setArg(0, *inputVectorField);
         initKernel.setArg(1, vectorField);
         queue.enqueueNDRangeKernel(
@@ -165,7 +165,7 @@ void EulerGradientVectorFlow::execute2DGVF(Image::pointer input, Image::pointer
     cl::Image2D* outputCLImage = outputAccess->get2DImage();
     if(storageFormat.image_channel_data_type == CL_SNORM_INT16) {
         // Have to convert type back to float
-        cl::Kernel resultKernel(program, "GVF2DCopy");
+        cl::Kernel resultKernel = getOpenCLKernel(device, "GVF2DCopy");
         resultKernel.setArg(0, vectorField);
         resultKernel.setArg(1, *outputCLImage);
         queue.enqueueNDRangeKernel(
@@ -183,13 +183,13 @@ void EulerGradientVectorFlow::execute2DGVF(Image::pointer input, Image::pointer
                 createRegion(width, height, 1)
         );
     }
+    pool->release(vectorField);
+    pool->release(vectorField2);
 }
 
 void EulerGradientVectorFlow::execute3DGVF(Image::pointer input, Image::pointer output, uint iterations) {
     OpenCLDevice::pointer device = getMainDevice();
-    cl::Program program = getOpenCLProgram(device);
 
-    cl::Context context = device->getContext();
     cl::CommandQueue queue = device->getCommandQueue();
     const uint width = input->getWidth();
     const uint height = input->getHeight();
@@ -212,17 +212,18 @@ void EulerGradientVectorFlow::execute3DGVF(Image::pointer input, Image::pointer
     reportInfo() << "Euler GVF using a maximum of " <<
             getPeakMemoryUsage(input, storageFormat.image_channel_data_type == CL_SNORM_INT16, device->isWritingTo3DTexturesSupported()) / (1024*1024) << " MB" << Reporter::end;
 
-    cl::Kernel iterationKernel(program, "GVF3DIteration");
+    cl::Kernel iterationKernel = getOpenCLKernel(device, "GVF3DIteration");
     OpenCLImageAccess::pointer access = input->getOpenCLImageAccess(ACCESS_READ, device);
     cl::Image3D* inputVectorField = access->get3DImage();
 
     // Copy input vector field and create double buffer
-    cl::Image3D vectorField(context, CL_MEM_READ_WRITE, storageFormat, width, height, depth);
-    cl::Image3D vectorField2(context, CL_MEM_READ_WRITE, storageFormat, width, height, depth);
+    OpenCLMemoryPool::pointer pool = OpenCLMemoryPool::getInstance(device);
+    cl::Image3D vectorField = pool->acquireImage3D(storageFormat, width, height, depth);
+    cl::Image3D vectorField2 = pool->acquireImage3D(storageFormat, width, height, depth);
 
     if(storageFormat.image_channel_data_type == CL_SNORM_INT16) {
         // Must run init kernel to copy values to 16 bit texture
-        cl::Kernel initKernel(program, "GVF3DCopy");
+        cl::Kernel initKernel = getOpenCLKernel(device, "GVF3DCopy");
         initKernel.setArg(0, *inputVectorField);
         initKernel.setArg(1, vectorField);
         queue.enqueueNDRangeKernel(
@@ -265,7 +266,7 @@ void EulerGradientVectorFlow::execute3DGVF(Image::pointer input, Image::pointer
     OpenCLImageAccess::pointer outputAccess = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
     cl::Image3D* outputCLImage = outputAccess->get3DImage();
     if(storageFormat.image_channel_data_type == CL_SNORM_INT16) {
-        cl::Kernel resultKernel(program, "GVF3DCopy");
+        cl::Kernel resultKernel = getOpenCLKernel(device, "GVF3DCopy");
         resultKernel.setArg(0, vectorField);
         resultKernel.setArg(1, *outputCLImage);
         queue.enqueueNDRangeKernel(
@@ -283,12 +284,13 @@ void EulerGradientVectorFlow::execute3DGVF(Image::pointer input, Image::pointer
                 createRegion(width, height, depth)
         );
     }
+    pool->release(vectorField);
+    pool->release(vectorField2);
 }
 
 void EulerGradientVectorFlow::execute3DGVFNo3DWrite(Image::pointer input, Image::pointer output, uint iterations) {
     OpenCLDevice::pointer device = getMainDevice();
 
-    cl::Context context = device->getContext();
     cl::CommandQueue queue = device->getCommandQueue();
     const uint width = input->getWidth();
     const uint height = input->getHeight();
@@ -315,28 +317,20 @@ void EulerGradientVectorFlow::execute3DGVFNo3DWrite(Image::pointer input, Image:
     }
     reportInfo() << "Euler GVF using a maximum of " <<
             getPeakMemoryUsage(input, storageFormat.image_channel_data_type == CL_SNORM_INT16, device->isWritingTo3DTexturesSupported()) / (1024*1024) << " MB" << Reporter::end;
-    cl::Program program = getOpenCLProgram(device, "", buildOptions);
 
-    cl::Kernel iterationKernel(program, "GVF3DIteration");
-    cl::Kernel initKernel(program, "GVF3DInit");
-    cl::Kernel finishKernel(program, "GVF3DFinish");
+    cl::Kernel iterationKernel = getOpenCLKernel(device, "GVF3DIteration", "", buildOptions);
+    cl::Kernel initKernel = getOpenCLKernel(device, "GVF3DInit", "", buildOptions);
+    cl::Kernel finishKernel = getOpenCLKernel(device, "GVF3DFinish", "", buildOptions);
 
 	reportInfo() << "Starting Euler GVF" << Reporter::end;
     OpenCLImageAccess::pointer access = input->getOpenCLImageAccess(ACCESS_READ, device);
     cl::Image3D* inputVectorField = access->get3DImage();
 
     // Create auxillary buffers
-    cl::Buffer vectorFieldBuffer(
-            device->getContext(),
-            CL_MEM_READ_WRITE,
-            3*vectorFieldSize*totalSize
-	);
+    OpenCLMemoryPool::pointer pool = OpenCLMemoryPool::getInstance(device);
+    cl::Buffer vectorFieldBuffer = pool->acquireBuffer(3*vectorFieldSize*totalSize);
 	{
-		cl::Buffer vectorFieldBuffer1(
-			device->getContext(),
-			CL_MEM_READ_WRITE,
-			3 * vectorFieldSize*totalSize
-			);
+		cl::Buffer vectorFieldBuffer1 = pool->acquireBuffer(3*vectorFieldSize*totalSize);
 
 		initKernel.setArg(0, *inputVectorField);
 		initKernel.setArg(1, vectorFieldBuffer);
@@ -367,13 +361,10 @@ void EulerGradientVectorFlow::execute3DGVFNo3DWrite(Image::pointer input, Image:
 				cl::NullRange
 				);
 		}
+		pool->release(vectorFieldBuffer1);
 	}
 
-    cl::Buffer finalVectorFieldBuffer(
-            device->getContext(),
-            CL_MEM_WRITE_ONLY,
-            4*sizeof(float)*totalSize
-    );
+    cl::Buffer finalVectorFieldBuffer = pool->acquireBuffer(4*sizeof(float)*totalSize, CL_MEM_WRITE_ONLY);
 
     // Copy vector field to image
     finishKernel.setArg(0, vectorFieldBuffer);
@@ -396,7 +387,8 @@ void EulerGradientVectorFlow::execute3DGVFNo3DWrite(Image::pointer input, Image:
             createOrigoRegion(),
             createRegion(width, height, depth)
     );
-
+    pool->release(vectorFieldBuffer);
+    pool->release(finalVectorFieldBuffer);
 }
 
 void EulerGradientVectorFlow::execute() {
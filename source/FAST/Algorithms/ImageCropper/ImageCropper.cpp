@@ -30,14 +30,25 @@ ImageCropper::ImageCropper() {
 
     mSize = Vector3ui::Zero();
     mOffset = Vector3ui::Zero();
+    mInputOffset = Vector3ui::Zero();
+}
+
+void ImageCropper::requestInputRegions() {
+    // Let the parent, e.g. an importer, only produce the region which is needed
+    mInputOffset = Vector3ui::Zero();
+    if(mSize == Vector3ui::Zero() || getNrOfInputData() == 0)
+        return;
+    ProcessObjectPort port = getInputPort(0);
+    port.getProcessObject()->requestRegion(this, port.getPortID(), mOffset, mSize, mInputOffset);
 }
 
 void ImageCropper::execute() {
     if(mSize == Vector3ui::Zero())
         throw Exception("Size must be given to ImageCropper");
 
+    // The input may be a region of the image containing the crop region
     Image::pointer input = getStaticInputData<Image>();
-    Image::pointer output = input->crop(mOffset, mSize);
+    Image::pointer output = input->crop(mOffset - mInputOffset, mSize);
     setStaticOutputData<Image>(0, output);
 }
 
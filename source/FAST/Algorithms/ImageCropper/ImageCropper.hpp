@@ -13,9 +13,12 @@ class ImageCropper : public ProcessObject {
     private:
         ImageCropper();
         void execute();
+        void requestInputRegions();
 
         VectorXui mOffset;
         VectorXui mSize;
+        // Offset of the input in the whole image, if the parent only produces a region of it
+        Vector3ui mInputOffset;
 };
 
 
@@ -1,5 +1,8 @@
 #include "FAST/Algorithms/ImageGradient/ImageGradient.hpp"
 #include "FAST/DeviceManager.hpp"
+#include "FAST/SlabSplitter.hpp"
+#include "FAST/WorkGroupSizeTuner.hpp"
+#include <boost/bind.hpp>
 
 namespace fast {
 
@@ -11,16 +14,16 @@ ImageGradient::ImageGradient() {
     mUse16bitFormat = false;
 }
 
+bool ImageGradient::isDeviceSupported(ExecutionDevice::pointer device) {
+    // There is no host implementation
+    return !device->isHost();
+}
+
 void ImageGradient::execute() {
     Image::pointer input = getStaticInputData<Image>(0);
     Image::pointer output = getStaticOutputData<Image>(0);
 
-    std::string buildOptions = "";
-    DataType type = TYPE_FLOAT;
-    if(mUse16bitFormat) {
-        type = TYPE_SNORM_INT16;
-        buildOptions = "-DVECTORS_16BIT";
-    }
+    DataType type = mUse16bitFormat ? TYPE_SNORM_INT16 : TYPE_FLOAT;
 
     // Initialize output image
     if(input->getDimensions() == 2) {
@@ -43,36 +46,41 @@ void ImageGradient::execute() {
     if(getMainDevice()->isHost()) {
         throw Exception("Not implemented yet.");
     } else {
-        OpenCLDevice::pointer device = OpenCLDevice::pointer(getMainDevice());
-        cl::Program program = getOpenCLProgram(device, "", buildOptions);
-        cl::Kernel kernel;
-        OpenCLImageAccess::pointer inputAccess = input->getOpenCLImageAccess(ACCESS_READ, device);
-        if(input->getDimensions() == 2) {
-            kernel = cl::Kernel(program, "gradient2D");
-            OpenCLImageAccess::pointer outputAccess = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
-            kernel.setArg(0, *inputAccess->get2DImage());
-            kernel.setArg(1, *outputAccess->get2DImage());
+        std::vector<OpenCLDevice::pointer> devices = getSplitDevices();
+        if(devices.size() > 1) {
+            // Central differences need one neighbour on each side
+            SlabSplitter::execute(input, output, devices, 1,
+                    boost::bind(&ImageGradient::executeOnDevice, this, _1, _2, _3));
         } else {
-            kernel = cl::Kernel(program, "gradient3D");
-            kernel.setArg(0, *inputAccess->get3DImage());
-
-            if(device->isWritingTo3DTexturesSupported()) {
-                OpenCLImageAccess::pointer outputAccess = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
-                kernel.setArg(1, *outputAccess->get3DImage());
-            } else {
-                // If device does not support writing to 3D textures, use a buffer instead
-                OpenCLBufferAccess::pointer outputAccess = output->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
-                kernel.setArg(1, *outputAccess->get());
-            }
+            executeOnDevice(input, output, getMainDevice());
         }
+    }
+}
 
-        device->getCommandQueue().enqueueNDRangeKernel(
-                kernel,
-                cl::NullRange,
-                cl::NDRange(input->getWidth(), input->getHeight(), input->getDepth()),
-                cl::NullRange
-        );
+void ImageGradient::executeOnDevice(Image::pointer input, Image::pointer output, OpenCLDevice::pointer device) {
+    std::string buildOptions = mUse16bitFormat ? "-DVECTORS_16BIT" : "";
+    cl::Kernel kernel;
+    OpenCLImageAccess::pointer inputAccess = input->getOpenCLImageAccess(ACCESS_READ, device);
+    if(input->getDimensions() == 2) {
+        kernel = getOpenCLKernel(device, "gradient2D", "", buildOptions);
+        OpenCLImageAccess::pointer outputAccess = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
+        kernel.setArg(0, *inputAccess->get2DImage());
+        kernel.setArg(1, *outputAccess->get2DImage());
+    } else {
+        kernel = getOpenCLKernel(device, "gradient3D", "", buildOptions);
+        kernel.setArg(0, *inputAccess->get3DImage());
+
+        if(device->isWritingTo3DTexturesSupported()) {
+            OpenCLImageAccess::pointer outputAccess = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
+            kernel.setArg(1, *outputAccess->get3DImage());
+        } else {
+            // If device does not support writing to 3D textures, use a buffer instead
+            OpenCLBufferAccess::pointer outputAccess = output->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
+            kernel.setArg(1, *outputAccess->get());
+        }
     }
+
+    WorkGroupSizeTuner::enqueueNDRangeKernel(device, kernel, cl::NDRange(input->getWidth(), input->getHeight(), input->getDepth()));
 }
 
 void ImageGradient::set16bitStorageFormat() {
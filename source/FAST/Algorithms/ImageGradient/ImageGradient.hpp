@@ -20,6 +20,8 @@ class ImageGradient : public ProcessObject {
     private:
         ImageGradient();
         void execute();
+        void executeOnDevice(Image::pointer input, Image::pointer output, OpenCLDevice::pointer device);
+        bool isDeviceSupported(ExecutionDevice::pointer device);
 
         bool mUse16bitFormat;
 };
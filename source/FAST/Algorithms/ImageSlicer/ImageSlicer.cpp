@@ -24,6 +24,36 @@ ImageSlicer::ImageSlicer() : mArbitrarySlicePlane(Plane(Vector3f(1,0,0))) {
 
 	mArbitrarySlicing = false;
 	mOrthogonalSlicing = false;
+	mInputOffset = Vector3ui::Zero();
+}
+
+void ImageSlicer::requestInputRegions() {
+	// For orthogonal slicing, ask the parent to only produce a slab of two voxels starting at the slice.
+	// A slab is used because 3D images must have at least two voxels in each direction.
+	// Otherwise the whole image is requested, replacing any previous request of this slicer.
+	mInputOffset = Vector3ui::Zero();
+	if(getNrOfInputData() == 0)
+		return;
+	Vector3ui offset = Vector3ui::Zero();
+	Vector3ui size = Vector3ui::Zero(); // 0 means the whole image along that axis
+	if(mOrthogonalSlicing && mOrthogonalSliceNr >= 0) {
+		switch(mOrthogonalSlicePlane) {
+			case PLANE_X:
+				offset.x() = mOrthogonalSliceNr;
+				size.x() = 2;
+				break;
+			case PLANE_Y:
+				offset.y() = mOrthogonalSliceNr;
+				size.y() = 2;
+				break;
+			case PLANE_Z:
+				offset.z() = mOrthogonalSliceNr;
+				size.z() = 2;
+				break;
+		}
+	}
+	ProcessObjectPort port = getInputPort(0);
+	port.getProcessObject()->requestRegion(this, port.getPortID(), offset, size, mInputOffset);
 }
 
 void ImageSlicer::execute() {
@@ -62,8 +92,8 @@ void ImageSlicer::orthogonalSlicing(Image::pointer input, Image::pointer output)
             break;
         }
     } else {
-        // Check that mSliceNr is valid
-        sliceNr = mOrthogonalSliceNr;
+        // Check that mSliceNr is valid. The input may be a region starting at mInputOffset.
+        sliceNr = mOrthogonalSliceNr - mInputOffset[mOrthogonalSlicePlane == PLANE_X ? 0 : (mOrthogonalSlicePlane == PLANE_Y ? 1 : 2)];
         switch(mOrthogonalSlicePlane) {
         case PLANE_X:
             if(sliceNr >= input->getWidth())
@@ -112,8 +142,7 @@ void ImageSlicer::orthogonalSlicing(Image::pointer input, Image::pointer output)
     OpenCLImageAccess::pointer outputAccess = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
 
 	cl::CommandQueue queue = device->getCommandQueue();
-	cl::Program program = getOpenCLProgram(device);
-	cl::Kernel kernel(program, "orthogonalSlicing");
+	cl::Kernel kernel = getOpenCLKernel(device, "orthogonalSlicing");
 
     kernel.setArg(0, *inputAccess->get3DImage());
     kernel.setArg(1, *outputAccess->get2DImage());
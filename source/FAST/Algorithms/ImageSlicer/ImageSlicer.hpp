@@ -17,6 +17,7 @@ class ImageSlicer : public ProcessObject {
 	private:
 		ImageSlicer();
 		void execute();
+		void requestInputRegions();
 		void orthogonalSlicing(SharedPointer<Image> input, SharedPointer<Image> output);
 		void arbitrarySlicing(SharedPointer<Image> input, SharedPointer<Image> output);
 
@@ -25,6 +26,8 @@ class ImageSlicer : public ProcessObject {
 		Plane mArbitrarySlicePlane;
 		PlaneType mOrthogonalSlicePlane;
 		int mOrthogonalSliceNr;
+		// Offset of the input in the whole image, if the parent only produces a region of it
+		Vector3ui mInputOffset;
 };
 
 } // end namespace fast
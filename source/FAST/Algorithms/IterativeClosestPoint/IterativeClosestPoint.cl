@@ -0,0 +1,136 @@
+// Sums of each iteration: number of correspondences, moving points (3), fixed points (3),
+// moving times fixed point transposed (9), squared error (1) and number of error terms (1).
+// The points are relative to reference points close to their centroids to keep the float sums accurate.
+#define NR_OF_SUMS 18
+#define STACK_SIZE 40
+
+// Index of the node closest to position, or -1 if no node has a squared distance below bestDistance.
+// The tree is stored as in KDTree: the node of the range [begin, end) is in the middle of it, and w is its split axis.
+int findNearestNeighbor(__global const float4* nodes, int nrOfNodes, float3 position, float bestDistance) {
+    int best = -1;
+    int stackBegin[STACK_SIZE];
+    int stackEnd[STACK_SIZE];
+    float stackDistance[STACK_SIZE];
+    int stackSize = 1;
+    stackBegin[0] = 0;
+    stackEnd[0] = nrOfNodes;
+    stackDistance[0] = 0;
+    while(stackSize > 0) {
+        stackSize--;
+        int begin = stackBegin[stackSize];
+        int end = stackEnd[stackSize];
+        if(stackDistance[stackSize] >= bestDistance)
+            continue;
+        while(begin < end) {
+            const int middle = (begin + end) / 2;
+            const float4 node = nodes[middle];
+            const float3 difference = position - node.xyz;
+            const float distance = dot(difference, difference);
+            if(distance < bestDistance) {
+                bestDistance = distance;
+                best = middle;
+            }
+            const int axis = (int)node.w;
+            const float planeDistance = axis == 0 ? difference.x : (axis == 1 ? difference.y : difference.z);
+            // Search the subtree on the other side of the split plane later
+            if(planeDistance*planeDistance < bestDistance) {
+                stackBegin[stackSize] = planeDistance < 0 ? middle + 1 : begin;
+                stackEnd[stackSize] = planeDistance < 0 ? end : middle;
+                stackDistance[stackSize] = planeDistance*planeDistance;
+                stackSize++;
+            }
+            if(planeDistance < 0) {
+                end = middle;
+            } else {
+                begin = middle + 1;
+            }
+        }
+    }
+    return best;
+}
+
+// Sum each of the NR_OF_SUMS values of the work-items in a work-group
+void sumWorkGroup(float* sums, __local float* scratch, __global float* result) {
+    const int localId = get_local_id(0);
+    for(int j = 0; j < NR_OF_SUMS; j++) {
+        scratch[localId] = sums[j];
+        barrier(CLK_LOCAL_MEM_FENCE);
+        for(int offset = get_local_size(0) / 2; offset > 0; offset = offset / 2) {
+            if(localId < offset)
+                scratch[localId] += scratch[localId + offset];
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+        if(localId == 0)
+            result[j] = scratch[0];
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+}
+
+__kernel void findCorrespondences(
+        __global const float4* movingPoints,
+        __private int nrOfPoints,
+        __global const float4* nodes,
+        __private int nrOfNodes,
+        __global int* correspondences,
+        __private float16 transform,
+        __private float maxDistance,
+        __private float4 movingReference,
+        __private float4 fixedReference,
+        __local float* scratch,
+        __global float* partialSums
+    ) {
+    float sums[NR_OF_SUMS];
+    for(int j = 0; j < NR_OF_SUMS; j++)
+        sums[j] = 0;
+
+    for(int i = get_global_id(0); i < nrOfPoints; i += get_global_size(0)) {
+        const float3 point = movingPoints[i].xyz;
+        const float3 moved = (float3)(
+                dot(transform.s012, point) + transform.s3,
+                dot(transform.s456, point) + transform.s7,
+                dot(transform.s89a, point) + transform.sb
+        );
+
+        // Error of the previous correspondence with the updated transform
+        const int previous = correspondences[i];
+        if(previous >= 0) {
+            const float3 difference = nodes[previous].xyz - moved;
+            sums[16] += dot(difference, difference);
+            sums[17] += 1;
+        }
+
+        const int closest = findNearestNeighbor(nodes, nrOfNodes, moved, maxDistance);
+        correspondences[i] = closest;
+        if(closest >= 0) {
+            const float3 p = moved - movingReference.xyz;
+            const float3 q = nodes[closest].xyz - fixedReference.xyz;
+            const float pArray[3] = {p.x, p.y, p.z};
+            const float qArray[3] = {q.x, q.y, q.z};
+            sums[0] += 1;
+            for(int r = 0; r < 3; r++) {
+                sums[1 + r] += pArray[r];
+                sums[4 + r] += qArray[r];
+                for(int c = 0; c < 3; c++)
+                    sums[7 + r*3 + c] += pArray[r]*qArray[c];
+            }
+        }
+    }
+
+    sumWorkGroup(sums, scratch, &partialSums[get_group_id(0)*NR_OF_SUMS]);
+}
+
+__kernel void sumPartialSums(
+        __global const float* partialSums,
+        __private int nrOfGroups,
+        __local float* scratch,
+        __global float* result
+    ) {
+    float sums[NR_OF_SUMS];
+    for(int j = 0; j < NR_OF_SUMS; j++) {
+        sums[j] = 0;
+        for(int i = get_local_id(0); i < nrOfGroups; i += get_local_size(0))
+            sums[j] += partialSums[i*NR_OF_SUMS + j];
+    }
+
+    sumWorkGroup(sums, scratch, result);
+}
@@ -1,18 +1,27 @@
 #include "FAST/Algorithms/IterativeClosestPoint/IterativeClosestPoint.hpp"
 #include "FAST/SceneGraph.hpp"
+#include "FAST/Algorithms/IterativeClosestPoint/KDTree.hpp"
+#include "FAST/OpenCLMemoryPool.hpp"
 #undef min
 #undef max
 #include <limits>
+#include <algorithm>
+#include <random>
 
 namespace fast {
 
 IterativeClosestPoint::IterativeClosestPoint() {
     createInputPort<PointSet>(0);
     createInputPort<PointSet>(1);
+    createOpenCLProgram(std::string(FAST_SOURCE_DIR) + "Algorithms/IterativeClosestPoint/IterativeClosestPoint.cl");
     mMaxIterations = 100;
     mMinErrorChange = 1e-5;
     mError = -1;
+    mMaxCorrespondenceDistance = std::numeric_limits<float>::max();
+    mNrOfIterations = 0;
+    mNrOfResolutionLevels = 1;
     mTransformationType = IterativeClosestPoint::RIGID;
+    mDistanceMetric = IterativeClosestPoint::POINT_TO_POINT;
     mIsModified = true;
     mTransformation = AffineTransformation::New();
 }
@@ -27,6 +36,12 @@ void IterativeClosestPoint::setMovingPointSetPort(ProcessObjectPort port) {
 void IterativeClosestPoint::setFixedPointSet(PointSet::pointer data) {
     setInputData(0, data);
 }
+void IterativeClosestPoint::setFixedMeshPort(ProcessObjectPort port) {
+    setInputConnection(0, port);
+}
+void IterativeClosestPoint::setFixedMesh(Mesh::pointer data) {
+    setInputData(0, data);
+}
 void IterativeClosestPoint::setMovingPointSet(PointSet::pointer data) {
     setInputData(1, data);
 }
@@ -39,33 +54,6 @@ float IterativeClosestPoint::getError() const {
     return mError;
 }
 
-/**
- * Create a new matrix which is matrix A rearranged.
- * This matrix has the same size as B
- */
-inline MatrixXf rearrangeMatrixToClosestPoints(const MatrixXf A, const MatrixXf B) {
-    MatrixXf result = MatrixXf::Constant(B.rows(), B.cols(), 0);
-
-    // For each point in B, find the closest point in A
-    for(uint b = 0; b < B.cols(); b++) {
-        Vector3f pointInB = B.col(b);
-        float minDistance = std::numeric_limits<float>::max();
-        uint closestPoint = 0;
-        for(uint a = 0; a < A.cols(); a++) {
-            Vector3f pointInA = A.col(a);
-            float distance = (pointInA-pointInB).norm();
-            if(distance < minDistance) {
-                minDistance = distance;
-                closestPoint = a;
-            }
-        }
-        result.col(b) = A.col(closestPoint);
-    }
-
-    return result;
-
-}
-
 /*
  * Get centroid
  */
@@ -89,115 +77,413 @@ void IterativeClosestPoint::setTransformationType(
     mIsModified = true;
 }
 
-void IterativeClosestPoint::execute() {
-    float error = std::numeric_limits<float>::max(), previousError;
-    uint iterations = 0;
+void IterativeClosestPoint::setMaximumCorrespondenceDistance(float distance) {
+    if(distance <= 0)
+        throw Exception("Maximum correspondence distance of IterativeClosestPoint must be larger than 0");
+    mMaxCorrespondenceDistance = distance;
+    mIsModified = true;
+}
+
+void IterativeClosestPoint::setDistanceMetric(const IterativeClosestPoint::DistanceMetric metric) {
+    mDistanceMetric = metric;
+    mIsModified = true;
+}
+
+void IterativeClosestPoint::setNrOfResolutionLevels(uint levels) {
+    if(levels == 0)
+        throw Exception("IterativeClosestPoint needs at least one resolution level");
+    mNrOfResolutionLevels = levels;
+    mIsModified = true;
+}
+
+uint IterativeClosestPoint::getNrOfIterations() const {
+    return mNrOfIterations;
+}
 
-    // Get access to the two point sets
-    PointSetAccess::pointer accessFixedSet = ((PointSet::pointer)getStaticInputData<PointSet>(0))->getAccess(ACCESS_READ);
-    PointSetAccess::pointer accessMovingSet = ((PointSet::pointer)getStaticInputData<PointSet>(1))->getAccess(ACCESS_READ);
+/*
+ * The rotation and translation which best align the moving points to their fixed points, from the correlation
+ * matrix H of the deviations from the centroids
+ */
+static Eigen::Affine3f getPointToPointUpdate(const Matrix3f& H, const Vector3f& centroidMoving, const Vector3f& centroidFixed, bool onlyTranslation) {
+    Eigen::Affine3f update = Eigen::Affine3f::Identity();
+    if(onlyTranslation) {
+        update.translation() = centroidFixed - centroidMoving;
+        return update;
+    }
+
+    // Do SVD on H
+    Eigen::JacobiSVD<Matrix3f> svd(H, Eigen::ComputeFullU | Eigen::ComputeFullV);
+
+    // Estimate rotation as R=V*U.transpose()
+    Matrix3f temp = svd.matrixV()*svd.matrixU().transpose();
+    Matrix3f d = Matrix3f::Identity();
+    d(2,2) = sign(temp.determinant());
+    Matrix3f R = svd.matrixV()*d*svd.matrixU().transpose();
+
+    // Estimate translation
+    Vector3f T = centroidFixed - R*centroidMoving;
+
+    update.linear() = R;
+    update.translation() = T;
+    return update;
+}
+
+/*
+ * Estimate the normal of each point as the direction of least variance of its closest neighbors
+ */
+static MatrixXf estimateNormals(const MatrixXf& points, const KDTree& tree) {
+    const uint nrOfNeighbors = 10;
+    MatrixXf normals(3, points.cols());
+    #pragma omp parallel for
+    for(int i = 0; i < (int)points.cols(); i++) {
+        std::vector<int> neighbors = tree.findKNearestNeighbors(points.col(i), nrOfNeighbors);
+        Vector3f centroid = Vector3f::Zero();
+        for(int j = 0; j < neighbors.size(); j++)
+            centroid += points.col(neighbors[j]);
+        centroid /= neighbors.size();
+        Matrix3f covariance = Matrix3f::Zero();
+        for(int j = 0; j < neighbors.size(); j++) {
+            Vector3f deviation = points.col(neighbors[j]) - centroid;
+            covariance += deviation*deviation.transpose();
+        }
+        // Eigenvalues are sorted in increasing order
+        Eigen::SelfAdjointEigenSolver<Matrix3f> solver(covariance);
+        normals.col(i) = solver.eigenvectors().col(0);
+    }
+    return normals;
+}
+
+/*
+ * Linearized point to plane step: the small rotation and the translation which minimize
+ * the distances from the moved points to the tangent planes of their closest fixed points
+ */
+static Eigen::Affine3f getPointToPlaneUpdate(const MatrixXf& movedPoints, const MatrixXf& fixedPoints, const MatrixXf& normals, bool onlyTranslation) {
+    // Normal equations of the rows [p x n, n] with right hand side (q - p).n
+    Eigen::Matrix<double, 6, 6> ATA = Eigen::Matrix<double, 6, 6>::Zero();
+    Eigen::Matrix<double, 6, 1> ATb = Eigen::Matrix<double, 6, 1>::Zero();
+    for(int i = 0; i < movedPoints.cols(); i++) {
+        Eigen::Vector3d p = movedPoints.col(i).cast<double>();
+        Eigen::Vector3d q = fixedPoints.col(i).cast<double>();
+        Eigen::Vector3d n = normals.col(i).cast<double>();
+        Eigen::Matrix<double, 6, 1> row;
+        row << p.cross(n), n;
+        ATA += row*row.transpose();
+        ATb += row*(q - p).dot(n);
+    }
+
+    Eigen::Affine3f update = Eigen::Affine3f::Identity();
+    if(onlyTranslation) {
+        Eigen::Vector3d translation = ATA.bottomRightCorner<3,3>().ldlt().solve(ATb.tail<3>());
+        update.translation() = translation.cast<float>();
+    } else {
+        Eigen::Matrix<double, 6, 1> x = ATA.ldlt().solve(ATb);
+        Eigen::Matrix3d R;
+        R = Eigen::AngleAxisd(x(2), Eigen::Vector3d::UnitZ())
+          * Eigen::AngleAxisd(x(1), Eigen::Vector3d::UnitY())
+          * Eigen::AngleAxisd(x(0), Eigen::Vector3d::UnitX());
+        update.linear() = R.cast<float>();
+        update.translation() = x.tail<3>().cast<float>();
+    }
+    return update;
+}
+
+void IterativeClosestPoint::execute() {
+    // The fixed data can be a point set, or a mesh with normals for point to plane registration
+    SpatialDataObject::pointer fixedData = getStaticInputData<SpatialDataObject>(0);
+    PointSet::pointer movingSet = getStaticInputData<PointSet>(1);
 
     // Get transformations of point sets
-    AffineTransformation::pointer fixedPointTransform2 = SceneGraph::getAffineTransformationFromData(getStaticInputData<PointSet>(0));
+    AffineTransformation::pointer fixedPointTransform2 = SceneGraph::getAffineTransformationFromData(fixedData);
     Eigen::Affine3f fixedPointTransform;
     fixedPointTransform.matrix() = fixedPointTransform2->matrix();
-    AffineTransformation::pointer initialMovingTransform2 = SceneGraph::getAffineTransformationFromData(getStaticInputData<PointSet>(1));
+    AffineTransformation::pointer initialMovingTransform2 = SceneGraph::getAffineTransformationFromData(movingSet);
     Eigen::Affine3f initialMovingTransform;
     initialMovingTransform.matrix() = initialMovingTransform2->matrix();
 
-    // These matrices are Nx3
-    MatrixXf fixedPoints = accessFixedSet->getPointSetAsMatrix();
-    MatrixXf movingPoints = accessMovingSet->getPointSetAsMatrix();
-
-    Eigen::Affine3f currentTransformation = Eigen::Affine3f::Identity();
+    // These matrices are 3xN
+    MatrixXf fixedPoints;
+    MatrixXf fixedNormals;
+    if(fixedData->getNameOfClass() == Mesh::getStaticNameOfClass()) {
+        Mesh::pointer mesh = fixedData;
+        if(mesh->getDimensions() != 3)
+            throw Exception("IterativeClosestPoint only supports 3D meshes");
+        MeshAccess::pointer access = mesh->getMeshAccess(ACCESS_READ);
+        std::vector<MeshVertex> vertices = access->getVertices();
+        fixedPoints = MatrixXf(3, vertices.size());
+        fixedNormals = MatrixXf(3, vertices.size());
+        for(int i = 0; i < vertices.size(); i++) {
+            fixedPoints.col(i) = vertices[i].getPosition();
+            fixedNormals.col(i) = vertices[i].getNormal();
+        }
+        // Normals are transformed by the inverse transpose
+        fixedNormals = fixedPointTransform.linear().inverse().transpose()*fixedNormals;
+        for(int i = 0; i < fixedNormals.cols(); i++)
+            fixedNormals.col(i).normalize();
+    } else {
+        PointSet::pointer fixedSet = fixedData;
+        PointSetAccess::pointer access = fixedSet->getAccess(ACCESS_READ);
+        fixedPoints = access->getPointSetAsMatrix();
+    }
+    MatrixXf movingPoints;
+    {
+        PointSetAccess::pointer access = movingSet->getAccess(ACCESS_READ);
+        movingPoints = access->getPointSetAsMatrix();
+    }
 
-    // Want to choose the smallest one as moving
-    bool invertTransform = false;
-    if(false && fixedPoints.cols() < movingPoints.cols()) {
-        reportInfo() << "switching fixed and moving" << Reporter::end;
-        // Switch fixed and moving
-        MatrixXf temp = fixedPoints;
-        fixedPoints = movingPoints;
-        movingPoints = temp;
-        invertTransform = true;
-
-        // Apply initial transformations
-        //currentTransformation = fixedPointTransform.getTransform();
-        movingPoints = fixedPointTransform*movingPoints.colwise().homogeneous();
-        fixedPoints = initialMovingTransform*fixedPoints.colwise().homogeneous();
+    if(fixedPoints.cols() == 0 || movingPoints.cols() == 0)
+        throw Exception("The point sets given to IterativeClosestPoint can't be empty");
+
+    // Apply initial transformations
+    movingPoints = initialMovingTransform*movingPoints.colwise().homogeneous();
+    fixedPoints = fixedPointTransform*fixedPoints.colwise().homogeneous();
+
+    // The fixed points don't move, so they are only indexed once
+    KDTree fixedPointTree(fixedPoints);
+    if(mDistanceMetric == IterativeClosestPoint::POINT_TO_PLANE && fixedNormals.cols() == 0)
+        fixedNormals = estimateNormals(fixedPoints, fixedPointTree);
+
+    // Coarse levels use the first points of a random order of the moving points
+    std::vector<int> order(movingPoints.cols());
+    for(int i = 0; i < order.size(); i++)
+        order[i] = i;
+    if(mNrOfResolutionLevels > 1)
+        std::shuffle(order.begin(), order.end(), std::mt19937(0));
+    MatrixXf orderedMovingPoints(3, order.size());
+    for(int i = 0; i < order.size(); i++)
+        orderedMovingPoints.col(i) = movingPoints.col(order[i]);
+
+    Eigen::Affine3f transformation;
+    if(!getMainDevice()->isHost() && mDistanceMetric == IterativeClosestPoint::POINT_TO_POINT) {
+        transformation = registerOnDevice(orderedMovingPoints, fixedPointTree, getMainDevice());
     } else {
-        // Apply initial transformations
-        //currentTransformation = initialMovingTransform.getTransform();
-        movingPoints = initialMovingTransform*movingPoints.colwise().homogeneous();
-        fixedPoints = fixedPointTransform*fixedPoints.colwise().homogeneous();
+        transformation = registerOnHost(orderedMovingPoints, fixedPoints, fixedNormals, fixedPointTree);
     }
-    do {
-        previousError = error;
-        MatrixXf movedPoints = currentTransformation*(movingPoints.colwise().homogeneous());
-
-        // Match closest points using current transformation
-        MatrixXf rearrangedFixedPoints = rearrangeMatrixToClosestPoints(
-                fixedPoints, movedPoints);
-
-        // Get centroids
-        Vector3f centroidFixed = getCentroid(rearrangedFixedPoints);
-        //reportInfo() << "Centroid fixed: " << Reporter::end;
-        //reportInfo() << centroidFixed << Reporter::end;
-        Vector3f centroidMoving = getCentroid(movedPoints);
-        //reportInfo() << "Centroid moving: " << Reporter::end;
-        //reportInfo() << centroidMoving << Reporter::end;
-
-        Eigen::Transform<float, 3, Eigen::Affine> updateTransform = Eigen::Transform<float, 3, Eigen::Affine>::Identity();
-
-        if(mTransformationType == IterativeClosestPoint::RIGID) {
-            // Create correlation matrix H of the deviations from centroid
-            MatrixXf H = (movedPoints.colwise() - centroidMoving)*
-                    (rearrangedFixedPoints.colwise() - centroidFixed).transpose();
-
-            // Do SVD on H
-            Eigen::JacobiSVD<Eigen::MatrixXf> svd(H, Eigen::ComputeFullU | Eigen::ComputeFullV);
-
-            // Estimate rotation as R=V*U.transpose()
-            MatrixXf temp = svd.matrixV()*svd.matrixU().transpose();
-            Matrix3f d = Matrix3f::Identity();
-            d(2,2) = sign(temp.determinant());
-            Matrix3f R = svd.matrixV()*d*svd.matrixU().transpose();
-
-            // Estimate translation
-            Vector3f T = centroidFixed - R*centroidMoving;
-
-            updateTransform.linear() = R;
-            updateTransform.translation() = T;
-        } else {
-            // Only translation
-            Vector3f T = centroidFixed - centroidMoving;
-            updateTransform.translation() = T;
-        }
+    mTransformation->matrix() = transformation.matrix();
+}
 
-        // Update current transformation
-        currentTransformation = updateTransform*currentTransformation;
+/*
+ * Number of moving points used at a resolution level, each level uses 4 times as many as the previous
+ */
+static int getLevelSize(uint level, uint nrOfLevels, int nrOfPoints) {
+    int levelSize = nrOfPoints;
+    for(uint i = level + 1; i < nrOfLevels; i++)
+        levelSize /= 4;
+    return std::max(levelSize, std::min(nrOfPoints, 256));
+}
 
-        // Calculate RMS error
-        MatrixXf distance = rearrangedFixedPoints - currentTransformation*(movingPoints.colwise().homogeneous());
-        error = 0;
-        for(uint i = 0; i < distance.cols(); i++) {
-            error += pow(distance.col(i).norm(),2);
-        }
-        error = sqrt(error / distance.cols());
+Eigen::Affine3f IterativeClosestPoint::registerOnHost(const MatrixXf& movingPoints, const MatrixXf& fixedPoints, const MatrixXf& fixedNormals, const KDTree& fixedPointTree) {
+    Eigen::Affine3f currentTransformation = Eigen::Affine3f::Identity();
+    float error = std::numeric_limits<float>::max();
+    uint iterations = 0;
+    for(uint level = 0; level < mNrOfResolutionLevels; level++) {
+        const int levelSize = getLevelSize(level, mNrOfResolutionLevels, movingPoints.cols());
+        MatrixXf levelPoints = movingPoints.leftCols(levelSize);
+        float previousError;
+        error = std::numeric_limits<float>::max();
+        uint levelIterations = 0;
+        do {
+            previousError = error;
+            MatrixXf allMovedPoints = currentTransformation*(levelPoints.colwise().homogeneous());
+
+            // Match closest points using current transformation
+            std::vector<int> closestPoints = fixedPointTree.findNearestNeighbors(allMovedPoints, mMaxCorrespondenceDistance);
+            std::vector<int> matchedPoints;
+            for(int i = 0; i < closestPoints.size(); i++) {
+                if(closestPoints[i] >= 0)
+                    matchedPoints.push_back(i);
+            }
+            if(matchedPoints.size() == 0)
+                throw Exception("No moving points were within the maximum correspondence distance in IterativeClosestPoint");
+            MatrixXf rearrangedFixedPoints(3, matchedPoints.size());
+            MatrixXf matchedMovingPoints(3, matchedPoints.size());
+            MatrixXf movedPoints(3, matchedPoints.size());
+            MatrixXf normals(3, fixedNormals.cols() > 0 ? matchedPoints.size() : 0);
+            for(int i = 0; i < matchedPoints.size(); i++) {
+                rearrangedFixedPoints.col(i) = fixedPoints.col(closestPoints[matchedPoints[i]]);
+                matchedMovingPoints.col(i) = levelPoints.col(matchedPoints[i]);
+                movedPoints.col(i) = allMovedPoints.col(matchedPoints[i]);
+                if(normals.cols() > 0)
+                    normals.col(i) = fixedNormals.col(closestPoints[matchedPoints[i]]);
+            }
 
-        iterations++;
-        reportInfo() << "Error: " << error << Reporter::end;
-        // To continue, change in error has to be above min error change and nr of iterations less than max iterations
-    } while(previousError-error > mMinErrorChange && iterations < mMaxIterations);
+            Eigen::Transform<float, 3, Eigen::Affine> updateTransform = Eigen::Transform<float, 3, Eigen::Affine>::Identity();
+
+            if(mDistanceMetric == IterativeClosestPoint::POINT_TO_PLANE) {
+                updateTransform = getPointToPlaneUpdate(movedPoints, rearrangedFixedPoints, normals,
+                        mTransformationType == IterativeClosestPoint::TRANSLATION);
+            } else {
+                Vector3f centroidFixed = getCentroid(rearrangedFixedPoints);
+                Vector3f centroidMoving = getCentroid(movedPoints);
+                // Create correlation matrix H of the deviations from centroid
+                Matrix3f H = (movedPoints.colwise() - centroidMoving)*
+                        (rearrangedFixedPoints.colwise() - centroidFixed).transpose();
+                updateTransform = getPointToPointUpdate(H, centroidMoving, centroidFixed,
+                        mTransformationType == IterativeClosestPoint::TRANSLATION);
+            }
 
+            // Update current transformation
+            currentTransformation = updateTransform*currentTransformation;
+
+            // Calculate RMS error, with the distances to the tangent planes for point to plane
+            MatrixXf distance = rearrangedFixedPoints - currentTransformation*(matchedMovingPoints.colwise().homogeneous());
+            error = 0;
+            for(uint i = 0; i < distance.cols(); i++) {
+                if(mDistanceMetric == IterativeClosestPoint::POINT_TO_PLANE) {
+                    error += pow(distance.col(i).dot(normals.col(i)),2);
+                } else {
+                    error += pow(distance.col(i).norm(),2);
+                }
+            }
+            error = sqrt(error / distance.cols());
 
-    if(invertTransform){
-        currentTransformation = currentTransformation.inverse();
+            iterations++;
+            levelIterations++;
+            reportInfo() << "Error: " << error << Reporter::end;
+            // To continue, change in error has to be above min error change and nr of iterations at this level less than max iterations
+        } while(previousError-error > mMinErrorChange && levelIterations < mMaxIterations);
     }
 
     mError = error;
-    mTransformation->matrix() = currentTransformation.matrix();
+    mNrOfIterations = iterations;
+    return currentTransformation;
 }
 
 
+
+Eigen::Affine3f IterativeClosestPoint::registerOnDevice(const MatrixXf& movingPoints, const KDTree& fixedPointTree, OpenCLDevice::pointer device) {
+    const int nrOfSums = 18; // See IterativeClosestPoint.cl
+    const int nrOfPoints = movingPoints.cols();
+    const int nrOfNodes = fixedPointTree.getNrOfPoints();
+    cl::CommandQueue queue = device->getCommandQueue();
+    OpenCLMemoryPool::pointer pool = OpenCLMemoryPool::getInstance(device);
+
+    // Upload both point sets once
+    std::vector<cl_float> movingData(nrOfPoints*4, 0);
+    for(int i = 0; i < nrOfPoints; i++) {
+        movingData[i*4] = movingPoints(0, i);
+        movingData[i*4 + 1] = movingPoints(1, i);
+        movingData[i*4 + 2] = movingPoints(2, i);
+    }
+    std::vector<cl_int> correspondenceData(nrOfPoints, -1);
+    cl::Buffer movingBuffer = pool->acquireBuffer(sizeof(cl_float)*4*nrOfPoints);
+    cl::Buffer nodeBuffer = pool->acquireBuffer(sizeof(cl_float)*4*std::max(nrOfNodes, 1));
+    cl::Buffer correspondenceBuffer = pool->acquireBuffer(sizeof(cl_int)*nrOfPoints);
+    queue.enqueueWriteBuffer(movingBuffer, CL_FALSE, 0, sizeof(cl_float)*4*nrOfPoints, &movingData[0]);
+    queue.enqueueWriteBuffer(nodeBuffer, CL_FALSE, 0, sizeof(cl_float)*4*nrOfNodes, &fixedPointTree.getNodes()[0]);
+    queue.enqueueWriteBuffer(correspondenceBuffer, CL_FALSE, 0, sizeof(cl_int)*nrOfPoints, &correspondenceData[0]);
+
+    cl::Kernel correspondenceKernel = getOpenCLKernel(device, "findCorrespondences");
+    cl::Kernel sumKernel = getOpenCLKernel(device, "sumPartialSums");
+    // The work-group size must be a power of two for the reductions
+    const int maxWorkGroupSize = std::min(
+            correspondenceKernel.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(device->getDevice()),
+            sumKernel.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(device->getDevice())
+    );
+    int workGroupSize = 1;
+    while(workGroupSize*2 <= std::min(maxWorkGroupSize, 256))
+        workGroupSize *= 2;
+    const int maxNrOfGroups = 256;
+    cl::Buffer partialSumBuffer = pool->acquireBuffer(sizeof(cl_float)*nrOfSums*maxNrOfGroups);
+    cl::Buffer sumBuffer = pool->acquireBuffer(sizeof(cl_float)*nrOfSums);
+
+    const float maxDistance = mMaxCorrespondenceDistance < std::numeric_limits<float>::max() ?
+            mMaxCorrespondenceDistance*mMaxCorrespondenceDistance : std::numeric_limits<float>::max();
+    correspondenceKernel.setArg(0, movingBuffer);
+    correspondenceKernel.setArg(2, nodeBuffer);
+    correspondenceKernel.setArg(3, nrOfNodes);
+    correspondenceKernel.setArg(4, correspondenceBuffer);
+    correspondenceKernel.setArg(6, maxDistance);
+    correspondenceKernel.setArg(9, sizeof(cl_float)*workGroupSize, NULL);
+    correspondenceKernel.setArg(10, partialSumBuffer);
+    sumKernel.setArg(0, partialSumBuffer);
+    sumKernel.setArg(2, sizeof(cl_float)*workGroupSize, NULL);
+    sumKernel.setArg(3, sumBuffer);
+
+    // The fixed centroid is the initial reference point of both point sets
+    const Vector3f fixedCentroid = getCentroid(Eigen::Map<const MatrixXf>(&fixedPointTree.getNodes()[0], 4, nrOfNodes).topRows(3));
+    Eigen::Affine3f currentTransformation = Eigen::Affine3f::Identity();
+    float error = std::numeric_limits<float>::max();
+    uint iterations = 0;
+    // The pooled buffers are released before throwing if no moving points have a correspondence
+    bool hasCorrespondences = true;
+    for(uint level = 0; level < mNrOfResolutionLevels && hasCorrespondences; level++) {
+        const int levelSize = getLevelSize(level, mNrOfResolutionLevels, nrOfPoints);
+        const int nrOfGroups = std::min(maxNrOfGroups, (levelSize + workGroupSize - 1) / workGroupSize);
+        Vector3f movingReference = currentTransformation*getCentroid(movingPoints.leftCols(levelSize));
+        Vector3f fixedReference = fixedCentroid;
+        correspondenceKernel.setArg(1, levelSize);
+        sumKernel.setArg(1, nrOfGroups);
+
+        float previousError = std::numeric_limits<float>::max();
+        error = std::numeric_limits<float>::max();
+        uint levelIterations = 0;
+        bool isUpdated = false;
+        while(true) {
+            // Find correspondences with the current transformation, and the error of the previous correspondences
+            cl_float16 transform;
+            for(int row = 0; row < 4; row++) {
+                for(int column = 0; column < 4; column++)
+                    transform.s[row*4 + column] = currentTransformation.matrix()(row, column);
+            }
+            cl_float4 movingReferenceArg = {{movingReference.x(), movingReference.y(), movingReference.z(), 0}};
+            cl_float4 fixedReferenceArg = {{fixedReference.x(), fixedReference.y(), fixedReference.z(), 0}};
+            correspondenceKernel.setArg(5, transform);
+            correspondenceKernel.setArg(7, movingReferenceArg);
+            correspondenceKernel.setArg(8, fixedReferenceArg);
+            queue.enqueueNDRangeKernel(correspondenceKernel, cl::NullRange,
+                    cl::NDRange(nrOfGroups*workGroupSize), cl::NDRange(workGroupSize));
+            queue.enqueueNDRangeKernel(sumKernel, cl::NullRange, cl::NDRange(workGroupSize), cl::NDRange(workGroupSize));
+            cl_float sums[nrOfSums];
+            queue.enqueueReadBuffer(sumBuffer, CL_TRUE, 0, sizeof(cl_float)*nrOfSums, sums);
+
+            if(isUpdated) {
+                error = sqrt(sums[16] / sums[17]);
+                reportInfo() << "Error: " << error << Reporter::end;
+                // To continue, change in error has to be above min error change and nr of iterations at this level less than max iterations
+                if(!(previousError-error > mMinErrorChange && levelIterations < mMaxIterations))
+                    break;
+                previousError = error;
+            }
+
+            const float nrOfCorrespondences = sums[0];
+            if(nrOfCorrespondences == 0) {
+                hasCorrespondences = false;
+                break;
+            }
+            const Vector3f movingMean(sums[1] / nrOfCorrespondences, sums[2] / nrOfCorrespondences, sums[3] / nrOfCorrespondences);
+            const Vector3f fixedMean(sums[4] / nrOfCorrespondences, sums[5] / nrOfCorrespondences, sums[6] / nrOfCorrespondences);
+            Matrix3f H;
+            for(int row = 0; row < 3; row++) {
+                for(int column = 0; column < 3; column++)
+                    H(row, column) = sums[7 + row*3 + column] - nrOfCorrespondences*movingMean[row]*fixedMean[column];
+            }
+            const Vector3f centroidMoving = movingReference + movingMean;
+            const Vector3f centroidFixed = fixedReference + fixedMean;
+
+            // Update current transformation
+            currentTransformation = getPointToPointUpdate(H, centroidMoving, centroidFixed,
+                    mTransformationType == IterativeClosestPoint::TRANSLATION)*currentTransformation;
+            iterations++;
+            levelIterations++;
+            isUpdated = true;
+
+            // The moved points are now centered close to the fixed centroid
+            movingReference = centroidFixed;
+            fixedReference = centroidFixed;
+        }
+    }
+
+    pool->release(movingBuffer);
+    pool->release(nodeBuffer);
+    pool->release(correspondenceBuffer);
+    pool->release(partialSumBuffer);
+    pool->release(sumBuffer);
+    if(!hasCorrespondences)
+        throw Exception("No moving points were within the maximum correspondence distance in IterativeClosestPoint");
+
+    mError = error;
+    mNrOfIterations = iterations;
+    return currentTransformation;
+}
+
 }
@@ -4,29 +4,78 @@
 #include "FAST/AffineTransformation.hpp"
 #include "FAST/ProcessObject.hpp"
 #include "FAST/Data/PointSet.hpp"
+#include "FAST/Data/Mesh.hpp"
 
 namespace fast {
 
+class KDTree;
+
+/**
+ * Rigid registration of a moving point set to a fixed point set or mesh.
+ *
+ * With the point to point metric on an OpenCL device, the point sets are uploaded once, and each iteration
+ * finds the correspondences and sums the centroids and correlation matrix with kernels.
+ * Only these sums are read back for the SVD. The point to plane metric runs on the host.
+ */
 class IterativeClosestPoint : public ProcessObject {
     FAST_OBJECT(IterativeClosestPoint)
     public:
         typedef enum { RIGID, TRANSLATION } TransformationType;
+        typedef enum { POINT_TO_POINT, POINT_TO_PLANE } DistanceMetric;
         void setFixedPointSetPort(ProcessObjectPort port);
         void setFixedPointSet(PointSet::pointer data);
+        /**
+         * A fixed mesh provides the normals for the point to plane metric,
+         * otherwise they are estimated from the closest fixed points.
+         */
+        void setFixedMeshPort(ProcessObjectPort port);
+        void setFixedMesh(Mesh::pointer data);
         void setMovingPointSetPort(ProcessObjectPort port);
         void setMovingPointSet(PointSet::pointer data);
         void setTransformationType(const IterativeClosestPoint::TransformationType type);
+        /**
+         * Moving points which are further away than this from their closest fixed point are not used
+         * in an iteration. Disabled by default.
+         */
+        void setMaximumCorrespondenceDistance(float distance);
+        /**
+         * Minimize the distances between the points (default), or the distances from the moving points
+         * to the tangent planes of the fixed points, which converges in fewer iterations on surfaces.
+         */
+        void setDistanceMetric(const IterativeClosestPoint::DistanceMetric metric);
+        /**
+         * Register with random subsets of the moving points first, each level using 4 times as many
+         * points as the previous one and the last level all points. A level ends when the error stops decreasing,
+         * or after at most 100 iterations. Each level has its own budget of iterations.
+         * Default is 1, i.e. all points in every iteration.
+         */
+        void setNrOfResolutionLevels(uint levels);
+        /**
+         * Total number of iterations of the last registration, over all resolution levels.
+         */
+        uint getNrOfIterations() const;
         AffineTransformation::pointer getOutputTransformation();
+        /**
+         * RMS error of the last iteration over the matched moving points. This is the distance to the closest
+         * fixed point for POINT_TO_POINT, and the distance to the tangent plane of the closest fixed point
+         * for POINT_TO_PLANE.
+         */
         float getError() const;
     private:
         IterativeClosestPoint();
         void execute();
+        Eigen::Affine3f registerOnHost(const MatrixXf& movingPoints, const MatrixXf& fixedPoints, const MatrixXf& fixedNormals, const KDTree& fixedPointTree);
+        Eigen::Affine3f registerOnDevice(const MatrixXf& movingPoints, const KDTree& fixedPointTree, OpenCLDevice::pointer device);
 
         float mMinErrorChange;
         uint mMaxIterations;
         float mError;
+        float mMaxCorrespondenceDistance;
+        uint mNrOfIterations;
+        uint mNrOfResolutionLevels;
         AffineTransformation::pointer mTransformation;
         IterativeClosestPoint::TransformationType mTransformationType;
+        IterativeClosestPoint::DistanceMetric mDistanceMetric;
 };
 
 } // end namespace fast
@@ -1,6 +1,9 @@
 #include "FAST/Testing.hpp"
 #include "FAST/Algorithms/IterativeClosestPoint/IterativeClosestPoint.hpp"
+#include "FAST/Algorithms/IterativeClosestPoint/KDTree.hpp"
 #include "FAST/Importers/VTKPointSetFileImporter.hpp"
+#include "FAST/DeviceManager.hpp"
+#include "FAST/OpenCLMemoryPool.hpp"
 
 namespace fast {
 
@@ -167,6 +170,247 @@ TEST_CASE("ICP on two point sets which are already transformed by scene graph",
     CHECK(detectedRotation.z() == Approx(rotation.z()));
 }
 
+TEST_CASE("KDTree finds the same nearest neighbors as a brute force search", "[fast][IterativeClosestPoint][KDTree]") {
+    srand(0);
+    MatrixXf points = MatrixXf::Random(3, 5000);
+    // Flatten the points along z to get unbalanced extents
+    points.row(2) *= 0.01f;
+    MatrixXf positions = MatrixXf::Random(3, 200)*1.2f;
+    const float maxDistance = 0.05f;
+
+    KDTree tree(points);
+    std::vector<int> neighbors = tree.findNearestNeighbors(positions);
+    std::vector<int> closeNeighbors = tree.findNearestNeighbors(positions, maxDistance);
+    for(int i = 0; i < positions.cols(); i++) {
+        int closest = 0;
+        float minDistance = std::numeric_limits<float>::max();
+        for(int j = 0; j < points.cols(); j++) {
+            float distance = (points.col(j) - positions.col(i)).norm();
+            if(distance < minDistance) {
+                minDistance = distance;
+                closest = j;
+            }
+        }
+        CHECK(neighbors[i] == closest);
+        CHECK(closeNeighbors[i] == (minDistance < maxDistance ? closest : -1));
+    }
+}
+
+TEST_CASE("ICP with outliers rejected by the maximum correspondence distance", "[fast][IterativeClosestPoint][icp]") {
+
+    Vector3f translation(0.01, 0, 0.01);
+
+    VTKPointSetFileImporter::pointer importerA = VTKPointSetFileImporter::New();
+    importerA->setFilename(std::string(FAST_TEST_DATA_DIR) + "Surface_LV.vtk");
+    VTKPointSetFileImporter::pointer importerB = VTKPointSetFileImporter::New();
+    importerB->setFilename(std::string(FAST_TEST_DATA_DIR) + "Surface_LV.vtk");
+
+    importerB->update();
+    PointSet::pointer B = importerB->getOutputData<PointSet>(0);
+    AffineTransformation::pointer transformation = AffineTransformation::New();
+    transformation->translate(translation);
+    B->getSceneGraphNode()->setTransformation(transformation);
+
+    // Add points far away from the surface to the moving point set
+    importerA->update();
+    PointSet::pointer A = importerA->getOutputData<PointSet>(0);
+    PointSetAccess::pointer access = A->getAccess(ACCESS_READ_WRITE);
+    MatrixXf points = access->getPointSetAsMatrix();
+    const float extent = (points.rowwise().maxCoeff() - points.rowwise().minCoeff()).maxCoeff();
+    for(int i = 0; i < 100; i++)
+        access->addPoint(points.col(i) + Vector3f(10*extent, 0, 0));
+    access->release();
+
+    IterativeClosestPoint::pointer icp = IterativeClosestPoint::New();
+    icp->setMovingPointSet(A);
+    icp->setFixedPointSetPort(importerB->getOutputPort());
+    icp->setTransformationType(IterativeClosestPoint::TRANSLATION);
+    icp->setMaximumCorrespondenceDistance(extent);
+    icp->update();
+
+    Vector3f detectedTranslation = icp->getOutputTransformation()->translation();
+    CHECK(detectedTranslation.x() == Approx(translation.x()));
+    CHECK(detectedTranslation.y() == Approx(translation.y()));
+    CHECK(detectedTranslation.z() == Approx(translation.z()));
+}
+
+// Register the LV surface to a copy of itself which is transformed with the given translation and rotation
+static IterativeClosestPoint::pointer registerTransformedSurface(Vector3f translation, Vector3f rotation,
+        IterativeClosestPoint::DistanceMetric metric, uint nrOfResolutionLevels,
+        ExecutionDevice::pointer device = DeviceManager::getInstance().getDefaultComputationDevice()) {
+    VTKPointSetFileImporter::pointer importerA = VTKPointSetFileImporter::New();
+    importerA->setFilename(std::string(FAST_TEST_DATA_DIR) + "Surface_LV.vtk");
+    VTKPointSetFileImporter::pointer importerB = VTKPointSetFileImporter::New();
+    importerB->setFilename(std::string(FAST_TEST_DATA_DIR) + "Surface_LV.vtk");
 
+    AffineTransformation::pointer transformation = AffineTransformation::New();
+    transformation->translate(translation);
+    Matrix3f R;
+    R = Eigen::AngleAxisf(rotation.x(), Vector3f::UnitX())
+    * Eigen::AngleAxisf(rotation.y(), Vector3f::UnitY())
+    * Eigen::AngleAxisf(rotation.z(), Vector3f::UnitZ());
+    transformation->rotate(R);
+    importerB->update();
+    PointSet::pointer B = importerB->getOutputData<PointSet>(0);
+    B->getSceneGraphNode()->setTransformation(transformation);
+
+    IterativeClosestPoint::pointer icp = IterativeClosestPoint::New();
+    icp->setMovingPointSetPort(importerA->getOutputPort());
+    icp->setFixedPointSetPort(importerB->getOutputPort());
+    icp->setDistanceMetric(metric);
+    icp->setNrOfResolutionLevels(nrOfResolutionLevels);
+    icp->setMainDevice(device);
+    icp->update();
+    return icp;
+}
+
+TEST_CASE("ICP with the point to plane metric", "[fast][IterativeClosestPoint][icp]") {
+    Vector3f translation(0.01, 0, 0.01);
+    Vector3f rotation(0.2, 0, 0);
+
+    IterativeClosestPoint::pointer pointToPoint = registerTransformedSurface(translation, rotation, IterativeClosestPoint::POINT_TO_POINT, 1);
+    IterativeClosestPoint::pointer icp = registerTransformedSurface(translation, rotation, IterativeClosestPoint::POINT_TO_PLANE, 1);
+
+    Vector3f detectedRotation = icp->getOutputTransformation()->getEulerAngles();
+    Vector3f detectedTranslation = icp->getOutputTransformation()->translation();
+    CHECK(detectedTranslation.x() == Approx(translation.x()).epsilon(0.001));
+    CHECK(detectedTranslation.y() == Approx(translation.y()).epsilon(0.001));
+    CHECK(detectedTranslation.z() == Approx(translation.z()).epsilon(0.001));
+    CHECK(detectedRotation.x() == Approx(rotation.x()).epsilon(0.001));
+    CHECK(detectedRotation.y() == Approx(rotation.y()).epsilon(0.001));
+    CHECK(detectedRotation.z() == Approx(rotation.z()).epsilon(0.001));
+    CHECK(icp->getNrOfIterations() <= pointToPoint->getNrOfIterations());
+}
+
+// Point on an ellipsoid with the given radii, at longitude u and colatitude v
+static Vector3f getEllipsoidPoint(Vector3f radii, float u, float v) {
+    return Vector3f(radii.x()*cos(u)*sin(v), radii.y()*sin(u)*sin(v), radii.z()*cos(v));
+}
+
+TEST_CASE("ICP with the point to plane metric to a mesh", "[fast][IterativeClosestPoint][icp]") {
+    Vector3f translation(2, -1, 1);
+    Vector3f rotation(0.1, 0.05, 0);
+    const Vector3f radii(30, 20, 15);
+
+    // Fixed ellipsoid mesh with its exact normals, as rings of vertices from pole to pole
+    const int nrOfRings = 23, nrOfVerticesPerRing = 48;
+    std::vector<Vector3f> vertices;
+    std::vector<Vector3f> normals;
+    std::vector<VectorXui> triangles;
+    for(int ring = 0; ring < nrOfRings; ring++) {
+        for(int i = 0; i < nrOfVerticesPerRing; i++) {
+            const float u = 2*M_PI*i/nrOfVerticesPerRing;
+            const float v = M_PI*(ring + 1)/(nrOfRings + 1);
+            vertices.push_back(getEllipsoidPoint(radii, u, v));
+            normals.push_back(getEllipsoidPoint(radii.cwiseInverse(), u, v).normalized());
+            if(ring + 1 < nrOfRings) {
+                const uint a = ring*nrOfVerticesPerRing + i;
+                const uint b = ring*nrOfVerticesPerRing + (i + 1) % nrOfVerticesPerRing;
+                triangles.push_back(Vector3ui(a, b, a + nrOfVerticesPerRing));
+                triangles.push_back(Vector3ui(b, b + nrOfVerticesPerRing, a + nrOfVerticesPerRing));
+            }
+        }
+    }
+    Mesh::pointer mesh = Mesh::New();
+    mesh->create(vertices, normals, triangles);
+
+    AffineTransformation::pointer transformation = AffineTransformation::New();
+    transformation->translate(translation);
+    Matrix3f R;
+    R = Eigen::AngleAxisf(rotation.x(), Vector3f::UnitX())
+    * Eigen::AngleAxisf(rotation.y(), Vector3f::UnitY())
+    * Eigen::AngleAxisf(rotation.z(), Vector3f::UnitZ());
+    transformation->rotate(R);
+    mesh->getSceneGraphNode()->setTransformation(transformation);
+
+    // Moving points on the same ellipsoid, in between the vertices of the mesh
+    PointSet::pointer points = PointSet::New();
+    PointSetAccess::pointer access = points->getAccess(ACCESS_READ_WRITE);
+    for(int j = 0; j < 15; j++) {
+        for(int i = 0; i < 30; i++)
+            access->addPoint(getEllipsoidPoint(radii, 2*M_PI*(i + 0.5f)/30, M_PI*(j + 0.5f)/15));
+    }
+    access->release();
+
+    IterativeClosestPoint::pointer icp = IterativeClosestPoint::New();
+    icp->setMovingPointSet(points);
+    icp->setFixedMesh(mesh);
+    icp->setDistanceMetric(IterativeClosestPoint::POINT_TO_PLANE);
+    icp->update();
+
+    Vector3f detectedRotation = icp->getOutputTransformation()->getEulerAngles();
+    Vector3f detectedTranslation = icp->getOutputTransformation()->translation();
+    CHECK(detectedTranslation.x() == Approx(translation.x()).epsilon(0.001));
+    CHECK(detectedTranslation.y() == Approx(translation.y()).epsilon(0.001));
+    CHECK(detectedTranslation.z() == Approx(translation.z()).epsilon(0.001));
+    CHECK(detectedRotation.x() == Approx(rotation.x()).epsilon(0.001));
+    CHECK(detectedRotation.y() == Approx(rotation.y()).epsilon(0.001));
+    CHECK(detectedRotation.z() == Approx(rotation.z()).epsilon(0.001));
+    // The moving points are not on the vertices, but close to the tangent planes
+    CHECK(icp->getError() < 0.1);
+}
+
+TEST_CASE("ICP with several resolution levels", "[fast][IterativeClosestPoint][icp]") {
+    Vector3f translation(0.01, 0, 0.01);
+    Vector3f rotation(0.5, 0, 0);
+
+    IterativeClosestPoint::pointer icp = registerTransformedSurface(translation, rotation, IterativeClosestPoint::POINT_TO_POINT, 3);
+
+    Vector3f detectedRotation = icp->getOutputTransformation()->getEulerAngles();
+    Vector3f detectedTranslation = icp->getOutputTransformation()->translation();
+    CHECK(detectedTranslation.x() == Approx(translation.x()).epsilon(0.001));
+    CHECK(detectedTranslation.y() == Approx(translation.y()).epsilon(0.001));
+    CHECK(detectedTranslation.z() == Approx(translation.z()).epsilon(0.001));
+    CHECK(detectedRotation.x() == Approx(rotation.x()).epsilon(0.001));
+    CHECK(detectedRotation.y() == Approx(rotation.y()).epsilon(0.001));
+    CHECK(detectedRotation.z() == Approx(rotation.z()).epsilon(0.001));
+}
+
+TEST_CASE("ICP on OpenCL device gives the same result as on host", "[fast][IterativeClosestPoint][icp]") {
+    Vector3f translation(0.01, 0, 0.01);
+    Vector3f rotation(0.5, 0, 0);
+
+    IterativeClosestPoint::pointer hostICP = registerTransformedSurface(translation, rotation,
+            IterativeClosestPoint::POINT_TO_POINT, 1, Host::getInstance());
+    IterativeClosestPoint::pointer deviceICP = registerTransformedSurface(translation, rotation,
+            IterativeClosestPoint::POINT_TO_POINT, 1, DeviceManager::getInstance().getDefaultComputationDevice());
+
+    Vector3f hostRotation = hostICP->getOutputTransformation()->getEulerAngles();
+    Vector3f hostTranslation = hostICP->getOutputTransformation()->translation();
+    Vector3f deviceRotation = deviceICP->getOutputTransformation()->getEulerAngles();
+    Vector3f deviceTranslation = deviceICP->getOutputTransformation()->translation();
+    for(int i = 0; i < 3; i++) {
+        CHECK(deviceTranslation[i] == Approx(hostTranslation[i]).epsilon(0.001));
+        CHECK(deviceRotation[i] == Approx(hostRotation[i]).epsilon(0.001));
+    }
+    CHECK(deviceICP->getError() == Approx(hostICP->getError()).epsilon(0.01));
+    CHECK(deviceRotation.x() == Approx(rotation.x()).epsilon(0.001));
+}
+
+TEST_CASE("ICP on OpenCL device releases its pooled buffers when no points correspond", "[fast][IterativeClosestPoint][icp]") {
+    PointSet::pointer fixedPoints = PointSet::New();
+    PointSet::pointer movingPoints = PointSet::New();
+    {
+        PointSetAccess::pointer fixedAccess = fixedPoints->getAccess(ACCESS_READ_WRITE);
+        PointSetAccess::pointer movingAccess = movingPoints->getAccess(ACCESS_READ_WRITE);
+        for(int i = 0; i < 100; i++) {
+            fixedAccess->addPoint(Vector3f(i, i % 10, 0));
+            movingAccess->addPoint(Vector3f(i, i % 10, 1000));
+        }
+    }
+
+    OpenCLDevice::pointer device = DeviceManager::getInstance().getDefaultComputationDevice();
+    OpenCLMemoryPool::pointer pool = OpenCLMemoryPool::getInstance(device);
+    pool->clear();
+
+    IterativeClosestPoint::pointer icp = IterativeClosestPoint::New();
+    icp->setFixedPointSet(fixedPoints);
+    icp->setMovingPointSet(movingPoints);
+    icp->setMaximumCorrespondenceDistance(1);
+    icp->setMainDevice(device);
+    CHECK_THROWS(icp->update());
+    // All buffers used by the registration are back in the pool
+    CHECK(pool->getNrOfFreeObjects() == 5);
+}
 
 } // end namespace fast
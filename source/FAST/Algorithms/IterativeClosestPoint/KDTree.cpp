@@ -0,0 +1,206 @@
+#include "FAST/Algorithms/IterativeClosestPoint/KDTree.hpp"
+#include "FAST/Exception.hpp"
+#include <algorithm>
+
+namespace fast {
+
+// Orders points along one axis when building the tree
+class AxisComparator {
+    public:
+        AxisComparator(const MatrixXf& points, int axis) : mPoints(points), mAxis(axis) {};
+        bool operator()(int a, int b) const {
+            return mPoints(mAxis, a) < mPoints(mAxis, b);
+        }
+    private:
+        const MatrixXf& mPoints;
+        int mAxis;
+};
+
+KDTree::KDTree(const MatrixXf& points) {
+    if(points.rows() != 3)
+        throw Exception("The points given to KDTree must be a 3xN matrix");
+
+    const int nrOfPoints = points.cols();
+    mIndices.resize(nrOfPoints);
+    for(int i = 0; i < nrOfPoints; i++)
+        mIndices[i] = i;
+
+    mNodes.resize(nrOfPoints*4);
+    build(points, 0, nrOfPoints);
+
+    for(int i = 0; i < nrOfPoints; i++) {
+        mNodes[i*4] = points(0, mIndices[i]);
+        mNodes[i*4 + 1] = points(1, mIndices[i]);
+        mNodes[i*4 + 2] = points(2, mIndices[i]);
+    }
+}
+
+void KDTree::build(const MatrixXf& points, int begin, int end) {
+    if(end <= begin)
+        return;
+    const int middle = (begin + end) / 2;
+    int axis = 0;
+    if(end - begin > 1) {
+        // Split along the axis with the largest extent
+        Vector3f minimum = points.col(mIndices[begin]);
+        Vector3f maximum = minimum;
+        for(int i = begin + 1; i < end; i++) {
+            minimum = minimum.cwiseMin(points.col(mIndices[i]));
+            maximum = maximum.cwiseMax(points.col(mIndices[i]));
+        }
+        (maximum - minimum).maxCoeff(&axis);
+        std::nth_element(mIndices.begin() + begin, mIndices.begin() + middle, mIndices.begin() + end, AxisComparator(points, axis));
+    }
+    mNodes[middle*4 + 3] = axis;
+    build(points, begin, middle);
+    build(points, middle + 1, end);
+}
+
+int KDTree::findNearestNeighbor(const Vector3f& position, float maxDistance, float* squaredDistance) const {
+    float bestDistance = maxDistance < std::numeric_limits<float>::max() ? maxDistance*maxDistance : std::numeric_limits<float>::max();
+    int best = -1;
+
+    // Ranges left to search. Far subtrees are pushed together with the squared distance to their split plane,
+    // so that they can be skipped if a closer point has been found in the mean time.
+    struct Range {
+        int begin, end;
+        float distance;
+    };
+    Range stack[64];
+    int stackSize = 1;
+    stack[0].begin = 0;
+    stack[0].end = mIndices.size();
+    stack[0].distance = 0;
+    while(stackSize > 0) {
+        stackSize--;
+        int begin = stack[stackSize].begin;
+        int end = stack[stackSize].end;
+        if(stack[stackSize].distance >= bestDistance)
+            continue;
+        while(begin < end) {
+            const int middle = (begin + end) / 2;
+            const float* node = &mNodes[middle*4];
+            const float dx = position.x() - node[0];
+            const float dy = position.y() - node[1];
+            const float dz = position.z() - node[2];
+            const float distance = dx*dx + dy*dy + dz*dz;
+            if(distance < bestDistance) {
+                bestDistance = distance;
+                best = middle;
+            }
+            const int axis = node[3];
+            const float planeDistance = position[axis] - node[axis];
+            // Continue in the subtree on the same side of the split plane as the position
+            if(planeDistance < 0) {
+                if(planeDistance*planeDistance < bestDistance) {
+                    stack[stackSize].begin = middle + 1;
+                    stack[stackSize].end = end;
+                    stack[stackSize].distance = planeDistance*planeDistance;
+                    stackSize++;
+                }
+                end = middle;
+            } else {
+                if(planeDistance*planeDistance < bestDistance) {
+                    stack[stackSize].begin = begin;
+                    stack[stackSize].end = middle;
+                    stack[stackSize].distance = planeDistance*planeDistance;
+                    stackSize++;
+                }
+                begin = middle + 1;
+            }
+        }
+    }
+
+    if(best == -1)
+        return -1;
+    if(squaredDistance != NULL)
+        *squaredDistance = bestDistance;
+    return mIndices[best];
+}
+
+std::vector<int> KDTree::findNearestNeighbors(const MatrixXf& positions, float maxDistance) const {
+    std::vector<int> result(positions.cols());
+    #pragma omp parallel for schedule(dynamic, 256)
+    for(int i = 0; i < (int)positions.cols(); i++)
+        result[i] = findNearestNeighbor(positions.col(i), maxDistance);
+    return result;
+}
+
+std::vector<int> KDTree::findKNearestNeighbors(const Vector3f& position, uint k) const {
+    k = std::min(k, getNrOfPoints());
+    // The k closest nodes found so far, sorted by squared distance
+    std::vector<std::pair<float, int> > closest;
+    closest.reserve(k + 1);
+    float worstDistance = std::numeric_limits<float>::max();
+
+    struct Range {
+        int begin, end;
+        float distance;
+    };
+    Range stack[64];
+    int stackSize = k > 0 ? 1 : 0;
+    stack[0].begin = 0;
+    stack[0].end = mIndices.size();
+    stack[0].distance = 0;
+    while(stackSize > 0) {
+        stackSize--;
+        int begin = stack[stackSize].begin;
+        int end = stack[stackSize].end;
+        if(stack[stackSize].distance >= worstDistance)
+            continue;
+        while(begin < end) {
+            const int middle = (begin + end) / 2;
+            const float* node = &mNodes[middle*4];
+            const float dx = position.x() - node[0];
+            const float dy = position.y() - node[1];
+            const float dz = position.z() - node[2];
+            const float distance = dx*dx + dy*dy + dz*dz;
+            if(distance < worstDistance) {
+                std::pair<float, int> candidate(distance, middle);
+                closest.insert(std::upper_bound(closest.begin(), closest.end(), candidate), candidate);
+                if(closest.size() > k)
+                    closest.pop_back();
+                if(closest.size() == k)
+                    worstDistance = closest.back().first;
+            }
+            const int axis = node[3];
+            const float planeDistance = position[axis] - node[axis];
+            if(planeDistance < 0) {
+                if(planeDistance*planeDistance < worstDistance) {
+                    stack[stackSize].begin = middle + 1;
+                    stack[stackSize].end = end;
+                    stack[stackSize].distance = planeDistance*planeDistance;
+                    stackSize++;
+                }
+                end = middle;
+            } else {
+                if(planeDistance*planeDistance < worstDistance) {
+                    stack[stackSize].begin = begin;
+                    stack[stackSize].end = middle;
+                    stack[stackSize].distance = planeDistance*planeDistance;
+                    stackSize++;
+                }
+                begin = middle + 1;
+            }
+        }
+    }
+
+    std::vector<int> result(closest.size());
+    for(int i = 0; i < closest.size(); i++)
+        result[i] = mIndices[closest[i].second];
+    return result;
+}
+
+uint KDTree::getNrOfPoints() const {
+    return mIndices.size();
+}
+
+const std::vector<float>& KDTree::getNodes() const {
+    return mNodes;
+}
+
+const std::vector<int>& KDTree::getIndices() const {
+    return mIndices;
+}
+
+} // end namespace fast
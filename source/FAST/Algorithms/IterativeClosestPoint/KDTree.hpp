@@ -0,0 +1,56 @@
+#ifndef KD_TREE_HPP_
+#define KD_TREE_HPP_
+
+#include "FAST/Data/DataTypes.hpp"
+#include <vector>
+#include <limits>
+
+namespace fast {
+
+/**
+ * A kd-tree for nearest neighbor queries in a set of 3D points.
+ *
+ * The tree is stored implicitly: the points are reordered so that the node of the range [begin, end)
+ * is the point in the middle of the range, and its two subtrees are the ranges to the left and right of it.
+ * Each node is split along the axis where the points of its range have the largest extent.
+ */
+class KDTree {
+    public:
+        /**
+         * Build the tree from a 3xN matrix of points
+         */
+        KDTree(const MatrixXf& points);
+        /**
+         * Index of the point closest to position, or -1 if no point is within maxDistance.
+         * If squaredDistance is given, the squared distance to the closest point is stored in it.
+         */
+        int findNearestNeighbor(const Vector3f& position, float maxDistance = std::numeric_limits<float>::max(), float* squaredDistance = NULL) const;
+        /**
+         * Indices of the points closest to each column of positions, -1 for positions with no point within maxDistance.
+         * The queries are run in parallel.
+         */
+        std::vector<int> findNearestNeighbors(const MatrixXf& positions, float maxDistance = std::numeric_limits<float>::max()) const;
+        /**
+         * Indices of the k points closest to position, sorted by increasing distance
+         */
+        std::vector<int> findKNearestNeighbors(const Vector3f& position, uint k) const;
+        uint getNrOfPoints() const;
+        /**
+         * The reordered points as x, y, z and split axis of each node
+         */
+        const std::vector<float>& getNodes() const;
+        /**
+         * Index in the original point set of each node
+         */
+        const std::vector<int>& getIndices() const;
+    private:
+        void build(const MatrixXf& points, int begin, int end);
+
+        // x, y, z and split axis of each node
+        std::vector<float> mNodes;
+        std::vector<int> mIndices;
+};
+
+} // end namespace fast
+
+#endif
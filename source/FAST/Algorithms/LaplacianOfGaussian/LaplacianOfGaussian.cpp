@@ -2,6 +2,12 @@
 #include "FAST/DeviceManager.hpp"
 #include "FAST/Data/Image.hpp"
 #include "FAST/Algorithms/LaplacianOfGaussian/LaplacianOfGaussian.hpp"
+#include "FAST/OpenCLProgram.hpp"
+#include "FAST/SlabSplitter.hpp"
+#include "FAST/WorkGroupSizeTuner.hpp"
+#include "FAST/Algorithms/SeparableConvolution.hpp"
+#include <boost/bind.hpp>
+#include <cmath>
 using namespace fast;
 
 void LaplacianOfGaussian::setMaskSize(unsigned char maskSize) {
@@ -29,82 +35,104 @@ LaplacianOfGaussian::LaplacianOfGaussian() {
     createOutputPort<Image>(0, OUTPUT_DEPENDS_ON_INPUT, 0);
     createOpenCLProgram(std::string(FAST_SOURCE_DIR) + "Algorithms/LaplacianOfGaussian/LaplacianOfGaussian2D.cl", "2D");
     createOpenCLProgram(std::string(FAST_SOURCE_DIR) + "Algorithms/LaplacianOfGaussian/LaplacianOfGaussian3D.cl", "3D");
+    setMaximumNumberOfOpenCLProgramVariants(8, "2D");
+    setMaximumNumberOfOpenCLProgramVariants(8, "3D");
     mStdDev = 1.0f;
     mMaskSize = 3;
     mIsModified = true;
     mRecreateMask = true;
-    mDimensionCLCodeCompiledFor = 0;
     mMask = NULL;
+    mMaskDimensions = 0;
 }
 
 LaplacianOfGaussian::~LaplacianOfGaussian() {
     delete[] mMask;
 }
 
-// TODO have to set mRecreateMask to true if input change dimension
+// 1D masks of the separable Laplacian of Gaussian: the normalized Gaussian, and its second derivative which
+// is made zero-sum so that the filter gives zero on constant images. The Laplacian of Gaussian is the sum over
+// all axes of the derivative mask along that axis and the Gaussian mask along the other axes, times getMaskScale.
+static void createSeparableMasks(float stdDev, uchar maskSize, std::vector<float>& gaussian, std::vector<float>& derivative) {
+    const int halfSize = (maskSize-1)/2;
+    gaussian.resize(maskSize);
+    derivative.resize(maskSize);
+    float sum = 0.0f;
+    for(int x = -halfSize; x <= halfSize; x++) {
+        gaussian[x+halfSize] = exp(-(float)(x*x)/(2.0f*stdDev*stdDev));
+        sum += gaussian[x+halfSize];
+    }
+    float derivativeSum = 0.0f;
+    for(int x = -halfSize; x <= halfSize; x++) {
+        gaussian[x+halfSize] /= sum;
+        derivative[x+halfSize] = (x*x - stdDev*stdDev)/pow(stdDev, 4.0f) * gaussian[x+halfSize];
+        derivativeSum += derivative[x+halfSize];
+    }
+    for(int i = 0; i < maskSize; i++)
+        derivative[i] -= derivativeSum*gaussian[i];
+}
+
+static float getMaskScale(float stdDev, uint dimensions) {
+    return 1.0f/pow(sqrt(2.0f*(float)M_PI)*stdDev, (float)dimensions);
+}
+
 void LaplacianOfGaussian::createMask(Image::pointer input) {
     if(!mRecreateMask)
         return;
 
-    unsigned char halfSize = (mMaskSize-1)/2;
-    float sum = 0.0f;
-    float sum2 = 0.0f;
+    delete[] mMask;
+    mMask = NULL;
+
+    std::vector<float> gaussian, derivative;
+    createSeparableMasks(mStdDev, mMaskSize, gaussian, derivative);
+    const float scale = getMaskScale(mStdDev, input->getDimensions());
 
     if(input->getDimensions() == 2) {
         mMask = new float[mMaskSize*mMaskSize];
-
-        for(int x = -halfSize; x <= halfSize; x++) {
-        for(int y = -halfSize; y <= halfSize; y++) {
-            float value = (x*x + y*y - 2.0f*mStdDev*mStdDev) * exp( -(float)(x*x + y*y)/(2.0f*mStdDev*mStdDev) ) /
-                    (2.0f*M_PI*pow(mStdDev, 6.0f)); // Matlab only uses pow(mStdDev, 4.0) for some reason
-            mMask[x+halfSize+(y+halfSize)*mMaskSize] = value;
-            sum += exp( -(float)(x*x + y*y)/(2.0f*mStdDev*mStdDev) );
+        for(int y = 0; y < mMaskSize; y++) {
+        for(int x = 0; x < mMaskSize; x++) {
+            mMask[x+y*mMaskSize] = scale*(derivative[x]*gaussian[y] + gaussian[x]*derivative[y]);
         }}
-
-        // Normalize gaussian
-        for(int i = 0; i < mMaskSize*mMaskSize; i++) {
-            mMask[i] /= sum;
-            sum2 += mMask[i];
-        }
-        // Make mask sum to zero
-        for(int i = 0; i < mMaskSize*mMaskSize; i++) {
-            mMask[i] = mMask[i] - sum2/(mMaskSize*mMaskSize);
-        }
-    } else if(input->getDimensions() == 3) {
-
+    } else {
+        mMask = new float[mMaskSize*mMaskSize*mMaskSize];
+        for(int z = 0; z < mMaskSize; z++) {
+        for(int y = 0; y < mMaskSize; y++) {
+        for(int x = 0; x < mMaskSize; x++) {
+            mMask[x+y*mMaskSize+z*mMaskSize*mMaskSize] = scale*(
+                    derivative[x]*gaussian[y]*gaussian[z] +
+                    gaussian[x]*derivative[y]*gaussian[z] +
+                    gaussian[x]*gaussian[y]*derivative[z]);
+        }}}
     }
 
-    ExecutionDevice::pointer device = getMainDevice();
-    if(!device->isHost()) {
-        OpenCLDevice::pointer clDevice = device;
-        unsigned int bufferSize = input->getDimensions() == 2 ? mMaskSize*mMaskSize : mMaskSize*mMaskSize*mMaskSize;
-        mCLMask = cl::Buffer(
-                clDevice->getContext(),
+    // The OpenCL buffers are created for each device when needed
+    mCLMasks.clear();
+    mMaskDimensions = input->getDimensions();
+    mRecreateMask = false;
+}
+
+cl::Buffer LaplacianOfGaussian::getMaskBuffer(OpenCLDevice::pointer device, uint dimensions) {
+    if(mCLMasks.count(device) == 0) {
+        unsigned int bufferSize = dimensions == 2 ? mMaskSize*mMaskSize : mMaskSize*mMaskSize*mMaskSize;
+        mCLMasks[device] = cl::Buffer(
+                device->getContext(),
                 CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
                 sizeof(float)*bufferSize,
                 mMask
         );
     }
-
-    mRecreateMask = false;
+    return mCLMasks[device];
 }
 
-void LaplacianOfGaussian::recompileOpenCLCode(Image::pointer input) {
-    // Check if there is a need to recompile OpenCL code
-    if(input->getDimensions() == mDimensionCLCodeCompiledFor &&
-            input->getDataType() == mTypeCLCodeCompiledFor)
-        return;
-
-    OpenCLDevice::pointer device = getMainDevice();
-    std::string buildOptions = "";
-    if(input->getDataType() == TYPE_FLOAT) {
-        buildOptions = "-DTYPE_FLOAT";
-    } else if(input->getDataType() == TYPE_INT8 || input->getDataType() == TYPE_INT16) {
-        buildOptions = "-DTYPE_INT";
+std::string LaplacianOfGaussian::getOpenCLBuildOptions(DataType type) {
+    std::string buildOptions = OpenCLDefines().set("MASK_SIZE", (int)mMaskSize).getBuildOptions() + " ";
+    if(type == TYPE_FLOAT) {
+        buildOptions += "-DTYPE_FLOAT";
+    } else if(type == TYPE_INT8 || type == TYPE_INT16) {
+        buildOptions += "-DTYPE_INT";
     } else {
-        buildOptions = "-DTYPE_UINT";
+        buildOptions += "-DTYPE_UINT";
     }
-    switch(input->getDataType()) {
+    switch(type) {
         case TYPE_FLOAT:
             buildOptions += " -DTYPE=float";
             break;
@@ -121,133 +149,108 @@ void LaplacianOfGaussian::recompileOpenCLCode(Image::pointer input) {
             buildOptions += " -DTYPE=ushort";
             break;
         }
-    cl::Program program;
-    if(input->getDimensions() == 2) {
-        program = getOpenCLProgram(device, "2D", buildOptions);
-    } else {
-        program = getOpenCLProgram(device, "3D", buildOptions);
-    }
-    mKernel = cl::Kernel(program, "laplacianOfGaussian");
-    mDimensionCLCodeCompiledFor = input->getDimensions();
-    mTypeCLCodeCompiledFor = input->getDataType();
+    return buildOptions;
 }
 
-template <class T>
-void executeAlgorithmOnHost(Image::pointer input, Image::pointer output, float * mask, unsigned char maskSize) {
-    // TODO: this method currently only processes the first component
-    unsigned int nrOfComponents = input->getNrOfComponents();
-    ImageAccess::pointer inputAccess = input->getImageAccess(ACCESS_READ);
-    ImageAccess::pointer outputAccess = output->getImageAccess(ACCESS_READ_WRITE);
+std::vector<std::pair<std::string, std::string> > LaplacianOfGaussian::getOpenCLProgramVariants(DataType type, uint dimensions) {
+    std::vector<std::pair<std::string, std::string> > variants;
+    variants.push_back(getOpenCLProgramVariant(dimensions == 2 ? "2D" : "3D", getOpenCLBuildOptions(type)));
+    return variants;
+}
 
-    T * inputData = (T*)inputAccess->get();
-    T * outputData = (T*)outputAccess->get();
+static void add(float* output, const float* input, std::size_t size) {
+    #pragma omp parallel for
+    for(int i = 0; i < (int)size; ++i)
+        output[i] += input[i];
+}
+
+// Separable filtering, with two passes along x and y, and two more along z in 3D
+static void executeAlgorithmOnHost(Image::pointer input, Image::pointer output, float stdDev, uchar maskSize) {
+    std::vector<float> gaussian, derivative;
+    createSeparableMasks(stdDev, maskSize, gaussian, derivative);
+    const uint width = input->getWidth();
+    const uint height = input->getHeight();
+    const uint depth = input->getDimensions() == 3 ? input->getDepth() : 1;
+    const std::size_t size = (std::size_t)width*height*depth;
+    std::vector<float> image(size), smoothed(size), derived(size), temporary(size);
+    SeparableConvolution::getFirstComponent(input, &image[0]);
+
+    // smoothed is the image smoothed along all axes so far, and derived is the sum of the terms with one derivative
+    SeparableConvolution::convolveX(&image[0], &smoothed[0], width, height*depth, gaussian);
+    SeparableConvolution::convolveX(&image[0], &derived[0], width, height*depth, derivative);
+
+    SeparableConvolution::convolveRows(&derived[0], &temporary[0], width, height, depth, false, gaussian);
+    SeparableConvolution::convolveRows(&smoothed[0], &derived[0], width, height, depth, false, derivative);
+    add(&derived[0], &temporary[0], size);
 
-    const unsigned char halfSize = (maskSize-1)/2;
-    unsigned int width = input->getWidth();
-    unsigned int height = input->getHeight();
     if(input->getDimensions() == 3) {
-        unsigned int depth = input->getDepth();
-        for(unsigned int z = 0; z < depth; z++) {
-        for(unsigned int y = 0; y < height; y++) {
-        for(unsigned int x = 0; x < width; x++) {
-
-            if(x < halfSize || x >= width-halfSize ||
-            y < halfSize || y >= height-halfSize ||
-            z < halfSize || z >= depth-halfSize) {
-                // on border only copy values
-                outputData[x*nrOfComponents+y*nrOfComponents*width+z*nrOfComponents*width*height] = inputData[x*nrOfComponents+y*nrOfComponents*width+z*nrOfComponents*width*height];
-                continue;
-            }
-
-            double sum = 0.0;
-            for(int c = -halfSize; c <= halfSize; c++) {
-            for(int b = -halfSize; b <= halfSize; b++) {
-            for(int a = -halfSize; a <= halfSize; a++) {
-                sum += mask[a+halfSize+(b+halfSize)*maskSize+(c+halfSize)*maskSize*maskSize]*
-                        inputData[(x+a)*nrOfComponents+(y+b)*nrOfComponents*width+(z+c)*nrOfComponents*width*height];
-            }}}
-            outputData[x*nrOfComponents+y*nrOfComponents*width+z*nrOfComponents*width*height] = (T)sum;
-        }}}
-    } else {
-        for(unsigned int y = halfSize; y < height-halfSize; y++) {
-        for(unsigned int x = halfSize; x < width-halfSize; x++) {
-
-            if(x < halfSize || x >= width-halfSize ||
-            y < halfSize || y >= height-halfSize) {
-                // on border only copy values
-                outputData[x*nrOfComponents+y*nrOfComponents*width] = inputData[x*nrOfComponents+y*nrOfComponents*width];
-                continue;
-            }
-
-            double sum = 0.0;
-            for(int b = -halfSize; b <= halfSize; b++) {
-            for(int a = -halfSize; a <= halfSize; a++) {
-                sum += mask[a+halfSize+(b+halfSize)*maskSize]*
-                        inputData[(x+a)*nrOfComponents+(y+b)*nrOfComponents*width];
-            }}
-            outputData[x*nrOfComponents+y*nrOfComponents*width] = (T)sum;
-        }}
+        SeparableConvolution::convolveRows(&smoothed[0], &image[0], width, height, depth, false, gaussian);
+        SeparableConvolution::convolveRows(&derived[0], &temporary[0], width, height, depth, true, gaussian);
+        SeparableConvolution::convolveRows(&image[0], &derived[0], width, height, depth, true, derivative);
+        add(&derived[0], &temporary[0], size);
     }
+
+    const float scale = getMaskScale(stdDev, input->getDimensions());
+    #pragma omp parallel for
+    for(int i = 0; i < (int)size; ++i)
+        derived[i] *= scale;
+
+    SeparableConvolution::setFirstComponent(&derived[0], output);
 }
 
 void LaplacianOfGaussian::execute() {
     Image::pointer input = getStaticInputData<Image>(0);
     Image::pointer output = getStaticOutputData<Image>(0);
 
-    if(input->getDimensions() != 2) {
-        throw Exception("The LaplacianOfGaussian filter currently only accept 2D images");
-    }
-
     // Initialize output image
     ExecutionDevice::pointer device = getMainDevice();
-    output->create(
-            input->getWidth(),
-            input->getHeight(),
-            TYPE_FLOAT,
-            1
-    );
-
-    createMask(input);
+    output->create(input->getSize(), TYPE_FLOAT, 1);
+    output->setSpacing(input->getSpacing());
 
     if(device->isHost()) {
-        switch(input->getDataType()) {
-            fastSwitchTypeMacro(executeAlgorithmOnHost<FAST_TYPE>(input, output, mMask, mMaskSize));
-        }
+        executeAlgorithmOnHost(input, output, mStdDev, mMaskSize);
     } else {
-        OpenCLDevice::pointer clDevice = device;
+        if(mMaskDimensions != input->getDimensions())
+            mRecreateMask = true;
+        createMask(input);
+        std::vector<OpenCLDevice::pointer> devices = getSplitDevices();
+        if(devices.size() > 1) {
+            SlabSplitter::execute(input, output, devices, (mMaskSize-1)/2,
+                    boost::bind(&LaplacianOfGaussian::executeOnDevice, this, _1, _2, _3));
+        } else {
+            executeOnDevice(input, output, getMainDevice());
+        }
+    }
+}
 
-        recompileOpenCLCode(input);
-        cl::NDRange globalSize;
-        OpenCLImageAccess::pointer inputAccess = input->getOpenCLImageAccess(ACCESS_READ, device);
-        if(input->getDimensions() == 2) {
-            globalSize = cl::NDRange(input->getWidth(),input->getHeight());
+void LaplacianOfGaussian::executeOnDevice(Image::pointer input, Image::pointer output, OpenCLDevice::pointer device) {
+    std::string buildOptions = getOpenCLBuildOptions(input->getDataType());
+    cl::Kernel kernel = getOpenCLKernel(device, "laplacianOfGaussian", input->getDimensions() == 2 ? "2D" : "3D", buildOptions);
+    cl::NDRange globalSize;
+    OpenCLImageAccess::pointer inputAccess = input->getOpenCLImageAccess(ACCESS_READ, device);
+    if(input->getDimensions() == 2) {
+        globalSize = cl::NDRange(input->getWidth(),input->getHeight());
+
+        OpenCLImageAccess::pointer outputAccess = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
+        kernel.setArg(0, *inputAccess->get2DImage());
+        kernel.setArg(2, *outputAccess->get2DImage());
+    } else {
+        globalSize = cl::NDRange(input->getWidth(),input->getHeight(),input->getDepth());
 
+        kernel.setArg(0, *inputAccess->get3DImage());
+        if(device->isWritingTo3DTexturesSupported()) {
             OpenCLImageAccess::pointer outputAccess = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
-            mKernel.setArg(0, *inputAccess->get2DImage());
-            mKernel.setArg(2, *outputAccess->get2DImage());
+            kernel.setArg(2, *outputAccess->get3DImage());
         } else {
-            globalSize = cl::NDRange(input->getWidth(),input->getHeight(),input->getDepth());
-
-            mKernel.setArg(0, *inputAccess->get3DImage());
-            if(clDevice->isWritingTo3DTexturesSupported()) {
-                OpenCLImageAccess::pointer outputAccess = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
-                mKernel.setArg(2, *outputAccess->get3DImage());
-            } else {
-                OpenCLBufferAccess::pointer outputAccess = output->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
-                mKernel.setArg(2, *outputAccess->get());
-            }
+            OpenCLBufferAccess::pointer outputAccess = output->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
+            kernel.setArg(2, *outputAccess->get());
         }
+    }
 
-        mKernel.setArg(1, mCLMask);
-        mKernel.setArg(3, mMaskSize);
+    kernel.setArg(1, getMaskBuffer(device, input->getDimensions()));
+    kernel.setArg(3, mMaskSize);
 
-        clDevice->getCommandQueue().enqueueNDRangeKernel(
-                mKernel,
-                cl::NullRange,
-                globalSize,
-                cl::NullRange
-        );
-    }
+    WorkGroupSizeTuner::enqueueNDRangeKernel(device, kernel, globalSize);
 }
 
 void LaplacianOfGaussian::waitToFinish() {
@@ -12,24 +12,24 @@ class LaplacianOfGaussian : public ProcessObject {
     public:
         void setMaskSize(unsigned char maskSize);
         void setStandardDeviation(float stdDev);
+        std::vector<std::pair<std::string, std::string> > getOpenCLProgramVariants(DataType type, uint dimensions);
         ~LaplacianOfGaussian();
     private:
         LaplacianOfGaussian();
         void execute();
         void waitToFinish();
+        void executeOnDevice(Image::pointer input, Image::pointer output, OpenCLDevice::pointer device);
         void createMask(Image::pointer input);
-        void recompileOpenCLCode(Image::pointer input);
+        cl::Buffer getMaskBuffer(OpenCLDevice::pointer device, uint dimensions);
+        std::string getOpenCLBuildOptions(DataType type);
 
         unsigned char mMaskSize;
         float mStdDev;
 
-        cl::Buffer mCLMask;
+        boost::unordered_map<OpenCLDevice::pointer, cl::Buffer> mCLMasks;
         float * mMask;
         bool mRecreateMask;
-
-        cl::Kernel mKernel;
-        unsigned char mDimensionCLCodeCompiledFor;
-        DataType mTypeCLCodeCompiledFor;
+        uchar mMaskDimensions; // Number of dimensions of the current mask
 
 };
 
@@ -1,10 +1,18 @@
-__constant sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP | CLK_FILTER_NEAREST;
+// Specialized variants are compiled with a constant MASK_SIZE to let the compiler unroll the mask loops
+#ifdef MASK_SIZE
+#define MASK_SIZE_ARGUMENT unusedMaskSize
+#define maskSize MASK_SIZE
+#else
+#define MASK_SIZE_ARGUMENT maskSize
+#endif
+
+__constant sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP_TO_EDGE | CLK_FILTER_NEAREST;
 
 __kernel void laplacianOfGaussian(
         __read_only image2d_t input,
         __constant float * mask,
         __write_only image2d_t output,
-        __private unsigned char maskSize
+        __private unsigned char MASK_SIZE_ARGUMENT
         ) {
 
     const int2 pos = {get_global_id(0), get_global_id(1)};
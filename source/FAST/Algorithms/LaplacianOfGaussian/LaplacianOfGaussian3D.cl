@@ -0,0 +1,53 @@
+// Specialized variants are compiled with a constant MASK_SIZE to let the compiler unroll the mask loops
+#ifdef MASK_SIZE
+#define MASK_SIZE_ARGUMENT unusedMaskSize
+#define maskSize MASK_SIZE
+#else
+#define MASK_SIZE_ARGUMENT maskSize
+#endif
+
+__constant sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP_TO_EDGE | CLK_FILTER_NEAREST;
+
+float filter(__read_only image3d_t input, __constant float * mask, const int4 pos, const unsigned char MASK_SIZE_ARGUMENT) {
+    const unsigned char halfSize = (maskSize-1)/2;
+    float sum = 0.0f;
+    for(int z = -halfSize; z <= halfSize; z++) {
+    for(int y = -halfSize; y <= halfSize; y++) {
+    for(int x = -halfSize; x <= halfSize; x++) {
+        const int4 offset = {x,y,z,0};
+        const float weight = mask[x+halfSize+(y+halfSize)*maskSize+(z+halfSize)*maskSize*maskSize];
+#ifdef TYPE_FLOAT
+        sum += weight*read_imagef(input, sampler, pos+offset).x;
+#elif TYPE_UINT
+        sum += weight*read_imageui(input, sampler, pos+offset).x;
+#else
+        sum += weight*read_imagei(input, sampler, pos+offset).x;
+#endif
+    }}}
+    return sum;
+}
+
+#ifdef cl_khr_3d_image_writes
+#pragma OPENCL EXTENSION cl_khr_3d_image_writes : enable
+__kernel void laplacianOfGaussian(
+        __read_only image3d_t input,
+        __constant float * mask,
+        __write_only image3d_t output,
+        __private unsigned char MASK_SIZE_ARGUMENT
+        ) {
+
+    const int4 pos = {get_global_id(0), get_global_id(1), get_global_id(2), 0};
+    write_imagef(output, pos, filter(input, mask, pos, maskSize));
+}
+#else
+__kernel void laplacianOfGaussian(
+        __read_only image3d_t input,
+        __constant float * mask,
+        __global float * output,
+        __private unsigned char MASK_SIZE_ARGUMENT
+        ) {
+
+    const int4 pos = {get_global_id(0), get_global_id(1), get_global_id(2), 0};
+    output[pos.x+pos.y*get_global_size(0)+pos.z*get_global_size(0)*get_global_size(1)] = filter(input, mask, pos, maskSize);
+}
+#endif
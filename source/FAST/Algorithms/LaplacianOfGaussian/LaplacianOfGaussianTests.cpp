@@ -3,6 +3,7 @@
 #include "FAST/Importers/ImageFileImporter.hpp"
 #include "FAST/Visualization/ImageRenderer/ImageRenderer.hpp"
 #include "FAST/Visualization/SimpleWindow.hpp"
+#include "FAST/DeviceManager.hpp"
 
 namespace fast {
 
@@ -26,6 +27,58 @@ TEST_CASE("Even input as mask size throws exception in LaplacianOfGaussian", "[f
     CHECK_THROWS(filter->setMaskSize(2));
 }
 
+TEST_CASE("LaplacianOfGaussian gives same result on Host and OpenCL device", "[fast][LaplacianOfGaussian][LoG]") {
+    OpenCLDevice::pointer device = DeviceManager::getInstance().getDefaultComputationDevice();
+    for(uint dimensions = 2; dimensions <= 3; ++dimensions) {
+        const uint size = 24, depth = dimensions == 3 ? size : 1;
+        // A bright ball in the center on a constant background
+        Image::pointer image = Image::New();
+        if(dimensions == 2) {
+            image->create(size, size, TYPE_UINT8, 1);
+        } else {
+            image->create(size, size, size, TYPE_UINT8, 1);
+        }
+        {
+            ImageAccess::pointer access = image->getImageAccess(ACCESS_READ_WRITE);
+            uchar* data = (uchar*)access->get();
+            for(uint z = 0; z < depth; ++z) {
+            for(uint y = 0; y < size; ++y) {
+            for(uint x = 0; x < size; ++x) {
+                int dz = dimensions == 3 ? (int)z - 12 : 0;
+                int distance2 = ((int)x-12)*((int)x-12) + ((int)y-12)*((int)y-12) + dz*dz;
+                data[x+y*size+z*size*size] = distance2 <= 9 ? 200 : 50;
+            }}}
+        }
+
+        std::vector<Image::pointer> outputs;
+        for(int i = 0; i < 2; ++i) {
+            LaplacianOfGaussian::pointer filter = LaplacianOfGaussian::New();
+            if(i == 0) {
+                filter->setMainDevice(Host::getInstance());
+            } else {
+                filter->setMainDevice(device);
+            }
+            filter->setMaskSize(7);
+            filter->setStandardDeviation(1.5);
+            filter->setInputData(image);
+            filter->update();
+            outputs.push_back(filter->getOutputData<Image>());
+        }
+
+        ImageAccess::pointer hostAccess = outputs[0]->getImageAccess(ACCESS_READ);
+        ImageAccess::pointer deviceAccess = outputs[1]->getImageAccess(ACCESS_READ);
+        float* hostData = (float*)hostAccess->get();
+        float* deviceData = (float*)deviceAccess->get();
+        for(uint i = 0; i < size*size*depth; ++i)
+            CHECK(hostData[i] == Approx(deviceData[i]).epsilon(0.001));
+
+        // Negative response in the center of the ball, and zero on the constant background
+        uint center = 12+12*size+(dimensions == 3 ? 12*size*size : 0);
+        CHECK(hostData[center] < 0);
+        CHECK(hostData[0] == Approx(0).epsilon(0.001));
+    }
+}
+
 TEST_CASE("Laplacian of Gaussian on 2D image with OpenCL", "[fast][LaplacianOfGaussian][LoG][visual]") {
     ImageFileImporter::pointer importer = ImageFileImporter::New();
     importer->setFilename(std::string(FAST_TEST_DATA_DIR) + "US/US-2D.jpg");
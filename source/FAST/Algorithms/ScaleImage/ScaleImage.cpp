@@ -1,5 +1,6 @@
 #include "ScaleImage.hpp"
 #include "FAST/Data/Image.hpp"
+#include "FAST/WorkGroupSizeTuner.hpp"
 
 namespace fast {
 
@@ -35,7 +36,6 @@ void ScaleImage::execute() {
     float maximum = input->calculateMaximumIntensity();
 
     OpenCLDevice::pointer device = getMainDevice();
-    cl::Program program = getOpenCLProgram(device);
     cl::Kernel kernel;
 
     OpenCLImageAccess::pointer inputAccess = input->getOpenCLImageAccess(ACCESS_READ, device);
@@ -43,13 +43,13 @@ void ScaleImage::execute() {
         output->create(width, height, TYPE_FLOAT, input->getNrOfComponents());
         globalSize = cl::NDRange(width, height);
         OpenCLImageAccess::pointer outputAccess = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
-        kernel = cl::Kernel(program, "scaleImage2D");
+        kernel = getOpenCLKernel(device, "scaleImage2D");
         kernel.setArg(0, *(inputAccess->get2DImage()));
         kernel.setArg(1, *(outputAccess->get2DImage()));
     } else {
         output->create(width, height, depth, TYPE_FLOAT, input->getNrOfComponents());
         globalSize = cl::NDRange(width, height, depth);
-        kernel = cl::Kernel(program, "scaleImage3D");
+        kernel = getOpenCLKernel(device, "scaleImage3D");
         kernel.setArg(0, *(inputAccess->get3DImage()));
         if(device->isWritingTo3DTexturesSupported()) {
             OpenCLImageAccess::pointer outputAccess = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
@@ -66,14 +66,7 @@ void ScaleImage::execute() {
     kernel.setArg(4, mLow);
     kernel.setArg(5, mHigh);
 
-    cl::CommandQueue queue = device->getCommandQueue();
-
-    queue.enqueueNDRangeKernel(
-            kernel,
-            cl::NullRange,
-            globalSize,
-            cl::NullRange
-    );
+    WorkGroupSizeTuner::enqueueNDRangeKernel(device, kernel, globalSize);
 }
 
 } // end namespace fast
@@ -1,8 +1,13 @@
 #include "FAST/Algorithms/SeededRegionGrowing/SeededRegionGrowing.hpp"
 #include "FAST/DeviceManager.hpp"
 #include "FAST/SceneGraph.hpp"
-#include <stack>
+#include "FAST/OpenCLMemoryPool.hpp"
+#include <algorithm>
+#include <atomic>
 #include "FAST/Data/Segmentation.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace fast {
 
@@ -35,90 +40,168 @@ void SeededRegionGrowing::addSeedPoint(Vector3ui position) {
     mSeedPoints.push_back(position);
 }
 
+void SeededRegionGrowing::setConvergenceCheckInterval(uint iterations) {
+    if(iterations == 0)
+        throw Exception("Convergence check interval of SeededRegionGrowing must be at least 1");
+    mConvergenceCheckInterval = iterations;
+}
+
+void SeededRegionGrowing::setConnectivity(uint connectivity) {
+    if(connectivity != 6 && connectivity != 18 && connectivity != 26)
+        throw Exception("Connectivity of SeededRegionGrowing must be 6, 18 or 26");
+    mConnectivity = connectivity;
+    mIsModified = true;
+}
+
 SeededRegionGrowing::SeededRegionGrowing() {
     createInputPort<Image>(0);
     createOutputPort<Segmentation>(0, OUTPUT_DEPENDS_ON_INPUT, 0);
-    mDimensionCLCodeCompiledFor = 0;
+    createOpenCLProgram(std::string(FAST_SOURCE_DIR) + "Algorithms/SeededRegionGrowing/SeededRegionGrowing2D.cl", "2D");
+    createOpenCLProgram(std::string(FAST_SOURCE_DIR) + "Algorithms/SeededRegionGrowing/SeededRegionGrowing3D.cl", "3D");
+    mConvergenceCheckInterval = 8;
+    mConnectivity = 0;
 }
 
-void SeededRegionGrowing::recompileOpenCLCode(Image::pointer input) {
-    // Check if there is a need to recompile OpenCL code
-    if(input->getDimensions() == mDimensionCLCodeCompiledFor &&
-            input->getDataType() == mTypeCLCodeCompiledFor)
-        return;
+uint SeededRegionGrowing::getConnectivity(uint dimensions) const {
+    // The default is 8 neighbors in 2D and 6 neighbors in 3D
+    if(mConnectivity == 0)
+        return dimensions == 2 ? 26 : 6;
+    return mConnectivity;
+}
 
-    OpenCLDevice::pointer device = getMainDevice();
+std::string SeededRegionGrowing::getOpenCLBuildOptions(DataType type, uint dimensions) {
     std::string buildOptions = "";
-    if(input->getDataType() == TYPE_FLOAT) {
+    if(type == TYPE_FLOAT) {
         buildOptions = "-DTYPE_FLOAT";
-    } else if(input->getDataType() == TYPE_INT8 || input->getDataType() == TYPE_INT16) {
+    } else if(type == TYPE_INT8 || type == TYPE_INT16) {
         buildOptions = "-DTYPE_INT";
     } else {
         buildOptions = "-DTYPE_UINT";
     }
-    std::string filename;
-    if(input->getDimensions() == 2) {
-        filename = "Algorithms/SeededRegionGrowing/SeededRegionGrowing2D.cl";
-    } else {
-        filename = "Algorithms/SeededRegionGrowing/SeededRegionGrowing3D.cl";
-    }
-    int programNr = device->createProgramFromSource(std::string(FAST_SOURCE_DIR) + filename, buildOptions);
-    mKernel = cl::Kernel(device->getProgram(programNr), "seededRegionGrowing");
-    mDimensionCLCodeCompiledFor = input->getDimensions();
-    mTypeCLCodeCompiledFor = input->getDataType();
+    buildOptions += " -DCONNECTIVITY=" + boost::lexical_cast<std::string>(getConnectivity(dimensions));
+    return buildOptions;
+}
+
+std::vector<std::pair<std::string, std::string> > SeededRegionGrowing::getOpenCLProgramVariants(DataType type, uint dimensions) {
+    std::vector<std::pair<std::string, std::string> > variants;
+    variants.push_back(getOpenCLProgramVariant(dimensions == 2 ? "2D" : "3D", getOpenCLBuildOptions(type, dimensions)));
+    return variants;
+}
+
+// Linear offsets to the neighbors of a voxel in an image with a border of one voxel
+static std::vector<int> getNeighborOffsets(uint connectivity, int paddedWidth, int paddedHeight, bool is3D) {
+    // 6, 18 and 26 connectivity include the neighbors which differ in at most 1, 2 and 3 coordinates
+    const int maxDistance = connectivity == 6 ? 1 : (connectivity == 18 ? 2 : 3);
+    const int zRange = is3D ? 1 : 0;
+    std::vector<int> offsets;
+    for(int c = -zRange; c <= zRange; c++) {
+    for(int b = -1; b < 2; b++) {
+    for(int a = -1; a < 2; a++) {
+        const int distance = abs(a)+abs(b)+abs(c);
+        if(distance == 0 || distance > maxDistance)
+            continue;
+        offsets.push_back(a + b*paddedWidth + c*paddedWidth*paddedHeight);
+    }}}
+    return offsets;
+}
+
+// Marks a voxel as visited, returns false if another thread already did
+static inline bool claimVoxel(std::vector<std::atomic<uint> >& visited, uint position) {
+    const uint bit = 1u << (position % 32);
+    if(visited[position / 32].load(std::memory_order_relaxed) & bit)
+        return false;
+    return (visited[position / 32].fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
 }
 
 template <class T>
 void SeededRegionGrowing::executeOnHost(T* input, Image::pointer output) {
-    ImageAccess::pointer outputAccess = output->getImageAccess(ACCESS_READ_WRITE);
-    uchar* outputData = (uchar*)outputAccess->get();
-    // initialize output to all zero
-    memset(outputData, 0, output->getWidth()*output->getHeight()*output->getDepth());
-    std::stack<Vector3ui> queue;
+    const int width = output->getWidth();
+    const int height = output->getHeight();
+    const int depth = output->getDepth();
+    const bool is3D = output->getDimensions() == 3;
+    // A border of one voxel around the image lets the neighbors be visited without bounds checks
+    const int paddedWidth = width + 2;
+    const int paddedHeight = height + 2;
+    const int zPadding = is3D ? 1 : 0;
+    const uint nrOfPaddedVoxels = paddedWidth*paddedHeight*(depth + 2*zPadding);
+    const int nrOfRows = height*depth;
+
+    // Voxels within the intensity range, the border is always outside
+    std::vector<uchar> inRange(nrOfPaddedVoxels, 0);
+    std::vector<std::atomic<uint> > visited((nrOfPaddedVoxels + 31) / 32);
+    #pragma omp parallel for
+    for(int i = 0; i < (int)visited.size(); i++)
+        visited[i].store(0, std::memory_order_relaxed);
+    #pragma omp parallel for
+    for(int i = 0; i < nrOfRows; i++) {
+        const int y = i % height;
+        const int z = i / height;
+        const T* inputRow = &input[(size_t)i*width];
+        uchar* row = &inRange[1 + (y+1)*paddedWidth + (z+zPadding)*paddedWidth*paddedHeight];
+        for(int x = 0; x < width; x++)
+            row[x] = inputRow[x] >= mMinimumIntensity && inputRow[x] <= mMaximumIntensity ? 1 : 0;
+    }
 
-    // Add seeds to queue
+    // Seeds within the intensity range are the first frontier
+    std::vector<uint> frontier;
     for(int i = 0; i < mSeedPoints.size(); i++) {
         Vector3ui pos = mSeedPoints[i];
 
         // Check if seed point is in bounds
-        if(pos.x() < 0 || pos.y() < 0 || pos.z() < 0 ||
-            pos.x() >= output->getWidth() || pos.y() >= output->getHeight() || pos.z() >= output->getDepth())
+        if(pos.x() >= width || pos.y() >= height || pos.z() >= depth)
             throw Exception("One of the seed points given to SeededRegionGrowing was out of bounds.");
 
-        queue.push(pos);
+        const uint position = (pos.x()+1) + (pos.y()+1)*paddedWidth + (pos.z()+zPadding)*paddedWidth*paddedHeight;
+        if(inRange[position] == 1 && claimVoxel(visited, position))
+            frontier.push_back(position);
     }
 
-    // Process queue
-    while(!queue.empty()) {
-        Vector3ui pos = queue.top();
-        queue.pop();
-
-        // Add neighbors to queue
-        for(int a = -1; a < 2; a++) {
-        for(int b = -1; b < 2; b++) {
-        for(int c = -1; c < 2; c++) {
-            if(abs(a)+abs(b)+abs(c) != 1) // connectivity
-                continue;
-            Vector3ui neighbor(pos.x()+a,pos.y()+b,pos.z()+c);
-            // Check for out of bounds
-            if(neighbor.x() < 0 || neighbor.y() < 0 || neighbor.z() < 0 ||
-                neighbor.x() >= output->getWidth() || neighbor.y() >= output->getHeight() || neighbor.z() >= output->getDepth())
-                continue;
-
-            // Check that voxel is not already segmented
-            if(outputData[neighbor.x()+neighbor.y()*output->getWidth()+neighbor.z()*output->getWidth()*output->getHeight()] == 1)
-                continue;
-
-            // Check condition
-            T value = input[neighbor.x()+neighbor.y()*output->getWidth()+neighbor.z()*output->getWidth()*output->getHeight()];
-            if(value >= mMinimumIntensity && value <= mMaximumIntensity) {
-                // add it to segmentation
-                outputData[neighbor.x()+neighbor.y()*output->getWidth()+neighbor.z()*output->getWidth()*output->getHeight()] = 1;
-
-                // Add to queue
-                queue.push(neighbor);
+    // Breadth first search, one level at a time. Each thread collects its part of the next frontier
+    // in its own buffer, which keeps its capacity between levels.
+    const std::vector<int> offsets = getNeighborOffsets(getConnectivity(output->getDimensions()), paddedWidth, paddedHeight, is3D);
+    const int nrOfOffsets = offsets.size();
+#ifdef _OPENMP
+    std::vector<std::vector<uint> > nextFrontiers(omp_get_max_threads());
+#else
+    std::vector<std::vector<uint> > nextFrontiers(1);
+#endif
+    while(!frontier.empty()) {
+        #pragma omp parallel
+        {
+#ifdef _OPENMP
+            std::vector<uint>& nextFrontier = nextFrontiers[omp_get_thread_num()];
+#else
+            std::vector<uint>& nextFrontier = nextFrontiers[0];
+#endif
+            nextFrontier.clear();
+            #pragma omp for schedule(dynamic, 1024)
+            for(int i = 0; i < (int)frontier.size(); i++) {
+                const uint position = frontier[i];
+                for(int j = 0; j < nrOfOffsets; j++) {
+                    const uint neighbor = position + offsets[j];
+                    if(inRange[neighbor] == 1 && claimVoxel(visited, neighbor))
+                        nextFrontier.push_back(neighbor);
+                }
             }
-        }}}
+        }
+
+        frontier.clear();
+        for(int i = 0; i < nextFrontiers.size(); i++)
+            frontier.insert(frontier.end(), nextFrontiers[i].begin(), nextFrontiers[i].end());
+    }
+
+    ImageAccess::pointer outputAccess = output->getImageAccess(ACCESS_READ_WRITE);
+    uchar* outputData = (uchar*)outputAccess->get();
+    #pragma omp parallel for
+    for(int i = 0; i < nrOfRows; i++) {
+        const int y = i % height;
+        const int z = i / height;
+        uchar* outputRow = &outputData[(size_t)i*width];
+        const uint rowStart = 1 + (y+1)*paddedWidth + (z+zPadding)*paddedWidth*paddedHeight;
+        for(int x = 0; x < width; x++) {
+            const uint position = rowStart + x;
+            outputRow[x] = (visited[position / 32].load(std::memory_order_relaxed) >> (position % 32)) & 1;
+        }
     }
 }
 
@@ -142,70 +225,125 @@ void SeededRegionGrowing::execute() {
             fastSwitchTypeMacro(executeOnHost<FAST_TYPE>((FAST_TYPE*)inputData, output));
         }
     } else {
-        OpenCLDevice::pointer device = getMainDevice();
+        executeOnDevice(input, output, getMainDevice());
+    }
+}
 
-        recompileOpenCLCode(input);
+void SeededRegionGrowing::executeOnDevice(Image::pointer input, Segmentation::pointer output, OpenCLDevice::pointer device) {
+    const uint width = input->getWidth();
+    const uint height = input->getHeight();
+    const uint depth = input->getDepth();
+    const uint nrOfVoxels = width*height*depth;
+    const std::string programName = input->getDimensions() == 2 ? "2D" : "3D";
+    const std::string buildOptions = getOpenCLBuildOptions(input->getDataType(), input->getDimensions());
 
-        ImageAccess::pointer access = output->getImageAccess(ACCESS_READ_WRITE);
-        uchar* outputData = (uchar*)access->get();
-        // Initialize to all 0s
-        memset(outputData,0,sizeof(uchar)*output->getWidth()*output->getHeight()*output->getDepth());
+    // Seed points are the first frontier
+    std::vector<cl_uint> seeds;
+    for(int i = 0; i < mSeedPoints.size(); i++) {
+        Vector3ui pos = mSeedPoints[i];
 
-        // Add sedd points
-        for(int i = 0; i < mSeedPoints.size(); i++) {
-            Vector3ui pos = mSeedPoints[i];
+        // Check if seed point is in bounds
+        if(pos.x() >= width || pos.y() >= height || pos.z() >= depth)
+            throw Exception("One of the seed points given to SeededRegionGrowing was out of bounds.");
 
-            // Check if seed point is in bounds
-            if(pos.x() < 0 || pos.y() < 0 || pos.z() < 0 ||
-                pos.x() >= output->getWidth() || pos.y() >= output->getHeight() || pos.z() >= output->getDepth())
-                throw Exception("One of the seed points given to SeededRegionGrowing was out of bounds.");
+        cl_uint linearPos = pos.x() + pos.y()*width + pos.z()*width*height;
+        if(std::find(seeds.begin(), seeds.end(), linearPos) == seeds.end())
+            seeds.push_back(linearPos);
+    }
 
-            outputData[pos.x() + pos.y()*output->getWidth() + pos.z()*output->getWidth()*output->getHeight()] = 2;
-        }
-        access->release();
-
-        cl::NDRange globalSize;
-        OpenCLImageAccess::pointer inputAccess = input->getOpenCLImageAccess(ACCESS_READ, device);
-        if(output->getDimensions() == 2) {
-            globalSize = cl::NDRange(input->getWidth(),input->getHeight());
-            mKernel.setArg(0, *inputAccess->get2DImage());
-        } else {
-            globalSize = cl::NDRange(input->getWidth(),input->getHeight(), input->getDepth());
-            mKernel.setArg(0, *inputAccess->get3DImage());
+    {
+        ImageAccess::pointer access = output->getImageAccess(ACCESS_READ_WRITE);
+        memset(access->get(), 0, sizeof(uchar)*nrOfVoxels);
+    }
+
+    OpenCLImageAccess::pointer inputAccess = input->getOpenCLImageAccess(ACCESS_READ, device);
+    cl::Image* image;
+    if(input->getDimensions() == 2) {
+        image = inputAccess->get2DImage();
+    } else {
+        image = inputAccess->get3DImage();
+    }
+    OpenCLBufferAccess::pointer outputAccess = output->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
+    cl::CommandQueue queue = device->getCommandQueue();
+    OpenCLMemoryPool::pointer pool = OpenCLMemoryPool::getInstance(device);
+
+    // The frontier buffers grow when a frontier doesn't fit
+    uint capacity = std::min(nrOfVoxels, std::max((uint)seeds.size(), 4096u));
+    cl::Buffer frontier = pool->acquireBuffer(sizeof(cl_uint)*capacity);
+    cl::Buffer nextFrontier = pool->acquireBuffer(sizeof(cl_uint)*capacity);
+    cl::Buffer counts = pool->acquireBuffer(sizeof(cl_uint)*3);
+    const uint nrOfQueuedWords = (nrOfVoxels + 31) / 32;
+    cl::Buffer queued = pool->acquireBuffer(sizeof(cl_uint)*nrOfQueuedWords);
+    cl_uint initialCounts[3] = {(cl_uint)seeds.size(), 0, 0};
+    queue.enqueueWriteBuffer(frontier, CL_FALSE, 0, sizeof(cl_uint)*seeds.size(), &seeds[0]);
+    queue.enqueueWriteBuffer(counts, CL_FALSE, 0, sizeof(cl_uint)*3, initialCounts);
+
+    cl::Kernel clearKernel = getOpenCLKernel(device, "clearQueued", programName, buildOptions);
+    clearKernel.setArg(0, queued);
+    queue.enqueueNDRangeKernel(clearKernel, cl::NullRange, cl::NDRange(nrOfQueuedWords), cl::NullRange);
+    cl::Kernel markKernel = getOpenCLKernel(device, "markFrontier", programName, buildOptions);
+    markKernel.setArg(0, queued);
+    markKernel.setArg(1, frontier);
+    queue.enqueueNDRangeKernel(markKernel, cl::NullRange, cl::NDRange(seeds.size()), cl::NullRange);
+
+    cl::Kernel growKernel = getOpenCLKernel(device, "growFrontier", programName, buildOptions);
+    growKernel.setArg(0, *image);
+    growKernel.setArg(1, *outputAccess->get());
+    growKernel.setArg(2, queued);
+    growKernel.setArg(5, counts);
+    growKernel.setArg(8, mMinimumIntensity);
+    growKernel.setArg(9, mMaximumIntensity);
+
+    const cl_uint zero = 0;
+    cl_uint current = 0;
+    while(true) {
+        // Grow several iterations before checking if the growing has stopped, without waiting for the device
+        for(uint i = 0; i < mConvergenceCheckInterval; ++i) {
+            queue.enqueueWriteBuffer(counts, CL_FALSE, sizeof(cl_uint)*(1-current), sizeof(cl_uint), &zero);
+            growKernel.setArg(3, frontier);
+            growKernel.setArg(4, nextFrontier);
+            growKernel.setArg(6, current);
+            growKernel.setArg(7, capacity);
+            queue.enqueueNDRangeKernel(growKernel, cl::NullRange, cl::NDRange(capacity), cl::NullRange);
+            std::swap(frontier, nextFrontier);
+            current = 1 - current;
         }
 
-        OpenCLBufferAccess::pointer outputAccess = output->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
-        cl::Buffer stopGrowingBuffer = cl::Buffer(
-                device->getContext(),
-                CL_MEM_READ_WRITE,
-                sizeof(char));
-        cl::CommandQueue queue = device->getCommandQueue();
-        mKernel.setArg(1, *outputAccess->get());
-        mKernel.setArg(2, stopGrowingBuffer);
-        mKernel.setArg(3, mMinimumIntensity);
-        mKernel.setArg(4, mMaximumIntensity);
-
-        bool stopGrowing = false;
-        char stopGrowingInit = 1;
-        char * stopGrowingResult = new char;
-        int iterations = 0;
-        do {
-            iterations++;
-            queue.enqueueWriteBuffer(stopGrowingBuffer, CL_TRUE, 0, sizeof(char), &stopGrowingInit);
-
-            queue.enqueueNDRangeKernel(
-                    mKernel,
-                    cl::NullRange,
-                    globalSize,
-                    cl::NullRange
-            );
-
-            queue.enqueueReadBuffer(stopGrowingBuffer, CL_TRUE, 0, sizeof(char), stopGrowingResult);
-            if(*stopGrowingResult == 1)
-                stopGrowing = true;
-        } while(!stopGrowing);
+        cl_uint result[3];
+        queue.enqueueReadBuffer(counts, CL_TRUE, 0, sizeof(cl_uint)*3, result);
+        if(result[current] == 0 && result[2] == 0)
+            break;
+
+        // Some voxels did not fit in a frontier. Grow the buffers and find all queued voxels again.
+        while(result[2] == 1) {
+            capacity = std::min(nrOfVoxels, std::max(2*capacity, (uint)result[current]));
+            pool->release(frontier);
+            pool->release(nextFrontier);
+            frontier = pool->acquireBuffer(sizeof(cl_uint)*capacity);
+            nextFrontier = pool->acquireBuffer(sizeof(cl_uint)*capacity);
+
+            queue.enqueueWriteBuffer(counts, CL_FALSE, sizeof(cl_uint)*current, sizeof(cl_uint), &zero);
+            queue.enqueueWriteBuffer(counts, CL_FALSE, sizeof(cl_uint)*2, sizeof(cl_uint), &zero);
+            cl::Kernel rebuildKernel = getOpenCLKernel(device, "rebuildFrontier", programName, buildOptions);
+            rebuildKernel.setArg(0, *image);
+            rebuildKernel.setArg(1, *outputAccess->get());
+            rebuildKernel.setArg(2, queued);
+            rebuildKernel.setArg(3, frontier);
+            rebuildKernel.setArg(4, counts);
+            rebuildKernel.setArg(5, current);
+            rebuildKernel.setArg(6, capacity);
+            rebuildKernel.setArg(7, mMinimumIntensity);
+            rebuildKernel.setArg(8, mMaximumIntensity);
+            cl::NDRange globalSize = input->getDimensions() == 2 ? cl::NDRange(width, height) : cl::NDRange(width, height, depth);
+            queue.enqueueNDRangeKernel(rebuildKernel, cl::NullRange, globalSize, cl::NullRange);
+            queue.enqueueReadBuffer(counts, CL_TRUE, 0, sizeof(cl_uint)*3, result);
+        }
     }
 
+    pool->release(frontier);
+    pool->release(nextFrontier);
+    pool->release(counts);
+    pool->release(queued);
 }
 
 void SeededRegionGrowing::waitToFinish() {
@@ -4,6 +4,7 @@
 #include "FAST/ProcessObject.hpp"
 #include "FAST/Data/Image.hpp"
 #include "FAST/Data/DataTypes.hpp"
+#include "FAST/Data/Segmentation.hpp"
 
 namespace fast {
 
@@ -14,20 +15,32 @@ class SeededRegionGrowing : public ProcessObject {
         void addSeedPoint(uint x, uint y);
         void addSeedPoint(uint x, uint y, uint z);
         void addSeedPoint(Vector3ui position);
+        /**
+         * Number of iterations between each check of whether the region has stopped growing on OpenCL devices (default 8).
+         * Each check waits for the device, while the extra iterations after the region has stopped are almost free.
+         */
+        void setConvergenceCheckInterval(uint iterations);
+        /**
+         * Neighborhood used when growing: 6 (face), 18 (face and edge) or 26 (face, edge and corner) neighbors.
+         * 2D images use the in-plane part of the neighborhood, i.e. 4 or 8 neighbors.
+         * The default is 8 neighbors for 2D images and 6 neighbors for 3D images.
+         */
+        void setConnectivity(uint connectivity);
+        std::vector<std::pair<std::string, std::string> > getOpenCLProgramVariants(DataType type, uint dimensions);
     private:
         SeededRegionGrowing();
         void execute();
         void waitToFinish();
-        void recompileOpenCLCode(Image::pointer input);
+        void executeOnDevice(Image::pointer input, Segmentation::pointer output, OpenCLDevice::pointer device);
+        std::string getOpenCLBuildOptions(DataType type, uint dimensions);
+        uint getConnectivity(uint dimensions) const;
         template <class T>
         void executeOnHost(T* input, Image::pointer output);
 
         float mMinimumIntensity, mMaximumIntensity;
         std::vector<Vector3ui> mSeedPoints;
-
-        cl::Kernel mKernel;
-        unsigned char mDimensionCLCodeCompiledFor;
-        DataType mTypeCLCodeCompiledFor;
+        uint mConvergenceCheckInterval;
+        uint mConnectivity;
 
 };
 
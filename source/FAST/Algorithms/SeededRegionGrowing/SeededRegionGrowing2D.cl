@@ -1,4 +1,3 @@
-
 __constant sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_FILTER_NEAREST | CLK_ADDRESS_NONE;
 
 #ifdef TYPE_FLOAT
@@ -9,49 +8,110 @@ __constant sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_FILTER_NEAREST
 #define READ_IMAGE(image, pos) (float)read_imageui(image, sampler, pos).x
 #endif
 
-__kernel void seededRegionGrowing(
+// 6, 18 and 26 connectivity include the neighbors which differ in at most 1, 2 and 3 coordinates.
+// In 2D this gives 4, 8 and 8 neighbors.
+#if CONNECTIVITY == 18
+#define MAX_DISTANCE 2
+#elif CONNECTIVITY == 26
+#define MAX_DISTANCE 3
+#else
+#define MAX_DISTANCE 1
+#endif
+
+// The frontier is a list of linear positions of pixels which have been queued, but not yet added to the
+// segmentation. queued has one bit per pixel, which is set when the pixel is added to a frontier, so that
+// each pixel is only added once. counts holds the sizes of the current and next frontier,
+// and a flag which is set when a frontier did not fit in its buffer.
+
+__kernel void clearQueued(__global uint* queued) {
+    queued[get_global_id(0)] = 0;
+}
+
+__kernel void markFrontier(
+        __global uint* queued,
+        __global const uint* frontier
+        ) {
+    const uint linearPos = frontier[get_global_id(0)];
+    atomic_or(&queued[linearPos / 32], 1u << (linearPos % 32));
+}
+
+__kernel void growFrontier(
         __read_only image2d_t image,
         __global char* segmentation,
-        __global char* stopGrowing,
-        __private float min,
-        __private float max
+        __global volatile uint* queued,
+        __global const uint* frontier,
+        __global uint* nextFrontier,
+        __global volatile uint* counts,
+        __private uint current,
+        __private uint capacity,
+        __private float minimum,
+        __private float maximum
         ) {
-    const int2 pos = {get_global_id(0), get_global_id(1)};
-    const uint linearPos = pos.x + pos.y*get_global_size(0);
-    
-    // Define neighborhood offsets
-    int2 offset[8] = {
-            {1,0},
-            {0,1},
-            {1,1},
-            {-1,0},
-            {0,-1},
-            {-1,-1},
-            {-1,1},
-            {1,-1}
-    };
-    
-    if(segmentation[linearPos] == 2) { // pixel is in queue
-        float intensity = READ_IMAGE(image, pos);
-        if(intensity >= min && intensity <= max) {
-            segmentation[linearPos] = 1; // add pixel to segmentation
-            // Add neighbor pixels to queue
-            for(int i = 0; i < 8; i++) {
-                // Out of bounds check
-                int2 neighborPos = pos + offset[i];
-                if(neighborPos.x < 0 || neighborPos.y < 0 || 
-                    neighborPos.x >= get_global_size(0) || neighborPos.y >= get_global_size(1))
-                    continue;
-                uint neighborLinearPos = neighborPos.x + neighborPos.y*get_global_size(0);
-                if(segmentation[neighborLinearPos] == 0) {
-                    segmentation[neighborLinearPos] = 2; // add to queue
-                    stopGrowing[0] = 0;
-                }
+    const uint id = get_global_id(0);
+    if(id >= min(counts[current], capacity))
+        return;
+
+    const int width = get_image_width(image);
+    const int height = get_image_height(image);
+    const uint linearPos = frontier[id];
+    const int2 pos = {linearPos % width, linearPos / width};
+
+    // Only seeds can be outside the intensity range, since neighbors are checked before they are queued
+    float intensity = READ_IMAGE(image, pos);
+    if(intensity < minimum || intensity > maximum)
+        return;
+    segmentation[linearPos] = 1;
+
+    for(int b = -1; b < 2; b++) {
+    for(int a = -1; a < 2; a++) {
+        if(abs(a)+abs(b) == 0 || abs(a)+abs(b) > MAX_DISTANCE)
+            continue;
+        int2 neighborPos = pos + (int2)(a,b);
+        if(neighborPos.x < 0 || neighborPos.y < 0 ||
+            neighborPos.x >= width || neighborPos.y >= height)
+            continue;
+        const uint neighborLinearPos = neighborPos.x + neighborPos.y*width;
+        const uint bit = 1u << (neighborLinearPos % 32);
+        if(queued[neighborLinearPos / 32] & bit)
+            continue;
+        intensity = READ_IMAGE(image, neighborPos);
+        if(intensity < minimum || intensity > maximum)
+            continue;
+        if((atomic_or(&queued[neighborLinearPos / 32], bit) & bit) == 0) {
+            // Pixels which don't fit are found again by rebuildFrontier
+            uint index = atomic_inc(&counts[1-current]);
+            if(index < capacity) {
+                nextFrontier[index] = neighborLinearPos;
+            } else {
+                counts[2] = 1;
             }
-        } else {
-            segmentation[linearPos] = 0; // Remove pixel
         }
+    }}
+}
+
+// Create the frontier from all queued pixels which have not been added to the segmentation
+__kernel void rebuildFrontier(
+        __read_only image2d_t image,
+        __global const char* segmentation,
+        __global const uint* queued,
+        __global uint* frontier,
+        __global volatile uint* counts,
+        __private uint current,
+        __private uint capacity,
+        __private float minimum,
+        __private float maximum
+        ) {
+    const int2 pos = {get_global_id(0), get_global_id(1)};
+    const uint linearPos = pos.x + pos.y*get_global_size(0);
+    if((queued[linearPos / 32] & (1u << (linearPos % 32))) == 0 || segmentation[linearPos] == 1)
+        return;
+    float intensity = READ_IMAGE(image, pos);
+    if(intensity < minimum || intensity > maximum)
+        return;
+    uint index = atomic_inc(&counts[current]);
+    if(index < capacity) {
+        frontier[index] = linearPos;
+    } else {
+        counts[2] = 1;
     }
 }
-        
-            
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "FAST/Visualization/SimpleWindow.hpp"
 #include "FAST/DeviceManager.hpp"
 #include "FAST/Data/Segmentation.hpp"
+#include <random>
 
 namespace fast {
 
@@ -70,6 +71,57 @@ TEST_CASE("3D Seeded region growing on OpenCL device", "[fast][SeededRegionGrowi
     }
 }
 
+// Number of pixels in the segmentation of a 2D image with the given values on the default OpenCL device
+static int segmentOnDevice(uint width, uint height, const std::vector<uchar>& values, uint convergenceCheckInterval) {
+    Image::pointer image = Image::New();
+    image->create(width, height, TYPE_UINT8, 1, Host::getInstance(), &values[0]);
+
+    SeededRegionGrowing::pointer algorithm = SeededRegionGrowing::New();
+    algorithm->setInputData(image);
+    algorithm->addSeedPoint(0, 0);
+    algorithm->setIntensityRange(1, 255);
+    algorithm->setConvergenceCheckInterval(convergenceCheckInterval);
+    algorithm->setMainDevice(DeviceManager::getInstance().getDefaultComputationDevice());
+    algorithm->update();
+    Segmentation::pointer result = algorithm->getOutputData<Segmentation>();
+
+    ImageAccess::pointer access = result->getImageAccess(ACCESS_READ);
+    uchar* data = (uchar*)access->get();
+    int sum = 0;
+    for(uint i = 0; i < width*height; i++) {
+        if(data[i] == 1)
+            sum++;
+    }
+    return sum;
+}
+
+TEST_CASE("Seeded region growing on OpenCL device with frontiers larger than the initial frontier buffers", "[fast][SeededRegionGrowing]") {
+    std::vector<uchar> values(512*512, 1);
+    CHECK(segmentOnDevice(512, 512, values, 8) == 512*512);
+    CHECK(segmentOnDevice(512, 512, values, 1) == 512*512);
+}
+
+TEST_CASE("Seeded region growing on OpenCL device along a long thin structure", "[fast][SeededRegionGrowing]") {
+    // A path going back and forth along every third row, so that the rows are not neighbors
+    const uint width = 64, height = 64;
+    std::vector<uchar> values(width*height, 0);
+    int pathLength = 0;
+    for(uint y = 0; y < height; y += 3) {
+        for(uint x = 0; x < width; ++x) {
+            values[x + y*width] = 1;
+            pathLength++;
+        }
+        // Connect to the next row at alternating ends
+        if(y + 3 < height) {
+            uint x = (y/3) % 2 == 0 ? width-1 : 0;
+            values[x + (y+1)*width] = 1;
+            values[x + (y+2)*width] = 1;
+            pathLength += 2;
+        }
+    }
+    CHECK(segmentOnDevice(width, height, values, 3) == pathLength);
+}
+
 TEST_CASE("3D Seeded region growing on Host", "[fast][SeededRegionGrowing]") {
     MetaImageImporter::pointer importer = MetaImageImporter::New();
     importer->setFilename(std::string(FAST_TEST_DATA_DIR) + "US/Ball/US-3Dt_0.mhd");
@@ -94,4 +146,112 @@ TEST_CASE("3D Seeded region growing on Host", "[fast][SeededRegionGrowing]") {
     CHECK(4106484 == sum);
 }
 
+// Number of voxels in the segmentation of a path of voxels starting in the seed. Connectivity 0 uses the default.
+static int segmentPath(Vector3ui size, const std::vector<Vector3ui>& path, uint connectivity, ExecutionDevice::pointer device) {
+    std::vector<uchar> values(size.x()*size.y()*size.z(), 0);
+    for(int i = 0; i < path.size(); i++)
+        values[path[i].x() + path[i].y()*size.x() + path[i].z()*size.x()*size.y()] = 1;
+    Image::pointer image = Image::New();
+    image->create(size, TYPE_UINT8, 1, Host::getInstance(), &values[0]);
+
+    SeededRegionGrowing::pointer algorithm = SeededRegionGrowing::New();
+    algorithm->setInputData(image);
+    algorithm->addSeedPoint(path[0]);
+    algorithm->setIntensityRange(1, 255);
+    if(connectivity > 0)
+        algorithm->setConnectivity(connectivity);
+    algorithm->setMainDevice(device);
+    algorithm->update();
+    Segmentation::pointer result = algorithm->getOutputData<Segmentation>();
+
+    ImageAccess::pointer access = result->getImageAccess(ACCESS_READ);
+    uchar* data = (uchar*)access->get();
+    int sum = 0;
+    for(uint i = 0; i < values.size(); i++) {
+        if(data[i] == 1)
+            sum++;
+    }
+    return sum;
+}
+
+TEST_CASE("Seeded region growing on Host with 6, 18 and 26 connectivity", "[fast][SeededRegionGrowing]") {
+    // Each step of the path is a face, edge and corner neighbor of the previous voxel
+    std::vector<Vector3ui> path;
+    path.push_back(Vector3ui(0,0,0));
+    path.push_back(Vector3ui(1,0,0));
+    path.push_back(Vector3ui(2,1,0));
+    path.push_back(Vector3ui(3,2,1));
+    CHECK(segmentPath(Vector3ui(8,8,8), path, 6, Host::getInstance()) == 2);
+    CHECK(segmentPath(Vector3ui(8,8,8), path, 18, Host::getInstance()) == 3);
+    CHECK(segmentPath(Vector3ui(8,8,8), path, 26, Host::getInstance()) == 4);
+
+    // 2D images use 4 neighbors for 6 connectivity, and 8 neighbors otherwise
+    path.pop_back();
+    CHECK(segmentPath(Vector3ui(8,8,1), path, 6, Host::getInstance()) == 2);
+    CHECK(segmentPath(Vector3ui(8,8,1), path, 18, Host::getInstance()) == 3);
+    CHECK(segmentPath(Vector3ui(8,8,1), path, 26, Host::getInstance()) == 3);
+}
+
+TEST_CASE("Seeded region growing uses 8 neighbors in 2D and 6 neighbors in 3D by default", "[fast][SeededRegionGrowing]") {
+    std::vector<ExecutionDevice::pointer> devices;
+    devices.push_back(Host::getInstance());
+    std::vector<OpenCLDevice::pointer> openCLDevices = DeviceManager::getInstance().getAllDevices();
+    devices.insert(devices.end(), openCLDevices.begin(), openCLDevices.end());
+
+    // Each step of the path is a face and an edge neighbor of the previous voxel
+    std::vector<Vector3ui> path;
+    path.push_back(Vector3ui(0,0,0));
+    path.push_back(Vector3ui(1,0,0));
+    path.push_back(Vector3ui(2,1,0));
+    for(int i = 0; i < devices.size(); i++) {
+        CHECK(segmentPath(Vector3ui(8,8,1), path, 0, devices[i]) == 3);
+        CHECK(segmentPath(Vector3ui(8,8,8), path, 0, devices[i]) == 2);
+    }
+}
+
+// Segmentation of a random pattern where about density/8 of the voxels are in the intensity range.
+// Which voxels are connected to the seed depends on the connectivity.
+static std::vector<uchar> segmentPattern(Vector3ui size, uint density, uint connectivity, ExecutionDevice::pointer device) {
+    std::minstd_rand random;
+    std::vector<uchar> values(size.x()*size.y()*size.z());
+    for(uint i = 0; i < values.size(); i++)
+        values[i] = random() % 8 < density ? 1 : 0;
+    values[0] = 1;
+    Image::pointer image = Image::New();
+    image->create(size, TYPE_UINT8, 1, Host::getInstance(), &values[0]);
+
+    SeededRegionGrowing::pointer algorithm = SeededRegionGrowing::New();
+    algorithm->setInputData(image);
+    algorithm->addSeedPoint(0, 0, 0);
+    algorithm->setIntensityRange(1, 255);
+    algorithm->setConnectivity(connectivity);
+    algorithm->setMainDevice(device);
+    algorithm->update();
+    Segmentation::pointer result = algorithm->getOutputData<Segmentation>();
+
+    ImageAccess::pointer access = result->getImageAccess(ACCESS_READ);
+    uchar* data = (uchar*)access->get();
+    return std::vector<uchar>(data, data + values.size());
+}
+
+TEST_CASE("Seeded region growing on OpenCL device matches Host with 6, 18 and 26 connectivity", "[fast][SeededRegionGrowing]") {
+    std::vector<OpenCLDevice::pointer> devices = DeviceManager::getInstance().getAllDevices();
+    const uint connectivities[3] = {6, 18, 26};
+    for(int i = 0; i < devices.size(); i++) {
+        INFO("Device " << devices[i]->getName());
+        for(int j = 0; j < 3; j++) {
+            INFO("Connectivity " << connectivities[j]);
+            std::vector<uchar> expected = segmentPattern(Vector3ui(24,20,16), 2, connectivities[j], Host::getInstance());
+            CHECK(segmentPattern(Vector3ui(24,20,16), 2, connectivities[j], devices[i]) == expected);
+            expected = segmentPattern(Vector3ui(64,48,1), 5, connectivities[j], Host::getInstance());
+            CHECK(segmentPattern(Vector3ui(64,48,1), 5, connectivities[j], devices[i]) == expected);
+        }
+    }
+}
+
+TEST_CASE("Seeded region growing with invalid connectivity throws exception", "[fast][SeededRegionGrowing]") {
+    SeededRegionGrowing::pointer algorithm = SeededRegionGrowing::New();
+    CHECK_THROWS(algorithm->setConnectivity(8));
+}
+
 } // end namespace fast
@@ -0,0 +1,107 @@
+#include "FAST/Algorithms/SeparableConvolution.hpp"
+#include <algorithm>
+#include <limits>
+#include <cstring>
+#include <cmath>
+
+namespace fast {
+
+void SeparableConvolution::convolveX(const float* input, float* output, uint width, uint nrOfRows, const std::vector<float>& mask) {
+    const int halfSize = (mask.size()-1)/2;
+    #pragma omp parallel
+    {
+        // The row is padded with its edge values, so that the inner loop has no branches and can be vectorized
+        std::vector<float> paddedRow(width + 2*halfSize);
+        #pragma omp for
+        for(int row = 0; row < (int)nrOfRows; ++row) {
+            const float* inputRow = input + (std::size_t)row*width;
+            float* outputRow = output + (std::size_t)row*width;
+            for(int i = 0; i < halfSize; ++i) {
+                paddedRow[i] = inputRow[0];
+                paddedRow[halfSize+width+i] = inputRow[width-1];
+            }
+            memcpy(&paddedRow[halfSize], inputRow, width*sizeof(float));
+
+            for(uint x = 0; x < width; ++x)
+                outputRow[x] = 0.0f;
+            for(uint k = 0; k < mask.size(); ++k) {
+                const float weight = mask[k];
+                const float* source = &paddedRow[k];
+                for(uint x = 0; x < width; ++x)
+                    outputRow[x] += weight*source[x];
+            }
+        }
+    }
+}
+
+// Each output row is a weighted sum of whole input rows. The rows are processed in blocks,
+// so that the output block stays in the cache while the input rows are added.
+void SeparableConvolution::convolveRows(const float* input, float* output, uint width, uint height, uint depth, bool alongZ, const std::vector<float>& mask) {
+    const int halfSize = (mask.size()-1)/2;
+    const uint blockSize = 1024;
+    const int length = alongZ ? depth : height;
+    const int rowStride = alongZ ? height : 1; // Number of rows between neighbours along the axis
+    #pragma omp parallel for
+    for(int row = 0; row < (int)(height*depth); ++row) {
+        const int position = alongZ ? row / height : row % height;
+        float* outputRow = output + (std::size_t)row*width;
+        for(uint blockStart = 0; blockStart < width; blockStart += blockSize) {
+            const uint blockEnd = std::min(blockStart + blockSize, width);
+            for(uint x = blockStart; x < blockEnd; ++x)
+                outputRow[x] = 0.0f;
+            for(int k = -halfSize; k <= halfSize; ++k) {
+                const int neighbour = std::min(std::max(position + k, 0), length - 1);
+                const float weight = mask[k+halfSize];
+                const float* inputRow = input + (std::size_t)(row + (neighbour - position)*rowStride)*width;
+                for(uint x = blockStart; x < blockEnd; ++x)
+                    outputRow[x] += weight*inputRow[x];
+            }
+        }
+    }
+}
+
+template <class T>
+static void getFirstComponentTemplate(Image::pointer image, float* output) {
+    ImageAccess::pointer access = image->getImageAccess(ACCESS_READ);
+    const T* data = (const T*)access->get();
+    const uint nrOfComponents = image->getNrOfComponents();
+    const int size = image->getWidth()*image->getHeight()*image->getDepth();
+    #pragma omp parallel for
+    for(int i = 0; i < size; ++i)
+        output[i] = data[(std::size_t)i*nrOfComponents];
+}
+
+template <class T>
+static void setFirstComponentTemplate(const float* input, Image::pointer image) {
+    ImageAccess::pointer access = image->getImageAccess(ACCESS_READ_WRITE);
+    T* data = (T*)access->get();
+    const uint nrOfComponents = image->getNrOfComponents();
+    const int size = image->getWidth()*image->getHeight()*image->getDepth();
+    const bool isInteger = std::numeric_limits<T>::is_integer;
+    // Integer values are saturated to the range of the type, as the OpenCL image writes do
+    const double minimum = std::numeric_limits<T>::lowest();
+    const double maximum = std::numeric_limits<T>::max();
+    #pragma omp parallel for
+    for(int i = 0; i < size; ++i) {
+        if(isInteger) {
+            const double value = std::round((double)input[i]);
+            data[(std::size_t)i*nrOfComponents] = (T)(value > maximum ? maximum : (value > minimum ? value : minimum));
+        } else {
+            data[(std::size_t)i*nrOfComponents] = (T)input[i];
+        }
+    }
+}
+
+void SeparableConvolution::getFirstComponent(Image::pointer image, float* output) {
+    switch(image->getDataType()) {
+        fastSwitchTypeMacro(getFirstComponentTemplate<FAST_TYPE>(image, output));
+    }
+}
+
+void SeparableConvolution::setFirstComponent(const float* input, Image::pointer image) {
+    switch(image->getDataType()) {
+        fastSwitchTypeMacro(setFirstComponentTemplate<FAST_TYPE>(input, image));
+    }
+}
+
+} // end namespace fast
@@ -0,0 +1,36 @@
+#ifndef SEPARABLE_CONVOLUTION_HPP_
+#define SEPARABLE_CONVOLUTION_HPP_
+
+#include "FAST/Data/Image.hpp"
+#include <vector>
+
+namespace fast {
+
+/**
+ * Separable filtering of images on the host, used by the host paths of the smoothing filters.
+ * The images are filtered as float buffers with x as the fastest axis, and each pass is parallelized with OpenMP.
+ * The borders are clamped as CLK_ADDRESS_CLAMP_TO_EDGE does in the OpenCL kernels.
+ */
+class SeparableConvolution {
+    public:
+        /**
+         * Convolve each of the nrOfRows rows along x with mask
+         */
+        static void convolveX(const float* input, float* output, uint width, uint nrOfRows, const std::vector<float>& mask);
+        /**
+         * Convolve along y, or along z if alongZ is true, with mask
+         */
+        static void convolveRows(const float* input, float* output, uint width, uint height, uint depth, bool alongZ, const std::vector<float>& mask);
+        /**
+         * Copy the first component of image to a float buffer
+         */
+        static void getFirstComponent(Image::pointer image, float* output);
+        /**
+         * Write a float buffer to the first component of image, rounding and saturating integer types as the OpenCL kernels do
+         */
+        static void setFirstComponent(const float* input, Image::pointer image);
+};
+
+} // end namespace fast
+
+#endif
@@ -2,6 +2,7 @@
 #include "FAST/DeviceManager.hpp"
 #include "FAST/Utility.hpp"
 #include "FAST/SceneGraph.hpp"
+#include "FAST/OpenCLMemoryPool.hpp"
 #include "FAST/Data/Segmentation.hpp"
 
 namespace fast {
@@ -9,6 +10,7 @@ namespace fast {
 Skeletonization::Skeletonization() {
     createInputPort<Segmentation>(0);
     createOutputPort<Image>(0, OUTPUT_DEPENDS_ON_INPUT, 0);
+    createOpenCLProgram(std::string(FAST_SOURCE_DIR) + "Algorithms/Skeletonization/Skeletonization2D.cl");
 }
 
 void Skeletonization::execute() {
@@ -24,19 +26,15 @@ void Skeletonization::execute() {
 
     OpenCLDevice::pointer device = getMainDevice();
 
-    // Create kernel
-    int programNr = device->createProgramFromSource(std::string(FAST_SOURCE_DIR) + "Algorithms/Skeletonization/Skeletonization2D.cl");
-    cl::Program program = device->getProgram(programNr);
-    cl::Kernel kernel1(program, "thinningStep1");
-    cl::Kernel kernel2(program, "thinningStep2");
+    // Get kernels
+    cl::Kernel kernel1 = getOpenCLKernel(device, "thinningStep1");
+    cl::Kernel kernel2 = getOpenCLKernel(device, "thinningStep2");
 
     // Create buffer for check if stop
-    cl::Buffer stopGrowingBuffer = cl::Buffer(
-            device->getContext(),
-            CL_MEM_READ_WRITE,
-            sizeof(char));
+    OpenCLMemoryPool::pointer pool = OpenCLMemoryPool::getInstance(device);
+    cl::Buffer stopGrowingBuffer = pool->acquireBuffer(sizeof(char));
 
-    cl::Image2D image2(device->getContext(), CL_MEM_READ_WRITE, cl::ImageFormat(CL_R, CL_UNSIGNED_INT8), output->getWidth(), output->getHeight());
+    cl::Image2D image2 = pool->acquireImage2D(cl::ImageFormat(CL_R, CL_UNSIGNED_INT8), output->getWidth(), output->getHeight());
     OpenCLImageAccess::pointer access = input->getOpenCLImageAccess(ACCESS_READ, device);
     cl::Image2D* image = access->get2DImage();
     OpenCLImageAccess::pointer access2 = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
@@ -88,6 +86,8 @@ void Skeletonization::execute() {
         if(*stopGrowingResult == 1)
             stopGrowing = true;
     } while(!stopGrowing);
+    pool->release(stopGrowingBuffer);
+    pool->release(image2);
     reportInfo() << "SKELETONIZATION EXECUTED" << Reporter::end;
 }
 
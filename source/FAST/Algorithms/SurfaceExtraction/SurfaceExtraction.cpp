@@ -5,6 +5,7 @@
 #include "FAST/Utility.hpp"
 #include "FAST/Utility.hpp"
 #include "FAST/SceneGraph.hpp"
+#include "FAST/OpenCLMemoryPool.hpp"
 
 namespace fast {
 
@@ -34,14 +35,15 @@ void SurfaceExtraction::execute() {
 #else
     const bool writingTo3DTextures = device->isWritingTo3DTexturesSupported();
 #endif
-    cl::Context clContext = device->getContext();
     const unsigned int SIZE = getRequiredHistogramPyramidSize(input);
 
-    if(mHPSize != SIZE) {
-        // Have to recreate the HP
-        images.clear();
-        buffers.clear();
-        std::string programName = "";
+    if(mHPSize != SIZE || !(mHPDevice == device)) {
+        // Have to recreate the HP. The old HP is given back to the memory pool, so that it
+        // can be reused if the size changes back.
+        releaseHistogramPyramid();
+        mHPDevice = device;
+        OpenCLMemoryPool::pointer pool = OpenCLMemoryPool::getInstance(device);
+        mProgramName = "";
         // create new HP (if necessary)
         if(writingTo3DTextures) {
             // Create images for the HistogramPyramid
@@ -56,51 +58,49 @@ void SurfaceExtraction::execute() {
             }
 
             // Make the two first buffers use INT8
-            images.push_back(cl::Image3D(clContext, CL_MEM_READ_WRITE, cl::ImageFormat(order2, CL_UNSIGNED_INT8), input->getWidth(), input->getHeight(), input->getDepth()));
+            images.push_back(pool->acquireImage3D(cl::ImageFormat(order2, CL_UNSIGNED_INT8), input->getWidth(), input->getHeight(), input->getDepth()));
             bufferSize /= 2;
-            images.push_back(cl::Image3D(clContext, CL_MEM_READ_WRITE, cl::ImageFormat(order1, CL_UNSIGNED_INT8), bufferSize, bufferSize, bufferSize));
+            images.push_back(pool->acquireImage3D(cl::ImageFormat(order1, CL_UNSIGNED_INT8), bufferSize, bufferSize, bufferSize));
             bufferSize /= 2;
             // And the third, fourth and fifth INT16
-            images.push_back(cl::Image3D(clContext, CL_MEM_READ_WRITE, cl::ImageFormat(order1, CL_UNSIGNED_INT16), bufferSize, bufferSize, bufferSize));
+            images.push_back(pool->acquireImage3D(cl::ImageFormat(order1, CL_UNSIGNED_INT16), bufferSize, bufferSize, bufferSize));
             bufferSize /= 2;
-            images.push_back(cl::Image3D(clContext, CL_MEM_READ_WRITE, cl::ImageFormat(order1, CL_UNSIGNED_INT16), bufferSize, bufferSize, bufferSize));
+            images.push_back(pool->acquireImage3D(cl::ImageFormat(order1, CL_UNSIGNED_INT16), bufferSize, bufferSize, bufferSize));
             bufferSize /= 2;
-            images.push_back(cl::Image3D(clContext, CL_MEM_READ_WRITE, cl::ImageFormat(order1, CL_UNSIGNED_INT16), bufferSize, bufferSize, bufferSize));
+            images.push_back(pool->acquireImage3D(cl::ImageFormat(order1, CL_UNSIGNED_INT16), bufferSize, bufferSize, bufferSize));
             bufferSize /= 2;
             // The rest will use INT32
             for(int i = 5; i < (log2((float)SIZE)); i ++) {
                 if(bufferSize == 1)
                     bufferSize = 2; // Image cant be 1x1x1
-                images.push_back(cl::Image3D(clContext, CL_MEM_READ_WRITE, cl::ImageFormat(order1, CL_UNSIGNED_INT32), bufferSize, bufferSize, bufferSize));
+                images.push_back(pool->acquireImage3D(cl::ImageFormat(order1, CL_UNSIGNED_INT32), bufferSize, bufferSize, bufferSize));
                 bufferSize /= 2;
             }
 
             // If writing to 3D textures is not supported we to create buffers to write to
        } else {
-            programName = "no_3d_write";
+            mProgramName = "no_3d_write";
             int bufferSize = SIZE*SIZE*SIZE;
-            buffers.push_back(cl::Buffer(clContext, CL_MEM_READ_WRITE, sizeof(char)*bufferSize));
+            buffers.push_back(pool->acquireBuffer(sizeof(char)*bufferSize));
             bufferSize /= 8;
-            buffers.push_back(cl::Buffer(clContext, CL_MEM_READ_WRITE, sizeof(char)*bufferSize));
+            buffers.push_back(pool->acquireBuffer(sizeof(char)*bufferSize));
             bufferSize /= 8;
-            buffers.push_back(cl::Buffer(clContext, CL_MEM_READ_WRITE, sizeof(short)*bufferSize));
+            buffers.push_back(pool->acquireBuffer(sizeof(short)*bufferSize));
             bufferSize /= 8;
-            buffers.push_back(cl::Buffer(clContext, CL_MEM_READ_WRITE, sizeof(short)*bufferSize));
+            buffers.push_back(pool->acquireBuffer(sizeof(short)*bufferSize));
             bufferSize /= 8;
-            buffers.push_back(cl::Buffer(clContext, CL_MEM_READ_WRITE, sizeof(short)*bufferSize));
+            buffers.push_back(pool->acquireBuffer(sizeof(short)*bufferSize));
             bufferSize /= 8;
             for(int i = 5; i < (log2((float)SIZE)); i ++) {
-                buffers.push_back(cl::Buffer(clContext, CL_MEM_READ_WRITE, sizeof(int)*bufferSize));
+                buffers.push_back(pool->acquireBuffer(sizeof(int)*bufferSize));
                 bufferSize /= 8;
             }
 
-            cubeIndexesBuffer = cl::Buffer(clContext, CL_MEM_WRITE_ONLY, sizeof(char)*SIZE*SIZE*SIZE);
-            cubeIndexesImage = cl::Image3D(clContext, CL_MEM_READ_ONLY,
-                    cl::ImageFormat(CL_R, CL_UNSIGNED_INT8),
-                    SIZE, SIZE, SIZE);
+            cubeIndexesBuffer = pool->acquireBuffer(sizeof(char)*SIZE*SIZE*SIZE, CL_MEM_WRITE_ONLY);
+            cubeIndexesImage = pool->acquireImage3D(cl::ImageFormat(CL_R, CL_UNSIGNED_INT8), SIZE, SIZE, SIZE, CL_MEM_READ_ONLY);
         }
 
-        // Compile program
+        // Build options of the program, which is compiled when the kernels are first used
         mHPSize = SIZE;
         char buffer[255];
         sprintf(buffer,"-DSIZE=%d", SIZE);
@@ -115,12 +115,12 @@ void SurfaceExtraction::execute() {
 #if defined(__APPLE__) || defined(__MACOSX)
         buildOptions += " -DMAC_HACK";
 #endif
-        program = getOpenCLProgram(device, programName, buildOptions);
+        mBuildOptions = buildOptions;
     }
 
-    cl::Kernel constructHPLevelKernel(program, "constructHPLevel");
-    cl::Kernel classifyCubesKernel(program, "classifyCubes");
-    cl::Kernel traverseHPKernel(program, "traverseHP");
+    cl::Kernel constructHPLevelKernel = getOpenCLKernel(device, "constructHPLevel", mProgramName, mBuildOptions);
+    cl::Kernel classifyCubesKernel = getOpenCLKernel(device, "classifyCubes", mProgramName, mBuildOptions);
+    cl::Kernel traverseHPKernel = getOpenCLKernel(device, "traverseHP", mProgramName, mBuildOptions);
 
     OpenCLImageAccess::pointer access = input->getOpenCLImageAccess(ACCESS_READ, device);
     cl::Image3D* clImage = access->get3DImage();
@@ -190,10 +190,10 @@ void SurfaceExtraction::execute() {
             );
         }
     } else {
-        cl::Kernel constructHPLevelCharCharKernel(program, "constructHPLevelCharChar");
-        cl::Kernel constructHPLevelCharShortKernel(program, "constructHPLevelCharShort");
-        cl::Kernel constructHPLevelShortShortKernel(program, "constructHPLevelShortShort");
-        cl::Kernel constructHPLevelShortIntKernel(program, "constructHPLevelShortInt");
+        cl::Kernel constructHPLevelCharCharKernel = getOpenCLKernel(device, "constructHPLevelCharChar", mProgramName, mBuildOptions);
+        cl::Kernel constructHPLevelCharShortKernel = getOpenCLKernel(device, "constructHPLevelCharShort", mProgramName, mBuildOptions);
+        cl::Kernel constructHPLevelShortShortKernel = getOpenCLKernel(device, "constructHPLevelShortShort", mProgramName, mBuildOptions);
+        cl::Kernel constructHPLevelShortIntKernel = getOpenCLKernel(device, "constructHPLevelShortInt", mProgramName, mBuildOptions);
 
         // Run base to first level
         constructHPLevelCharCharKernel.setArg(0, buffers[0]);
@@ -361,6 +361,28 @@ void SurfaceExtraction::execute() {
 
 }
 
+void SurfaceExtraction::releaseHistogramPyramid() {
+    if(!mHPDevice.isValid())
+        return;
+    OpenCLMemoryPool::pointer pool = OpenCLMemoryPool::getInstance(mHPDevice);
+    for(uint i = 0; i < images.size(); ++i)
+        pool->release(images[i]);
+    for(uint i = 0; i < buffers.size(); ++i)
+        pool->release(buffers[i]);
+    if(buffers.size() > 0) {
+        pool->release(cubeIndexesBuffer);
+        pool->release(cubeIndexesImage);
+    }
+    images.clear();
+    buffers.clear();
+    cubeIndexesBuffer = cl::Buffer();
+    cubeIndexesImage = cl::Image3D();
+}
+
+SurfaceExtraction::~SurfaceExtraction() {
+    releaseHistogramPyramid();
+}
+
 SurfaceExtraction::SurfaceExtraction() {
     mThreshold = 0.0f;
     mHPSize = 0;
@@ -9,14 +9,19 @@ class SurfaceExtraction : public ProcessObject {
     FAST_OBJECT(SurfaceExtraction)
     public:
         void setThreshold(float threshold);
+        ~SurfaceExtraction();
     private:
         SurfaceExtraction();
         void execute();
+        void releaseHistogramPyramid();
 
         float mThreshold;
         unsigned int mHPSize;
-        cl::Program program;
-        // HP
+        // Name and build options of the OpenCL program compiled for the current HP size
+        std::string mProgramName;
+        std::string mBuildOptions;
+        // HP, borrowed from the memory pool of mHPDevice
+        OpenCLDevice::pointer mHPDevice;
         std::vector<cl::Image3D> images;
         std::vector<cl::Buffer> buffers;
 
@@ -19,6 +19,7 @@ InverseGradientSegmentation::InverseGradientSegmentation() {
     createInputPort<Segmentation>(0);
     createInputPort<Image>(1);
     createOutputPort<Segmentation>(0, OUTPUT_DEPENDS_ON_INPUT, 0);
+    createOpenCLProgram(std::string(FAST_SOURCE_DIR) + "Algorithms/TubeSegmentationAndCenterlineExtraction/InverseGradientSegmentation.cl");
 }
 
 void InverseGradientSegmentation::execute() {
@@ -38,13 +39,9 @@ void InverseGradientSegmentation::execute() {
     OpenCLImageAccess::pointer segmentationOutputAccess = segmentation->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
     cl::Image3D* volume = segmentationOutputAccess->get3DImage();
 
-    device->createProgramFromSourceWithName("inverseGradientSegmentation",
-            std::string(FAST_SOURCE_DIR) + "Algorithms/TubeSegmentationAndCenterlineExtraction/InverseGradientSegmentation.cl");
-    cl::Program program(device->getProgram("inverseGradientSegmentation"));
 
-
-    cl::Kernel initGrowKernel(program, "initGrowing");
-    cl::Kernel growKernel(program, "grow");
+    cl::Kernel initGrowKernel = getOpenCLKernel(device, "initGrowing");
+    cl::Kernel growKernel = getOpenCLKernel(device, "grow");
 
     cl::CommandQueue queue = device->getCommandQueue();
 
@@ -168,8 +165,8 @@ void InverseGradientSegmentation::execute() {
 
     std::cout << "segmentation result grown in " << i << " iterations" << std::endl;
 
-    cl::Kernel dilateKernel(program, "dilate");
-    cl::Kernel erodeKernel(program, "erode");
+    cl::Kernel dilateKernel = getOpenCLKernel(device, "dilate");
+    cl::Kernel erodeKernel = getOpenCLKernel(device, "erode");
 
     if(!device->isWritingTo3DTexturesSupported()) {
         OpenCLBufferAccess::pointer segmentation2Access = segmentation2->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
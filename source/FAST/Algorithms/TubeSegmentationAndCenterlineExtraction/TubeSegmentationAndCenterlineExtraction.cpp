@@ -375,11 +375,10 @@ Image::pointer TubeSegmentationAndCenterlineExtraction::createGradients(Image::p
     bool no3Dwrite = !device->isWritingTo3DTexturesSupported();
 
     OpenCLImageAccess::pointer access = image->getOpenCLImageAccess(ACCESS_READ, device);
-    cl::Program program =  getOpenCLProgram(device, "", "-DVECTORS_16BIT");
-    reportInfo() << "build gradients program" << Reporter::end;
 
     // Convert to float 0-1
-    cl::Kernel toFloatKernel(program, "toFloat");
+    cl::Kernel toFloatKernel = getOpenCLKernel(device, "toFloat", "", "-DVECTORS_16BIT");
+    reportInfo() << "build gradients program" << Reporter::end;
 
     float minimumIntensity;
     if(mMinimumIntensity > -std::numeric_limits<float>::max()) {
@@ -415,7 +414,7 @@ Image::pointer TubeSegmentationAndCenterlineExtraction::createGradients(Image::p
     );
 
     // Create vector field
-    cl::Kernel vectorFieldKernel(program, "createVectorField");
+    cl::Kernel vectorFieldKernel = getOpenCLKernel(device, "createVectorField", "", "-DVECTORS_16BIT");
 
     // Use sensitivity to set vector maximum (fmax)
     float vectorMaximum = (1 - mSensitivity);
@@ -465,8 +464,7 @@ void TubeSegmentationAndCenterlineExtraction::runTubeDetectionFilter(Image::poin
     OpenCLBufferAccess::pointer radiusAccess = radius->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
     OpenCLImageAccess::pointer vectorFieldAccess = vectorField->getOpenCLImageAccess(ACCESS_READ, device);
 
-    cl::Program program = getOpenCLProgram(device);
-    cl::Kernel kernel(program, "circleFittingTDF");
+    cl::Kernel kernel = getOpenCLKernel(device, "circleFittingTDF");
 
     kernel.setArg(0, *(vectorFieldAccess->get3DImage()));
     kernel.setArg(1, *(TDFAccess->get()));
@@ -505,9 +503,8 @@ void TubeSegmentationAndCenterlineExtraction::runNonCircularTubeDetectionFilter(
     OpenCLImageAccess::pointer vectorFieldAccess = vectorField->getOpenCLImageAccess(ACCESS_READ, device);
 
     reportInfo() << "building TDF program" << Reporter::end;
-    cl::Program program = getOpenCLProgram(device);
+    cl::Kernel kernel = getOpenCLKernel(device, "nonCircularTDF");
     reportInfo() << "build TDF program" << Reporter::end;
-    cl::Kernel kernel(program, "nonCircularTDF");
 
     kernel.setArg(0, *(vectorFieldAccess->get3DImage()));
     kernel.setArg(1, *(TDFAccess->get()));
@@ -9,11 +9,16 @@ cl::Buffer* OpenCLBufferAccess::get() const {
     return mBuffer;
 }
 
-OpenCLBufferAccess::OpenCLBufferAccess(cl::Buffer* buffer,  SharedPointer<Image> image) {
+const std::vector<cl::Event>& OpenCLBufferAccess::getEvents() const {
+    return mEvents;
+}
+
+OpenCLBufferAccess::OpenCLBufferAccess(cl::Buffer* buffer,  SharedPointer<Image> image, std::vector<cl::Event> events) {
     // Copy the image
     mBuffer = new cl::Buffer(*buffer);
     mIsDeleted = false;
     mImage = image;
+    mEvents = events;
 }
 
 void OpenCLBufferAccess::release() {
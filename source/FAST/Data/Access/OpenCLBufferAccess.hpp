@@ -12,7 +12,13 @@ class OpenCLDevice;
 class OpenCLBufferAccess {
     public:
         cl::Buffer* get() const;
-        OpenCLBufferAccess(cl::Buffer* buffer,  SharedPointer<Image> image);
+        /**
+         * Events of the transfers which must complete before the buffer can be used.
+         * The command queue of the device already waits for these, but commands
+         * enqueued in other queues must wait for them explicitly.
+         */
+        const std::vector<cl::Event>& getEvents() const;
+        OpenCLBufferAccess(cl::Buffer* buffer,  SharedPointer<Image> image, std::vector<cl::Event> events = std::vector<cl::Event>());
         void release();
         ~OpenCLBufferAccess();
 		typedef UniquePointer<OpenCLBufferAccess> pointer;
@@ -22,6 +28,7 @@ class OpenCLBufferAccess {
         cl::Buffer* mBuffer;
         bool mIsDeleted;
         SharedPointer<Image> mImage;
+        std::vector<cl::Event> mEvents;
 };
 
 } // end namespace fast
@@ -15,19 +15,24 @@ cl::Image3D* OpenCLImageAccess::get3DImage() const {
     return (cl::Image3D*)mImage;
 }
 
+const std::vector<cl::Event>& OpenCLImageAccess::getEvents() const {
+    return mEvents;
+}
 
-OpenCLImageAccess::OpenCLImageAccess(cl::Image3D* image, SharedPointer<Image> object) {
+OpenCLImageAccess::OpenCLImageAccess(cl::Image3D* image, SharedPointer<Image> object, std::vector<cl::Event> events) {
     // Copy the image
     mImage = new cl::Image3D(*image);
     mIsDeleted = false;
     mImageObject = object;
+    mEvents = events;
 }
 
-OpenCLImageAccess::OpenCLImageAccess(cl::Image2D* image, SharedPointer<Image> object) {
+OpenCLImageAccess::OpenCLImageAccess(cl::Image2D* image, SharedPointer<Image> object, std::vector<cl::Event> events) {
     // Copy the image
     mImage = new cl::Image2D(*image);
     mIsDeleted = false;
     mImageObject = object;
+    mEvents = events;
 }
 
 void OpenCLImageAccess::release() {
@@ -15,8 +15,14 @@ class OpenCLImageAccess {
         cl::Image* get() const;
         cl::Image2D* get2DImage() const;
         cl::Image3D* get3DImage() const;
-        OpenCLImageAccess(cl::Image2D* image, SharedPointer<Image> object);
-        OpenCLImageAccess(cl::Image3D* image, SharedPointer<Image> object);
+        /**
+         * Events of the transfers which must complete before the image can be used.
+         * The command queue of the device already waits for these, but commands
+         * enqueued in other queues must wait for them explicitly.
+         */
+        const std::vector<cl::Event>& getEvents() const;
+        OpenCLImageAccess(cl::Image2D* image, SharedPointer<Image> object, std::vector<cl::Event> events = std::vector<cl::Event>());
+        OpenCLImageAccess(cl::Image3D* image, SharedPointer<Image> object, std::vector<cl::Event> events = std::vector<cl::Event>());
         void release();
         ~OpenCLImageAccess();
 		typedef UniquePointer<OpenCLImageAccess> pointer;
@@ -26,6 +32,7 @@ class OpenCLImageAccess {
         cl::Image* mImage;
         bool mIsDeleted;
         SharedPointer<Image> mImageObject;
+        std::vector<cl::Event> mEvents;
 
 };
 
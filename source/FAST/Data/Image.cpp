@@ -73,6 +73,37 @@ void * adaptImageDataToHostData(void * data, cl_channel_order order, unsigned in
 
 
 
+void Image::addTransferFromHostEvent(OpenCLDevice::pointer device, cl::Event event) {
+    std::vector<cl::Event> events(1, event);
+    // Kernels using the data must wait for the upload
+    device->enqueueWaitForEvents(device->getCommandQueue(), events);
+    device->getTransferQueue().flush();
+    mCLTransferEvents[device] = events;
+
+    // The host data must not be changed or deleted before the upload is finished
+    std::vector<cl::Event> pendingEvents;
+    for(int i = 0; i < mHostDataTransferEvents.size(); i++) {
+        if(mHostDataTransferEvents[i].getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>() != CL_COMPLETE)
+            pendingEvents.push_back(mHostDataTransferEvents[i]);
+    }
+    pendingEvents.push_back(event);
+    mHostDataTransferEvents = pendingEvents;
+}
+
+void Image::waitForTransfersFromHost() {
+    if(mHostDataTransferEvents.size() > 0) {
+        cl::Event::waitForEvents(mHostDataTransferEvents);
+        mHostDataTransferEvents.clear();
+    }
+}
+
+void Image::waitForCommandQueue(OpenCLDevice::pointer device) {
+    // Make the transfer queue wait for the kernels which are enqueued in the command queue
+    std::vector<cl::Event> events(1, device->enqueueMarker(device->getCommandQueue()));
+    device->getCommandQueue().flush();
+    device->enqueueWaitForEvents(device->getTransferQueue(), events);
+}
+
 void Image::transferCLImageFromHost(OpenCLDevice::pointer device) {
 
     // Special treatment for images with 3 components because an OpenCL image can only have 1, 2 or 4 channels
@@ -80,24 +111,31 @@ void Image::transferCLImageFromHost(OpenCLDevice::pointer device) {
     cl::ImageFormat format = getOpenCLImageFormat(device, mDimensions == 2 ? CL_MEM_OBJECT_IMAGE2D : CL_MEM_OBJECT_IMAGE3D, mType, mComponents);
     if(format.image_channel_order == CL_RGBA && mComponents != 4) {
         void * tempData = adaptDataToImage(mHostData, CL_RGBA, mWidth*mHeight*mDepth, mType, mComponents);
-        device->getCommandQueue().enqueueWriteImage(*(cl::Image*)mCLImages[device],
+        // The padded data is deleted right away, thus this transfer is blocking
+        cl::Event event;
+        device->getTransferQueue().enqueueWriteImage(*(cl::Image*)mCLImages[device],
         CL_TRUE, createOrigoRegion(), createRegion(mWidth, mHeight, mDepth), 0,
-                0, tempData);
+                0, tempData, NULL, &event);
         deleteArray(tempData, mType);
+        addTransferFromHostEvent(device, event);
     } else {
-        device->getCommandQueue().enqueueWriteImage(*(cl::Image*)mCLImages[device],
-        CL_TRUE, createOrigoRegion(), createRegion(mWidth, mHeight, mDepth), 0,
-                0, mHostData);
+        cl::Event event;
+        device->getTransferQueue().enqueueWriteImage(*(cl::Image*)mCLImages[device],
+        CL_FALSE, createOrigoRegion(), createRegion(mWidth, mHeight, mDepth), 0,
+                0, mHostData, NULL, &event);
+        addTransferFromHostEvent(device, event);
     }
 }
 
 void Image::transferCLImageToHost(OpenCLDevice::pointer device) {
+    waitForTransfersFromHost();
+    waitForCommandQueue(device);
     // Special treatment for images with 3 components because an OpenCL image can only have 1, 2 or 4 channels
 	// And if the device does not support 1 or 2 channels
     cl::ImageFormat format = getOpenCLImageFormat(device, mDimensions == 2 ? CL_MEM_OBJECT_IMAGE2D : CL_MEM_OBJECT_IMAGE3D, mType, mComponents);
     if(format.image_channel_order == CL_RGBA && mComponents != 4) {
         void * tempData = allocateDataArray(mWidth*mHeight*mDepth,mType,4);
-        device->getCommandQueue().enqueueReadImage(*(cl::Image*)mCLImages[device],
+        device->getTransferQueue().enqueueReadImage(*(cl::Image*)mCLImages[device],
         CL_TRUE, createOrigoRegion(), createRegion(mWidth, mHeight, mDepth), 0,
                 0, tempData);
         mHostData = adaptImageDataToHostData(tempData,CL_RGBA, mWidth*mHeight*mDepth,mType,mComponents);
@@ -108,7 +146,7 @@ void Image::transferCLImageToHost(OpenCLDevice::pointer device) {
             mHostData = allocateDataArray(mWidth*mHeight*mDepth,mType,mComponents);
 			mHostHasData = true;
         }
-        device->getCommandQueue().enqueueReadImage(*(cl::Image*)mCLImages[device],
+        device->getTransferQueue().enqueueReadImage(*(cl::Image*)mCLImages[device],
         CL_TRUE, createOrigoRegion(), createRegion(mWidth, mHeight, mDepth), 0,
                 0, mHostData);
     }
@@ -126,7 +164,8 @@ void Image::updateOpenCLImageData(OpenCLDevice::pointer device) {
         return;
 
     bool updated = false;
-    if (mCLImagesIsUpToDate.count(device) == 0) {
+    bool isNewImage = mCLImagesIsUpToDate.count(device) == 0;
+    if (isNewImage) {
         // Data is not on device, create it
         cl::Image * newImage;
         if(mDimensions == 2) {
@@ -148,6 +187,9 @@ void Image::updateOpenCLImageData(OpenCLDevice::pointer device) {
 
     // Find which data is up to date
 	if (!mCLImagesIsUpToDate[device]) {
+		// Kernels enqueued earlier may still use the existing image
+		if (!isNewImage)
+			waitForCommandQueue(device);
 		if (mHostDataIsUpToDate) {
 			// Transfer host data to this device
 			transferCLImageFromHost(device);
@@ -212,7 +254,7 @@ OpenCLBufferAccess::pointer Image::getOpenCLBufferAccess(
     }
 
     // Now it is guaranteed that the data is on the device and that it is up to date
-	OpenCLBufferAccess::pointer accessObject(new OpenCLBufferAccess(mCLBuffers[device],  mPtr.lock()));
+	OpenCLBufferAccess::pointer accessObject(new OpenCLBufferAccess(mCLBuffers[device],  mPtr.lock(), mCLTransferEvents[device]));
 	return std::move(accessObject);
 }
 
@@ -234,7 +276,8 @@ void Image::updateOpenCLBufferData(OpenCLDevice::pointer device) {
         return;
 
     bool updated = false;
-    if (mCLBuffers.count(device) == 0) {
+    bool isNewBuffer = mCLBuffers.count(device) == 0;
+    if (isNewBuffer) {
         // Data is not on device, create it
         unsigned int bufferSize = getBufferSize();
         cl::Buffer * newBuffer = new cl::Buffer(device->getContext(),
@@ -252,6 +295,9 @@ void Image::updateOpenCLBufferData(OpenCLDevice::pointer device) {
 
     // Find which data is up to date
     if(!mCLBuffersIsUpToDate[device]) {
+        // Kernels enqueued earlier may still use the existing buffer
+        if (!isNewBuffer)
+            waitForCommandQueue(device);
         if (mHostDataIsUpToDate) {
             // Transfer host data to this device
             transferCLBufferFromHost(device);
@@ -292,18 +338,22 @@ void Image::updateOpenCLBufferData(OpenCLDevice::pointer device) {
 
 void Image::transferCLBufferFromHost(OpenCLDevice::pointer device) {
     unsigned int bufferSize = getBufferSize();
-    device->getCommandQueue().enqueueWriteBuffer(*mCLBuffers[device],
-        CL_TRUE, 0, bufferSize, mHostData);
+    cl::Event event;
+    device->getTransferQueue().enqueueWriteBuffer(*mCLBuffers[device],
+        CL_FALSE, 0, bufferSize, mHostData, NULL, &event);
+    addTransferFromHostEvent(device, event);
 }
 
 void Image::transferCLBufferToHost(OpenCLDevice::pointer device) {
+    waitForTransfersFromHost();
+    waitForCommandQueue(device);
 	if (!mHostHasData) {
 		// Must allocate memory for host data
 		mHostData = allocateDataArray(mWidth*mHeight*mDepth, mType, mComponents);
 		mHostHasData = true;
 	}
     unsigned int bufferSize = getBufferSize();
-    device->getCommandQueue().enqueueReadBuffer(*mCLBuffers[device],
+    device->getTransferQueue().enqueueReadBuffer(*mCLBuffers[device],
         CL_TRUE, 0, bufferSize, mHostData);
 }
 
@@ -394,10 +444,10 @@ OpenCLImageAccess::pointer Image::getOpenCLImageAccess(
 
     // Now it is guaranteed that the data is on the device and that it is up to date
     if(mDimensions == 2) {
-        OpenCLImageAccess::pointer accessObject(new OpenCLImageAccess((cl::Image2D*)mCLImages[device], mPtr.lock()));
+        OpenCLImageAccess::pointer accessObject(new OpenCLImageAccess((cl::Image2D*)mCLImages[device], mPtr.lock(), mCLTransferEvents[device]));
         return accessObject;
     } else {
-        OpenCLImageAccess::pointer accessObject(new OpenCLImageAccess((cl::Image3D*)mCLImages[device], mPtr.lock()));
+        OpenCLImageAccess::pointer accessObject(new OpenCLImageAccess((cl::Image3D*)mCLImages[device], mPtr.lock(), mCLTransferEvents[device]));
         return accessObject;
     }
 }
@@ -426,6 +476,8 @@ ImageAccess::pointer Image::getImageAccess(accessType type) {
     }
     updateHostData();
     if(type == ACCESS_READ_WRITE) {
+        // Uploads of the host data may still be in progress
+        waitForTransfersFromHost();
         setAllDataToOutOfDate();
         updateModifiedTimestamp();
     }
@@ -611,6 +663,7 @@ bool Image::isInitialized() const {
 void Image::free(ExecutionDevice::pointer device) {
     // Delete data on a specific device
     if(device->isHost()) {
+        waitForTransfersFromHost();
         deleteArray(mHostData, mType);
         mHostHasData = false;
     } else {
@@ -623,6 +676,7 @@ void Image::free(ExecutionDevice::pointer device) {
         delete mCLBuffers[clDevice];
         mCLBuffers.erase(clDevice);
         mCLBuffersIsUpToDate.erase(clDevice);
+        mCLTransferEvents.erase(clDevice);
     }
 }
 
@@ -642,6 +696,7 @@ void Image::freeAll() {
     }
     mCLBuffers.clear();
     mCLBuffersIsUpToDate.clear();
+    mCLTransferEvents.clear();
 
     // Delete host data
     if(mHostHasData) {
@@ -967,6 +1022,15 @@ void Image::findDeviceWithUptodateData(ExecutionDevice::pointer* device, bool* i
     }
 }
 
+bool Image::isDataUpToDate(ExecutionDevice::pointer device) const {
+    if(device->isHost())
+        return mHostHasData && mHostDataIsUpToDate;
+
+    OpenCLDevice::pointer clDevice = device;
+    return (mCLImagesIsUpToDate.count(clDevice) > 0 && mCLImagesIsUpToDate.at(clDevice)) ||
+            (mCLBuffersIsUpToDate.count(clDevice) > 0 && mCLBuffersIsUpToDate.at(clDevice));
+}
+
 Image::pointer Image::crop(VectorXui offset, VectorXui size) {
     Image::pointer newImage = Image::New();
 
@@ -50,6 +50,11 @@ class Image : public SpatialDataObject {
         // Create a new image which is a cropped version of this image
         Image::pointer crop(VectorXui offset, VectorXui size);
 
+        /**
+         * Returns true if the data on the device is up to date, so that it can be accessed there without a transfer
+         */
+        bool isDataUpToDate(ExecutionDevice::pointer device) const;
+
         // Override
         BoundingBox getTransformedBoundingBox() const;
 
@@ -86,6 +91,14 @@ class Image : public SpatialDataObject {
 
         void updateHostData();
 
+        // Uploads are done asynchronously in the transfer queue of the device. These are
+        // the events of the last upload to each device, and of uploads which read the host data.
+        boost::unordered_map<OpenCLDevice::pointer, std::vector<cl::Event> > mCLTransferEvents;
+        std::vector<cl::Event> mHostDataTransferEvents;
+        void addTransferFromHostEvent(OpenCLDevice::pointer device, cl::Event event);
+        void waitForTransfersFromHost();
+        void waitForCommandQueue(OpenCLDevice::pointer device);
+
         bool hasAnyData();
 
         uint getBufferSize() const;
@@ -1480,4 +1480,29 @@ TEST_CASE("createFromImage on 3D image", "[fast][image]") {
     }
 }
 
+TEST_CASE("Access to OpenCL image uploaded from host carries the event of the upload", "[fast][image]") {
+    DeviceManager& deviceManager = DeviceManager::getInstance();
+    OpenCLDevice::pointer device = deviceManager.getOneOpenCLDevice();
+
+    unsigned int width = 256;
+    unsigned int height = 512;
+    DataType type = TYPE_FLOAT;
+    void* data = allocateRandomData(width*height, type);
 
+    Image::pointer image = Image::New();
+    image->create(width, height, type, 1, Host::getInstance(), data);
+
+    OpenCLImageAccess::pointer access = image->getOpenCLImageAccess(ACCESS_READ, device);
+    REQUIRE(access->getEvents().size() == 1);
+
+    // Read the image in the transfer queue, which has to wait for the upload explicitly
+    float* result = new float[width*height];
+    device->enqueueWaitForEvents(device->getTransferQueue(), access->getEvents());
+    device->getTransferQueue().enqueueReadImage(*access->get2DImage(), CL_TRUE,
+            createOrigoRegion(), createRegion(width, height, 1), 0, 0, result);
+    CHECK(memcmp(result, data, width*height*sizeof(float)) == 0);
+    access->release();
+
+    delete[] result;
+    deleteArray(data, type);
+}
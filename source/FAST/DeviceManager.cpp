@@ -1,7 +1,14 @@
 #include "FAST/DeviceManager.hpp"
 #include "FAST/Exception.hpp"
 #include "FAST/Visualization/Window.hpp"
+#include "FAST/ProcessObject.hpp"
+#include "FAST/OpenCLProgram.hpp"
+#include "FAST/Utility.hpp"
 #include <QApplication>
+#include <set>
+#include <stdexcept>
+#include <boost/thread.hpp>
+#include <boost/chrono.hpp>
 
 #if defined(__APPLE__) || defined(__MACOSX)
 #include <OpenCL/cl_gl.h>
@@ -710,4 +717,115 @@ Context DeviceManager::createContext(cl::Device device, unsigned long * OpenGLCo
 }
 */
 
+class OpenCLProgramVariant {
+    public:
+        OpenCLDevice::pointer device;
+        std::string filename;
+        std::string buildOptions;
+        double runtime;
+        std::string error;
+};
+
+inline void addProcessObjectAndParents(ProcessObject::pointer processObject, std::vector<ProcessObject::pointer>& processObjects, std::set<ProcessObject*>& visited) {
+    if(visited.count(processObject.getPtr().get()) > 0)
+        return;
+    visited.insert(processObject.getPtr().get());
+    processObjects.push_back(processObject);
+    for(uint i = 0; processObject->inputPortExists(i); ++i) {
+        try {
+            ProcessObjectPort port = processObject->getInputPort(i);
+            addProcessObjectAndParents(port.getProcessObject(), processObjects, visited);
+        } catch(std::out_of_range &e) {
+            // Input port is not connected
+        }
+    }
+}
+
+// Run by each warm-up thread. Builds variants until there are none left.
+void buildOpenCLProgramVariants(std::vector<OpenCLProgramVariant>* variants, uint* next, boost::mutex* mutex) {
+    while(true) {
+        uint i;
+        {
+            boost::lock_guard<boost::mutex> lock(*mutex);
+            if(*next >= variants->size())
+                return;
+            i = *next;
+            ++(*next);
+        }
+        OpenCLProgramVariant& variant = (*variants)[i];
+        OpenCLProgram::pointer program = OpenCLProgram::New();
+        program->setSourceFilename(variant.filename);
+        boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+        try {
+            program->build(variant.device, variant.buildOptions);
+        } catch(cl::Error &e) {
+            variant.error = getCLErrorString(e.err());
+        } catch(Exception &e) {
+            variant.error = e.what();
+        }
+        variant.runtime = boost::chrono::duration<double, boost::milli>(boost::chrono::steady_clock::now() - start).count();
+    }
+}
+
+void DeviceManager::warmUpOpenCLPrograms(
+        std::vector<ProcessObject::pointer> processObjects,
+        std::vector<DataType> types,
+        std::vector<uint> dimensions,
+        uint nrOfThreads) {
+    std::vector<ProcessObject::pointer> allProcessObjects;
+    std::set<ProcessObject*> visited;
+    for(uint i = 0; i < processObjects.size(); ++i)
+        addProcessObjectAndParents(processObjects[i], allProcessObjects, visited);
+
+    // Collect the unique program variants of all process objects
+    std::vector<OpenCLProgramVariant> variants;
+    std::set<std::string> keys;
+    for(uint i = 0; i < allProcessObjects.size(); ++i) {
+        ExecutionDevice::pointer device = allProcessObjects[i]->getMainDevice();
+        if(device->isHost())
+            continue;
+        for(uint j = 0; j < types.size(); ++j) {
+        for(uint k = 0; k < dimensions.size(); ++k) {
+            std::vector<std::pair<std::string, std::string> > programs = allProcessObjects[i]->getOpenCLProgramVariants(types[j], dimensions[k]);
+            for(uint l = 0; l < programs.size(); ++l) {
+                std::stringstream key;
+                key << device.getPtr().get() << programs[l].first << "|" << programs[l].second;
+                if(keys.count(key.str()) > 0)
+                    continue;
+                keys.insert(key.str());
+                OpenCLProgramVariant variant;
+                variant.device = device;
+                variant.filename = programs[l].first;
+                variant.buildOptions = programs[l].second;
+                variant.runtime = 0;
+                variants.push_back(variant);
+            }
+        }}
+    }
+
+    if(nrOfThreads == 0)
+        nrOfThreads = std::max(boost::thread::hardware_concurrency(), 1u);
+    nrOfThreads = std::min(nrOfThreads, (uint)variants.size());
+
+    boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+    uint next = 0;
+    boost::mutex mutex;
+    boost::thread_group threads;
+    for(uint i = 0; i < nrOfThreads; ++i)
+        threads.create_thread(boost::bind(&buildOpenCLProgramVariants, &variants, &next, &mutex));
+    threads.join_all();
+    double runtime = boost::chrono::duration<double, boost::milli>(boost::chrono::steady_clock::now() - start).count();
+
+    for(uint i = 0; i < variants.size(); ++i) {
+        const OpenCLProgramVariant& variant = variants[i];
+        if(variant.error != "") {
+            reportWarning() << "Failed to build OpenCL program " << variant.filename << " " << variant.buildOptions << " during warm-up: " << variant.error << reportEnd();
+            continue;
+        }
+        reportInfo() << "Built OpenCL program " << variant.filename << " " << variant.buildOptions << " in " << variant.runtime << " ms" << reportEnd();
+        variant.device->getRunTimeMeasurementManager()->getTiming("build " + variant.filename + " " + variant.buildOptions)->addSample(variant.runtime);
+    }
+    reportInfo() << "Built " << variants.size() << " OpenCL programs with " << nrOfThreads << " threads in " << runtime << " ms" << reportEnd();
+}
+
 } // end namespace fast
@@ -4,9 +4,12 @@
 #include "FAST/ExecutionDevice.hpp"
 #include <vector>
 #include "FAST/DeviceCriteria.hpp"
+#include "FAST/Data/DataTypes.hpp"
 
 namespace fast {
 
+class ProcessObject;
+
 typedef std::pair<cl::Platform, std::vector<cl::Device> > PlatformDevices;
 
 /**
@@ -44,6 +47,18 @@ class DeviceManager : public Object {
         std::vector<cl::Device> getDevicesForBestPlatform(
                 const DeviceCriteria& deviceCriteria,
                std::vector<PlatformDevices> &platformDevices);
+        /**
+         * Compile the OpenCL programs used by the given process objects, and all process objects
+         * upstream of them, for input images of the given data types and dimensions. This avoids a
+         * stall in the first frame of a pipeline. The programs are compiled on the main device of
+         * their process object by nrOfThreads threads in parallel (0 means one per CPU core).
+         * The compile time of each program is reported and added to the runtime measurements of the device.
+         */
+        void warmUpOpenCLPrograms(
+                std::vector<SharedPointer<ProcessObject> > processObjects,
+                std::vector<DataType> types,
+                std::vector<uint> dimensions,
+                uint nrOfThreads = 0);
     private:
 	unsigned long * mGLContext;
         DeviceManager();
@@ -0,0 +1,64 @@
+#include "FAST/DevicePlacement.hpp"
+#include "FAST/Exception.hpp"
+
+namespace fast {
+
+DevicePlacement::DevicePlacement() {
+}
+
+void DevicePlacement::setCandidates(std::vector<ExecutionDevice::pointer> candidates) {
+    if(candidates.size() == 0)
+        throw Exception("At least one candidate device must be given to DevicePlacement");
+    mCandidates = candidates;
+    reset();
+}
+
+std::vector<ExecutionDevice::pointer> DevicePlacement::getCandidates() const {
+    return mCandidates;
+}
+
+void DevicePlacement::reset() {
+    mProfiles.clear();
+}
+
+bool DevicePlacement::isDecided(std::string key) const {
+    if(mProfiles.count(key) == 0)
+        return false;
+    return mProfiles.at(key).nrOfExecutions >= 2*mCandidates.size();
+}
+
+ExecutionDevice::pointer DevicePlacement::getDevice(std::string key) {
+    if(mCandidates.size() == 0)
+        throw Exception("No candidate devices were given to DevicePlacement");
+
+    if(mProfiles.count(key) == 0) {
+        Profile profile;
+        profile.nrOfExecutions = 0;
+        profile.runtimes = std::vector<double>(mCandidates.size(), 0);
+        profile.bestCandidate = 0;
+        mProfiles[key] = profile;
+    }
+    Profile& profile = mProfiles[key];
+
+    if(isDecided(key))
+        return mCandidates[profile.bestCandidate];
+
+    return mCandidates[profile.nrOfExecutions / 2];
+}
+
+void DevicePlacement::addMeasurement(std::string key, double runtime, double transferRuntime) {
+    if(mProfiles.count(key) == 0 || isDecided(key))
+        return;
+
+    Profile& profile = mProfiles[key];
+    unsigned int candidate = profile.nrOfExecutions / 2;
+    // The first execution on each candidate is a warm-up which also includes compiling the kernels
+    if(profile.nrOfExecutions % 2 == 1) {
+        profile.runtimes[candidate] = runtime + transferRuntime;
+        if(profile.runtimes[candidate] < profile.runtimes[profile.bestCandidate])
+            profile.bestCandidate = candidate;
+    }
+    profile.nrOfExecutions++;
+}
+
+} // end namespace fast
@@ -0,0 +1,52 @@
+#ifndef DEVICE_PLACEMENT_HPP_
+#define DEVICE_PLACEMENT_HPP_
+
+#include "FAST/ExecutionDevice.hpp"
+#include <boost/unordered_map.hpp>
+#include <vector>
+
+namespace fast {
+
+/**
+ * Chooses the cheapest of several candidate devices for a process object from measured runtimes.
+ *
+ * The runtimes are measured on the real executions of the process object: for each new
+ * input signature (see ProcessObject::getDevicePlacementKey), every candidate is used for
+ * one warm-up execution and one measured execution. After that, the candidate with the
+ * lowest measured runtime, including the transfer of the inputs to the device, is used until
+ * an input with another signature arrives.
+ */
+class DevicePlacement {
+    public:
+        DevicePlacement();
+        void setCandidates(std::vector<ExecutionDevice::pointer> candidates);
+        std::vector<ExecutionDevice::pointer> getCandidates() const;
+        /**
+         * Get the device to use for the next execution with input signature key
+         */
+        ExecutionDevice::pointer getDevice(std::string key);
+        /**
+         * Give the runtime in milliseconds of an execution on the device returned by getDevice, and the time
+         * used to transfer its input data to the device. The cost of a candidate is the sum of the two.
+         * Runtimes of warm-up executions and executions after the device is decided are ignored.
+         */
+        void addMeasurement(std::string key, double runtime, double transferRuntime = 0);
+        /**
+         * Returns true if all candidates have been measured for the key
+         */
+        bool isDecided(std::string key) const;
+        void reset();
+    private:
+        struct Profile {
+            unsigned int nrOfExecutions; // Number of executions during profiling, two for each candidate
+            std::vector<double> runtimes; // Execution and transfer time of each candidate
+            unsigned int bestCandidate;
+        };
+
+        std::vector<ExecutionDevice::pointer> mCandidates;
+        boost::unordered_map<std::string, Profile> mProfiles;
+};
+
+} // end namespace fast
+
+#endif
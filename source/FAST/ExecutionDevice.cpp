@@ -1,11 +1,12 @@
 #include "FAST/ExecutionDevice.hpp"
 #include "FAST/RuntimeMeasurementManager.hpp"
 #include "FAST/Utility.hpp"
+#include "FAST/KernelSourceRegistry.hpp"
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/lock_guard.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/filesystem.hpp>
-#include <boost/functional/hash.hpp>
+#include <boost/shared_ptr.hpp>
 #include <fstream>
 
 #if defined(__APPLE__) || defined(__MACOSX)
@@ -19,14 +20,10 @@
 #endif
 #endif
 
-// Some include files for reading the modification date of files
 #ifdef WIN32
 #include <windows.h>
 #undef min
 #undef max
-#else
-#include <sys/stat.h>
-#include <time.h>
 #endif
 
 namespace fast {
@@ -98,8 +95,6 @@ OpenCLDevice::OpenCLDevice() {
 }
 
 
-boost::mutex buildBinaryMutex; // a global mutex
-
 bool OpenCLDevice::isImageFormatSupported(cl_channel_order order, cl_channel_type type, cl_mem_object_type imageType) {
     std::vector<cl::ImageFormat> formats;
     context.getSupportedImageFormats(CL_MEM_READ_WRITE, imageType, &formats);
@@ -116,25 +111,12 @@ bool OpenCLDevice::isImageFormatSupported(cl_channel_order order, cl_channel_typ
 }
 
 
+/**
+ * Get the source of an OpenCL file. The source is taken from the library if it is
+ * one of the embedded FAST kernels, see KernelSourceRegistry.
+ */
 std::string readFile(std::string filename) {
-    std::string retval = "";
-
-    std::ifstream sourceFile(filename.c_str(), std::fstream::in);
-    if (sourceFile.fail())
-        throw Exception("Failed to open OpenCL source file.");
-
-    std::stringstream stringStream;
-
-    stringStream.str("");
-
-    stringStream << sourceFile.rdbuf();
-
-    std::string sourceCode = stringStream.str();
-
-    retval = sourceCode;
-    //retval = std::string(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
-
-    return retval;
+    return KernelSourceRegistry::getSource(filename);
 }
 
 OpenCLDevice::OpenCLDevice(std::vector<cl::Device> devices, unsigned long* OpenGLContext) :
@@ -198,6 +180,37 @@ OpenCLDevice::OpenCLDevice(std::vector<cl::Device> devices, unsigned long* OpenG
             this->queues.push_back(cl::CommandQueue(context, devices[i]));
         }
     }
+    // And a queue for transfers on the first device
+    if(profilingEnabled) {
+        mTransferQueue = cl::CommandQueue(context, devices[0], CL_QUEUE_PROFILING_ENABLE);
+    } else {
+        mTransferQueue = cl::CommandQueue(context, devices[0]);
+    }
+}
+
+cl::CommandQueue OpenCLDevice::getTransferQueue() {
+    return mTransferQueue;
+}
+
+void OpenCLDevice::enqueueWaitForEvents(cl::CommandQueue queue, const std::vector<cl::Event>& events) {
+    if(events.size() == 0)
+        return;
+    // The queues are in-order, thus a marker which waits for the events also blocks later commands
+#if !defined(CL_VERSION_1_2) || defined(CL_USE_DEPRECATED_OPENCL_1_1_APIS)
+    queue.enqueueWaitForEvents(events);
+#else
+    queue.enqueueMarkerWithWaitList(&events, NULL);
+#endif
+}
+
+cl::Event OpenCLDevice::enqueueMarker(cl::CommandQueue queue) {
+    cl::Event event;
+#if !defined(CL_VERSION_1_2) || defined(CL_USE_DEPRECATED_OPENCL_1_1_APIS)
+    queue.enqueueMarker(&event);
+#else
+    queue.enqueueMarkerWithWaitList(NULL, &event);
+#endif
+    return event;
 }
 
 int OpenCLDevice::createProgramFromSource(std::string filename, std::string buildOptions, bool useCaching) {
@@ -209,6 +222,7 @@ int OpenCLDevice::createProgramFromSource(std::string filename, std::string buil
         cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
         program = buildSources(source, buildOptions);
     }
+    boost::lock_guard<boost::mutex> lock(mProgramMutex);
     programs.push_back(program);
     return programs.size()-1;
 }
@@ -226,6 +240,7 @@ int OpenCLDevice::createProgramFromSource(std::vector<std::string> filenames, st
     }
 
     cl::Program program = buildSources(sources, buildOptions);
+    boost::lock_guard<boost::mutex> lock(mProgramMutex);
     programs.push_back(program);
     return programs.size()-1;
 }
@@ -234,11 +249,13 @@ int OpenCLDevice::createProgramFromString(std::string code, std::string buildOpt
     cl::Program::Sources source(1, std::make_pair(code.c_str(), code.length()));
 
     cl::Program program = buildSources(source, buildOptions);
+    boost::lock_guard<boost::mutex> lock(mProgramMutex);
     programs.push_back(program);
     return programs.size()-1;
 }
 
 cl::Program OpenCLDevice::getProgram(unsigned int i) {
+    boost::lock_guard<boost::mutex> lock(mProgramMutex);
     return programs[i];
 }
 
@@ -271,7 +288,6 @@ cl::Program OpenCLDevice::buildSources(cl::Program::Sources source, std::string
     // Build program for the context devices
     try{
         program.build(devices, buildOptions.c_str());
-        programs.push_back(program);
     } catch(cl::Error &error) {
         if(error.err() == CL_BUILD_PROGRAM_FAILURE) {
             for(unsigned int i=0; i<devices.size(); i++){
@@ -290,10 +306,43 @@ RuntimeMeasurementsManagerPtr OpenCLDevice::getRunTimeMeasurementManager(){
 }
 
 
-cl::Program OpenCLDevice::writeBinary(std::string filename, std::string buildOptions) {
-    // Build program from source file and store the binary file
+/**
+ * Get the source code of a file with the files it includes with #include "..." inserted,
+ * so that a change in any of them changes the hash of the program.
+ */
+std::string readFileWithIncludes(std::string filename, int depth = 0) {
     std::string sourceCode = readFile(filename);
+    if(depth > 16 || sourceCode.find("#include") == std::string::npos)
+        return sourceCode;
+
+    std::string directory = "";
+    if(filename.rfind("/") != std::string::npos)
+        directory = filename.substr(0, filename.rfind("/")+1);
+    std::stringstream stream(sourceCode);
+    std::string result;
+    std::string line;
+    while(std::getline(stream, line)) {
+        std::size_t pos = line.find("#include");
+        std::size_t start = line.find('"', pos);
+        std::size_t end = line.find('"', start+1);
+        if(pos != std::string::npos && start != std::string::npos && end != std::string::npos) {
+            std::string includeFilename = directory + line.substr(start+1, end-start-1);
+            if(KernelSourceRegistry::exists(includeFilename)) {
+                result += readFileWithIncludes(includeFilename, depth+1) + "\n";
+                continue;
+            }
+        }
+        result += line + "\n";
+    }
+    return result;
+}
 
+boost::mutex buildBinaryMutex; // protects buildBinaryMutexes
+// One mutex per binary file, so that different programs can be built in parallel
+std::map<std::string, boost::shared_ptr<boost::mutex> > buildBinaryMutexes;
+
+cl::Program OpenCLDevice::writeBinary(std::string sourceCode, std::string buildOptions, std::string binaryFilename) {
+    // Build program from source and store the binary file
     cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
     cl::Program program = buildSources(source, buildOptions);
 
@@ -303,69 +352,44 @@ cl::Program OpenCLDevice::writeBinary(std::string filename, std::string buildOpt
     VECTOR_CLASS<char *> binaries;
     binaries = program.getInfo<CL_PROGRAM_BINARIES>();
 
-    boost::hash<std::string> hash_function;
-    std::string deviceName = getDevice(0).getInfo<CL_DEVICE_NAME>();
-    std::size_t hash = hash_function(buildOptions + deviceName);
-    std::string binaryPath = std::string(OUL_OPENCL_KERNEL_BINARY_PATH);
-    std::string binaryFilename = binaryPath + filename + "_" + boost::lexical_cast<std::string>(hash) + ".bin";
-    std::string cacheFilename = binaryPath + filename + "_" + boost::lexical_cast<std::string>(hash) + ".cache";
-    if(binaryPath != "") {
-        // Remove shared path from filename
-        for(int i = 0; i < std::min(filename.size(), binaryPath.size()); i++) {
-            if(binaryPath[i] == filename[i]) {
-
-            } else {
-                binaryFilename = binaryPath + filename.substr(i) + "_" + boost::lexical_cast<std::string>(hash) + ".bin";
-                cacheFilename = binaryPath + filename.substr(i) + "_" + boost::lexical_cast<std::string>(hash) + ".cache";
-                break;
-            }
-        }
-    }
-
     // Create directories if they don't exist
     if(binaryFilename.rfind("/") != std::string::npos) {
         std::string directoryPath = binaryFilename.substr(0, binaryFilename.rfind("/"));
         boost::filesystem::create_directories(directoryPath);
     }
-    FILE * file = fopen(binaryFilename.c_str(), "wb");
-    if(!file)
-        printf("could not write to file\n");
-    fwrite(binaries[0], sizeof(char), (int)binarySizes[0], file);
-    fclose(file);
-
-    // Write cache file
-    FILE * cacheFile = fopen(cacheFilename.c_str(), "w");
-    std::string timeStr;
-    #ifdef WIN32
-	HANDLE hFile = CreateFile(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
-	FILETIME ftCreate, ftAccess, ftWrite;
-	SYSTEMTIME sysTime;
-	GetFileTime(hFile, &ftCreate, &ftAccess, &ftWrite);
-	FileTimeToSystemTime(&ftWrite, &sysTime);
-	char* buffer = new char[255];
-	sprintf(buffer, "%d%d%d%d%d", sysTime.wYear, sysTime.wMonth, sysTime.wDay, sysTime.wHour, sysTime.wMinute, sysTime.wSecond);
-	timeStr = buffer;
-	delete[] buffer;
-    #else
-    struct stat attrib; // create a file attribute structure
-    stat(filename.c_str(), &attrib);
-    timeStr = ctime(&(attrib.st_mtime));
-    #endif
-    VECTOR_CLASS<cl::Device> devices = context.getInfo<CL_CONTEXT_DEVICES>();
-    timeStr += "-" + devices[0].getInfo<CL_DEVICE_NAME>() + "\n";
-    timeStr += "-" + buildOptions;
-    fwrite(timeStr.c_str(), sizeof(char), timeStr.size(), cacheFile);
-    fclose(cacheFile);
+
+    // Write to a temporary file first and then rename it, so that other processes
+    // never see a partially written binary file
+    std::string temporaryFilename = binaryFilename + "." + boost::filesystem::unique_path().string() + ".tmp";
+    FILE * file = fopen(temporaryFilename.c_str(), "wb");
+    if(!file) {
+        reportWarning() << "Could not write OpenCL binary file " << binaryFilename << Reporter::end;
+    } else {
+        std::size_t written = fwrite(binaries[0], sizeof(char), binarySizes[0], file);
+        fclose(file);
+        boost::system::error_code error;
+        if(written == binarySizes[0])
+            boost::filesystem::rename(temporaryFilename, binaryFilename, error);
+        if(written != binarySizes[0] || error) {
+            // E.g. another process wrote the same file at the same time on Windows
+            boost::filesystem::remove(temporaryFilename, error);
+        }
+    }
+
+    for(std::size_t i = 0; i < binaries.size(); ++i)
+        delete[] binaries[i];
 
     return program;
 }
 
-cl::Program OpenCLDevice::readBinary(std::string filename) {
-    std::ifstream sourceFile(filename.c_str(), std::ios_base::binary | std::ios_base::in);
-    std::string sourceCode(
-        std::istreambuf_iterator<char>(sourceFile),
+cl::Program OpenCLDevice::readBinary(std::string binaryFilename, std::string buildOptions) {
+    std::ifstream binaryFile(binaryFilename.c_str(), std::ios_base::binary | std::ios_base::in);
+    std::string binaryCode(
+        std::istreambuf_iterator<char>(binaryFile),
         (std::istreambuf_iterator<char>()));
-    cl::Program::Binaries binary(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
+    if(binaryCode.size() == 0)
+        throw Exception("OpenCL binary file " + binaryFilename + " is empty");
+    cl::Program::Binaries binary(1, std::make_pair(binaryCode.c_str(), binaryCode.length()));
 
     VECTOR_CLASS<cl::Device> devices = context.getInfo<CL_CONTEXT_DEVICES>();
     if(devices.size() > 1) {
@@ -378,110 +402,88 @@ cl::Program OpenCLDevice::readBinary(std::string filename) {
     cl::Program program = cl::Program(context, devices, binary);
 
     // Build program for these specific devices
-    program.build(devices);
+    program.build(devices, buildOptions.c_str());
     return program;
 }
 
 cl::Program OpenCLDevice::buildProgramFromBinary(std::string filename, std::string buildOptions) {
-    boost::lock_guard<boost::mutex> lock(buildBinaryMutex);
-    cl::Program program;
+    // The binary is identified by a hash of everything which affects the compiled program.
+    // Thus, a binary is never out of date, and binaries can be shipped with an installation.
+    std::string sourceCode = readFileWithIncludes(filename);
+    cl::Device device = getDevice(0);
+    unsigned long long hash = hashString(sourceCode);
+    hash = hashString(buildOptions, hash);
+    hash = hashString(platform.getInfo<CL_PLATFORM_NAME>() + platform.getInfo<CL_PLATFORM_VERSION>(), hash);
+    hash = hashString(device.getInfo<CL_DEVICE_NAME>() + device.getInfo<CL_DEVICE_VERSION>() + device.getInfo<CL_DRIVER_VERSION>(), hash);
+    std::stringstream hashStream;
+    hashStream << std::hex << hash;
 
-    boost::hash<std::string> hash_function;
-    std::string deviceName = getDevice(0).getInfo<CL_DEVICE_NAME>();
-    std::size_t hash = hash_function(buildOptions + deviceName);
     std::string binaryPath = std::string(OUL_OPENCL_KERNEL_BINARY_PATH);
-    std::string binaryFilename = binaryPath + filename + "_" + boost::lexical_cast<std::string>(hash) + ".bin";
-    std::string cacheFilename = binaryPath + filename + "_" + boost::lexical_cast<std::string>(hash) + ".cache";
+    std::string binaryFilename = binaryPath + filename + "_" + hashStream.str() + ".bin";
     if(binaryPath != "") {
         // Remove shared path from filename
         for(int i = 0; i < std::min(filename.size(), binaryPath.size()); i++) {
-            if(binaryPath[i] == filename[i]) {
-
-            } else {
-                binaryFilename = binaryPath + filename.substr(i) + "_" + boost::lexical_cast<std::string>(hash) + ".bin";
-                cacheFilename = binaryPath + filename.substr(i) + "_" + boost::lexical_cast<std::string>(hash) + ".cache";
+            if(binaryPath[i] != filename[i]) {
+                binaryFilename = binaryPath + filename.substr(i) + "_" + hashStream.str() + ".bin";
                 break;
             }
         }
     }
 
-    // Check if a binary file exists
-    std::ifstream binaryFile(binaryFilename.c_str(), std::ios_base::binary | std::ios_base::in);
-    if(binaryFile.fail()) {
-        program = writeBinary(filename, buildOptions);
-    } else {
-        // Compare modified dates of binary file and source file
-
-        // Read cache file
-        std::ifstream cacheFile(cacheFilename.c_str());
-        std::string cache(
-            std::istreambuf_iterator<char>(cacheFile),
-            (std::istreambuf_iterator<char>()));
-
-        bool outOfDate = true;
-        bool wrongDeviceID = true;
-        bool buildOptionsChanged = true;
-        const size_t pos = cache.find("-");
-        const size_t pos2 = cache.find("-", pos+1);
-        if(pos != std::string::npos && pos2 != std::string::npos) {
-            // Get modification date of file
-            #ifdef WIN32
-            HANDLE hFile = CreateFile(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
-            FILETIME ftCreate, ftAccess, ftWrite;
-			SYSTEMTIME sysTime;
-            GetFileTime(hFile, &ftCreate, &ftAccess, &ftWrite);
-			FileTimeToSystemTime(&ftWrite, &sysTime);
-			char* buffer = new char[255];
-			sprintf(buffer, "%d%d%d%d%d", sysTime.wYear, sysTime.wMonth, sysTime.wDay, sysTime.wHour,sysTime.wMinute,sysTime.wSecond);
-			outOfDate = strcmp(buffer, cache.substr(0, pos).c_str()) != 0;
-			delete[] buffer;
-            #else
-            struct stat attrib; // create a file attribute structure
-            stat(filename.c_str(), &attrib);
-            outOfDate = strcmp(ctime(&(attrib.st_mtime)), cache.substr(0, pos).c_str()) != 0;
-            #endif
-            VECTOR_CLASS<cl::Device> devices = context.getInfo<CL_CONTEXT_DEVICES>();
-            wrongDeviceID = cache.substr(pos+1, pos2-pos-2) != devices[0].getInfo<CL_DEVICE_NAME>();
-            buildOptionsChanged = cache.substr(pos2+1) != buildOptions;
-        }
-
-        if(outOfDate || wrongDeviceID || buildOptionsChanged) {
-            std::cout << "Binary is out of date. Compiling..." << std::endl;
-            program = writeBinary(filename, buildOptions);
-        } else {
-            //std::cout << "Binary is not out of date." << std::endl;
-            program = readBinary(binaryFilename);
+    // Only one thread may build or read a given binary at a time
+    boost::shared_ptr<boost::mutex> binaryMutex;
+    {
+        boost::lock_guard<boost::mutex> lock(buildBinaryMutex);
+        if(buildBinaryMutexes.count(binaryFilename) == 0)
+            buildBinaryMutexes[binaryFilename] = boost::shared_ptr<boost::mutex>(new boost::mutex);
+        binaryMutex = buildBinaryMutexes[binaryFilename];
+    }
+    boost::lock_guard<boost::mutex> lock(*binaryMutex);
+
+    if(boost::filesystem::exists(binaryFilename)) {
+        try {
+            return readBinary(binaryFilename, buildOptions);
+        } catch(cl::Error &error) {
+            reportWarning() << "Failed to load OpenCL binary " << binaryFilename << ". Compiling..." << Reporter::end;
+        } catch(Exception &e) {
+            reportWarning() << e.what() << ". Compiling..." << Reporter::end;
         }
     }
-
-    return program;
+    return writeBinary(sourceCode, buildOptions, binaryFilename);
 }
 
 int OpenCLDevice::createProgramFromSourceWithName(
         std::string programName,
         std::string filename,
         std::string buildOptions) {
-    programNames[programName] = createProgramFromSource(filename,buildOptions);
-    return programNames[programName];
+    int index = createProgramFromSource(filename,buildOptions);
+    boost::lock_guard<boost::mutex> lock(mProgramMutex);
+    programNames[programName] = index;
+    return index;
 }
 
 int OpenCLDevice::createProgramFromSourceWithName(
         std::string programName,
         std::vector<std::string> filenames,
         std::string buildOptions) {
-    programNames[programName] = createProgramFromSource(filenames,buildOptions);
-    return programNames[programName];
+    int index = createProgramFromSource(filenames,buildOptions);
+    boost::lock_guard<boost::mutex> lock(mProgramMutex);
+    programNames[programName] = index;
+    return index;
 }
 
 int OpenCLDevice::createProgramFromStringWithName(
         std::string programName,
         std::string code,
         std::string buildOptions) {
-    programNames[programName] = createProgramFromString(code,buildOptions);
-    return programNames[programName];
+    int index = createProgramFromString(code,buildOptions);
+    boost::lock_guard<boost::mutex> lock(mProgramMutex);
+    programNames[programName] = index;
+    return index;
 }
 
 cl::Program OpenCLDevice::getProgram(std::string name) {
+    boost::lock_guard<boost::mutex> lock(mProgramMutex);
     if(programNames.count(name) == 0) {
         std::string msg ="Could not find OpenCL program with the name" + name;
         throw Exception(msg.c_str(), __LINE__, __FILE__);
@@ -491,6 +493,7 @@ cl::Program OpenCLDevice::getProgram(std::string name) {
 }
 
 bool OpenCLDevice::hasProgram(std::string name) {
+    boost::lock_guard<boost::mutex> lock(mProgramMutex);
     return programNames.count(name) > 0;
 }
 
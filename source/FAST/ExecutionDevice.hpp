@@ -4,6 +4,7 @@
 #include "FAST/Object.hpp"
 #include "FAST/SmartPointers.hpp"
 #include "RuntimeMeasurementManager.hpp"
+#include <boost/thread/mutex.hpp>
 
 namespace fast {
 
@@ -53,6 +54,20 @@ class OpenCLDevice : public ExecutionDevice {
     FAST_OBJECT(OpenCLDevice)
     public:
         cl::CommandQueue getCommandQueue();
+        /**
+         * A separate in-order queue used for transfers between host and device, so that
+         * transfers can overlap with the kernels in the command queue. Use enqueueWaitForEvents
+         * to make a queue wait for commands in the other queue.
+         */
+        cl::CommandQueue getTransferQueue();
+        /**
+         * Make all commands enqueued in queue after this call wait for the given events to complete
+         */
+        void enqueueWaitForEvents(cl::CommandQueue queue, const std::vector<cl::Event>& events);
+        /**
+         * Returns an event which completes when all commands enqueued in queue before this call have completed
+         */
+        cl::Event enqueueMarker(cl::CommandQueue queue);
         cl::Device getDevice();
 
         int createProgramFromSource(std::string filename, std::string buildOptions = "", bool caching = true);
@@ -84,15 +99,18 @@ class OpenCLDevice : public ExecutionDevice {
     private:
         OpenCLDevice();
         unsigned long * mGLContext;
-        cl::Program writeBinary(std::string filename, std::string buildOptions);
-        cl::Program readBinary(std::string filename);
+        cl::Program writeBinary(std::string sourceCode, std::string buildOptions, std::string binaryFilename);
+        cl::Program readBinary(std::string binaryFilename, std::string buildOptions);
         cl::Program buildProgramFromBinary(std::string filename, std::string buildOptions);
         cl::Program buildSources(cl::Program::Sources source, std::string buildOptions);
 
         cl::Context context;
         std::vector<cl::CommandQueue> queues;
+        cl::CommandQueue mTransferQueue;
         std::map<std::string, int> programNames;
         std::vector<cl::Program> programs;
+        // Protects programNames and programs, so that programs can be created by several threads
+        boost::mutex mProgramMutex;
         std::vector<cl::Device> devices;
         cl::Platform platform;
 
@@ -1,5 +1,6 @@
 #include "FAST/Testing.hpp"
 #include "FAST/Exporters/VTKMeshFileExporter.hpp"
+#include "FAST/Importers/VTKMeshFileImporter.hpp"
 #include "FAST/Data/Mesh.hpp"
 
 using namespace fast;
@@ -57,3 +58,47 @@ TEST_CASE("Export 3D mesh", "[fast][VTKMeshFileExporter]") {
 	exporter->setFilename("VTKMeshFileExporter3DTest.vtk");
 	CHECK_NOTHROW(exporter->update());
 }
+
+TEST_CASE("Export 3D mesh in binary format and import it again", "[fast][VTKMeshFileExporter]") {
+	Mesh::pointer mesh = Mesh::New();
+	std::vector<Vector3f> vertices = {
+			Vector3f(0, 0, 1),
+			Vector3f(1, 0, 0),
+			Vector3f(0, 1.5, 0),
+			Vector3f(-2.25, 1, 3)
+	};
+	std::vector<Vector3f> normals = {
+			Vector3f(1, 0, 0),
+			Vector3f(0, 1, 0),
+			Vector3f(0, 0, 1),
+			Vector3f(0, 0, 1)
+	};
+	std::vector<VectorXui> triangles = {
+			Vector3ui(0, 1, 2),
+			Vector3ui(1, 2, 3)
+	};
+	mesh->create(vertices, normals, triangles);
+
+	VTKMeshFileExporter::pointer exporter = VTKMeshFileExporter::New();
+	exporter->setInputData(mesh);
+	exporter->setFilename("VTKMeshFileExporter3DBinaryTest.vtk");
+	exporter->enableBinaryFormat();
+	CHECK_NOTHROW(exporter->update());
+
+	VTKMeshFileImporter::pointer importer = VTKMeshFileImporter::New();
+	importer->setFilename("VTKMeshFileExporter3DBinaryTest.vtk");
+	importer->update();
+	Mesh::pointer importedMesh = importer->getOutputData<Mesh>(0);
+	CHECK(importedMesh->getNrOfVertices() == 4);
+	CHECK(importedMesh->getNrOfTriangles() == 2);
+
+	MeshAccess::pointer access = importedMesh->getMeshAccess(ACCESS_READ);
+	for(int i = 0; i < vertices.size(); i++) {
+		MeshVertex vertex = access->getVertex(i);
+		CHECK(vertex.getPosition().x() == Approx(vertices[i].x()));
+		CHECK(vertex.getPosition().y() == Approx(vertices[i].y()));
+		CHECK(vertex.getPosition().z() == Approx(vertices[i].z()));
+		CHECK(vertex.getNormal().z() == Approx(normals[i].z()));
+	}
+	CHECK(access->getTriangle(1) == triangles[1]);
+}
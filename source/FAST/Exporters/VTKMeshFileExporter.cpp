@@ -1,6 +1,7 @@
 #include "VTKMeshFileExporter.hpp"
 #include "FAST/Data/Mesh.hpp"
 #include <fstream>
+#include <cstring>
 #include "FAST/SceneGraph.hpp"
 
 namespace fast {
@@ -9,9 +10,43 @@ void VTKMeshFileExporter::setFilename(std::string filename) {
     mFilename = filename;
 }
 
+void VTKMeshFileExporter::enableBinaryFormat() {
+    mWriteBinary = true;
+}
+
+void VTKMeshFileExporter::disableBinaryFormat() {
+    mWriteBinary = false;
+}
+
 VTKMeshFileExporter::VTKMeshFileExporter() {
     createInputPort<Mesh>(0);
     mFilename = "";
+    mWriteBinary = false;
+}
+
+// Legacy VTK binary files are big-endian
+template <class T>
+inline void writeBigEndian(std::ofstream& file, const std::vector<T>& values) {
+    const unsigned short one = 1;
+    const bool swap = *((const unsigned char*)&one) == 1;
+    std::vector<char> buffer(values.size()*sizeof(T));
+    for(std::size_t i = 0; i < values.size(); ++i) {
+        const char* value = (const char*)&values[i];
+        char* destination = &buffer[i*sizeof(T)];
+        for(std::size_t j = 0; j < sizeof(T); ++j)
+            destination[j] = value[swap ? sizeof(T) - 1 - j : j];
+    }
+    if(buffer.size() > 0)
+        file.write(&buffer[0], buffer.size());
+    file << "\n";
+}
+
+template <class T>
+inline void writeASCII(std::ofstream& file, const std::vector<T>& values, unsigned int valuesPerLine) {
+    for(std::size_t i = 0; i < values.size(); ++i) {
+        file << values[i];
+        file << ((i + 1) % valuesPerLine == 0 ? "\n" : " ");
+    }
 }
 
 void VTKMeshFileExporter::execute() {
@@ -25,7 +60,50 @@ void VTKMeshFileExporter::execute() {
     // Get transformation
     AffineTransformation::pointer transform = SceneGraph::getAffineTransformationFromData(mesh);
 
-    std::ofstream file(mFilename.c_str());
+    // Collect vertices and normals in flat arrays
+    MeshAccess::pointer access = mesh->getMeshAccess(ACCESS_READ);
+    std::vector<MeshVertex> vertices = access->getVertices();
+    std::vector<float> positions(vertices.size()*3);
+    std::vector<float> normals(vertices.size()*3);
+    for(int i = 0; i < vertices.size(); i++) {
+        MeshVertex& vertex = vertices[i];
+        VectorXf position = vertex.getPosition();
+        VectorXf normal = vertex.getNormal();
+        if(dimensions == 3) {
+            position = (transform->matrix()*Vector3f(position).homogeneous()).head(3);
+            normal = transform->linear()*normal; // Transform the normal
+            positions[i*3 + 2] = position.z();
+        } else {
+            positions[i*3 + 2] = 0;
+        }
+        positions[i*3] = position.x();
+        positions[i*3 + 1] = position.y();
+
+        // Normalize it
+        float length = normal.norm();
+        if(length == 0) { // prevent NaN situations
+            normals[i*3] = 0;
+            normals[i*3 + 1] = 1;
+            normals[i*3 + 2] = 0;
+        } else {
+            normal.normalize();
+            normals[i*3] = normal.x();
+            normals[i*3 + 1] = normal.y();
+            normals[i*3 + 2] = dimensions == 3 ? normal.z() : 0;
+        }
+    }
+
+    // Collect triangles or lines in the VTK cell array layout: number of points followed by point ids
+    std::vector<VectorXui> connections = dimensions == 3 ? access->getTriangles() : access->getLines();
+    const unsigned int pointsPerCell = dimensions == 3 ? 3 : 2;
+    std::vector<int> cells(connections.size()*(pointsPerCell + 1));
+    for(int i = 0; i < connections.size(); i++) {
+        cells[i*(pointsPerCell + 1)] = pointsPerCell;
+        for(unsigned int j = 0; j < pointsPerCell; j++)
+            cells[i*(pointsPerCell + 1) + j + 1] = connections[i](j);
+    }
+
+    std::ofstream file(mFilename.c_str(), std::ios::out | std::ios::binary);
 
     if(!file.is_open())
         throw Exception("Unable to open the file " + mFilename);
@@ -33,63 +111,32 @@ void VTKMeshFileExporter::execute() {
     // Write header
     file << "# vtk DataFile Version 3.0\n"
             "vtk output\n"
-            "ASCII\n"
-            "DATASET POLYDATA\n";
+         << (mWriteBinary ? "BINARY\n" : "ASCII\n")
+         << "DATASET POLYDATA\n";
 
     // Write vertices
-    MeshAccess::pointer access = mesh->getMeshAccess(ACCESS_READ);
-    std::vector<MeshVertex> vertices = access->getVertices();
     file << "POINTS " << vertices.size() << " float\n";
-    for(int i = 0; i < vertices.size(); i++) {
-        MeshVertex vertex = vertices[i];
-        if(dimensions == 3) {
-			vertex.getPosition() = (transform->matrix()*vertex.getPosition().homogeneous()).head(3);
-			file << vertex.getPosition().x() << " " << vertex.getPosition().y() << " " << vertex.getPosition().z() << "\n";
-        } else {
-			file << vertex.getPosition().x() << " " << vertex.getPosition().y() << " " << 0 << "\n";
-        }
+    if(mWriteBinary) {
+        writeBigEndian(file, positions);
+    } else {
+        writeASCII(file, positions, 3);
     }
 
-    if(dimensions == 3) {
-		// Write triangles
-		std::vector<VectorXui> triangles = access->getTriangles();
-		file << "POLYGONS " << mesh->getNrOfTriangles() << " " << mesh->getNrOfTriangles()*4 << "\n";
-		for(int i = 0; i < triangles.size(); i++) {
-			Vector3ui triangle = triangles[i];
-			file << "3 " << triangle.x() << " " << triangle.y() << " " << triangle.z() << "\n";
-		}
+    // Write triangles or lines
+    file << (dimensions == 3 ? "POLYGONS " : "LINES ") << connections.size() << " " << cells.size() << "\n";
+    if(mWriteBinary) {
+        writeBigEndian(file, cells);
     } else {
-    	// Write lines
-		std::vector<VectorXui> lines = access->getLines();
-		file << "LINES " << mesh->getNrOfLines() << " " << mesh->getNrOfLines()*3 << "\n";
-		for(int i = 0; i < lines.size(); i++) {
-			Vector2ui line = lines[i];
-			file << "2 " << line.x() << " " << line.y() << "\n";
-		}
+        writeASCII(file, cells, pointsPerCell + 1);
     }
 
-    // Write.getNormal()s
+    // Write normals
     file << "POINT_DATA " << vertices.size() << "\n";
     file << "NORMALS Normals float\n";
-    for(int i = 0; i < vertices.size(); i++) {
-        MeshVertex vertex = vertices[i];
-        VectorXf normal = vertex.getNormal();
-
-        if(dimensions == 3)
-			normal = transform->linear()*normal; // Transform the normal
-
-        // Normalize it
-        float length = normal.norm();
-        if(length == 0) { // prevent NaN situations
-			file << "0 1 0\n";
-        } else {
-        	normal.normalize();
-			if(dimensions == 3) {
-				file << normal.x() << " " << normal.y() << " " << normal.z() << "\n";
-			} else {
-				file << normal.x() << " " << normal.y() << " 0" << "\n";
-			}
-        }
+    if(mWriteBinary) {
+        writeBigEndian(file, normals);
+    } else {
+        writeASCII(file, normals, 3);
     }
 
     file.close();
@@ -9,11 +9,17 @@ class VTKMeshFileExporter : public ProcessObject {
     FAST_OBJECT(VTKMeshFileExporter);
     public:
         void setFilename(std::string filename);
+        /**
+         * Write the file in the legacy VTK BINARY format instead of ASCII. Default is ASCII.
+         */
+        void enableBinaryFormat();
+        void disableBinaryFormat();
     private:
         VTKMeshFileExporter();
         void execute();
 
         std::string mFilename;
+        bool mWriteBinary;
 };
 
 }
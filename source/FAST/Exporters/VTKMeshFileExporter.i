@@ -8,6 +8,8 @@ class VTKMeshFileExporter : public ProcessObject {
     public:
     	static SharedPointer<VTKMeshFileExporter> New();
         void setFilename(std::string filename);
+        void enableBinaryFormat();
+        void disableBinaryFormat();
     private:
         VTKMeshFileExporter();
 };
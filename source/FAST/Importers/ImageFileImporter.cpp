@@ -6,21 +6,52 @@
 
 namespace fast {
 
+inline bool matchExtension(std::string extension, std::string extension2) {
+    // Convert to lower case first
+    std::transform(extension2.begin(), extension2.end(), extension2.begin(), ::tolower);
+    return extension == extension2;
+
+}
+
 void ImageFileImporter::setFilename(std::string filename) {
     mFilename = filename;
     mIsModified = true;
+    mRegionRequested = false;
+    if(matchExtension(filename.substr(filename.rfind(".")+1), "mhd")) {
+        // A new importer, so that no region of the previous file is kept
+        mMetaImageImporter = MetaImageImporter::New();
+        mMetaImageImporter->setFilename(filename);
+    }
 }
 
 ImageFileImporter::ImageFileImporter() {
     mFilename = "";
+    mRegionRequested = false;
     createOutputPort<Image>(0, OUTPUT_STATIC);
 }
 
-inline bool matchExtension(std::string extension, std::string extension2) {
-    // Convert to lower case first
-    std::transform(extension2.begin(), extension2.end(), extension2.begin(), ::tolower);
-    return extension == extension2;
+bool ImageFileImporter::setOutputRegion(uint portID, Vector3ui offset, Vector3ui size) {
+    if(mRegionRequested && mRegionOffset == offset && mRegionSize == size)
+        return true;
+
+    // A previously accepted region no longer applies
+    if(mRegionRequested) {
+        mRegionRequested = false;
+        mIsModified = true;
+    }
 
+    // Only MetaImage files can be partially imported. The importer reads the header the first time only.
+    if(mFilename == "" || !matchExtension(mFilename.substr(mFilename.rfind(".")+1), "mhd"))
+        return false;
+    Vector3ui regionOffset;
+    if(!mMetaImageImporter->requestRegion(this, 0, offset, size, regionOffset))
+        return false;
+
+    mRegionRequested = true;
+    mRegionOffset = offset;
+    mRegionSize = size;
+    mIsModified = true;
+    return true;
 }
 
 void ImageFileImporter::execute() {
@@ -30,11 +61,10 @@ void ImageFileImporter::execute() {
     // Get file extension
     std::string ext = mFilename.substr(mFilename.rfind(".")+1);
     if(matchExtension(ext, "mhd")) {
-        MetaImageImporter::pointer importer = MetaImageImporter::New();
-        importer->setFilename(mFilename);
-        importer->update(); // Have to to update because otherwise getInputData will not be available
+        // The importer has the accepted region, if any, from setOutputRegion
+        mMetaImageImporter->update(); // Have to to update because otherwise getInputData will not be available
         // Set input to be output
-        Image::pointer data = importer->getOutputData<Image>();
+        Image::pointer data = mMetaImageImporter->getOutputData<Image>();
         setOutputData(0, data);
     } else if(matchExtension(ext, "jpg") ||
             matchExtension(ext, "jpeg") ||
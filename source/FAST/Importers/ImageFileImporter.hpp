@@ -2,6 +2,7 @@
 #define IMAGE_FILE_IMPORTER_HPP_
 
 #include "FAST/ProcessObject.hpp"
+#include "MetaImageImporter.hpp"
 
 namespace fast {
 
@@ -12,8 +13,15 @@ class ImageFileImporter : public ProcessObject {
         ImageFileImporter();
     private:
         void execute();
+        // Forwarded to the MetaImageImporter for .mhd files. Other formats are always imported whole.
+        bool setOutputRegion(uint portID, Vector3ui offset, Vector3ui size);
 
         std::string mFilename;
+        // Importer of .mhd files. It is kept, so that the header is only read once to validate regions.
+        MetaImageImporter::pointer mMetaImageImporter;
+        bool mRegionRequested;
+        Vector3ui mRegionOffset;
+        Vector3ui mRegionSize;
 };
 
 }
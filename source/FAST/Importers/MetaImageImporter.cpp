@@ -12,12 +12,64 @@ using namespace fast;
 
 void MetaImageImporter::setFilename(std::string filename) {
     mFilename = filename;
+    mHeaderFilename = "";
     mIsModified = true;
 }
 
+void MetaImageImporter::setRegionOfInterest(Vector3ui offset, Vector3ui size) {
+    if(!mRegionOfInterestSet || mRegionOffset != offset || mRegionSize != size)
+        mIsModified = true;
+    mRegionOffset = offset;
+    mRegionSize = size;
+    mRegionOfInterestSet = true;
+}
+
+Vector3ui MetaImageImporter::getRegionSize(Vector3ui offset, Vector3ui size) const {
+    // A size of 0 means the rest of the image along that axis
+    for(int i = 0; i < 3; ++i) {
+        if(size[i] == 0 && offset[i] < mSize[i])
+            size[i] = mSize[i] - offset[i];
+    }
+    return size;
+}
+
+bool MetaImageImporter::isValidRegion(Vector3ui offset, Vector3ui size) const {
+    size = getRegionSize(offset, size);
+    for(int i = 0; i < 3; ++i) {
+        if(size[i] == 0 || offset[i] + size[i] > mSize[i])
+            return false;
+    }
+    return true;
+}
+
+bool MetaImageImporter::setOutputRegion(uint portID, Vector3ui offset, Vector3ui size) {
+    // The region can only be accepted if it is valid for this image and not the whole image.
+    // If not, the whole image is imported, also if a region was set before.
+    bool valid = offset != Vector3ui::Zero() || size != Vector3ui::Zero();
+    try {
+        readHeader();
+        // OpenCL 3D images must have a depth of at least 2
+        valid = valid && isValidRegion(offset, size) && (!mImageIs3D || getRegionSize(offset, size).z() >= 2);
+    } catch(Exception &e) {
+        valid = false;
+    }
+    if(!valid) {
+        if(mRegionOfInterestSet) {
+            mRegionOfInterestSet = false;
+            mIsModified = true;
+        }
+        return false;
+    }
+
+    setRegionOfInterest(offset, size);
+    return true;
+}
+
 MetaImageImporter::MetaImageImporter() {
     mFilename = "";
     mIsModified = true;
+    mRegionOfInterestSet = false;
+    mHeaderFilename = "";
     createOutputPort<Image>(0, OUTPUT_STATIC);
 }
 
@@ -39,22 +91,46 @@ std::vector<std::string> stringSplit(std::string str, std::string delimiter) {
     return values;
 }
 
+/**
+ * Copy the rows of a region from an image with the given size in src to dst. src points to the first element of the region.
+ */
+inline void copyRegion(char* dst, const char* src, Vector3ui size, Vector3ui regionSize, std::size_t elementSize) {
+    const std::size_t rowSize = regionSize.x()*elementSize;
+    #pragma omp parallel for
+    for(int z = 0; z < (int)regionSize.z(); ++z) {
+        for(uint y = 0; y < regionSize.y(); ++y) {
+            memcpy(
+                    dst + ((std::size_t)z*regionSize.y() + y)*rowSize,
+                    src + ((std::size_t)z*size.y() + y)*size.x()*elementSize,
+                    rowSize
+            );
+        }
+    }
+}
+
 template <class T>
-inline void * readRawData(std::string rawFilename, unsigned int width, unsigned int height, unsigned int depth, unsigned int nrOfComponents, bool compressed, std::size_t compressedFileSize) {
-    T * data = new T[width*height*depth*nrOfComponents];
+inline void * readRawData(std::string rawFilename, Vector3ui size, unsigned int nrOfComponents, bool compressed, std::size_t compressedFileSize, Vector3ui regionOffset, Vector3ui regionSize) {
+    const std::size_t elementSize = sizeof(T)*nrOfComponents;
+    const std::size_t totalSize = (std::size_t)size.x()*size.y()*size.z()*elementSize;
+    const bool wholeImage = regionOffset == Vector3ui::Zero() && regionSize == size;
+    // Byte position of the first and one past the last element of the region in the raw data
+    const std::size_t regionStart = (((std::size_t)regionOffset.z()*size.y() + regionOffset.y())*size.x() + regionOffset.x())*elementSize;
+    const std::size_t regionEnd = (((std::size_t)(regionOffset.z() + regionSize.z() - 1)*size.y() + regionOffset.y() + regionSize.y() - 1)*size.x() + regionOffset.x() + regionSize.x())*elementSize;
+    T * data = new T[(std::size_t)regionSize.x()*regionSize.y()*regionSize.z()*nrOfComponents];
     if(compressed) {
 #ifdef ZLIB_ENABLED
         // Read compressed data
         boost::iostreams::mapped_file_source file;
-        file.open(rawFilename, width*height*depth*nrOfComponents*sizeof(T));
+        file.open(rawFilename, totalSize);
         if(!file.is_open())
             throw FileNotFoundException(rawFilename);
         Bytef* fileData = (Bytef*)file.data();
 
-        unsigned long uncompressedSize = sizeof(T)*width*height*depth*nrOfComponents;
-        unsigned long fileSize = file.size();
+        // The whole image has to be decompressed, even if only a region is needed
+        T * uncompressedData = wholeImage ? data : new T[totalSize/sizeof(T)];
+        unsigned long uncompressedSize = totalSize;
 		int z_result = uncompress(
-            (Bytef*)data,       // destination for the uncompressed
+            (Bytef*)uncompressedData,       // destination for the uncompressed
                                     // data.  This should be the size of
                                     // the original data, which you should
                                     // already know.
@@ -79,24 +155,36 @@ inline void * readRawData(std::string rawFilename, unsigned int width, unsigned
             break;
         }
         file.close();
+        if(!wholeImage) {
+            copyRegion((char*)data, (char*)uncompressedData + regionStart, size, regionSize, elementSize);
+            delete[] uncompressedData;
+        }
 #else
         throw Exception("Error reading MetaImage. Compressed raw files (.zraw) currently not supported.");
 #endif
     } else {
+        // Only map the part of the file containing the region. The offset of the mapping has to be aligned.
+        const std::size_t mappingStart = regionStart - regionStart % boost::iostreams::mapped_file_source::alignment();
         boost::iostreams::mapped_file_source file;
-        file.open(rawFilename, width*height*depth*nrOfComponents*sizeof(T));
+        file.open(rawFilename, regionEnd - mappingStart, mappingStart);
         if(!file.is_open())
             throw FileNotFoundException(rawFilename);
-        T * fileData = (T*)file.data();
-        memcpy(data,fileData,width*height*depth*nrOfComponents*sizeof(T));
+        const char * fileData = file.data() + (regionStart - mappingStart);
+        if(wholeImage) {
+            memcpy(data,fileData,totalSize);
+        } else {
+            copyRegion((char*)data, fileData, size, regionSize, elementSize);
+        }
         file.close();
     }
     return data;
 }
 
-void MetaImageImporter::execute() {
+void MetaImageImporter::readHeader() {
     if(mFilename == "")
         throw Exception("Filename was not set in MetaImageImporter");
+    if(mHeaderFilename == mFilename)
+        return;
 
     // Open and parse mhd file
     std::fstream mhdFile;
@@ -133,7 +221,6 @@ void MetaImageImporter::execute() {
 
     unsigned int width, height, depth = 1;
     unsigned int nrOfComponents = 1;
-    Image::pointer output = getOutputData<Image>(0);
 
     Vector3f spacing(1,1,1), offset(0,0,0), centerOfRotation(0,0,0);
     Matrix3f transformMatrix = Matrix3f::Identity();
@@ -293,38 +380,63 @@ void MetaImageImporter::execute() {
     if(!sizeFound || !rawFilenameFound || !typeFound || !dimensionsFound)
         throw Exception("Error reading the mhd file", __LINE__, __FILE__);
 
+    mRawFilename = rawFilename;
+    mTypeName = typeName;
+    mImageIs3D = imageIs3D;
+    mIsCompressed = isCompressed;
+    mCompressedDataSize = compressedDataSize;
+    mSize = Vector3ui(width, height, depth);
+    mNrOfComponents = nrOfComponents;
+    mSpacing = spacing;
+    mOffset = offset;
+    mTransformMatrix = transformMatrix;
+    mHeaderFilename = mFilename;
+}
+
+void MetaImageImporter::execute() {
+    readHeader();
+
+    Vector3ui regionOffset = Vector3ui::Zero();
+    Vector3ui regionSize = mSize;
+    if(mRegionOfInterestSet) {
+        if(!isValidRegion(mRegionOffset, mRegionSize))
+            throw Exception("Region of interest given to the MetaImageImporter is outside the image");
+        regionOffset = mRegionOffset;
+        regionSize = getRegionSize(mRegionOffset, mRegionSize);
+    }
+    Image::pointer output = getOutputData<Image>(0);
 
     void * data;
     DataType type;
-    if(typeName == "MET_SHORT") {
+    if(mTypeName == "MET_SHORT") {
         type = TYPE_INT16;
-        data = readRawData<short>(rawFilename, width, height, depth, nrOfComponents, isCompressed, compressedDataSize);
-    } else if(typeName == "MET_USHORT") {
+        data = readRawData<short>(mRawFilename, mSize, mNrOfComponents, mIsCompressed, mCompressedDataSize, regionOffset, regionSize);
+    } else if(mTypeName == "MET_USHORT") {
         type = TYPE_UINT16;
-        data = readRawData<unsigned short>(rawFilename, width, height, depth, nrOfComponents, isCompressed, compressedDataSize);
-    } else if(typeName == "MET_CHAR") {
+        data = readRawData<unsigned short>(mRawFilename, mSize, mNrOfComponents, mIsCompressed, mCompressedDataSize, regionOffset, regionSize);
+    } else if(mTypeName == "MET_CHAR") {
         type = TYPE_INT8;
-        data = readRawData<char>(rawFilename, width, height, depth, nrOfComponents, isCompressed, compressedDataSize);
-    } else if(typeName == "MET_UCHAR") {
+        data = readRawData<char>(mRawFilename, mSize, mNrOfComponents, mIsCompressed, mCompressedDataSize, regionOffset, regionSize);
+    } else if(mTypeName == "MET_UCHAR") {
         type = TYPE_UINT8;
-        data = readRawData<unsigned char>(rawFilename, width, height, depth, nrOfComponents, isCompressed, compressedDataSize);
-    } else if(typeName == "MET_FLOAT") {
+        data = readRawData<unsigned char>(mRawFilename, mSize, mNrOfComponents, mIsCompressed, mCompressedDataSize, regionOffset, regionSize);
+    } else if(mTypeName == "MET_FLOAT") {
         type = TYPE_FLOAT;
-        data = readRawData<float>(rawFilename, width, height, depth, nrOfComponents, isCompressed, compressedDataSize);
+        data = readRawData<float>(mRawFilename, mSize, mNrOfComponents, mIsCompressed, mCompressedDataSize, regionOffset, regionSize);
     }
 
-    if(imageIs3D) {
-        output->create(width,height,depth,type,nrOfComponents,getMainDevice(),data);
+    if(mImageIs3D) {
+        output->create(regionSize.x(),regionSize.y(),regionSize.z(),type,mNrOfComponents,getMainDevice(),data);
     } else {
-        output->create(width,height,type,nrOfComponents,getMainDevice(),data);
+        output->create(regionSize.x(),regionSize.y(),type,mNrOfComponents,getMainDevice(),data);
     }
 
-    output->setSpacing(spacing);
+    output->setSpacing(mSpacing);
 
-    // Create transformation
+    // Create transformation. The offset of the region is converted from voxels to mm.
     AffineTransformation::pointer T = AffineTransformation::New();
-    T->translation() = offset;
-    T->linear() = transformMatrix;
+    T->translation() = mOffset + mTransformMatrix*mSpacing.cwiseProduct(regionOffset.cast<float>());
+    T->linear() = mTransformMatrix;
     output->getSceneGraphNode()->setTransformation(T);
 
     // Clean up
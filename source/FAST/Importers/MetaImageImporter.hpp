@@ -9,10 +9,37 @@ class MetaImageImporter : public Importer {
     FAST_OBJECT(MetaImageImporter)
     public:
         void setFilename(std::string filename);
+        /**
+         * Only import the given region (offset and size in voxels) of the image.
+         * For uncompressed raw files, only the bytes of this region are read from disk.
+         * A size of 0 along an axis means the rest of the image along that axis.
+         */
+        void setRegionOfInterest(Vector3ui offset, Vector3ui size);
     private:
         MetaImageImporter();
+        bool setOutputRegion(uint portID, Vector3ui offset, Vector3ui size);
         std::string mFilename;
         void execute();
+        void readHeader();
+        Vector3ui getRegionSize(Vector3ui offset, Vector3ui size) const;
+        bool isValidRegion(Vector3ui offset, Vector3ui size) const;
+
+        bool mRegionOfInterestSet;
+        Vector3ui mRegionOffset;
+        Vector3ui mRegionSize;
+
+        // Header information of mHeaderFilename
+        std::string mHeaderFilename;
+        std::string mRawFilename;
+        std::string mTypeName;
+        bool mImageIs3D;
+        bool mIsCompressed;
+        std::size_t mCompressedDataSize;
+        Vector3ui mSize;
+        uint mNrOfComponents;
+        Vector3f mSpacing;
+        Vector3f mOffset;
+        Matrix3f mTransformMatrix;
 };
 
 } // end namespace fast
@@ -1,5 +1,6 @@
 #include "FAST/Testing.hpp"
 #include "FAST/Importers/MetaImageImporter.hpp"
+#include "FAST/Algorithms/ImageCropper/ImageCropper.hpp"
 #include "FAST/DeviceManager.hpp"
 #include "FAST/Visualization/ImageRenderer/ImageRenderer.hpp"
 #include "FAST/Visualization/SimpleWindow.hpp"
@@ -101,6 +102,141 @@ TEST_CASE("Import MetaImage file to OpenCL device", "[fast][MetaImageImporter]")
     CHECK(image->getDataType() == TYPE_UINT8);
 }
 
+TEST_CASE("Import region of interest of 3D MetaImage file", "[fast][MetaImageImporter]") {
+    MetaImageImporter::pointer importer = MetaImageImporter::New();
+    importer->setFilename(std::string(FAST_TEST_DATA_DIR)+"US/Ball/US-3Dt_0.mhd");
+    importer->setMainDevice(Host::getInstance());
+    importer->update();
+    Image::pointer image = importer->getOutputData<Image>(0);
+
+    MetaImageImporter::pointer roiImporter = MetaImageImporter::New();
+    roiImporter->setFilename(std::string(FAST_TEST_DATA_DIR)+"US/Ball/US-3Dt_0.mhd");
+    roiImporter->setMainDevice(Host::getInstance());
+    roiImporter->setRegionOfInterest(Vector3ui(10, 20, 30), Vector3ui(100, 50, 0));
+    roiImporter->update();
+    Image::pointer roi = roiImporter->getOutputData<Image>(0);
+
+    CHECK(roi->getWidth() == 100);
+    CHECK(roi->getHeight() == 50);
+    CHECK(roi->getDepth() == 170);
+    CHECK(roi->getSpacing().x() == Approx(image->getSpacing().x()));
+
+    // The region must be placed at the same position in world space as in the whole image
+    AffineTransformation::pointer T = image->getSceneGraphNode()->getTransformation();
+    AffineTransformation::pointer roiT = roi->getSceneGraphNode()->getTransformation();
+    Vector3f position = T->linear()*image->getSpacing().cwiseProduct(Vector3f(10, 20, 30)) + T->translation();
+    CHECK(roiT->translation().x() == Approx(position.x()));
+    CHECK(roiT->translation().y() == Approx(position.y()));
+    CHECK(roiT->translation().z() == Approx(position.z()));
+
+    ImageAccess::pointer access = image->getImageAccess(ACCESS_READ);
+    ImageAccess::pointer roiAccess = roi->getImageAccess(ACCESS_READ);
+    uchar* data = (uchar*)access->get();
+    uchar* roiData = (uchar*)roiAccess->get();
+    bool equal = true;
+    for(uint z = 0; z < roi->getDepth(); ++z) {
+    for(uint y = 0; y < roi->getHeight(); ++y) {
+    for(uint x = 0; x < roi->getWidth(); ++x) {
+        uchar expected = data[x + 10 + (y + 20)*image->getWidth() + (z + 30)*image->getWidth()*image->getHeight()];
+        if(roiData[x + y*roi->getWidth() + z*roi->getWidth()*roi->getHeight()] != expected)
+            equal = false;
+    }}}
+    CHECK(equal);
+}
+
+TEST_CASE("MetaImageImporter rejects requested region outside of image", "[fast][MetaImageImporter]") {
+    MetaImageImporter::pointer importer = MetaImageImporter::New();
+    importer->setFilename(std::string(FAST_TEST_DATA_DIR)+"US/Ball/US-3Dt_0.mhd");
+    Vector3ui regionOffset;
+    CHECK(importer->requestRegion(NULL, 0, Vector3ui(0, 0, 100), Vector3ui(0, 0, 2), regionOffset) == true);
+    CHECK(regionOffset == Vector3ui(0, 0, 100));
+    CHECK(importer->requestRegion(NULL, 0, Vector3ui(0, 0, 199), Vector3ui(0, 0, 2), regionOffset) == false);
+    CHECK(importer->requestRegion(NULL, 0, Vector3ui(300, 0, 0), Vector3ui(0, 0, 0), regionOffset) == false);
+    CHECK(regionOffset == Vector3ui::Zero());
+}
+
+// Check that region is equal to the part of image starting at offset
+static bool isRegionOfImage(Image::pointer region, Image::pointer image, Vector3ui offset) {
+    ImageAccess::pointer access = image->getImageAccess(ACCESS_READ);
+    ImageAccess::pointer regionAccess = region->getImageAccess(ACCESS_READ);
+    uchar* data = (uchar*)access->get();
+    uchar* regionData = (uchar*)regionAccess->get();
+    for(uint z = 0; z < region->getDepth(); ++z) {
+    for(uint y = 0; y < region->getHeight(); ++y) {
+    for(uint x = 0; x < region->getWidth(); ++x) {
+        uchar expected = data[x + offset.x() + (y + offset.y())*image->getWidth() + (z + offset.z())*image->getWidth()*image->getHeight()];
+        if(regionData[x + y*region->getWidth() + z*region->getWidth()*region->getHeight()] != expected)
+            return false;
+    }}}
+    return true;
+}
+
+TEST_CASE("MetaImageImporter merges the regions requested by several croppers", "[fast][MetaImageImporter]") {
+    MetaImageImporter::pointer fullImporter = MetaImageImporter::New();
+    fullImporter->setFilename(std::string(FAST_TEST_DATA_DIR)+"US/Ball/US-3Dt_0.mhd");
+    fullImporter->setMainDevice(Host::getInstance());
+    fullImporter->update();
+    Image::pointer image = fullImporter->getOutputData<Image>(0);
+
+    MetaImageImporter::pointer importer = MetaImageImporter::New();
+    importer->setFilename(std::string(FAST_TEST_DATA_DIR)+"US/Ball/US-3Dt_0.mhd");
+    ImageCropper::pointer cropper = ImageCropper::New();
+    cropper->setInputConnection(importer->getOutputPort());
+    cropper->setOffset(Vector3ui(10, 20, 30));
+    cropper->setSize(Vector3ui(40, 30, 20));
+    ImageCropper::pointer cropper2 = ImageCropper::New();
+    cropper2->setInputConnection(importer->getOutputPort());
+    cropper2->setOffset(Vector3ui(60, 40, 100));
+    cropper2->setSize(Vector3ui(30, 30, 30));
+
+    // Update each cropper twice, so that both requests are known by the importer the second time
+    for(int i = 0; i < 2; i++) {
+        cropper->update();
+        cropper2->update();
+        Image::pointer output = cropper->getOutputData<Image>(0);
+        Image::pointer output2 = cropper2->getOutputData<Image>(0);
+        CHECK(output->getWidth() == 40);
+        CHECK(output->getDepth() == 20);
+        CHECK(output2->getWidth() == 30);
+        CHECK(isRegionOfImage(output, image, Vector3ui(10, 20, 30)));
+        CHECK(isRegionOfImage(output2, image, Vector3ui(60, 40, 100)));
+    }
+
+    // The importer produces the bounding box of the two regions
+    Image::pointer region = importer->getOutputData<Image>(0);
+    CHECK(region->getWidth() == 80);
+    CHECK(region->getHeight() == 50);
+    CHECK(region->getDepth() == 100);
+    // The cropper outputs are new images, not the output of the importer
+    Image::pointer output = cropper->getOutputData<Image>(0);
+    CHECK(!(output == region));
+}
+
+TEST_CASE("MetaImageImporter produces the whole image if a consumer has not requested a region", "[fast][MetaImageImporter]") {
+    MetaImageImporter::pointer importer = MetaImageImporter::New();
+    importer->setFilename(std::string(FAST_TEST_DATA_DIR)+"US/Ball/US-3Dt_0.mhd");
+    ImageCropper::pointer cropper = ImageCropper::New();
+    cropper->setInputConnection(importer->getOutputPort());
+    cropper->setOffset(Vector3ui(10, 20, 30));
+    cropper->setSize(Vector3ui(40, 30, 20));
+    {
+        // Has not requested a region, and needs the whole image
+        ImageCropper::pointer otherConsumer = ImageCropper::New();
+        otherConsumer->setInputConnection(importer->getOutputPort());
+
+        cropper->update();
+        Image::pointer image = importer->getOutputData<Image>(0);
+        Image::pointer output = cropper->getOutputData<Image>(0);
+        CHECK(image->getDepth() == 200);
+        CHECK(output->getDepth() == 20);
+    }
+
+    // Without the other consumer, only the region of the cropper is needed
+    cropper->update();
+    Image::pointer image = importer->getOutputData<Image>(0);
+    CHECK(image->getDepth() == 20);
+}
+
 /*
 TEST_CASE("Import compressed raw file with MetaImage", "[fast][MetaImageImporter][visual]") {
     MetaImageImporter::pointer importer = MetaImageImporter::New();
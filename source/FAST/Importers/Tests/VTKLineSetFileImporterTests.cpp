@@ -2,6 +2,7 @@
 #include "FAST/Importers/VTKLineSetFileImporter.hpp"
 #include "FAST/Data/Access/LineSetAccess.hpp"
 #include "FAST/Data/LineSet.hpp"
+#include <fstream>
 
 using namespace fast;
 
@@ -16,3 +17,54 @@ TEST_CASE("VTKLineSetFileImporter", "[fast][VTKLineSetFileImporter]") {
     CHECK(access->getNrOfLines() == 97);
 
 }
+
+TEST_CASE("VTKLineSetFileImporter reads an ASCII file", "[fast][VTKLineSetFileImporter]") {
+    const std::string filename = "VTKLineSetFileImporterASCIITest.vtk";
+    std::ofstream file(filename.c_str());
+    file << "# vtk DataFile Version 3.0\n"
+            "Line set\n"
+            "ASCII\n"
+            "DATASET POLYDATA\n"
+            "POINTS 3 float\n"
+            "0 0 0 1.5 0 0\n"
+            "1.5 -2 0.25\n"
+            "LINES 2 6\n"
+            "2 0 1\n"
+            "2 1 2\n";
+    file.close();
+
+    VTKLineSetFileImporter::pointer importer = VTKLineSetFileImporter::New();
+    importer->setFilename(filename);
+    importer->update();
+    LineSet::pointer lineSet = importer->getOutputData<LineSet>(0);
+
+    LineSetAccess::pointer access = lineSet->getAccess(ACCESS_READ);
+    REQUIRE(access->getNrOfPoints() == 3);
+    REQUIRE(access->getNrOfLines() == 2);
+    CHECK(access->getPoint(2).x() == Approx(1.5));
+    CHECK(access->getPoint(2).y() == Approx(-2));
+    CHECK(access->getPoint(2).z() == Approx(0.25));
+    CHECK(access->getLine(1) == Vector2ui(1, 2));
+}
+
+TEST_CASE("VTKLineSetFileImporter reads a file with no lines", "[fast][VTKLineSetFileImporter]") {
+    const std::string filename = "VTKLineSetFileImporterEmptyTest.vtk";
+    std::ofstream file(filename.c_str());
+    file << "# vtk DataFile Version 3.0\n"
+            "Line set\n"
+            "ASCII\n"
+            "DATASET POLYDATA\n"
+            "POINTS 1 float\n"
+            "1 2 3\n"
+            "LINES 0 0\n";
+    file.close();
+
+    VTKLineSetFileImporter::pointer importer = VTKLineSetFileImporter::New();
+    importer->setFilename(filename);
+    importer->update();
+    LineSet::pointer lineSet = importer->getOutputData<LineSet>(0);
+
+    LineSetAccess::pointer access = lineSet->getAccess(ACCESS_READ);
+    CHECK(access->getNrOfPoints() == 1);
+    CHECK(access->getNrOfLines() == 0);
+}
@@ -1,6 +1,7 @@
 #include "FAST/Testing.hpp"
 #include "FAST/Importers/VTKMeshFileImporter.hpp"
 #include "FAST/Data/Mesh.hpp"
+#include <fstream>
 
 namespace fast {
 
@@ -26,4 +27,56 @@ TEST_CASE("Importer VTK surface from file", "[fast][VTKMeshFileImporter]") {
     CHECK(surface->getNrOfVertices() == 386);
 }
 
+TEST_CASE("Import VTK surface from an ASCII file with normals", "[fast][VTKMeshFileImporter]") {
+    const std::string filename = "VTKMeshFileImporterASCIITest.vtk";
+    std::ofstream file(filename.c_str());
+    file << "# vtk DataFile Version 3.0\n"
+            "Surface\n"
+            "ASCII\n"
+            "DATASET POLYDATA\n"
+            "POINTS 4 float\n"
+            "0 0 1 1 0 0\n"
+            "0 1.5 0 -2.25 1 3\n"
+            "POLYGONS 2 8\n"
+            "3 0 1 2\n"
+            "3 1 2 3\n"
+            "POINT_DATA 4\n"
+            "NORMALS Normals float\n"
+            "1 0 0 0 1 0 0 0 1 0 0 -1\n";
+    file.close();
+
+    VTKMeshFileImporter::pointer importer = VTKMeshFileImporter::New();
+    importer->setFilename(filename);
+    importer->update();
+    Mesh::pointer surface = importer->getOutputData<Mesh>(0);
+    REQUIRE(surface->getNrOfVertices() == 4);
+    REQUIRE(surface->getNrOfTriangles() == 2);
+
+    MeshAccess::pointer access = surface->getMeshAccess(ACCESS_READ);
+    CHECK(access->getVertex(3).getPosition().x() == Approx(-2.25));
+    CHECK(access->getVertex(3).getPosition().z() == Approx(3));
+    CHECK(access->getVertex(3).getNormal().z() == Approx(-1));
+    CHECK(access->getTriangle(1) == Vector3ui(1, 2, 3));
+}
+
+TEST_CASE("Import VTK surface from a file with no triangles", "[fast][VTKMeshFileImporter]") {
+    const std::string filename = "VTKMeshFileImporterEmptyTest.vtk";
+    std::ofstream file(filename.c_str());
+    file << "# vtk DataFile Version 3.0\n"
+            "Surface\n"
+            "ASCII\n"
+            "DATASET POLYDATA\n"
+            "POINTS 1 float\n"
+            "1 2 3\n"
+            "POLYGONS 0 0\n";
+    file.close();
+
+    VTKMeshFileImporter::pointer importer = VTKMeshFileImporter::New();
+    importer->setFilename(filename);
+    importer->update();
+    Mesh::pointer surface = importer->getOutputData<Mesh>(0);
+    CHECK(surface->getNrOfVertices() == 1);
+    CHECK(surface->getNrOfTriangles() == 0);
+}
+
 } // end namespace fast
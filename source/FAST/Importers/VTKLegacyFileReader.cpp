@@ -0,0 +1,498 @@
+#include "VTKLegacyFileReader.hpp"
+#include "FAST/Exception.hpp"
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+namespace fast {
+
+static const double powersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+inline bool isWhitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline bool hostIsLittleEndian() {
+    const unsigned short one = 1;
+    return *((const unsigned char*)&one) == 1;
+}
+
+static std::size_t getSizeOfType(std::string type) {
+    boost::to_lower(type);
+    if(type == "char" || type == "unsigned_char")
+        return 1;
+    if(type == "short" || type == "unsigned_short")
+        return 2;
+    if(type == "int" || type == "unsigned_int" || type == "float")
+        return 4;
+    if(type == "double" || type == "vtktypeint64" || type == "vtktypeuint64")
+        return 8;
+    throw Exception("Unsupported data type " + type + " in VTK file");
+}
+
+// Read a big-endian value of type S from source and convert it to D
+template <class S, class D>
+inline void copyBigEndian(const char* source, D* destination, std::size_t count) {
+    const bool swap = hostIsLittleEndian();
+    unsigned char bytes[sizeof(S)];
+    for(std::size_t i = 0; i < count; ++i) {
+        const char* value = source + i*sizeof(S);
+        for(std::size_t j = 0; j < sizeof(S); ++j)
+            bytes[j] = value[swap ? sizeof(S) - 1 - j : j];
+        S converted;
+        std::memcpy(&converted, bytes, sizeof(S));
+        destination[i] = (D)converted;
+    }
+}
+
+// Parse textual special values such as nan and inf, which are rare, using strtod on a small stack copy
+inline const char* parseSpecialValue(const char* p, const char* end, float* value) {
+    char buffer[32];
+    int length = 0;
+    while(p + length < end && !isWhitespace(p[length]) && length < 31) {
+        buffer[length] = p[length];
+        ++length;
+    }
+    buffer[length] = '\0';
+    char* parsedEnd;
+    const double result = std::strtod(buffer, &parsedEnd);
+    if(parsedEnd != buffer + length || length == 0)
+        return NULL;
+    *value = (float)result;
+    return p + length;
+}
+
+// Parse one floating point number starting at p. Returns the position after the number, or NULL if invalid.
+inline const char* parseToken(const char* p, const char* end, float* value) {
+    const char* start = p;
+    bool negative = false;
+    if(*p == '-' || *p == '+') {
+        negative = *p == '-';
+        ++p;
+    }
+    unsigned long long mantissa = 0;
+    int exponent = 0;
+    int significantDigits = 0;
+    bool foundDigits = false;
+    while(p < end && isDigit(*p)) {
+        if(significantDigits < 19) {
+            mantissa = mantissa*10 + (*p - '0');
+            if(mantissa > 0)
+                ++significantDigits;
+        } else {
+            ++exponent;
+        }
+        foundDigits = true;
+        ++p;
+    }
+    if(p < end && *p == '.') {
+        ++p;
+        while(p < end && isDigit(*p)) {
+            if(significantDigits < 19) {
+                mantissa = mantissa*10 + (*p - '0');
+                if(mantissa > 0)
+                    ++significantDigits;
+                --exponent;
+            }
+            foundDigits = true;
+            ++p;
+        }
+    }
+    if(!foundDigits)
+        return parseSpecialValue(start, end, value);
+    if(p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negativeExponent = false;
+        if(p < end && (*p == '-' || *p == '+')) {
+            negativeExponent = *p == '-';
+            ++p;
+        }
+        if(p >= end || !isDigit(*p))
+            return NULL;
+        int parsedExponent = 0;
+        while(p < end && isDigit(*p)) {
+            if(parsedExponent < 10000)
+                parsedExponent = parsedExponent*10 + (*p - '0');
+            ++p;
+        }
+        exponent += negativeExponent ? -parsedExponent : parsedExponent;
+    }
+    if(p < end && !isWhitespace(*p))
+        return NULL;
+
+    double result = (double)mantissa;
+    if(exponent < 0) {
+        result = exponent >= -22 ? result / powersOfTen[-exponent] : result*std::pow(10.0, exponent);
+    } else if(exponent > 0) {
+        result = exponent <= 22 ? result * powersOfTen[exponent] : result*std::pow(10.0, exponent);
+    }
+    *value = (float)(negative ? -result : result);
+    return p;
+}
+
+// Parse one non-negative integer starting at p. Returns the position after the number, or NULL if invalid.
+inline const char* parseToken(const char* p, const char* end, unsigned int* value) {
+    if(*p == '+')
+        ++p;
+    if(p >= end || !isDigit(*p))
+        return NULL;
+    unsigned long long result = 0;
+    while(p < end && isDigit(*p)) {
+        result = result*10 + (*p - '0');
+        if(result > 0xFFFFFFFFull)
+            return NULL;
+        ++p;
+    }
+    if(p < end && !isWhitespace(*p))
+        return NULL;
+    *value = (unsigned int)result;
+    return p;
+}
+
+inline std::size_t countTokens(const char* p, const char* end) {
+    std::size_t count = 0;
+    bool inToken = false;
+    for(; p < end; ++p) {
+        const bool whitespace = isWhitespace(*p);
+        if(!whitespace && !inToken)
+            ++count;
+        inToken = !whitespace;
+    }
+    return count;
+}
+
+VTKLegacyFileReader::VTKLegacyFileReader(std::string filename) {
+    mFilename = filename;
+    mAttributeCount = 0;
+    try {
+        mFile.open(filename);
+    } catch(std::exception &e) {
+        throw FileNotFoundException(filename);
+    }
+    if(!mFile.is_open())
+        throw FileNotFoundException(filename);
+    mCursor = mFile.data();
+    mEnd = mCursor + mFile.size();
+
+    // Parse header
+    std::string line;
+    if(!readLine(line) || line.find("# vtk DataFile") != 0)
+        throw Exception("The file " + filename + " is not a legacy VTK file");
+    readLine(line); // Title
+    if(!readLine(line))
+        throw Exception("Unexpected end of VTK file " + filename);
+    boost::trim(line);
+    boost::to_upper(line);
+    if(line == "BINARY") {
+        mBinary = true;
+    } else if(line == "ASCII") {
+        mBinary = false;
+    } else {
+        throw Exception("Unknown file type " + line + " in VTK file " + filename + ". Must be ASCII or BINARY.");
+    }
+    std::vector<std::string> tokens;
+    if(!nextKeyword(tokens) || tokens[0] != "DATASET" || tokens.size() < 2)
+        throw Exception("No DATASET found in VTK file " + filename);
+    mDatasetType = tokens[1];
+}
+
+bool VTKLegacyFileReader::isBinary() const {
+    return mBinary;
+}
+
+std::string VTKLegacyFileReader::getDatasetType() const {
+    return mDatasetType;
+}
+
+bool VTKLegacyFileReader::readLine(std::string& line) {
+    if(mCursor >= mEnd)
+        return false;
+    const char* newline = (const char*)std::memchr(mCursor, '\n', mEnd - mCursor);
+    const char* lineEnd = newline == NULL ? mEnd : newline;
+    line.assign(mCursor, lineEnd);
+    if(line.size() > 0 && line[line.size()-1] == '\r')
+        line.erase(line.size()-1);
+    mCursor = newline == NULL ? mEnd : newline + 1;
+    return true;
+}
+
+bool VTKLegacyFileReader::nextKeyword(std::vector<std::string>& tokens) {
+    while(mCursor < mEnd && isWhitespace(*mCursor))
+        ++mCursor;
+    std::string line;
+    if(!readLine(line))
+        return false;
+    boost::trim(line);
+    tokens.clear();
+    boost::split(tokens, line, boost::is_any_of(" \t"), boost::token_compress_on);
+    return true;
+}
+
+std::size_t VTKLegacyFileReader::getCount(const std::vector<std::string>& tokens, unsigned int index) const {
+    if(index >= tokens.size())
+        throw Exception("Malformed " + tokens[0] + " line in VTK file " + mFilename);
+    try {
+        return boost::lexical_cast<std::size_t>(tokens[index]);
+    } catch(boost::bad_lexical_cast &e) {
+        throw Exception("Malformed " + tokens[0] + " line in VTK file " + mFilename);
+    }
+}
+
+void VTKLegacyFileReader::checkRemainingBytes(std::size_t bytes) const {
+    if((std::size_t)(mEnd - mCursor) < bytes)
+        throw Exception("Unexpected end of VTK file " + mFilename);
+}
+
+const char* VTKLegacyFileReader::findEndOfASCIIBlock() const {
+    // The numbers of a section end where a line starts with an upper case keyword
+    const char* lineStart = mCursor;
+    while(lineStart < mEnd) {
+        const char* p = lineStart;
+        while(p < mEnd && (*p == ' ' || *p == '\t' || *p == '\r'))
+            ++p;
+        if(p < mEnd && *p >= 'A' && *p <= 'Z')
+            return lineStart;
+        const char* newline = (const char*)std::memchr(p, '\n', mEnd - p);
+        if(newline == NULL)
+            break;
+        lineStart = newline + 1;
+    }
+    return mEnd;
+}
+
+template <class T>
+void VTKLegacyFileReader::parseASCII(T* destination, std::size_t count) {
+    const char* begin = mCursor;
+    const char* end = findEndOfASCIIBlock();
+    const std::size_t length = end - begin;
+
+    // Split the block into chunks of about 256 KB which end on whitespace, so that no number is split between two chunks
+    const int nrOfChunks = (int)std::max<std::size_t>(1, std::min<std::size_t>(1024, length / (1 << 18)));
+    std::vector<const char*> chunkStart(nrOfChunks + 1);
+    chunkStart[0] = begin;
+    chunkStart[nrOfChunks] = end;
+    for(int i = 1; i < nrOfChunks; ++i) {
+        const char* p = std::max(begin + (length / nrOfChunks)*i, chunkStart[i-1]);
+        while(p < end && !isWhitespace(*p))
+            ++p;
+        chunkStart[i] = p;
+    }
+
+    // First pass: count the numbers in each chunk to find where each chunk should write its output
+    std::vector<std::size_t> chunkOffset(nrOfChunks + 1, 0);
+#pragma omp parallel for
+    for(int i = 0; i < nrOfChunks; ++i) {
+        chunkOffset[i+1] = countTokens(chunkStart[i], chunkStart[i+1]);
+    }
+    for(int i = 0; i < nrOfChunks; ++i)
+        chunkOffset[i+1] += chunkOffset[i];
+    if(chunkOffset[nrOfChunks] != count) {
+        throw Exception("Expected " + boost::lexical_cast<std::string>(count) + " numbers but found " +
+                boost::lexical_cast<std::string>(chunkOffset[nrOfChunks]) + " in VTK file " + mFilename);
+    }
+
+    // Second pass: parse the numbers. Each thread flags its own invalid chunks and the flags are combined afterwards.
+    bool error = false;
+#pragma omp parallel for reduction(||:error)
+    for(int i = 0; i < nrOfChunks; ++i) {
+        const char* p = chunkStart[i];
+        const char* chunkEnd = chunkStart[i+1];
+        T* output = destination + chunkOffset[i];
+        while(true) {
+            while(p < chunkEnd && isWhitespace(*p))
+                ++p;
+            if(p >= chunkEnd)
+                break;
+            p = parseToken(p, chunkEnd, output);
+            if(p == NULL) {
+                error = true;
+                break;
+            }
+            ++output;
+        }
+    }
+    if(error)
+        throw Exception("Invalid number in VTK file " + mFilename);
+
+    mCursor = end;
+}
+
+void VTKLegacyFileReader::readFloats(float* destination, std::size_t count, const std::string& type) {
+    if(!mBinary) {
+        parseASCII(destination, count);
+        return;
+    }
+
+    const std::size_t size = getSizeOfType(type);
+    checkRemainingBytes(count*size);
+    const std::string lowerType = boost::to_lower_copy(type);
+    if(lowerType == "float") {
+        copyBigEndian<float>(mCursor, destination, count);
+    } else if(lowerType == "double") {
+        copyBigEndian<double>(mCursor, destination, count);
+    } else {
+        throw Exception("Expected float or double data in VTK file " + mFilename + ", got " + type);
+    }
+    mCursor += count*size;
+}
+
+void VTKLegacyFileReader::readIntegers(unsigned int* destination, std::size_t count, const std::string& type) {
+    if(!mBinary) {
+        parseASCII(destination, count);
+        return;
+    }
+
+    const std::size_t size = getSizeOfType(type);
+    checkRemainingBytes(count*size);
+    const std::string lowerType = boost::to_lower_copy(type);
+    if(lowerType == "int" || lowerType == "unsigned_int") {
+        copyBigEndian<unsigned int>(mCursor, destination, count);
+    } else if(lowerType == "vtktypeint64" || lowerType == "vtktypeuint64") {
+        copyBigEndian<unsigned long long>(mCursor, destination, count);
+    } else {
+        throw Exception("Expected integer data in VTK file " + mFilename + ", got " + type);
+    }
+    mCursor += count*size;
+}
+
+void VTKLegacyFileReader::readCells(
+        const std::vector<std::string>& keywordTokens,
+        std::vector<unsigned int>& offsets,
+        std::vector<unsigned int>& connectivity
+        ) {
+    const std::size_t nrOfCells = getCount(keywordTokens, 1);
+    const std::size_t size = getCount(keywordTokens, 2);
+
+    // Version 5 files store the cells as two arrays, OFFSETS and CONNECTIVITY
+    const char* p = mCursor;
+    while(p < mEnd && isWhitespace(*p))
+        ++p;
+    if(mEnd - p >= 7 && std::memcmp(p, "OFFSETS", 7) == 0) {
+        std::vector<std::string> tokens;
+        nextKeyword(tokens);
+        if(tokens.size() < 2)
+            throw Exception("Malformed OFFSETS line in VTK file " + mFilename);
+        offsets.resize(nrOfCells); // The number of offsets is the number of cells + 1 in this layout
+        readIntegers(offsets.data(), nrOfCells, tokens[1]);
+        if(!nextKeyword(tokens) || tokens[0] != "CONNECTIVITY" || tokens.size() < 2)
+            throw Exception("Expected CONNECTIVITY after OFFSETS in VTK file " + mFilename);
+        connectivity.resize(size);
+        readIntegers(connectivity.data(), size, tokens[1]);
+        for(std::size_t i = 0; i < offsets.size(); ++i) {
+            if(offsets[i] > size)
+                throw Exception("Invalid cell offsets in VTK file " + mFilename);
+        }
+        return;
+    }
+
+    // Classic layout: each cell is stored as the number of points followed by the point ids
+    std::vector<unsigned int> cells(size);
+    readIntegers(cells.data(), size, "int");
+    offsets.resize(nrOfCells + 1);
+    offsets[0] = 0;
+    connectivity.clear();
+    connectivity.reserve(size > nrOfCells ? size - nrOfCells : 0);
+    std::size_t position = 0;
+    for(std::size_t i = 0; i < nrOfCells; ++i) {
+        if(position >= size || position + 1 + cells[position] > size)
+            throw Exception("Invalid " + keywordTokens[0] + " cell array in VTK file " + mFilename);
+        const unsigned int nrOfPoints = cells[position];
+        connectivity.insert(connectivity.end(), cells.begin() + position + 1, cells.begin() + position + 1 + nrOfPoints);
+        position += nrOfPoints + 1;
+        offsets[i+1] = connectivity.size();
+    }
+}
+
+void VTKLegacyFileReader::skipBytes(std::size_t count, const std::string& type) {
+    const std::size_t bytes = count*getSizeOfType(type);
+    checkRemainingBytes(bytes);
+    mCursor += bytes;
+}
+
+void VTKLegacyFileReader::skipMetaData() {
+    // Meta data is ASCII also in binary files, and ends with an empty line
+    std::string line;
+    while(readLine(line)) {
+        boost::trim(line);
+        if(line.size() == 0)
+            break;
+    }
+}
+
+void VTKLegacyFileReader::skipSection(const std::vector<std::string>& tokens) {
+    const std::string& keyword = tokens[0];
+    if(keyword == "POINT_DATA" || keyword == "CELL_DATA") {
+        mAttributeCount = getCount(tokens, 1);
+        return;
+    }
+
+    if(!mBinary) {
+        // Data of an ASCII section ends where the next keyword begins
+        mCursor = findEndOfASCIIBlock();
+        return;
+    }
+
+    if(keyword == "POINTS") {
+        if(tokens.size() < 3)
+            throw Exception("Malformed POINTS line in VTK file " + mFilename);
+        skipBytes(getCount(tokens, 1)*3, tokens[2]);
+    } else if(keyword == "VERTICES" || keyword == "LINES" || keyword == "POLYGONS" || keyword == "TRIANGLE_STRIPS") {
+        std::vector<unsigned int> offsets, connectivity;
+        readCells(tokens, offsets, connectivity);
+    } else if(keyword == "SCALARS") {
+        if(tokens.size() < 3)
+            throw Exception("Malformed SCALARS line in VTK file " + mFilename);
+        const std::size_t nrOfComponents = tokens.size() > 3 ? getCount(tokens, 3) : 1;
+        std::vector<std::string> lookupTableTokens;
+        if(!nextKeyword(lookupTableTokens) || lookupTableTokens[0] != "LOOKUP_TABLE")
+            throw Exception("Expected LOOKUP_TABLE after SCALARS in VTK file " + mFilename);
+        skipBytes(mAttributeCount*nrOfComponents, tokens[2]);
+    } else if(keyword == "COLOR_SCALARS") {
+        skipBytes(mAttributeCount*getCount(tokens, 2), "unsigned_char");
+    } else if(keyword == "LOOKUP_TABLE") {
+        skipBytes(getCount(tokens, 2)*4, "unsigned_char");
+    } else if(keyword == "VECTORS" || keyword == "NORMALS") {
+        if(tokens.size() < 3)
+            throw Exception("Malformed " + keyword + " line in VTK file " + mFilename);
+        skipBytes(mAttributeCount*3, tokens[2]);
+    } else if(keyword == "TEXTURE_COORDINATES") {
+        if(tokens.size() < 4)
+            throw Exception("Malformed TEXTURE_COORDINATES line in VTK file " + mFilename);
+        skipBytes(mAttributeCount*getCount(tokens, 2), tokens[3]);
+    } else if(keyword == "TENSORS") {
+        if(tokens.size() < 3)
+            throw Exception("Malformed TENSORS line in VTK file " + mFilename);
+        skipBytes(mAttributeCount*9, tokens[2]);
+    } else if(keyword == "FIELD") {
+        const std::size_t nrOfArrays = getCount(tokens, 2);
+        for(std::size_t i = 0; i < nrOfArrays; ++i) {
+            std::vector<std::string> arrayTokens;
+            if(!nextKeyword(arrayTokens))
+                throw Exception("Unexpected end of VTK file " + mFilename);
+            if(arrayTokens[0] == "METADATA") {
+                skipMetaData();
+                if(!nextKeyword(arrayTokens))
+                    throw Exception("Unexpected end of VTK file " + mFilename);
+            }
+            if(arrayTokens.size() < 4)
+                throw Exception("Malformed FIELD array in VTK file " + mFilename);
+            skipBytes(getCount(arrayTokens, 1)*getCount(arrayTokens, 2), arrayTokens[3]);
+        }
+    } else if(keyword == "METADATA") {
+        skipMetaData();
+    } else {
+        throw Exception("Unsupported section " + keyword + " in binary VTK file " + mFilename);
+    }
+}
+
+} // end namespace fast
@@ -0,0 +1,67 @@
+#ifndef VTK_LEGACY_FILE_READER_HPP_
+#define VTK_LEGACY_FILE_READER_HPP_
+
+#include <string>
+#include <vector>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+namespace fast {
+
+/**
+ * Reads the sections of a legacy VTK file (both ASCII and BINARY) directly from a memory mapped file.
+ * ASCII numbers are tokenized and parsed in place by several threads without any string allocation.
+ * BINARY data is stored as big-endian and is byte swapped while it is copied to the destination.
+ *
+ * Usage: call nextKeyword until it returns false, and for each keyword either read its data
+ * with one of the read methods or call skipSection.
+ */
+class VTKLegacyFileReader {
+    public:
+        VTKLegacyFileReader(std::string filename);
+        bool isBinary() const;
+        std::string getDatasetType() const;
+        /**
+         * Move to the next keyword line (e.g. "POINTS 386 float") and split it into tokens.
+         * Returns false when the end of the file has been reached.
+         */
+        bool nextKeyword(std::vector<std::string>& tokens);
+        /**
+         * Read count numbers of the given VTK data type (e.g. float or double) into destination
+         */
+        void readFloats(float* destination, std::size_t count, const std::string& type);
+        void readIntegers(unsigned int* destination, std::size_t count, const std::string& type);
+        /**
+         * Read a cell array section (VERTICES, LINES, POLYGONS or TRIANGLE_STRIPS) into the offset/connectivity form.
+         * Cell i consists of the point ids connectivity[offsets[i]] to connectivity[offsets[i+1]-1].
+         * Both the classic (size prefixed) layout and the OFFSETS/CONNECTIVITY layout of version 5 files are supported.
+         */
+        void readCells(const std::vector<std::string>& keywordTokens, std::vector<unsigned int>& offsets, std::vector<unsigned int>& connectivity);
+        /**
+         * Skip the data of the section with the given keyword tokens
+         */
+        void skipSection(const std::vector<std::string>& keywordTokens);
+        /**
+         * Get the number at position index of a keyword line as a count, e.g. 386 in "POINTS 386 float"
+         */
+        std::size_t getCount(const std::vector<std::string>& tokens, unsigned int index) const;
+    private:
+        bool readLine(std::string& line);
+        void skipBytes(std::size_t count, const std::string& type);
+        void skipMetaData();
+        const char* findEndOfASCIIBlock() const;
+        template <class T>
+        void parseASCII(T* destination, std::size_t count);
+        void checkRemainingBytes(std::size_t bytes) const;
+
+        boost::iostreams::mapped_file_source mFile;
+        std::string mFilename;
+        const char* mCursor;
+        const char* mEnd;
+        bool mBinary;
+        std::string mDatasetType;
+        std::size_t mAttributeCount;
+};
+
+} // end namespace fast
+
+#endif
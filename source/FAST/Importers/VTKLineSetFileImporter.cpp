@@ -1,8 +1,6 @@
 #include "VTKLineSetFileImporter.hpp"
+#include "VTKLegacyFileReader.hpp"
 #include "FAST/Data/LineSet.hpp"
-#include <fstream>
-#include <boost/lexical_cast.hpp>
-#include <boost/algorithm/string.hpp>
 
 namespace fast {
 
@@ -16,88 +14,48 @@ VTKLineSetFileImporter::VTKLineSetFileImporter() {
     mIsModified = true;
 }
 
-inline bool gotoLineWithString(std::ifstream &file, std::string searchFor) {
-    bool found = false;
-    std::string line;
-    while(getline(file, line)) {
-        if(line.find(searchFor) != std::string::npos) {
-            found = true;
-            break;
-        }
-    }
-
-    return found;
-}
-
 void VTKLineSetFileImporter::execute() {
     if(mFilename == "")
         throw Exception("No filename given to the VTKLineSetFileImporter");
 
-    // Try to open file and check that it exists
-    std::ifstream file(mFilename.c_str());
-    std::string line;
-    if(!file.is_open()) {
-        throw FileNotFoundException(mFilename);
-    }
-
-    // Check file header?
+    // Opens the file and parses the header, supports both ASCII and BINARY files
+    VTKLegacyFileReader reader(mFilename);
 
-    // Read vertices
     std::vector<Vector3f> vertices;
-    if(!gotoLineWithString(file, "POINTS")) {
-        throw Exception("Found no points in the VTK file");
-    }
-    while(getline(file, line)) {
-        boost::trim(line);
-        if(line.size() == 0)
-            break;
-
-        if(!(isdigit(line[0]) || line[0] == '-')) {
-            // Has reached end
-            break;
-        }
-
-        std::vector<std::string> tokens;
-        boost::split(tokens, line, boost::is_any_of(" "));
-
-        for(int i = 0; i < tokens.size(); i += 3) {
-            Vector3f v;
-            v(0) = boost::lexical_cast<float>(tokens[i]);
-            v(1) = boost::lexical_cast<float>(tokens[i+1]);
-            v(2) = boost::lexical_cast<float>(tokens[i+2]);
-            vertices.push_back(v);
-        }
-    }
-    file.seekg(0); // set stream to start
-
-    // Read lines
     std::vector<Vector2ui> lines;
-    if(!gotoLineWithString(file, "LINES")) {
-        throw Exception("Found no lines in the VTK file");
-    }
-    while(getline(file, line)) {
-        boost::trim(line);
-        if(line.size() == 0)
-            break;
-
-        if(!(isdigit(line[0]) || line[0] == '-')) {
-            // Has reached end
-            break;
+    bool foundVertices = false;
+    bool foundLines = false;
+    std::vector<std::string> tokens;
+    while(reader.nextKeyword(tokens)) {
+        if(tokens[0] == "POINTS") {
+            // Read vertices
+            if(tokens.size() < 3)
+                throw Exception("Malformed POINTS line in VTK file");
+            vertices.resize(reader.getCount(tokens, 1));
+            if(vertices.size() > 0)
+                reader.readFloats(vertices[0].data(), vertices.size()*3, tokens[2]);
+            foundVertices = true;
+        } else if(tokens[0] == "LINES") {
+            // Read lines
+            std::vector<unsigned int> offsets, connectivity;
+            reader.readCells(tokens, offsets, connectivity);
+            if(!offsets.empty())
+                lines.reserve(offsets.size() - 1);
+            for(std::size_t i = 0; i + 1 < offsets.size(); ++i) {
+                if(offsets[i+1] - offsets[i] != 2) {
+                    throw Exception("Error while reading lines in VTKLineSetFileImporter. Check format.");
+                }
+                lines.push_back(Vector2ui(connectivity[offsets[i]], connectivity[offsets[i]+1]));
+            }
+            foundLines = true;
+        } else {
+            reader.skipSection(tokens);
         }
-
-        std::vector<std::string> tokens;
-        boost::split(tokens, line, boost::is_any_of(" "));
-
-        if(tokens.size() != 3) {
-            throw Exception("Error while reading lines in VTKLineSetFileImporter. Check format.");
-        }
-
-        Vector2ui line;
-        line(0) = boost::lexical_cast<uint>(tokens[1]);
-        line(1) = boost::lexical_cast<uint>(tokens[2]);
-
-        lines.push_back(line);
     }
+    if(!foundVertices)
+        throw Exception("Found no points in the VTK file");
+    if(!foundLines)
+        throw Exception("Found no lines in the VTK file");
 
     // Add data to output
     LineSet::pointer output = getOutputData<LineSet>(0);
@@ -1,7 +1,6 @@
 #include <boost/lexical_cast.hpp>
-#include <boost/algorithm/string.hpp>
-#include <fstream>
 #include "VTKMeshFileImporter.hpp"
+#include "VTKLegacyFileReader.hpp"
 #include "FAST/Data/Mesh.hpp"
 
 namespace fast {
@@ -17,131 +16,72 @@ VTKMeshFileImporter::VTKMeshFileImporter() {
     createOutputPort<Mesh>(0, OUTPUT_STATIC);
 }
 
-inline bool gotoLineWithString(std::ifstream &file, std::string searchFor) {
-    bool found = false;
-    std::string line;
-    while(getline(file, line)) {
-        if(line.find(searchFor) != std::string::npos) {
-            found = true;
-            break;
-        }
-    }
-
-    return found;
-}
-
 void VTKMeshFileImporter::execute() {
     if(mFilename == "")
         throw Exception("No filename given to the VTKMeshFileImporter");
 
-    // Try to open file and check that it exists
-    std::ifstream file(mFilename.c_str());
-    std::string line;
-    if(!file.is_open()) {
-        throw FileNotFoundException(mFilename);
-    }
+    // Opens the file and parses the header, supports both ASCII and BINARY files
+    VTKLegacyFileReader reader(mFilename);
 
-    // Check file header?
-
-    // Read vertices
     std::vector<Vector3f> vertices;
-    if(!gotoLineWithString(file, "POINTS")) {
-        throw Exception("Found no vertices in the VTK surface file");
-    }
-    while(getline(file, line)) {
-        boost::trim(line);
-        if(line.size() == 0)
-            break;
-
-        if(!(isdigit(line[0]) || line[0] == '-')) {
-            // Has reached end
-            break;
-        }
-
-        std::vector<std::string> tokens;
-        boost::split(tokens, line, boost::is_any_of(" "));
-
-        for(int i = 0; i < tokens.size(); i += 3) {
-            Vector3f v;
-            v(0) = boost::lexical_cast<float>(tokens[i]);
-            v(1) = boost::lexical_cast<float>(tokens[i+1]);
-            v(2) = boost::lexical_cast<float>(tokens[i+2]);
-            vertices.push_back(v);
+    std::vector<Vector3f> normals;
+    std::vector<VectorXui> triangles;
+    bool foundVertices = false;
+    bool foundTriangles = false;
+    bool isPointData = false;
+    std::vector<std::string> tokens;
+    while(reader.nextKeyword(tokens)) {
+        const std::string keyword = tokens[0];
+        if(keyword == "POINTS") {
+            // Read vertices directly into the vector, as Vector3f is three packed floats
+            if(tokens.size() < 3)
+                throw Exception("Malformed POINTS line in VTK surface file");
+            vertices.resize(reader.getCount(tokens, 1));
+            if(vertices.size() > 0)
+                reader.readFloats(vertices[0].data(), vertices.size()*3, tokens[2]);
+            foundVertices = true;
+        } else if(keyword == "POLYGONS") {
+            // Read triangles (other types of polygons not supported yet)
+            std::vector<unsigned int> offsets, connectivity;
+            reader.readCells(tokens, offsets, connectivity);
+            if(!offsets.empty())
+                triangles.reserve(offsets.size() - 1);
+            for(std::size_t i = 0; i + 1 < offsets.size(); ++i) {
+                if(offsets[i+1] - offsets[i] != 3) {
+                    throw Exception("The VTKMeshFileImporter currently only supports reading files with triangles. Encountered a non-triangle. Aborting.");
+                }
+                const unsigned int* ids = &connectivity[offsets[i]];
+                triangles.push_back(Vector3ui(ids[0], ids[1], ids[2]));
+            }
+            foundTriangles = true;
+        } else if(keyword == "NORMALS" && isPointData) {
+            if(tokens.size() < 3)
+                throw Exception("Malformed NORMALS line in VTK surface file");
+            normals.resize(vertices.size());
+            if(normals.size() > 0)
+                reader.readFloats(normals[0].data(), normals.size()*3, tokens[2]);
+        } else {
+            if(keyword == "POINT_DATA") {
+                isPointData = true;
+                if(reader.getCount(tokens, 1) != vertices.size()) {
+                    std::string message = "Read different amount of vertices (" + boost::lexical_cast<std::string>(vertices.size()) + ") and point data (" + tokens[1] + ").";
+                    throw Exception(message);
+                }
+            } else if(keyword == "CELL_DATA") {
+                isPointData = false;
+            }
+            reader.skipSection(tokens);
         }
     }
-    file.seekg(0); // set stream to start
 
-    // Read triangles (other types of polygons not supported yet)
-    std::vector<VectorXui> triangles;
-    if(!gotoLineWithString(file, "POLYGONS")) {
+    if(!foundVertices)
+        throw Exception("Found no vertices in the VTK surface file");
+    if(!foundTriangles)
         throw Exception("Found no triangles in the VTK surface file");
-    }
-    while(getline(file, line)) {
-        boost::trim(line);
-        if(line.size() == 0)
-            break;
-
-        if(!isdigit(line[0])) {
-            // Has reached end
-            break;
-        }
 
-
-        std::vector<std::string> tokens;
-        boost::split(tokens, line, boost::is_any_of(" "));
-
-        if(boost::lexical_cast<int>(tokens[0]) != 3) {
-            throw Exception("The VTKMeshFileImporter currently only supports reading files with triangles. Encountered a non-triangle. Aborting.");
-        }
-        if(tokens.size() != 4) {
-            throw Exception("Error while reading triangles in VTKMeshFileImporter. Check format.");
-        }
-
-        Vector3ui triangle;
-        triangle(0) = boost::lexical_cast<uint>(tokens[1]);
-        triangle(1) = boost::lexical_cast<uint>(tokens[2]);
-        triangle(2) = boost::lexical_cast<uint>(tokens[3]);
-
-        triangles.push_back(triangle);
-
-    }
-    file.seekg(0); // set stream to start
-
-    // Read normals (if any)
-    std::vector<Vector3f> normals;
-    if(!gotoLineWithString(file, "NORMALS")) {
+    if(normals.size() == 0) {
         // Create dummy normals
-        for(uint i = 0; i < vertices.size(); i++) {
-            Vector3f dummyNormal;
-            normals.push_back(dummyNormal);
-        }
-    } else {
-        while(getline(file, line)) {
-            boost::trim(line);
-            if(line.size() == 0)
-                break;
-
-            if(!(isdigit(line[0]) || line[0] == '-')) {
-                // Has reached end
-                break;
-            }
-
-            std::vector<std::string> tokens;
-            boost::split(tokens, line, boost::is_any_of(" "));
-
-            for(int i = 0; i < tokens.size(); i += 3) {
-                Vector3f v;
-                v(0) = boost::lexical_cast<float>(tokens[i]);
-                v(1) = boost::lexical_cast<float>(tokens[i+1]);
-                v(2) = boost::lexical_cast<float>(tokens[i+2]);
-                normals.push_back(v);
-            }
-        }
-
-        if(normals.size() != vertices.size()) {
-            std::string message = "Read different amount of vertices (" + boost::lexical_cast<std::string>(vertices.size()) + ") and normals (" + boost::lexical_cast<std::string>(normals.size()) + ").";
-            throw Exception(message);
-        }
+        normals.resize(vertices.size(), Vector3f::Zero());
     }
 
     Mesh::pointer output = getOutputData<Mesh>(0);
@@ -152,5 +92,3 @@ void VTKMeshFileImporter::execute() {
 }
 
 } // end namespace fast
-
-
@@ -1,8 +1,6 @@
 #include "VTKPointSetFileImporter.hpp"
+#include "VTKLegacyFileReader.hpp"
 #include "FAST/Data/PointSet.hpp"
-#include <boost/lexical_cast.hpp>
-#include <boost/algorithm/string.hpp>
-#include <fstream>
 
 namespace fast {
 
@@ -17,58 +15,31 @@ VTKPointSetFileImporter::VTKPointSetFileImporter() {
     createOutputPort<PointSet>(0, OUTPUT_STATIC);
 }
 
-inline bool gotoLineWithString(std::ifstream &file, std::string searchFor) {
-    bool found = false;
-    std::string line;
-    while(getline(file, line)) {
-        if(line.find(searchFor) != std::string::npos) {
-            found = true;
-            break;
-        }
-    }
-
-    return found;
-}
-
 void VTKPointSetFileImporter::execute() {
     if(mFilename == "")
         throw Exception("No filename given to the VTKPointSetFileImporter");
 
-    // Try to open file and check that it exists
-    std::ifstream file(mFilename.c_str());
-    std::string line;
-    if(!file.is_open()) {
-        throw FileNotFoundException(mFilename);
-    }
-
-    // Check file header?
+    // Opens the file and parses the header, supports both ASCII and BINARY files
+    VTKLegacyFileReader reader(mFilename);
 
     // Read vertices
     std::vector<Vector3f> vertices;
-    if(!gotoLineWithString(file, "POINTS")) {
-        throw Exception("Found no vertices in the VTK surface file");
-    }
-    while(getline(file, line)) {
-        boost::trim(line);
-        if(line.size() == 0)
-            break;
-
-        if(!(isdigit(line[0]) || line[0] == '-')) {
-            // Has reached end
-            break;
-        }
-
-        std::vector<std::string> tokens;
-        boost::split(tokens, line, boost::is_any_of(" "));
-
-        for(int i = 0; i < tokens.size(); i += 3) {
-            Vector3f v;
-            v(0) = boost::lexical_cast<float>(tokens[i]);
-            v(1) = boost::lexical_cast<float>(tokens[i+1]);
-            v(2) = boost::lexical_cast<float>(tokens[i+2]);
-            vertices.push_back(v);
+    bool foundVertices = false;
+    std::vector<std::string> tokens;
+    while(reader.nextKeyword(tokens)) {
+        if(tokens[0] == "POINTS") {
+            if(tokens.size() < 3)
+                throw Exception("Malformed POINTS line in VTK file");
+            vertices.resize(reader.getCount(tokens, 1));
+            if(vertices.size() > 0)
+                reader.readFloats(vertices[0].data(), vertices.size()*3, tokens[2]);
+            foundVertices = true;
+            break; // Nothing more to read
         }
+        reader.skipSection(tokens);
     }
+    if(!foundVertices)
+        throw Exception("Found no vertices in the VTK surface file");
 
     // Add data to output
     PointSet::pointer output = getOutputData<PointSet>(0);
@@ -0,0 +1,119 @@
+#include "FAST/KernelSourceRegistry.hpp"
+#include "FAST/Exception.hpp"
+#include "FAST/Paths.hpp"
+#include <boost/unordered_map.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+
+namespace fast {
+
+static boost::mutex registryMutex; // protects the variables below
+static boost::unordered_map<std::string, const EmbeddedKernelSource*> embeddedSourceMap;
+static bool embeddedSourceMapCreated = false;
+static std::string overrideDirectory;
+static bool overrideDirectorySet = false;
+
+static std::string normalizePath(std::string path) {
+    std::string result;
+    result.reserve(path.size());
+    for(std::size_t i = 0; i < path.size(); ++i) {
+        char c = path[i] == '\\' ? '/' : path[i];
+        if(c == '/' && result.size() > 0 && result[result.size()-1] == '/')
+            continue;
+        result += c;
+    }
+    return result;
+}
+
+static std::string readFileFromDisk(std::string filename) {
+    std::ifstream file(filename.c_str(), std::fstream::in);
+    if(file.fail())
+        throw Exception("Failed to open OpenCL source file " + filename);
+
+    std::stringstream stream;
+    stream << file.rdbuf();
+    return stream.str();
+}
+
+std::string KernelSourceRegistry::getRelativePath(std::string filename) {
+    filename = normalizePath(filename);
+    const std::string sourceDir = normalizePath(FAST_SOURCE_DIR);
+    if(filename.compare(0, sourceDir.size(), sourceDir) == 0)
+        filename = filename.substr(sourceDir.size());
+    return filename;
+}
+
+const EmbeddedKernelSource* KernelSourceRegistry::getEmbeddedSource(std::string filename) {
+    boost::lock_guard<boost::mutex> lock(registryMutex);
+    if(!embeddedSourceMapCreated) {
+        for(const EmbeddedKernelSource* it = embeddedKernelSources; it->name != NULL; ++it)
+            embeddedSourceMap[it->name] = it;
+        embeddedSourceMapCreated = true;
+    }
+
+    boost::unordered_map<std::string, const EmbeddedKernelSource*>::const_iterator it = embeddedSourceMap.find(getRelativePath(filename));
+    if(it == embeddedSourceMap.end())
+        return NULL;
+    return it->second;
+}
+
+void KernelSourceRegistry::setOverrideDirectory(std::string directory) {
+    boost::lock_guard<boost::mutex> lock(registryMutex);
+    overrideDirectory = directory;
+    overrideDirectorySet = true;
+}
+
+std::string KernelSourceRegistry::getOverrideDirectory() {
+    boost::lock_guard<boost::mutex> lock(registryMutex);
+    if(overrideDirectorySet)
+        return overrideDirectory;
+    const char* environmentDirectory = std::getenv("FAST_KERNEL_SOURCE_DIR");
+    if(environmentDirectory == NULL)
+        return "";
+    return std::string(environmentDirectory);
+}
+
+std::string KernelSourceRegistry::getOverrideFilename(std::string filename) {
+    std::string directory = getOverrideDirectory();
+    if(directory == "")
+        return "";
+    std::string overrideFilename = directory + "/" + getRelativePath(filename);
+    if(!boost::filesystem::exists(overrideFilename))
+        return "";
+    return overrideFilename;
+}
+
+std::string KernelSourceRegistry::getSource(std::string filename) {
+    std::string overrideFilename = getOverrideFilename(filename);
+    if(overrideFilename != "")
+        return readFileFromDisk(overrideFilename);
+
+    const EmbeddedKernelSource* embeddedSource = getEmbeddedSource(filename);
+    if(embeddedSource != NULL)
+        return std::string(embeddedSource->source, embeddedSource->size);
+
+    return readFileFromDisk(filename);
+}
+
+bool KernelSourceRegistry::exists(std::string filename) {
+    return getOverrideFilename(filename) != "" ||
+            getEmbeddedSource(filename) != NULL ||
+            boost::filesystem::exists(filename);
+}
+
+bool KernelSourceRegistry::isEmbedded(std::string filename) {
+    return getOverrideFilename(filename) == "" && getEmbeddedSource(filename) != NULL;
+}
+
+std::string KernelSourceRegistry::getEmbeddedSourceHash(std::string filename) {
+    const EmbeddedKernelSource* embeddedSource = getEmbeddedSource(filename);
+    if(embeddedSource == NULL)
+        return "";
+    return std::string(embeddedSource->hash);
+}
+
+} // end namespace fast
@@ -0,0 +1,58 @@
+#ifndef KERNEL_SOURCE_REGISTRY_HPP_
+#define KERNEL_SOURCE_REGISTRY_HPP_
+
+#include <string>
+#include <cstddef>
+
+namespace fast {
+
+/**
+ * An OpenCL source file compiled into the library. The list of embedded sources
+ * is generated by EmbedKernelSources.cmake and ends with an entry where name is NULL.
+ */
+struct EmbeddedKernelSource {
+    const char* name; // Path relative to FAST_SOURCE_DIR
+    const char* source;
+    std::size_t size;
+    const char* hash; // SHA1 of the source
+};
+
+// Defined in the generated file EmbeddedKernelSources.cpp
+extern const EmbeddedKernelSource embeddedKernelSources[];
+
+/**
+ * Resolves the OpenCL source files of FAST, so that they don't have to be read from the source tree at runtime.
+ *
+ * A filename is resolved in the following order:
+ * 1. The override directory, if set with setOverrideDirectory or the environment variable FAST_KERNEL_SOURCE_DIR.
+ *    Lets developers edit kernels without rebuilding the library.
+ * 2. The sources embedded in the library. Filenames are given as FAST_SOURCE_DIR + relative path,
+ *    and the relative path is used as key.
+ * 3. The file system, for OpenCL files which are not part of FAST.
+ */
+class KernelSourceRegistry {
+    public:
+        static std::string getSource(std::string filename);
+        static bool exists(std::string filename);
+        /**
+         * Returns true if the source of this file will be taken from the library
+         */
+        static bool isEmbedded(std::string filename);
+        /**
+         * SHA1 of the embedded source, or an empty string if the file is not embedded
+         */
+        static std::string getEmbeddedSourceHash(std::string filename);
+        static void setOverrideDirectory(std::string directory);
+        static std::string getOverrideDirectory();
+        /**
+         * Get the key used for a filename, i.e. the path relative to FAST_SOURCE_DIR with duplicate slashes removed
+         */
+        static std::string getRelativePath(std::string filename);
+    private:
+        static const EmbeddedKernelSource* getEmbeddedSource(std::string filename);
+        static std::string getOverrideFilename(std::string filename);
+};
+
+} // end namespace fast
+
+#endif
@@ -0,0 +1,158 @@
+#include "FAST/OpenCLMemoryPool.hpp"
+#include <boost/thread/lock_guard.hpp>
+#include <sstream>
+
+namespace fast {
+
+static std::string getBufferKey(std::size_t size, cl_mem_flags flags) {
+    std::stringstream key;
+    key << flags << "_" << size;
+    return key.str();
+}
+
+static std::string getImageKey(const cl_image_format& format, std::size_t width, std::size_t height, std::size_t depth, cl_mem_flags flags) {
+    std::stringstream key;
+    key << flags << "_" << format.image_channel_order << "_" << format.image_channel_data_type << "_" <<
+            width << "_" << height << "_" << depth;
+    return key.str();
+}
+
+template <class T>
+static bool takeFreeObject(boost::unordered_map<std::string, std::vector<T> >& objects, std::string key, T* object) {
+    typename boost::unordered_map<std::string, std::vector<T> >::iterator it = objects.find(key);
+    if(it == objects.end() || it->second.empty())
+        return false;
+    *object = it->second.back();
+    it->second.pop_back();
+    return true;
+}
+
+OpenCLMemoryPool::pointer OpenCLMemoryPool::getInstance(OpenCLDevice::pointer device) {
+    static boost::mutex poolsMutex;
+    static boost::unordered_map<OpenCLDevice::pointer, OpenCLMemoryPool::pointer> pools;
+    boost::lock_guard<boost::mutex> lock(poolsMutex);
+    if(pools.count(device) == 0) {
+        OpenCLMemoryPool::pointer pool = OpenCLMemoryPool::New();
+        pool->mContext = device->getContext();
+        // Keep at most a quarter of the device memory in free objects
+        pool->mMaximumFreeMemory = device->getDevice().getInfo<CL_DEVICE_GLOBAL_MEM_SIZE>() / 4;
+        pools[device] = pool;
+    }
+    return pools[device];
+}
+
+OpenCLMemoryPool::OpenCLMemoryPool() {
+    mFreeMemory = 0;
+    mMaximumFreeMemory = 512*1024*1024;
+}
+
+cl::Buffer OpenCLMemoryPool::acquireBuffer(std::size_t size, cl_mem_flags flags) {
+    {
+        boost::lock_guard<boost::mutex> lock(mMutex);
+        cl::Buffer buffer;
+        if(takeFreeObject(mBuffers, getBufferKey(size, flags), &buffer)) {
+            mFreeMemory -= size;
+            return buffer;
+        }
+    }
+    return cl::Buffer(mContext, flags, size);
+}
+
+cl::Image2D OpenCLMemoryPool::acquireImage2D(cl::ImageFormat format, std::size_t width, std::size_t height, cl_mem_flags flags) {
+    {
+        boost::lock_guard<boost::mutex> lock(mMutex);
+        cl::Image2D image;
+        if(takeFreeObject(mImages2D, getImageKey(format, width, height, 1, flags), &image)) {
+            mFreeMemory -= image.getInfo<CL_MEM_SIZE>();
+            return image;
+        }
+    }
+    return cl::Image2D(mContext, flags, format, width, height);
+}
+
+cl::Image3D OpenCLMemoryPool::acquireImage3D(cl::ImageFormat format, std::size_t width, std::size_t height, std::size_t depth, cl_mem_flags flags) {
+    {
+        boost::lock_guard<boost::mutex> lock(mMutex);
+        cl::Image3D image;
+        if(takeFreeObject(mImages3D, getImageKey(format, width, height, depth, flags), &image)) {
+            mFreeMemory -= image.getInfo<CL_MEM_SIZE>();
+            return image;
+        }
+    }
+    return cl::Image3D(mContext, flags, format, width, height, depth);
+}
+
+bool OpenCLMemoryPool::reserveFreeMemory(cl::Memory object) {
+    std::size_t size = object.getInfo<CL_MEM_SIZE>();
+    if(mFreeMemory + size > mMaximumFreeMemory)
+        return false;
+    mFreeMemory += size;
+    return true;
+}
+
+void OpenCLMemoryPool::release(cl::Buffer buffer) {
+    boost::lock_guard<boost::mutex> lock(mMutex);
+    if(!reserveFreeMemory(buffer))
+        return;
+    mBuffers[getBufferKey(buffer.getInfo<CL_MEM_SIZE>(), buffer.getInfo<CL_MEM_FLAGS>())].push_back(buffer);
+}
+
+void OpenCLMemoryPool::release(cl::Image2D image) {
+    boost::lock_guard<boost::mutex> lock(mMutex);
+    if(!reserveFreeMemory(image))
+        return;
+    std::string key = getImageKey(
+            image.getImageInfo<CL_IMAGE_FORMAT>(),
+            image.getImageInfo<CL_IMAGE_WIDTH>(),
+            image.getImageInfo<CL_IMAGE_HEIGHT>(),
+            1,
+            image.getInfo<CL_MEM_FLAGS>()
+    );
+    mImages2D[key].push_back(image);
+}
+
+void OpenCLMemoryPool::release(cl::Image3D image) {
+    boost::lock_guard<boost::mutex> lock(mMutex);
+    if(!reserveFreeMemory(image))
+        return;
+    std::string key = getImageKey(
+            image.getImageInfo<CL_IMAGE_FORMAT>(),
+            image.getImageInfo<CL_IMAGE_WIDTH>(),
+            image.getImageInfo<CL_IMAGE_HEIGHT>(),
+            image.getImageInfo<CL_IMAGE_DEPTH>(),
+            image.getInfo<CL_MEM_FLAGS>()
+    );
+    mImages3D[key].push_back(image);
+}
+
+void OpenCLMemoryPool::setMaximumFreeMemory(std::size_t bytes) {
+    boost::lock_guard<boost::mutex> lock(mMutex);
+    mMaximumFreeMemory = bytes;
+}
+
+std::size_t OpenCLMemoryPool::getFreeMemory() {
+    boost::lock_guard<boost::mutex> lock(mMutex);
+    return mFreeMemory;
+}
+
+uint OpenCLMemoryPool::getNrOfFreeObjects() {
+    boost::lock_guard<boost::mutex> lock(mMutex);
+    uint count = 0;
+    for(boost::unordered_map<std::string, std::vector<cl::Buffer> >::iterator it = mBuffers.begin(); it != mBuffers.end(); ++it)
+        count += it->second.size();
+    for(boost::unordered_map<std::string, std::vector<cl::Image2D> >::iterator it = mImages2D.begin(); it != mImages2D.end(); ++it)
+        count += it->second.size();
+    for(boost::unordered_map<std::string, std::vector<cl::Image3D> >::iterator it = mImages3D.begin(); it != mImages3D.end(); ++it)
+        count += it->second.size();
+    return count;
+}
+
+void OpenCLMemoryPool::clear() {
+    boost::lock_guard<boost::mutex> lock(mMutex);
+    mBuffers.clear();
+    mImages2D.clear();
+    mImages3D.clear();
+    mFreeMemory = 0;
+}
+
+} // end namespace fast
@@ -0,0 +1,62 @@
+#ifndef OPENCL_MEMORY_POOL_HPP_
+#define OPENCL_MEMORY_POOL_HPP_
+
+#include "FAST/Object.hpp"
+#include "FAST/ExecutionDevice.hpp"
+#include "FAST/Data/DataTypes.hpp"
+#include <boost/unordered_map.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace fast {
+
+/**
+ * A pool of OpenCL buffers and images on one device, so that process objects can reuse
+ * temporary memory objects between executions instead of allocating new ones every frame.
+ *
+ * Memory objects are borrowed with the acquire methods and given back with release.
+ * A memory object with the same size, format and flags is returned if one is free.
+ * A released object may be given to another process object while the kernels using it
+ * are still running, so pooled objects should only be used in the command queue of the device,
+ * which executes commands in order.
+ */
+class OpenCLMemoryPool : public Object {
+    FAST_OBJECT(OpenCLMemoryPool)
+    public:
+        /**
+         * Get the pool of a device
+         */
+        static OpenCLMemoryPool::pointer getInstance(OpenCLDevice::pointer device);
+
+        cl::Buffer acquireBuffer(std::size_t size, cl_mem_flags flags = CL_MEM_READ_WRITE);
+        cl::Image2D acquireImage2D(cl::ImageFormat format, std::size_t width, std::size_t height, cl_mem_flags flags = CL_MEM_READ_WRITE);
+        cl::Image3D acquireImage3D(cl::ImageFormat format, std::size_t width, std::size_t height, std::size_t depth, cl_mem_flags flags = CL_MEM_READ_WRITE);
+        void release(cl::Buffer buffer);
+        void release(cl::Image2D image);
+        void release(cl::Image3D image);
+        /**
+         * Free memory objects are deleted instead of kept when the total size of the free objects would exceed this.
+         * Default is a quarter of the global memory of the device.
+         */
+        void setMaximumFreeMemory(std::size_t bytes);
+        std::size_t getFreeMemory();
+        uint getNrOfFreeObjects();
+        /**
+         * Delete all free memory objects
+         */
+        void clear();
+    private:
+        OpenCLMemoryPool();
+        bool reserveFreeMemory(cl::Memory object);
+
+        cl::Context mContext;
+        boost::unordered_map<std::string, std::vector<cl::Buffer> > mBuffers;
+        boost::unordered_map<std::string, std::vector<cl::Image2D> > mImages2D;
+        boost::unordered_map<std::string, std::vector<cl::Image3D> > mImages3D;
+        std::size_t mFreeMemory;
+        std::size_t mMaximumFreeMemory;
+        boost::mutex mMutex;
+};
+
+} // end namespace fast
+
+#endif
@@ -1,8 +1,21 @@
 #include "OpenCLProgram.hpp"
 #include "ExecutionDevice.hpp"
+#include "KernelSourceRegistry.hpp"
 
 namespace fast {
 
+std::string OpenCLDefines::getBuildOptions() const {
+    std::string buildOptions = "";
+    for(std::map<std::string, std::string>::const_iterator it = mDefines.begin(); it != mDefines.end(); ++it) {
+        if(it != mDefines.begin())
+            buildOptions += " ";
+        buildOptions += "-D" + it->first;
+        if(it->second != "")
+            buildOptions += "=" + it->second;
+    }
+    return buildOptions;
+}
+
 void OpenCLProgram::setName(std::string name) {
     mName = name;
 }
@@ -24,19 +37,77 @@ cl::Program OpenCLProgram::build(SharedPointer<OpenCLDevice> device,
     if(mSourceFilename == "")
         throw Exception("No source filename was given to OpenCLProgram. Therefore build operation is not possible.");
 
-    if(buildExists(device, buildOptions))
+    if(buildExists(device, buildOptions)) {
+        markVariantAsUsed(device, buildOptions);
         return mOpenCLPrograms[device][buildOptions];
+    }
+
+    if(!KernelSourceRegistry::exists(mSourceFilename))
+        throw Exception("The OpenCL source file " + mSourceFilename + " was not found in the library or on disk.");
 
     std::string programName = mSourceFilename + buildOptions;
     // Only create program if it doesn't exist for this device from before
     if(!device->hasProgram(programName))
         device->createProgramFromSourceWithName(programName, mSourceFilename, buildOptions);
-    return device->getProgram(programName);
+    cl::Program program = device->getProgram(programName);
+    mOpenCLPrograms[device][buildOptions] = program;
+    markVariantAsUsed(device, buildOptions);
+    return program;
+}
+
+void OpenCLProgram::markVariantAsUsed(SharedPointer<OpenCLDevice> device, std::string buildOptions) {
+    std::list<std::string>& usage = mVariantUsage[device];
+    if(usage.size() > 0 && usage.front() == buildOptions)
+        return;
+    usage.remove(buildOptions);
+    usage.push_front(buildOptions);
+
+    // Remove the least recently used variants from this program only. The device keeps its compiled program,
+    // since other programs and process objects with the same source and build options may share it.
+    while(mMaximumNumberOfVariants > 0 && usage.size() > mMaximumNumberOfVariants) {
+        std::string oldBuildOptions = usage.back();
+        usage.pop_back();
+        mOpenCLPrograms[device].erase(oldBuildOptions);
+        boost::unordered_map<std::pair<std::string, std::string>, cl::Kernel>& kernels = mKernels[device];
+        boost::unordered_map<std::pair<std::string, std::string>, cl::Kernel>::iterator it = kernels.begin();
+        while(it != kernels.end()) {
+            if(it->first.first == oldBuildOptions) {
+                it = kernels.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void OpenCLProgram::setMaximumNumberOfVariants(unsigned int maximum) {
+    mMaximumNumberOfVariants = maximum;
+}
+
+unsigned int OpenCLProgram::getNumberOfVariants(SharedPointer<OpenCLDevice> device) const {
+    if(mOpenCLPrograms.count(device) == 0)
+        return 0;
+    return mOpenCLPrograms.at(device).size();
+}
+
+cl::Kernel OpenCLProgram::getKernel(SharedPointer<OpenCLDevice> device, std::string kernelName, std::string buildOptions) {
+    boost::unordered_map<std::pair<std::string, std::string>, cl::Kernel>& kernels = mKernels[device];
+    std::pair<std::string, std::string> key = std::make_pair(buildOptions, kernelName);
+    boost::unordered_map<std::pair<std::string, std::string>, cl::Kernel>::iterator it = kernels.find(key);
+    if(it != kernels.end()) {
+        markVariantAsUsed(device, buildOptions);
+        return it->second;
+    }
+
+    cl::Kernel kernel(build(device, buildOptions), kernelName.c_str());
+    kernels[key] = kernel;
+    return kernel;
 }
 
 OpenCLProgram::OpenCLProgram() {
     mName = "";
     mSourceFilename = "";
+    mMaximumNumberOfVariants = 0;
 }
 
 bool OpenCLProgram::buildExists(SharedPointer<OpenCLDevice> device,
@@ -45,7 +116,7 @@ bool OpenCLProgram::buildExists(SharedPointer<OpenCLDevice> device,
     if(mOpenCLPrograms.count(device) == 0) {
         hasBuild = false;
     } else {
-        const boost::unordered_map<std::string, cl::Program> programs = mOpenCLPrograms.at(device);
+        const boost::unordered_map<std::string, cl::Program>& programs = mOpenCLPrograms.at(device);
         if(programs.count(buildOptions) == 0)
             hasBuild = false;
     }
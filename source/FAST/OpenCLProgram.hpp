@@ -4,10 +4,14 @@
 #include "Object.hpp"
 #include "SmartPointers.hpp"
 #include <boost/unordered_map.hpp>
+#include <boost/lexical_cast.hpp>
+#include <list>
+#include <map>
 
 namespace cl {
 
 class Program;
+class Kernel;
 
 }
 
@@ -15,6 +19,29 @@ namespace fast {
 
 class OpenCLDevice;
 
+/**
+ * Compile-time constants of a specialized kernel variant. Each constant is given to the
+ * compiler as -DNAME=value, so that loops over it can be unrolled and constant folded.
+ */
+class OpenCLDefines {
+    public:
+        template <class T>
+        OpenCLDefines& set(std::string name, T value) {
+            mDefines[name] = boost::lexical_cast<std::string>(value);
+            return *this;
+        }
+        OpenCLDefines& set(std::string name) {
+            mDefines[name] = "";
+            return *this;
+        }
+        /**
+         * The constants are sorted by name, so that the same constants always give the same build options
+         */
+        std::string getBuildOptions() const;
+    private:
+        std::map<std::string, std::string> mDefines;
+};
+
 class OpenCLProgram : public Object {
     FAST_OBJECT(OpenCLProgram)
     public:
@@ -23,14 +50,33 @@ class OpenCLProgram : public Object {
         void setSourceFilename(std::string filename);
         std::string getSourceFilename() const;
         cl::Program build(SharedPointer<OpenCLDevice>, std::string buildOptions = "");
+        /**
+         * Get a kernel of this program. The kernel object is created the first time and reused
+         * in later calls with the same device, kernel name and build options. Kernel arguments
+         * are kept between calls.
+         */
+        cl::Kernel getKernel(SharedPointer<OpenCLDevice>, std::string kernelName, std::string buildOptions = "");
+        /**
+         * Limit the number of variants (build options) of this program kept for each device.
+         * The least recently used variant is removed from this program when the limit is exceeded. 0 (default) means no limit.
+         * Programs compiled on the device are shared and are not removed from the device.
+         */
+        void setMaximumNumberOfVariants(unsigned int maximum);
+        unsigned int getNumberOfVariants(SharedPointer<OpenCLDevice>) const;
     protected:
         OpenCLProgram();
 
         bool buildExists(SharedPointer<OpenCLDevice>, std::string buildOptions = "") const;
+        void markVariantAsUsed(SharedPointer<OpenCLDevice>, std::string buildOptions);
 
         std::string mName;
         std::string mSourceFilename;
         boost::unordered_map<SharedPointer<OpenCLDevice>, boost::unordered_map<std::string, cl::Program> > mOpenCLPrograms;
+        // Kernels per device, with build options and kernel name as key
+        boost::unordered_map<SharedPointer<OpenCLDevice>, boost::unordered_map<std::pair<std::string, std::string>, cl::Kernel> > mKernels;
+        // Build options of each device, the most recently used first
+        boost::unordered_map<SharedPointer<OpenCLDevice>, std::list<std::string> > mVariantUsage;
+        unsigned int mMaximumNumberOfVariants;
 };
 
 } // end namespace fast
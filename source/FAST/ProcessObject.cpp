@@ -1,15 +1,21 @@
 #include "FAST/ProcessObject.hpp"
 #include "FAST/Exception.hpp"
 #include "FAST/OpenCLProgram.hpp"
+#include "FAST/Data/Image.hpp"
 #include <boost/lexical_cast.hpp>
+#include <boost/chrono.hpp>
+#include <algorithm>
 
 namespace fast {
 
 ProcessObject::ProcessObject() : mIsModified(false), mRuntimeManager(new RuntimeMeasurementsManager) {
      mDevices[0] = DeviceManager::getInstance().getDefaultComputationDevice();
+     mAutomaticDevicePlacement = false;
 }
 
 void ProcessObject::update() {
+    requestInputRegions();
+
     bool aParentHasBeenModified = false;
     // TODO check mInputConnections here instead
     boost::unordered_map<uint, ProcessObjectPort>::iterator it;
@@ -34,15 +40,109 @@ void ProcessObject::update() {
     // If this process object itself has been modified or a parent object (input)
     // has been modified, execute is called
     if(this->mIsModified || aParentHasBeenModified) {
+        std::string placementKey;
+        bool measurePlacement = false;
+        if(mAutomaticDevicePlacement) {
+            placementKey = getDevicePlacementKey();
+            ExecutionDevice::pointer device = mDevicePlacement.getDevice(placementKey);
+            if(!(device == getMainDevice()))
+                setMainDevice(device);
+            measurePlacement = !mDevicePlacement.isDecided(placementKey);
+        }
+
+        // The transfer of the inputs is measured separately, as it depends on where the data is when profiling
+        double transferRuntime = 0;
+        if(measurePlacement)
+            transferRuntime = transferInputData(getMainDevice());
+
         this->mRuntimeManager->startRegularTimer("execute");
+        boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
         // set isModified to false before executing to avoid recursive update calls
         this->mIsModified = false;
         this->preExecute();
         this->execute();
         this->postExecute();
-        if(this->mRuntimeManager->isEnabled())
+        if(this->mRuntimeManager->isEnabled() || measurePlacement)
             this->waitToFinish();
         this->mRuntimeManager->stopRegularTimer("execute");
+
+        if(measurePlacement) {
+            double runtime = boost::chrono::duration<double, boost::milli>(boost::chrono::steady_clock::now() - start).count();
+            mDevicePlacement.addMeasurement(placementKey, runtime, transferRuntime);
+        }
+    }
+}
+
+ProcessObject::~ProcessObject() {
+    boost::unordered_map<uint, ProcessObjectPort>::iterator it;
+    for(it = mInputConnections.begin(); it != mInputConnections.end(); it++)
+        it->second.getProcessObject()->removeOutputConsumer(it->second.getPortID(), this);
+}
+
+bool ProcessObject::requestRegion(const ProcessObject* consumer, uint portID, Vector3ui offset, Vector3ui size, Vector3ui& regionOffset) {
+    mRequestedRegions[portID][consumer] = std::make_pair(offset, size);
+    return setMergedOutputRegion(portID, regionOffset);
+}
+
+bool ProcessObject::setOutputRegion(uint portID, Vector3ui offset, Vector3ui size) {
+    return false;
+}
+
+bool ProcessObject::setMergedOutputRegion(uint portID, Vector3ui& regionOffset) {
+    std::vector<std::pair<Vector3ui, Vector3ui> > regions;
+    boost::unordered_map<const ProcessObject*, std::pair<Vector3ui, Vector3ui> >& requests = mRequestedRegions[portID];
+    boost::unordered_map<const ProcessObject*, std::pair<Vector3ui, Vector3ui> >::iterator it;
+    for(it = requests.begin(); it != requests.end(); it++)
+        regions.push_back(it->second);
+    // Consumers which have not requested a region need the whole image
+    const std::vector<const ProcessObject*>& consumers = mOutputConsumers[portID];
+    for(int i = 0; i < consumers.size(); i++) {
+        if(requests.count(consumers[i]) == 0)
+            regions.push_back(std::make_pair(Vector3ui::Zero().eval(), Vector3ui::Zero().eval()));
+    }
+
+    // Bounding box of the regions, where a size of 0 means the rest of the image
+    Vector3ui offset = Vector3ui::Zero();
+    Vector3ui size = Vector3ui::Zero();
+    for(int axis = 0; axis < 3; axis++) {
+        bool toEnd = false;
+        uint end = 0;
+        for(int i = 0; i < regions.size(); i++) {
+            offset[axis] = i == 0 ? regions[i].first[axis] : std::min(offset[axis], regions[i].first[axis]);
+            if(regions[i].second[axis] == 0) {
+                toEnd = true;
+            } else {
+                end = std::max(end, regions[i].first[axis] + regions[i].second[axis]);
+            }
+        }
+        size[axis] = toEnd ? 0 : end - offset[axis];
+    }
+
+    if(!setOutputRegion(portID, offset, size)) {
+        regionOffset = Vector3ui::Zero();
+        return false;
+    }
+    regionOffset = offset;
+    return true;
+}
+
+void ProcessObject::addOutputConsumer(uint portID, const ProcessObject* consumer) {
+    mOutputConsumers[portID].push_back(consumer);
+    // The new consumer needs the whole image until it requests a region
+    if(mRequestedRegions[portID].size() > 0) {
+        Vector3ui regionOffset;
+        setMergedOutputRegion(portID, regionOffset);
+    }
+}
+
+void ProcessObject::removeOutputConsumer(uint portID, const ProcessObject* consumer) {
+    std::vector<const ProcessObject*>& consumers = mOutputConsumers[portID];
+    std::vector<const ProcessObject*>::iterator it = std::find(consumers.begin(), consumers.end(), consumer);
+    if(it != consumers.end())
+        consumers.erase(it);
+    if(std::find(consumers.begin(), consumers.end(), consumer) == consumers.end() && mRequestedRegions[portID].erase(consumer) > 0) {
+        Vector3ui regionOffset;
+        setMergedOutputRegion(portID, regionOffset);
     }
 }
 
@@ -153,6 +253,95 @@ void ProcessObject::setOutputDataDynamicDependsOnInputData(uint outputNumber, ui
     mOutputDynamicDependsOnInput[outputNumber] = inputNumber;
 }
 
+void ProcessObject::setSplitDevices(std::vector<OpenCLDevice::pointer> devices) {
+    mSplitDevices = devices;
+    mIsModified = true;
+}
+
+std::vector<OpenCLDevice::pointer> ProcessObject::getSplitDevices() const {
+    return mSplitDevices;
+}
+
+void ProcessObject::enableAutomaticDevicePlacement(std::vector<ExecutionDevice::pointer> candidates) {
+    if(candidates.size() == 0) {
+        candidates.push_back(DeviceManager::getInstance().getHostDevice());
+        ExecutionDevice::pointer device = DeviceManager::getInstance().getDefaultComputationDevice();
+        if(!device->isHost())
+            candidates.push_back(device);
+    }
+    std::vector<ExecutionDevice::pointer> supportedCandidates;
+    for(uint i = 0; i < candidates.size(); ++i) {
+        if(isDeviceSupported(candidates[i]))
+            supportedCandidates.push_back(candidates[i]);
+    }
+    if(supportedCandidates.size() == 0)
+        throw Exception("None of the candidate devices for automatic device placement are supported by " + getNameOfClass());
+    mDevicePlacement.setCandidates(supportedCandidates);
+    mAutomaticDevicePlacement = true;
+}
+
+void ProcessObject::disableAutomaticDevicePlacement() {
+    mAutomaticDevicePlacement = false;
+}
+
+bool ProcessObject::isDeviceSupported(ExecutionDevice::pointer device) {
+    return true;
+}
+
+double ProcessObject::transferInputData(ExecutionDevice::pointer device) {
+    boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+    boost::unordered_map<uint, ProcessObjectPort>::iterator it;
+    for(it = mInputConnections.begin(); it != mInputConnections.end(); it++) {
+        DataObject::pointer data = it->second.getData();
+        if(data->isDynamicData()) {
+            data = DynamicData::pointer(data)->getCurrentFrame();
+            if(!data.isValid())
+                continue;
+        }
+        if(data->getNameOfClass() != Image::getStaticNameOfClass())
+            continue;
+        Image::pointer image = data;
+        if(image->isDataUpToDate(device))
+            continue;
+        if(device->isHost()) {
+            ImageAccess::pointer access = image->getImageAccess(ACCESS_READ);
+        } else {
+            OpenCLDevice::pointer clDevice = device;
+            {
+                OpenCLImageAccess::pointer access = image->getOpenCLImageAccess(ACCESS_READ, clDevice);
+            }
+            clDevice->getTransferQueue().finish();
+            clDevice->getCommandQueue().finish();
+        }
+    }
+    return boost::chrono::duration<double, boost::milli>(boost::chrono::steady_clock::now() - start).count();
+}
+
+std::string ProcessObject::getDevicePlacementKey() {
+    std::string key = "";
+    boost::unordered_map<uint, ProcessObjectPort>::iterator it;
+    for(it = mInputConnections.begin(); it != mInputConnections.end(); it++) {
+        DataObject::pointer data = it->second.getData();
+        if(data->isDynamicData()) {
+            data = DynamicData::pointer(data)->getCurrentFrame();
+            if(!data.isValid()) // No frames yet
+                continue;
+        }
+        key += boost::lexical_cast<std::string>(it->first) + ":" + data->getNameOfClass();
+        if(data->getNameOfClass() == Image::getStaticNameOfClass()) {
+            Image::pointer image = data;
+            Vector3ui size = image->getSize();
+            key += "_" + boost::lexical_cast<std::string>(size.x()) + "x" +
+                    boost::lexical_cast<std::string>(size.y()) + "x" +
+                    boost::lexical_cast<std::string>(size.z()) + "_" +
+                    boost::lexical_cast<std::string>((int)image->getDataType()) + "_" +
+                    boost::lexical_cast<std::string>(image->getNrOfComponents());
+        }
+        key += " ";
+    }
+    return key;
+}
+
 void ProcessObject::setMainDeviceCriteria(const DeviceCriteria& criteria) {
     mDeviceCriteria[0] = criteria;
     mDevices[0] = DeviceManager::getInstance().getDevice(criteria);
@@ -170,7 +359,16 @@ void ProcessObject::setInputConnection(ProcessObjectPort port) {
 }
 
 void ProcessObject::setInputConnection(uint connectionID, ProcessObjectPort port) {
+    if(mInputConnections.count(connectionID) > 0) {
+        ProcessObjectPort previousPort = mInputConnections[connectionID];
+        if(previousPort == port) {
+            mInputConnections[connectionID] = port;
+            return;
+        }
+        previousPort.getProcessObject()->removeOutputConsumer(previousPort.getPortID(), this);
+    }
     mInputConnections[connectionID] = port;
+    port.getProcessObject()->addOutputConsumer(port.getPortID(), this);
 }
 
 ProcessObjectPort ProcessObject::getOutputPort() {
@@ -295,4 +493,63 @@ cl::Program ProcessObject::getOpenCLProgram(
     return program->build(device, buildOptions);
 }
 
+cl::Kernel ProcessObject::getOpenCLKernel(
+        OpenCLDevice::pointer device,
+        std::string kernelName,
+        std::string programName,
+        std::string buildOptions
+        ) {
+
+    if(mOpenCLPrograms.count(programName) == 0) {
+        throw Exception("OpenCL program with the name " + programName + " not found in " + getNameOfClass());
+    }
+
+    OpenCLProgram::pointer program = mOpenCLPrograms[programName];
+    return program->getKernel(device, kernelName, buildOptions);
+}
+
+std::string ProcessObject::getSpecializedBuildOptions(const OpenCLDefines& constants, std::string buildOptions) {
+    std::string constantOptions = constants.getBuildOptions();
+    if(buildOptions == "")
+        return constantOptions;
+    if(constantOptions == "")
+        return buildOptions;
+    return buildOptions + " " + constantOptions;
+}
+
+cl::Kernel ProcessObject::getSpecializedOpenCLKernel(
+        OpenCLDevice::pointer device,
+        std::string kernelName,
+        const OpenCLDefines& constants,
+        std::string programName,
+        std::string buildOptions
+        ) {
+    return getOpenCLKernel(device, kernelName, programName, getSpecializedBuildOptions(constants, buildOptions));
+}
+
+void ProcessObject::setMaximumNumberOfOpenCLProgramVariants(uint maximum, std::string programName) {
+    if(mOpenCLPrograms.count(programName) == 0) {
+        throw Exception("OpenCL program with the name " + programName + " not found in " + getNameOfClass());
+    }
+
+    mOpenCLPrograms[programName]->setMaximumNumberOfVariants(maximum);
+}
+
+std::pair<std::string, std::string> ProcessObject::getOpenCLProgramVariant(std::string name, std::string buildOptions) const {
+    if(mOpenCLPrograms.count(name) == 0) {
+        throw Exception("OpenCL program with the name " + name + " not found in " + getNameOfClass());
+    }
+
+    return std::make_pair(mOpenCLPrograms.at(name)->getSourceFilename(), buildOptions);
+}
+
+std::vector<std::pair<std::string, std::string> > ProcessObject::getOpenCLProgramVariants(DataType type, uint dimensions) {
+    std::vector<std::pair<std::string, std::string> > variants;
+    boost::unordered_map<std::string, OpenCLProgram::pointer>::iterator it;
+    for(it = mOpenCLPrograms.begin(); it != mOpenCLPrograms.end(); it++) {
+        variants.push_back(std::make_pair(it->second->getSourceFilename(), std::string("")));
+    }
+    return variants;
+}
+
 } // namespace fast
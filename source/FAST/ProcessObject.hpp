@@ -11,6 +11,8 @@
 #include "FAST/ExecutionDevice.hpp"
 #include "FAST/DeviceManager.hpp"
 #include "FAST/Data/DynamicData.hpp"
+#include "FAST/Data/DataTypes.hpp"
+#include "FAST/DevicePlacement.hpp"
 
 namespace fast {
 
@@ -20,10 +22,11 @@ enum OutputDataType { OUTPUT_STATIC, OUTPUT_DYNAMIC, OUTPUT_DEPENDS_ON_INPUT };
 
 class ProcessObjectPort;
 class OpenCLProgram;
+class OpenCLDefines;
 
 class ProcessObject : public virtual Object {
     public:
-        virtual ~ProcessObject() {};
+        virtual ~ProcessObject();
         void update();
         typedef SharedPointer<ProcessObject> pointer;
 
@@ -40,6 +43,22 @@ class ProcessObject : public virtual Object {
         void setDevice(uint deviceNumber, ExecutionDevice::pointer device);
         void setDeviceCriteria(uint deviceNumber, const DeviceCriteria& criteria);
         ExecutionDevice::pointer getDevice(uint deviceNumber) const;
+        /**
+         * Process objects which support it will split their input image into slabs and process
+         * one slab on each of these OpenCL devices concurrently. See SlabSplitter.
+         * An empty list (default) means that only the main device is used.
+         */
+        void setSplitDevices(std::vector<SharedPointer<OpenCLDevice> > devices);
+        std::vector<SharedPointer<OpenCLDevice> > getSplitDevices() const;
+        /**
+         * Let the process object choose its main device among the candidates by measuring the
+         * runtime, including transfers, on each of them (see DevicePlacement). The choice is
+         * made again when the size or type of the input data changes.
+         * Default candidates are the host and the default computation device. Candidates the
+         * process object doesn't support (see isDeviceSupported) are skipped.
+         */
+        void enableAutomaticDevicePlacement(std::vector<ExecutionDevice::pointer> candidates = std::vector<ExecutionDevice::pointer>());
+        void disableAutomaticDevicePlacement();
 
         template <class DataType>
         void createInputPort(uint portID, bool required = true, InputDataType = INPUT_STATIC_OR_DYNAMIC);
@@ -76,6 +95,27 @@ class ProcessObject : public virtual Object {
         template <class DataType>
         DataObject::pointer getOutputData();
 
+        /**
+         * Request that only a region (offset and size in voxels) of the output image of the given
+         * port is produced for consumer. This is called by downstream process objects, such as ImageCropper
+         * and ImageSlicer, before their inputs are updated. A size of 0 along an axis means the rest of the
+         * image along that axis, so an offset and size of 0 requests the whole image.
+         *
+         * The requests of all process objects connected to the port are merged: the region produced is the
+         * bounding box of their requested regions, and consumers which have not requested a region need the
+         * whole image. Returns true if the next output of the port will be the merged region, and sets
+         * regionOffset to its offset in the whole image. Returns false (default) if the whole image will be produced.
+         */
+        bool requestRegion(const ProcessObject* consumer, uint portID, Vector3ui offset, Vector3ui size, Vector3ui& regionOffset);
+
+        /**
+         * Get the source filenames and build options of the OpenCL programs this process object
+         * uses for input images of the given data type and number of dimensions, so that they can
+         * be compiled in advance with DeviceManager::warmUpOpenCLPrograms. Default is all programs
+         * created with createOpenCLProgram without build options.
+         */
+        virtual std::vector<std::pair<std::string, std::string> > getOpenCLProgramVariants(DataType type, uint dimensions);
+
         bool inputPortExists(uint portID) const;
         bool outputPortExists(uint portID) const;
         virtual std::string getNameOfClass() const = 0;
@@ -93,6 +133,26 @@ class ProcessObject : public virtual Object {
 
         virtual void waitToFinish() {};
 
+        // Called by update before the inputs are updated. Override to request regions from the parents.
+        virtual void requestInputRegions() {};
+        /**
+         * Produce only this region of the output image of the port, merged from the requests of its consumers
+         * (see requestRegion). Returns true if the region is accepted. Default is false, i.e. the whole image.
+         */
+        virtual bool setOutputRegion(uint portID, Vector3ui offset, Vector3ui size);
+
+        /**
+         * Signature of the current input data used by automatic device placement. Default is the
+         * size, data type and number of components of each input image. Where the data is located
+         * is not part of it, as that changes when the candidates are profiled.
+         */
+        virtual std::string getDevicePlacementKey();
+        /**
+         * Whether this process object can execute on the device. Automatic device placement
+         * skips candidates which are not supported. Default is true.
+         */
+        virtual bool isDeviceSupported(ExecutionDevice::pointer device);
+
         RuntimeMeasurementsManagerPtr mRuntimeManager;
 
         void setInputRequired(uint portID, bool required);
@@ -112,6 +172,35 @@ class ProcessObject : public virtual Object {
                 std::string name = "",
                 std::string buildOptions = ""
         );
+        /**
+         * Get a kernel of a program created with createOpenCLProgram. The kernel object is cached,
+         * so use this instead of creating cl::Kernel objects in execute.
+         */
+        cl::Kernel getOpenCLKernel(
+                SharedPointer<OpenCLDevice> device,
+                std::string kernelName,
+                std::string programName = "",
+                std::string buildOptions = ""
+        );
+        /**
+         * Get a kernel variant where the given constants are compile-time constants (see OpenCLDefines).
+         * Use setMaximumNumberOfOpenCLProgramVariants to limit the number of variants kept.
+         */
+        cl::Kernel getSpecializedOpenCLKernel(
+                SharedPointer<OpenCLDevice> device,
+                std::string kernelName,
+                const OpenCLDefines& constants,
+                std::string programName = "",
+                std::string buildOptions = ""
+        );
+        /**
+         * Keep at most this number of variants of a program in this process object on each device, removing the least recently used
+         */
+        void setMaximumNumberOfOpenCLProgramVariants(uint maximum, std::string programName = "");
+        // Build options of a specialized variant, as used by getSpecializedOpenCLKernel
+        static std::string getSpecializedBuildOptions(const OpenCLDefines& constants, std::string buildOptions = "");
+        // Source filename and build options of a program created with createOpenCLProgram
+        std::pair<std::string, std::string> getOpenCLProgramVariant(std::string name = "", std::string buildOptions = "") const;
 
     private:
         void updateTimestamp(DataObject::pointer data);
@@ -120,6 +209,11 @@ class ProcessObject : public virtual Object {
         void postExecute();
         // This fetches output data without creating it
         DataObject::pointer getOutputDataX(uint portID) const;
+        // Make the input images up to date on device, and return the time used in milliseconds
+        double transferInputData(ExecutionDevice::pointer device);
+        void addOutputConsumer(uint portID, const ProcessObject* consumer);
+        void removeOutputConsumer(uint portID, const ProcessObject* consumer);
+        bool setMergedOutputRegion(uint portID, Vector3ui& regionOffset);
 
         boost::unordered_map<uint, bool> mRequiredInputs;
         boost::unordered_map<uint, bool> mReleaseAfterExecute;
@@ -127,6 +221,9 @@ class ProcessObject : public virtual Object {
         boost::unordered_map<uint, ExecutionDevice::pointer> mDevices;
         boost::unordered_map<uint, uint> mOutputDynamicDependsOnInput;
         boost::unordered_map<uint, DeviceCriteria> mDeviceCriteria;
+        std::vector<SharedPointer<OpenCLDevice> > mSplitDevices;
+        bool mAutomaticDevicePlacement;
+        DevicePlacement mDevicePlacement;
 
         // New pipeline
         boost::unordered_map<uint, ProcessObjectPort> mInputConnections;
@@ -137,6 +234,9 @@ class ProcessObject : public virtual Object {
         // Whether the ports accept dynamic, static or any of the two
         boost::unordered_map<uint, InputDataType> mInputPortType;
         boost::unordered_map<uint, OutputDataType> mOutputPortType;
+        // Process objects connected to each output port, and the regions requested by them
+        boost::unordered_map<uint, std::vector<const ProcessObject*> > mOutputConsumers;
+        boost::unordered_map<uint, boost::unordered_map<const ProcessObject*, std::pair<Vector3ui, Vector3ui> > > mRequestedRegions;
 
         boost::unordered_map<std::string, SharedPointer<OpenCLProgram> > mOpenCLPrograms;
 
@@ -1,6 +1,9 @@
 #include "RuntimeMeasurement.hpp"
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <limits>
+#include <cmath>
 
 namespace fast {
 
@@ -8,6 +11,9 @@ RuntimeMeasurement::RuntimeMeasurement(){}
 
 RuntimeMeasurement::RuntimeMeasurement(std::string name) {
 	sum = 0.0f;
+	sumOfSquares = 0.0f;
+	min = std::numeric_limits<double>::max();
+	max = -std::numeric_limits<double>::max();
 	samples = 0;
 	this->name = name;
 }
@@ -15,6 +21,9 @@ RuntimeMeasurement::RuntimeMeasurement(std::string name) {
 void RuntimeMeasurement::addSample(double runtime) {
 	samples++;
 	sum += runtime;
+	sumOfSquares += runtime*runtime;
+	min = std::min(min, runtime);
+	max = std::max(max, runtime);
 }
 
 std::string RuntimeMeasurement::print() const {
@@ -30,7 +39,9 @@ std::string RuntimeMeasurement::print() const {
 	} else {
 		buffer << "Total: " << sum << " ms" << std::endl;
 		buffer << "Average: " << sum / samples << " ms" << std::endl;
-		buffer << "Standard deviation: " << "TODO" << " ms" << std::endl; //TODO
+		buffer << "Standard deviation: " << getStdDeviation() << " ms" << std::endl;
+		buffer << "Min: " << min << " ms" << std::endl;
+		buffer << "Max: " << max << " ms" << std::endl;
 		buffer << "Number of samples: " << samples << std::endl;
 	}
 	buffer << "----------------------------------------------------" << std::endl;
@@ -49,8 +60,23 @@ double RuntimeMeasurement::getAverage() const {
 }
 
 double RuntimeMeasurement::getStdDeviation() const {
-	// TODO: implement
-    return 0.0;
+	if(samples < 2)
+		return 0.0;
+	double average = sum / samples;
+	double variance = (sumOfSquares - samples*average*average) / (samples - 1);
+	return sqrt(std::max(variance, 0.0));
+}
+
+double RuntimeMeasurement::getMin() const {
+	return min;
+}
+
+double RuntimeMeasurement::getMax() const {
+	return max;
+}
+
+unsigned int RuntimeMeasurement::getSamples() const {
+	return samples;
 }
 
 } // end namespace fast
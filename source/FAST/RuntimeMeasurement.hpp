@@ -17,6 +17,9 @@ public:
 	double getSum() const;
 	double getAverage() const;
 	double getStdDeviation() const;
+	double getMin() const;
+	double getMax() const;
+	unsigned int getSamples() const;
 	std::string print() const;
 	virtual ~RuntimeMeasurement() {};
 
@@ -24,6 +27,9 @@ private:
 	RuntimeMeasurement();
 
 	double sum;
+	double sumOfSquares;
+	double min;
+	double max;
 	unsigned int samples;
 	std::string name;
 };
@@ -0,0 +1,98 @@
+#include "FAST/SlabSplitter.hpp"
+#include "FAST/Exception.hpp"
+#include <cstring>
+#include <algorithm>
+
+namespace fast {
+
+void SlabSplitter::getSlab(
+        uint length,
+        uint nrOfSlabs,
+        uint slab,
+        uint halo,
+        uint* start,
+        uint* end,
+        uint* haloStart,
+        uint* haloEnd
+        ) {
+    if(slab >= nrOfSlabs)
+        throw Exception("Slab index out of range in SlabSplitter");
+
+    // Distribute the remainder over the first slabs
+    const uint size = length / nrOfSlabs;
+    const uint remainder = length % nrOfSlabs;
+    *start = slab*size + std::min(slab, remainder);
+    *end = *start + size + (slab < remainder ? 1 : 0);
+    *haloStart = *start > halo ? *start - halo : 0;
+    *haloEnd = std::min(*end + halo, length);
+}
+
+void SlabSplitter::execute(
+        Image::pointer input,
+        Image::pointer output,
+        std::vector<OpenCLDevice::pointer> devices,
+        uint halo,
+        SlabFunction function
+        ) {
+    if(devices.size() == 0)
+        throw Exception("No devices given to SlabSplitter");
+    if(input->getSize() != output->getSize())
+        throw Exception("Input and output of SlabSplitter must have the same size");
+
+    const uint dimensions = input->getDimensions();
+    const uint length = dimensions == 2 ? input->getHeight() : input->getDepth();
+    if(length < devices.size())
+        throw Exception("Image is too small to be split across all devices");
+
+    // Size in bytes of one row (2D) or slice (3D)
+    const std::size_t inputSliceSize = getSizeOfDataType(input->getDataType(), input->getNrOfComponents())*
+            input->getWidth()*(dimensions == 2 ? 1 : input->getHeight());
+    const std::size_t outputSliceSize = getSizeOfDataType(output->getDataType(), output->getNrOfComponents())*
+            output->getWidth()*(dimensions == 2 ? 1 : output->getHeight());
+
+    // Create the input slabs from the host data, and enqueue the work on each device
+    std::vector<Image::pointer> outputSlabs;
+    {
+        ImageAccess::pointer inputAccess = input->getImageAccess(ACCESS_READ);
+        const char* inputData = (const char*)inputAccess->get();
+        for(uint i = 0; i < devices.size(); ++i) {
+            uint start, end, haloStart, haloEnd;
+            getSlab(length, devices.size(), i, halo, &start, &end, &haloStart, &haloEnd);
+            const uint slabLength = haloEnd - haloStart;
+            const char* slabData = inputData + haloStart*inputSliceSize;
+
+            // The explicit 2D/3D create methods are used so that a thin 3D slab is never created as a 2D image
+            Image::pointer inputSlab = Image::New();
+            Image::pointer outputSlab = Image::New();
+            if(dimensions == 2) {
+                inputSlab->create(input->getWidth(), slabLength, input->getDataType(), input->getNrOfComponents(), Host::getInstance(), slabData);
+                outputSlab->create(output->getWidth(), slabLength, output->getDataType(), output->getNrOfComponents());
+            } else {
+                inputSlab->create(input->getWidth(), input->getHeight(), slabLength, input->getDataType(), input->getNrOfComponents(), Host::getInstance(), slabData);
+                outputSlab->create(output->getWidth(), output->getHeight(), slabLength, output->getDataType(), output->getNrOfComponents());
+            }
+            inputSlab->setSpacing(input->getSpacing());
+            outputSlab->setSpacing(output->getSpacing());
+
+            function(inputSlab, outputSlab, devices[i]);
+            outputSlabs.push_back(outputSlab);
+        }
+    }
+
+    // Stitch the interior of each slab into the output
+    ImageAccess::pointer outputAccess = output->getImageAccess(ACCESS_READ_WRITE);
+    char* outputData = (char*)outputAccess->get();
+    for(uint i = 0; i < devices.size(); ++i) {
+        uint start, end, haloStart, haloEnd;
+        getSlab(length, devices.size(), i, halo, &start, &end, &haloStart, &haloEnd);
+        ImageAccess::pointer slabAccess = outputSlabs[i]->getImageAccess(ACCESS_READ);
+        const char* slabData = (const char*)slabAccess->get();
+        std::memcpy(
+                outputData + start*outputSliceSize,
+                slabData + (start - haloStart)*outputSliceSize,
+                (end - start)*outputSliceSize
+        );
+    }
+}
+
+} // end namespace fast
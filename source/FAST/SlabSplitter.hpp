@@ -0,0 +1,49 @@
+#ifndef SLAB_SPLITTER_HPP_
+#define SLAB_SPLITTER_HPP_
+
+#include "FAST/ExecutionDevice.hpp"
+#include "FAST/Data/Image.hpp"
+#include <boost/function.hpp>
+
+namespace fast {
+
+/**
+ * Runs an image filter on several OpenCL devices at once by splitting the image into
+ * slabs along its last axis (z in 3D and y in 2D), one slab per device.
+ *
+ * Each slab is extended with a halo of voxels from its neighbours so that filters which
+ * read a neighbourhood give the same result at the slab borders as on the whole image.
+ * The slab function should only enqueue its work, so that all devices run concurrently.
+ * When all slabs have been enqueued, the interior of each slab is copied to the output.
+ */
+class SlabSplitter {
+    public:
+        typedef boost::function<void (Image::pointer input, Image::pointer output, OpenCLDevice::pointer device)> SlabFunction;
+        /**
+         * Output must already be created with the same size as input.
+         */
+        static void execute(
+                Image::pointer input,
+                Image::pointer output,
+                std::vector<OpenCLDevice::pointer> devices,
+                uint halo,
+                SlabFunction function
+        );
+        /**
+         * Get the interior [start, end) and the range with halo [haloStart, haloEnd) of a slab
+         */
+        static void getSlab(
+                uint length,
+                uint nrOfSlabs,
+                uint slab,
+                uint halo,
+                uint* start,
+                uint* end,
+                uint* haloStart,
+                uint* haloEnd
+        );
+};
+
+} // end namespace fast
+
+#endif
@@ -0,0 +1,352 @@
+#include "IGTLinkServer.hpp"
+#include "FAST/Data/Image.hpp"
+#include "FAST/Data/PointSet.hpp"
+#include "FAST/AffineTransformation.hpp"
+#include "FAST/SceneGraph.hpp"
+#include <boost/lexical_cast.hpp>
+
+#include "igtlImageMessage.h"
+#include "igtlTransformMessage.h"
+#include "igtlPointMessage.h"
+
+namespace fast {
+
+// Milliseconds a send to a client may block before the client is disconnected
+static const int clientSendTimeout = 2000;
+
+void IGTLinkServer::setPort(uint port) {
+    mPort = port;
+    mIsModified = true;
+}
+
+void IGTLinkServer::addInputConnection(ProcessObjectPort port, std::string deviceName) {
+    uint portID = mDeviceNames.size();
+    createInputPort<DataObject>(portID);
+    setInputConnection(portID, port);
+    mDeviceNames.push_back(deviceName);
+    mLastSentData.push_back(0);
+    mLastSentTimestamp.push_back(0);
+}
+
+void IGTLinkServer::setMaximumQueueSize(uint size) {
+    if(size == 0)
+        throw Exception("Maximum queue size of IGTLinkServer must be larger than 0");
+    mMaximumQueueSize = size;
+}
+
+void IGTLinkServer::setMaximumBatchSize(uint size) {
+    if(size == 0)
+        throw Exception("Maximum batch size of IGTLinkServer must be larger than 0");
+    mMaximumBatchSize = size;
+}
+
+uint IGTLinkServer::getNrOfClients() {
+    boost::lock_guard<boost::mutex> lock(mClientsMutex);
+    uint count = 0;
+    for(uint i = 0; i < mClients.size(); i++) {
+        boost::lock_guard<boost::mutex> clientLock(mClients[i]->mutex);
+        if(mClients[i]->connected)
+            count++;
+    }
+    return count;
+}
+
+uint IGTLinkServer::getNrOfSentFrames() const {
+    return mNrOfSentFrames.load();
+}
+
+uint IGTLinkServer::getNrOfDroppedFrames() const {
+    return mNrOfDroppedFrames.load();
+}
+
+IGTLinkServer::IGTLinkServer() {
+    mPort = 0;
+    mMaximumQueueSize = 1;
+    mMaximumBatchSize = 16;
+    mNrOfSentFrames = 0;
+    mNrOfDroppedFrames = 0;
+    mAcceptThread = NULL;
+    mServerIsStarted = false;
+    mStop = false;
+    mIsModified = true;
+}
+
+IGTLinkServer::~IGTLinkServer() {
+    stop();
+}
+
+void IGTLinkServer::stop() {
+    {
+        boost::lock_guard<boost::mutex> lock(mStopMutex);
+        mStop = true;
+    }
+    if(mAcceptThread != NULL) {
+        mAcceptThread->join();
+        delete mAcceptThread;
+        mAcceptThread = NULL;
+    }
+
+    std::vector<boost::shared_ptr<Client> > clients;
+    {
+        boost::lock_guard<boost::mutex> lock(mClientsMutex);
+        clients = mClients;
+        mClients.clear();
+    }
+    for(uint i = 0; i < clients.size(); i++) {
+        {
+            boost::lock_guard<boost::mutex> lock(clients[i]->mutex);
+            clients[i]->stop = true;
+        }
+        clients[i]->condition.notify_one();
+        clients[i]->thread->join();
+        delete clients[i]->thread;
+    }
+
+    if(mServerSocket.IsNotNull())
+        mServerSocket->CloseSocket();
+    mServerIsStarted = false;
+}
+
+void IGTLinkServer::acceptConnections() {
+    while(true) {
+        {
+            boost::lock_guard<boost::mutex> lock(mStopMutex);
+            if(mStop)
+                break;
+        }
+
+        // Wait a short time so that the stop flag is checked regularly
+        igtl::Socket::Pointer socket = mServerSocket->WaitForConnection(200);
+
+        boost::lock_guard<boost::mutex> lock(mClientsMutex);
+        // Remove clients which have disconnected
+        for(int i = mClients.size() - 1; i >= 0; i--) {
+            bool connected;
+            {
+                boost::lock_guard<boost::mutex> clientLock(mClients[i]->mutex);
+                connected = mClients[i]->connected;
+            }
+            if(!connected) {
+                mClients[i]->thread->join();
+                delete mClients[i]->thread;
+                mClients.erase(mClients.begin() + i);
+            }
+        }
+
+        if(socket.IsNotNull()) {
+            reportInfo() << "New client connected to IGTLinkServer" << reportEnd();
+            // A send which blocks longer than the timeout fails, so that the send thread can always be joined
+            socket->SetSendTimeout(clientSendTimeout);
+            boost::shared_ptr<Client> client(new Client);
+            client->socket = socket;
+            client->connected = true;
+            client->stop = false;
+            client->thread = new boost::thread(boost::bind(&IGTLinkServer::sendToClient, this, client));
+            mClients.push_back(client);
+        }
+    }
+}
+
+void IGTLinkServer::sendToClient(boost::shared_ptr<Client> client) {
+    std::vector<igtl::MessageBase::Pointer> batch;
+    std::vector<char> buffer;
+    while(true) {
+        batch.clear();
+        {
+            boost::unique_lock<boost::mutex> lock(client->mutex);
+            while(client->queue.empty() && !client->stop)
+                client->condition.wait(lock);
+            if(client->stop)
+                break;
+            while(!client->queue.empty() && batch.size() < mMaximumBatchSize) {
+                batch.push_back(client->queue.front().second);
+                client->queue.pop_front();
+            }
+        }
+
+        // Concatenate the packed messages so that the whole batch is sent with one call
+        std::size_t size = 0;
+        for(uint i = 0; i < batch.size(); i++)
+            size += batch[i]->GetPackSize();
+        buffer.resize(size);
+        std::size_t offset = 0;
+        for(uint i = 0; i < batch.size(); i++) {
+            memcpy(&buffer[offset], batch[i]->GetPackPointer(), batch[i]->GetPackSize());
+            offset += batch[i]->GetPackSize();
+        }
+        if(client->socket->Send(&buffer[0], size) == 0) {
+            reportInfo() << "Client disconnected from IGTLinkServer, or did not receive data for " << clientSendTimeout << " ms" << reportEnd();
+            break;
+        }
+        mNrOfSentFrames += batch.size();
+    }
+    client->socket->CloseSocket();
+    boost::lock_guard<boost::mutex> lock(client->mutex);
+    client->connected = false;
+}
+
+void IGTLinkServer::enqueue(std::string deviceName, igtl::MessageBase::Pointer message) {
+    boost::lock_guard<boost::mutex> clientsLock(mClientsMutex);
+    for(uint i = 0; i < mClients.size(); i++) {
+        boost::shared_ptr<Client> client = mClients[i];
+        {
+            boost::lock_guard<boost::mutex> lock(client->mutex);
+            if(!client->connected)
+                continue;
+
+            // Latest frame wins: drop the oldest frame of this device if the client has not kept up
+            uint count = 0;
+            std::deque<std::pair<std::string, igtl::MessageBase::Pointer> >::iterator oldest = client->queue.end();
+            std::deque<std::pair<std::string, igtl::MessageBase::Pointer> >::iterator it;
+            for(it = client->queue.begin(); it != client->queue.end(); it++) {
+                if(it->first == deviceName) {
+                    if(count == 0)
+                        oldest = it;
+                    count++;
+                }
+            }
+            if(count >= mMaximumQueueSize) {
+                client->queue.erase(oldest);
+                mNrOfDroppedFrames++;
+            }
+            client->queue.push_back(std::make_pair(deviceName, message));
+        }
+        client->condition.notify_one();
+    }
+}
+
+inline void setTimestamp(igtl::MessageBase::Pointer message, DataObject::pointer data) {
+    igtl::TimeStamp::Pointer timestamp = igtl::TimeStamp::New();
+    if(data->getCreationTimestamp() > 0) {
+        timestamp->SetTime(data->getCreationTimestamp() / 1000.0); // convert from milliseconds
+    } else {
+        timestamp->GetTime(); // Set to current time
+    }
+    message->SetTimeStamp(timestamp);
+}
+
+inline igtl::MessageBase::Pointer createIGTLImageMessage(Image::pointer image) {
+    int scalarType;
+    switch(image->getDataType()) {
+        case TYPE_UINT8:
+            scalarType = igtl::ImageMessage::TYPE_UINT8;
+            break;
+        case TYPE_INT8:
+            scalarType = igtl::ImageMessage::TYPE_INT8;
+            break;
+        case TYPE_UINT16:
+            scalarType = igtl::ImageMessage::TYPE_UINT16;
+            break;
+        case TYPE_INT16:
+            scalarType = igtl::ImageMessage::TYPE_INT16;
+            break;
+        case TYPE_FLOAT:
+            scalarType = igtl::ImageMessage::TYPE_FLOAT32;
+            break;
+        default:
+            throw Exception("Unsupported image data type given to IGTLinkServer");
+    }
+
+    int size[3] = {(int)image->getWidth(), (int)image->getHeight(), (int)image->getDepth()};
+    float spacing[3] = {image->getSpacing().x(), image->getSpacing().y(), image->getSpacing().z()};
+    int offset[3] = {0, 0, 0};
+    igtl::ImageMessage::Pointer message = igtl::ImageMessage::New();
+    message->SetDimensions(size);
+    message->SetSpacing(spacing);
+    message->SetNumComponents(image->getNrOfComponents());
+    message->SetScalarType(scalarType);
+    message->SetSubVolume(size, offset);
+
+    // Position and orientation from the scene graph
+    AffineTransformation::pointer T = SceneGraph::getAffineTransformationFromData(image);
+    igtl::Matrix4x4 matrix;
+    for(int i = 0; i < 4; i++) {
+    for(int j = 0; j < 4; j++) {
+        matrix[i][j] = T->matrix()(i,j);
+    }}
+    message->SetMatrix(matrix);
+    message->AllocateScalars();
+
+    ImageAccess::pointer access = image->getImageAccess(ACCESS_READ);
+    memcpy(message->GetScalarPointer(), access->get(), message->GetImageSize());
+
+    return message;
+}
+
+inline igtl::MessageBase::Pointer createIGTLTransformMessage(AffineTransformation::pointer transform) {
+    igtl::Matrix4x4 matrix;
+    for(int i = 0; i < 4; i++) {
+    for(int j = 0; j < 4; j++) {
+        matrix[i][j] = transform->matrix()(i,j);
+    }}
+
+    igtl::TransformMessage::Pointer message = igtl::TransformMessage::New();
+    message->SetMatrix(matrix);
+
+    return message;
+}
+
+inline igtl::MessageBase::Pointer createIGTLPointMessage(PointSet::pointer points) {
+    AffineTransformation::pointer T = SceneGraph::getAffineTransformationFromData(points);
+    PointSetAccess::pointer access = points->getAccess(ACCESS_READ);
+    igtl::PointMessage::Pointer message = igtl::PointMessage::New();
+    for(uint i = 0; i < points->getNrOfPoints(); i++) {
+        Vector3f position = T->multiply(access->getPoint(i));
+        igtl::PointElement::Pointer element = igtl::PointElement::New();
+        element->SetName(boost::lexical_cast<std::string>(i).c_str());
+        element->SetPosition(position.x(), position.y(), position.z());
+        message->AddPointElement(element);
+    }
+
+    return message;
+}
+
+void IGTLinkServer::execute() {
+    if(mPort == 0)
+        throw Exception("Must call setPort before executing the IGTLinkServer.");
+
+    if(!mServerIsStarted) {
+        mServerSocket = igtl::ServerSocket::New();
+        if(mServerSocket->CreateServer(mPort) < 0)
+            throw Exception("Unable to create IGTLinkServer on port " + boost::lexical_cast<std::string>(mPort));
+        mStop = false;
+        mServerIsStarted = true;
+        mAcceptThread = new boost::thread(boost::bind(&IGTLinkServer::acceptConnections, this));
+    }
+
+    for(uint i = 0; i < mDeviceNames.size(); i++) {
+        DataObject::pointer data = getStaticInputData<DataObject>(i);
+
+        // Skip frames which have already been sent, e.g. when a static input has not changed
+        std::size_t dataPointer = (std::size_t)data.getPtr().get();
+        if(mLastSentData[i] == dataPointer && mLastSentTimestamp[i] == data->getTimestamp())
+            continue;
+        mLastSentData[i] = dataPointer;
+        mLastSentTimestamp[i] = data->getTimestamp();
+
+        // No need to create messages when nobody is listening
+        if(getNrOfClients() == 0)
+            continue;
+
+        igtl::MessageBase::Pointer message;
+        Image::pointer image = boost::dynamic_pointer_cast<Image>(data.getPtr());
+        AffineTransformation::pointer transform = boost::dynamic_pointer_cast<AffineTransformation>(data.getPtr());
+        PointSet::pointer points = boost::dynamic_pointer_cast<PointSet>(data.getPtr());
+        if(image.isValid()) {
+            message = createIGTLImageMessage(image);
+        } else if(transform.isValid()) {
+            message = createIGTLTransformMessage(transform);
+        } else if(points.isValid()) {
+            message = createIGTLPointMessage(points);
+        } else {
+            throw Exception("Unsupported data " + data->getNameOfClass() + " given to IGTLinkServer. Only Image, AffineTransformation and PointSet can be sent.");
+        }
+        message->SetDeviceName(mDeviceNames[i].c_str());
+        setTimestamp(message, data);
+        // Pack once here, the packed message is shared by all clients
+        message->Pack();
+        enqueue(mDeviceNames[i], message);
+    }
+}
+
+} // end namespace fast
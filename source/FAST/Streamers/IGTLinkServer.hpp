@@ -0,0 +1,95 @@
+#ifndef IGTLINK_SERVER_HPP
+#define IGTLINK_SERVER_HPP
+
+#include <boost/thread.hpp>
+#include <boost/shared_ptr.hpp>
+#include <deque>
+#include <atomic>
+#include "FAST/ProcessObject.hpp"
+#include "igtlServerSocket.h"
+#include "igtlMessageBase.h"
+
+namespace fast {
+
+/**
+ * Sends frames of Image, AffineTransformation and PointSet data to all clients
+ * connected to an OpenIGTLink server socket.
+ *
+ * Each client has its own send thread and queue, and the messages waiting in a
+ * queue are sent together in batches. If a client is slower than the pipeline,
+ * the oldest frames of a device are dropped (latest frame wins), so the
+ * pipeline is never blocked by the network. A client which has not received any
+ * data for 2 seconds is disconnected, so that stop never waits for a stalled client.
+ */
+class IGTLinkServer : public ProcessObject {
+    FAST_OBJECT(IGTLinkServer)
+    public:
+        void setPort(uint port);
+        /**
+         * Send the frames of the given port to the clients with the given device name
+         */
+        void addInputConnection(ProcessObjectPort port, std::string deviceName);
+        /**
+         * Maximum number of frames per device name waiting to be sent to a client.
+         * When the queue is full, the oldest frame is dropped. Default is 1, which
+         * means that only the newest frame is sent to slow clients.
+         */
+        void setMaximumQueueSize(uint size);
+        /**
+         * Maximum number of messages sent to a client in one batch. Default is 16.
+         */
+        void setMaximumBatchSize(uint size);
+        uint getNrOfClients();
+        uint getNrOfSentFrames() const;
+        uint getNrOfDroppedFrames() const;
+        void stop();
+        ~IGTLinkServer();
+    private:
+        IGTLinkServer();
+        void execute();
+
+        class Client {
+            public:
+                igtl::Socket::Pointer socket;
+                boost::thread* thread;
+                boost::mutex mutex;
+                boost::condition_variable condition;
+                std::deque<std::pair<std::string, igtl::MessageBase::Pointer> > queue;
+                bool connected;
+                bool stop;
+        };
+
+        /**
+         * These methods run in separate threads. One for accepting new clients
+         * and one per client for sending the queued messages.
+         */
+        void acceptConnections();
+        void sendToClient(boost::shared_ptr<Client> client);
+
+        void enqueue(std::string deviceName, igtl::MessageBase::Pointer message);
+
+        uint mPort;
+        uint mMaximumQueueSize;
+        uint mMaximumBatchSize;
+        // Updated by the send threads and read by the pipeline
+        std::atomic<uint> mNrOfSentFrames;
+        std::atomic<uint> mNrOfDroppedFrames;
+
+        std::vector<std::string> mDeviceNames;
+        // Used to avoid sending the same frame several times
+        std::vector<std::size_t> mLastSentData;
+        std::vector<unsigned long> mLastSentTimestamp;
+
+        igtl::ServerSocket::Pointer mServerSocket;
+        boost::thread* mAcceptThread;
+        bool mServerIsStarted;
+        bool mStop;
+        boost::mutex mStopMutex;
+
+        std::vector<boost::shared_ptr<Client> > mClients;
+        boost::mutex mClientsMutex;
+};
+
+} // end namespace fast
+
+#endif
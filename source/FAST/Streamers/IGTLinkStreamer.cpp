@@ -1,7 +1,6 @@
 #include "IGTLinkStreamer.hpp"
 #include "FAST/Data/Image.hpp"
 #include "FAST/AffineTransformation.hpp"
-#include <boost/shared_array.hpp>
 #include <boost/lexical_cast.hpp>
 
 #include "igtlOSUtil.h"
@@ -9,6 +8,7 @@
 #include "igtlTransformMessage.h"
 #include "igtlPositionMessage.h"
 #include "igtlImageMessage.h"
+#include "igtl_image.h"
 #include "igtlStatusMessage.h"
 #include "igtlStringMessage.h"
 
@@ -42,11 +42,15 @@ uint IGTLinkStreamer::getNrOfFrames() const {
     return mNrOfFrames;
 }
 
-inline Image::pointer createFASTImageFromMessage(igtl::ImageMessage::Pointer message, ExecutionDevice::pointer device) {
-    Image::pointer image = Image::New();
-    int width, height, depth;
-    message->GetDimensions(width, height, depth);
-    void* data = message->GetScalarPointer();
+void IGTLinkStreamer::enableCRCCheck() {
+    mCRCCheck = true;
+}
+
+void IGTLinkStreamer::disableCRCCheck() {
+    mCRCCheck = false;
+}
+
+inline DataType getDataTypeFromMessage(igtl::ImageMessage::Pointer message) {
     DataType type;
     switch(message->GetScalarType()) {
         case igtl::ImageMessage::TYPE_INT8:
@@ -68,17 +72,14 @@ inline Image::pointer createFASTImageFromMessage(igtl::ImageMessage::Pointer mes
             throw Exception("Unsupported image data type.");
             break;
     }
+    return type;
+}
 
-    if(depth == 1) {
-        image->create(width, height, type, message->GetNumComponents(), device, data);
-    } else {
-        image->create(width, height, depth, type, message->GetNumComponents(), device, data);
-    }
-
-    boost::shared_array<float> spacing(new float[3]);
-    boost::shared_array<float> offset(new float[3]);
-    message->GetSpacing(spacing.get());
-    message->GetOrigin(offset.get());
+inline void setImageMetadataFromMessage(Image::pointer image, igtl::ImageMessage::Pointer message) {
+    float spacing[3];
+    float offset[3];
+    message->GetSpacing(spacing);
+    message->GetOrigin(offset);
     igtl::Matrix4x4 matrix;
     message->GetMatrix(matrix);
     image->setSpacing(Vector3f(spacing[0], spacing[1], spacing[2]));
@@ -91,11 +92,88 @@ inline Image::pointer createFASTImageFromMessage(igtl::ImageMessage::Pointer mes
     }}
     T->linear() = fastMatrix;
     image->getSceneGraphNode()->setTransformation(T);
+}
+
+inline Image::pointer createFASTImageFromMessage(igtl::ImageMessage::Pointer message, ExecutionDevice::pointer device) {
+    Image::pointer image = Image::New();
+    int width, height, depth;
+    message->GetDimensions(width, height, depth);
+    void* data = message->GetScalarPointer();
+    DataType type = getDataTypeFromMessage(message);
+
+    if(depth == 1) {
+        image->create(width, height, type, message->GetNumComponents(), device, data);
+    } else {
+        image->create(width, height, depth, type, message->GetNumComponents(), device, data);
+    }
+
+    setImageMetadataFromMessage(image, message);
+
+    return image;
+}
+
+Image::pointer IGTLinkStreamer::receiveImage(igtl::MessageHeader::Pointer header) {
+    mImageMessage->SetMessageHeader(header);
+    mImageMessage->AllocatePack(); // Reuses the buffer of the previous message if it had the same size
+    unsigned char* body = (unsigned char*)mImageMessage->GetPackBodyPointer();
+
+    if(mCRCCheck) {
+        // The CRC covers the entire body, so it has to be received into the message buffer and then copied to the image.
+        // Only the path below, used when the CRC check is disabled, receives directly into the image.
+        mSocket->Receive(body, mImageMessage->GetPackBodySize());
+        int c = mImageMessage->Unpack(1);
+        if(!(c & igtl::MessageHeader::UNPACK_BODY)) // CRC check failed
+            return Image::pointer();
+        return createFASTImageFromMessage(mImageMessage, getMainDevice());
+    }
+
+    // Receive and unpack only the image header first
+    mSocket->Receive(body, IGTL_IMAGE_HEADER_SIZE);
+    const std::size_t pixelDataSize = (std::size_t)mImageMessage->GetPackBodySize() - IGTL_IMAGE_HEADER_SIZE;
+    int c = mImageMessage->Unpack(0);
+    if(!(c & igtl::MessageHeader::UNPACK_BODY)) {
+        mSocket->Receive(body + IGTL_IMAGE_HEADER_SIZE, pixelDataSize);
+        return Image::pointer();
+    }
+    int width, height, depth;
+    mImageMessage->GetDimensions(width, height, depth);
+    DataType type = getDataTypeFromMessage(mImageMessage);
+    uint nrOfComponents = mImageMessage->GetNumComponents();
+    const std::size_t imageSize = (std::size_t)getSizeOfDataType(type, nrOfComponents)*width*height*depth;
+    if(pixelDataSize != imageSize) {
+        // Message does not contain the entire image (e.g. a sub volume), receive it the regular way
+        mSocket->Receive(body + IGTL_IMAGE_HEADER_SIZE, pixelDataSize);
+        return createFASTImageFromMessage(mImageMessage, getMainDevice());
+    }
+
+    // Receive the pixels directly into the host memory of the output image
+    Image::pointer image = Image::New();
+    if(depth == 1) {
+        image->create(width, height, type, nrOfComponents);
+    } else {
+        image->create(width, height, depth, type, nrOfComponents);
+    }
+    ImageAccess::pointer access = image->getImageAccess(ACCESS_READ_WRITE);
+    mSocket->Receive(access->get(), pixelDataSize);
+    access->release();
 
+    setImageMetadataFromMessage(image, mImageMessage);
 
     return image;
 }
 
+void IGTLinkStreamer::addLatencySample(igtl::TimeStamp::Pointer senderTimestamp) {
+    if(!mRuntimeManager->isEnabled())
+        return;
+
+    // Time from the sender created the message until the frame was added, in milliseconds.
+    // Only meaningful if the clocks of the sender and receiver are synchronized, e.g. on loopback.
+    igtl::TimeStamp::Pointer now = igtl::TimeStamp::New();
+    now->GetTime();
+    mRuntimeManager->getTiming("receive latency")->addSample(
+            (now->GetTimeStamp() - senderTimestamp->GetTimeStamp())*1000.0);
+}
+
 void IGTLinkStreamer::updateFirstFrameSetFlag() {
     // Check that all output ports have got their first frame
     bool allHaveGotData = true;
@@ -190,21 +268,18 @@ void IGTLinkStreamer::producerStream() {
                 mInFreezeMode = false;
             }
             statusMessageCounter = 0;
-            igtl::TransformMessage::Pointer transMsg;
-            transMsg = igtl::TransformMessage::New();
-            transMsg->SetMessageHeader(headerMsg);
-            transMsg->AllocatePack();
+            mTransformMessage->SetMessageHeader(headerMsg);
+            mTransformMessage->AllocatePack();
             // Receive transform data from the socket
-            mSocket->Receive(transMsg->GetPackBodyPointer(), transMsg->GetPackBodySize());
+            mSocket->Receive(mTransformMessage->GetPackBodyPointer(), mTransformMessage->GetPackBodySize());
             // Deserialize the transform data
-            // If you want to skip CRC check, call Unpack() without argument.
-            int c = transMsg->Unpack(1);
+            int c = mTransformMessage->Unpack(mCRCCheck ? 1 : 0);
 
 
             if(c & igtl::MessageHeader::UNPACK_BODY) { // if CRC check is OK
                 // Retrive the transform data
                 igtl::Matrix4x4 matrix;
-                transMsg->GetMatrix(matrix);
+                mTransformMessage->GetMatrix(matrix);
                 Matrix4f fastMatrix;
                 for(int i = 0; i < 4; i++) {
                 for(int j = 0; j < 4; j++) {
@@ -224,6 +299,7 @@ void IGTLinkStreamer::producerStream() {
                     T->matrix() = fastMatrix;
                     T->setCreationTimestamp(timestamp);
                     ptr->addFrame(T);
+                    addLatencySample(ts);
                 } catch(NoMoreFramesException &e) {
                     throw e;
                 } catch(Exception &e) {
@@ -243,30 +319,8 @@ void IGTLinkStreamer::producerStream() {
             statusMessageCounter = 0;
             reportInfo() << "Receiving IMAGE data type." << Reporter::end;
 
-            // Create a message buffer to receive transform data
-            igtl::ImageMessage::Pointer imgMsg;
-            imgMsg = igtl::ImageMessage::New();
-            imgMsg->SetMessageHeader(headerMsg);
-            imgMsg->AllocatePack();
-
-            // Receive transform data from the socket
-            mSocket->Receive(imgMsg->GetPackBodyPointer(), imgMsg->GetPackBodySize());
-
-            // Deserialize the transform data
-            // If you want to skip CRC check, call Unpack() without argument.
-            int c = imgMsg->Unpack(1);
-            if(c & igtl::MessageHeader::UNPACK_BODY) { // if CRC check is OK
-                // Retrive the image data
-                int size[3]; // image dimension
-                float spacing[3]; // spacing (mm/pixel)
-                int svsize[3]; // sub-volume size
-                int svoffset[3]; // sub-volume offset
-                int scalarType; // scalar type
-                scalarType = imgMsg->GetScalarType();
-                imgMsg->GetDimensions(size);
-                imgMsg->GetSpacing(spacing);
-                imgMsg->GetSubVolume(svsize, svoffset);
-
+            Image::pointer image = receiveImage(headerMsg);
+            if(image.isValid()) { // if CRC check is OK
                 DynamicData::pointer ptr;
                 try {
                      ptr = getOutputDataFromDeviceName<Image>(headerMsg->GetDeviceName());
@@ -276,9 +330,9 @@ void IGTLinkStreamer::producerStream() {
                     continue;
                 }
                 try {
-                    Image::pointer image = createFASTImageFromMessage(imgMsg, getMainDevice());
                     image->setCreationTimestamp(timestamp);
                     ptr->addFrame(image);
+                    addLatencySample(ts);
                 } catch(NoMoreFramesException &e) {
                     throw e;
                 } catch(Exception &e) {
@@ -294,13 +348,9 @@ void IGTLinkStreamer::producerStream() {
             ++statusMessageCounter;
             reportInfo() << "STATUS MESSAGE recieved" << Reporter::end;
             // Receive generic message
-            igtl::MessageBase::Pointer message;
-            message = igtl::MessageBase::New();
-            message->SetMessageHeader(headerMsg);
-            message->AllocatePack();
-
-            // Receive transform data from the socket
-            mSocket->Receive(message->GetPackBodyPointer(), message->GetPackBodySize());
+            mGenericMessage->SetMessageHeader(headerMsg);
+            mGenericMessage->AllocatePack();
+            mSocket->Receive(mGenericMessage->GetPackBodyPointer(), mGenericMessage->GetPackBodySize());
             if(statusMessageCounter > 3 && !mInFreezeMode) {
                 reportInfo() << "3 STATUS MESSAGE received, freeze detected" << Reporter::end;
                 mInFreezeMode = true;
@@ -317,18 +367,10 @@ void IGTLinkStreamer::producerStream() {
                 }
             }
        } else {
-           // Receive generic message
-          igtl::MessageBase::Pointer message;
-          message = igtl::MessageBase::New();
-          message->SetMessageHeader(headerMsg);
-          message->AllocatePack();
-
-          // Receive transform data from the socket
-          mSocket->Receive(message->GetPackBodyPointer(), message->GetPackBodySize());
-
-          // Deserialize the transform data
-          // If you want to skip CRC check, call Unpack() without argument.
-          int c = message->Unpack();
+           // Receive and discard generic message
+           mGenericMessage->SetMessageHeader(headerMsg);
+           mGenericMessage->AllocatePack();
+           mSocket->Receive(mGenericMessage->GetPackBodyPointer(), mGenericMessage->GetPackBodySize());
        }
     }
     // Make sure we end the waiting thread if first frame has not been inserted
@@ -363,6 +405,10 @@ IGTLinkStreamer::IGTLinkStreamer() {
     mPort = 0;
     mMaximumNrOfFramesSet = false;
     mInFreezeMode = false;
+    mCRCCheck = true;
+    mImageMessage = igtl::ImageMessage::New();
+    mTransformMessage = igtl::TransformMessage::New();
+    mGenericMessage = igtl::MessageBase::New();
     setMaximumNumberOfFrames(50); // Set default maximum number of frames to 50
 }
 
@@ -7,10 +7,24 @@
 #include "FAST/SmartPointers.hpp"
 #include "FAST/Streamers/Streamer.hpp"
 #include "FAST/ProcessObject.hpp"
+#include "FAST/Data/Image.hpp"
 #include "igtlClientSocket.h"
+#include "igtlMessageHeader.h"
+#include "igtlTimeStamp.h"
+#include "igtlImageMessage.h"
+#include "igtlTransformMessage.h"
 
 namespace fast {
 
+/**
+ * Receives image and transform messages from an OpenIGTLink server.
+ *
+ * When runtime measurements are enabled, the time from each message was sent until its
+ * frame was added to the output is recorded in getRuntime("receive latency").
+ *
+ * Images are copied from the message to the output image unless the CRC check is
+ * disabled with disableCRCCheck, see enableCRCCheck.
+ */
 class IGTLinkStreamer : public Streamer, public ProcessObject {
     FAST_OBJECT(IGTLinkStreamer)
     public:
@@ -20,6 +34,13 @@ class IGTLinkStreamer : public Streamer, public ProcessObject {
         void setMaximumNumberOfFrames(uint nrOfFrames);
         bool hasReachedEnd() const;
         uint getNrOfFrames() const;
+        /**
+         * The CRC of each received message is checked by default. Disabling the check
+         * saves a pass over each message, and lets images be received directly
+         * into the host memory of the output image instead of being copied.
+         */
+        void enableCRCCheck();
+        void disableCRCCheck();
 
         template<class T>
         ProcessObjectPort getOutputPort(std::string deviceName);
@@ -60,17 +81,25 @@ class IGTLinkStreamer : public Streamer, public ProcessObject {
         bool mHasReachedEnd;
         bool mStop;
         bool mInFreezeMode;
+        bool mCRCCheck;
 
         std::string mAddress;
         uint mPort;
 
         igtl::ClientSocket::Pointer mSocket;
 
+        // Receive buffers which are reused for all messages of the same type
+        igtl::ImageMessage::Pointer mImageMessage;
+        igtl::TransformMessage::Pointer mTransformMessage;
+        igtl::MessageBase::Pointer mGenericMessage;
+
         boost::unordered_map<std::string, uint> mOutputPortDeviceNames;
 
         template <class T>
         DynamicData::pointer getOutputDataFromDeviceName(std::string deviceName);
         void updateFirstFrameSetFlag();
+        Image::pointer receiveImage(igtl::MessageHeader::Pointer header);
+        void addLatencySample(igtl::TimeStamp::Pointer senderTimestamp);
 };
 
 
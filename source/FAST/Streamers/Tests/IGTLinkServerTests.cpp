@@ -0,0 +1,58 @@
+#include "FAST/Testing.hpp"
+#include "FAST/Streamers/IGTLinkServer.hpp"
+#include "FAST/Streamers/IGTLinkStreamer.hpp"
+#include "FAST/Streamers/ImageFileStreamer.hpp"
+#include "FAST/Tests/DummyObjects.hpp"
+#include "FAST/Data/Image.hpp"
+
+using namespace fast;
+
+TEST_CASE("No port given to IGTLinkServer throws exception", "[IGTLinkServer][fast][IGTLink]") {
+    IGTLinkServer::pointer server = IGTLinkServer::New();
+    CHECK_THROWS(server->update());
+}
+
+TEST_CASE("Zero queue or batch size given to IGTLinkServer throws exception", "[IGTLinkServer][fast][IGTLink]") {
+    IGTLinkServer::pointer server = IGTLinkServer::New();
+    CHECK_THROWS(server->setMaximumQueueSize(0));
+    CHECK_THROWS(server->setMaximumBatchSize(0));
+}
+
+inline void updateServer(IGTLinkServer::pointer server, int iterations) {
+    for(int i = 0; i < iterations; i++) {
+        server->update();
+        boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+    }
+}
+
+TEST_CASE("Stream 2D images from IGTLinkServer to IGTLinkStreamer", "[IGTLinkServer][fast][IGTLink]") {
+    ImageFileStreamer::pointer fileStreamer = ImageFileStreamer::New();
+    fileStreamer->setFilenameFormat(std::string(FAST_TEST_DATA_DIR) + "US/CarotidArtery/Right/US-2D_#.mhd");
+    fileStreamer->setStreamingMode(STREAMING_MODE_PROCESS_ALL_FRAMES);
+
+    IGTLinkServer::pointer server = IGTLinkServer::New();
+    server->setPort(18947);
+    server->addInputConnection(fileStreamer->getOutputPort(), "FASTImage");
+    server->update(); // Starts the server
+
+    // Run the pipeline of the server in a separate thread while the client receives
+    boost::thread serverThread(boost::bind(&updateServer, server, 100));
+
+    IGTLinkStreamer::pointer streamer = IGTLinkStreamer::New();
+    streamer->setConnectionAddress("localhost");
+    streamer->setConnectionPort(18947);
+    ProcessObjectPort port = streamer->getOutputPort<Image>("FASTImage");
+    streamer->update();
+
+    DynamicData::pointer data = port.getData();
+    DummyProcessObject::pointer dummy = DummyProcessObject::New();
+    for(int i = 0; i < 3; i++) {
+        Image::pointer image = data->getNextFrame(dummy);
+        CHECK(image->getDimensions() == 2);
+        CHECK(image->getWidth() > 0);
+    }
+    streamer->stop();
+    serverThread.join();
+    CHECK(server->getNrOfSentFrames() >= 3);
+    server->stop();
+}
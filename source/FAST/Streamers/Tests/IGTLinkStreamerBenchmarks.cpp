@@ -0,0 +1,72 @@
+#include "SyntheticIGTLServer.hpp"
+#include "FAST/Testing.hpp"
+#include "FAST/Streamers/IGTLinkStreamer.hpp"
+#include "FAST/AffineTransformation.hpp"
+#include "FAST/Reporter.hpp"
+#include <boost/chrono.hpp>
+
+using namespace fast;
+
+/**
+ * Stream synthetic frames over loopback to an IGTLinkStreamer and report the
+ * receive throughput, number of dropped frames and the latency from each message
+ * was sent until its frame was added to the output of the streamer.
+ */
+static void benchmarkIGTLinkStreamer(uint port, uint width, uint height, uint depth, uint nrOfFrames, uint fps, uint transformsPerImage, bool crcCheck) {
+    SyntheticIGTLServer server;
+    server.setPort(port);
+    server.setImageSize(width, height, depth);
+    server.setNrOfFrames(nrOfFrames);
+    server.setFramesPerSecond(fps);
+    server.setTransformsPerImage(transformsPerImage);
+    server.start();
+
+    IGTLinkStreamer::pointer streamer = IGTLinkStreamer::New();
+    streamer->setConnectionAddress("localhost");
+    streamer->setConnectionPort(port);
+    streamer->setStreamingMode(STREAMING_MODE_NEWEST_FRAME_ONLY);
+    streamer->enableRuntimeMeasurements();
+    if(!crcCheck)
+        streamer->disableCRCCheck();
+    streamer->getOutputPort<Image>("DummyImage");
+    if(transformsPerImage > 0)
+        streamer->getOutputPort<AffineTransformation>("DummyTransform");
+
+    boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+    streamer->update();
+    server.wait();
+
+    // Wait for the remaining frames, which are either in the socket buffer or lost
+    const uint nrOfSentFrames = server.getNrOfSentImages() + server.getNrOfSentTransforms();
+    boost::chrono::steady_clock::time_point timeout = boost::chrono::steady_clock::now() + boost::chrono::seconds(2);
+    while(streamer->getNrOfFrames() < nrOfSentFrames && boost::chrono::steady_clock::now() < timeout)
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(1));
+    double seconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+    streamer->stop();
+
+    const uint nrOfReceivedFrames = streamer->getNrOfFrames();
+    Reporter::info() << "Frames sent: " << nrOfSentFrames << ", received: " << nrOfReceivedFrames <<
+            ", dropped: " << nrOfSentFrames - nrOfReceivedFrames << Reporter::end;
+    Reporter::info() << "Throughput: " << nrOfReceivedFrames / seconds << " frames/s, " <<
+            server.getNrOfSentBytes() / (seconds*1024*1024) << " MB/s" << Reporter::end;
+    Reporter::info() << streamer->getRuntime("receive latency")->print() << Reporter::end;
+
+    // The newest frame only mode may drop frames when the machine is busy, so drops are only reported
+    CHECK(nrOfReceivedFrames > 0);
+}
+
+TEST_CASE("IGTLinkStreamer throughput of 2D images", "[fast][benchmark][IGTLink]") {
+    benchmarkIGTLinkStreamer(18950, 512, 512, 1, 500, 0, 0, true);
+}
+
+TEST_CASE("IGTLinkStreamer throughput of 2D images without CRC check", "[fast][benchmark][IGTLink]") {
+    benchmarkIGTLinkStreamer(18951, 512, 512, 1, 500, 0, 0, false);
+}
+
+TEST_CASE("IGTLinkStreamer throughput of 3D images", "[fast][benchmark][IGTLink]") {
+    benchmarkIGTLinkStreamer(18952, 128, 128, 128, 50, 0, 0, true);
+}
+
+TEST_CASE("IGTLinkStreamer latency of 2D images and transforms at 30 fps", "[fast][benchmark][IGTLink]") {
+    benchmarkIGTLinkStreamer(18953, 512, 512, 1, 150, 30, 2, true);
+}
@@ -4,6 +4,7 @@
 #include "FAST/Visualization/ImageRenderer/ImageRenderer.hpp"
 #include "FAST/Visualization/SimpleWindow.hpp"
 #include "FAST/Algorithms/AddTransformation/AddTransformation.hpp"
+#include "FAST/Tests/DummyObjects.hpp"
 
 using namespace fast;
 
@@ -32,3 +33,55 @@ TEST_CASE("Stream 2D images using IGTLinkStreamer", "[IGTLinkStreamer][fast][IGT
     window->setTimeout(5000);
     CHECK_NOTHROW(window->start());
 }
+
+// Pixel data of the first frames received from a dummy server streaming the carotid artery images
+static std::vector<std::vector<uchar> > receiveFrames(uint port, bool crcCheck, int nrOfFrames) {
+    ImageFileStreamer::pointer fileStreamer = ImageFileStreamer::New();
+    fileStreamer->setFilenameFormat(std::string(FAST_TEST_DATA_DIR) + "US/CarotidArtery/Right/US-2D_#.mhd");
+    fileStreamer->setStreamingMode(STREAMING_MODE_PROCESS_ALL_FRAMES);
+    DummyIGTLServer server;
+    server.setImageStreamer(fileStreamer);
+    server.setPort(port);
+    server.start();
+
+    IGTLinkStreamer::pointer streamer = IGTLinkStreamer::New();
+    streamer->setConnectionAddress("localhost");
+    streamer->setConnectionPort(port);
+    streamer->setStreamingMode(STREAMING_MODE_PROCESS_ALL_FRAMES);
+    if(crcCheck) {
+        streamer->enableCRCCheck();
+    } else {
+        streamer->disableCRCCheck();
+    }
+    ProcessObjectPort imagePort = streamer->getOutputPort<Image>("DummyImage");
+    streamer->getOutputPort<AffineTransformation>("DummyTransform");
+    streamer->update();
+
+    DynamicData::pointer data = imagePort.getData();
+    DummyProcessObject::pointer dummy = DummyProcessObject::New();
+    std::vector<std::vector<uchar> > frames;
+    for(int i = 0; i < nrOfFrames; i++) {
+        Image::pointer image = data->getNextFrame(dummy);
+        CHECK(image->getWidth() > 0);
+        CHECK(image->getHeight() > 0);
+        CHECK(image->getDimensions() == 2);
+        const size_t size = image->getWidth()*image->getHeight()*getSizeOfDataType(image->getDataType(), image->getNrOfComponents());
+        ImageAccess::pointer access = image->getImageAccess(ACCESS_READ);
+        const uchar* pixels = (const uchar*)access->get();
+        frames.push_back(std::vector<uchar>(pixels, pixels + size));
+    }
+    streamer->stop();
+    return frames;
+}
+
+TEST_CASE("Stream 2D images using IGTLinkStreamer without CRC check", "[IGTLinkStreamer][fast][IGTLink]") {
+    // Images are received directly into the host memory of the frames without the CRC check,
+    // and copied from the message with it. Both must give the same pixels.
+    std::vector<std::vector<uchar> > framesWithCRCCheck = receiveFrames(18945, true, 5);
+    std::vector<std::vector<uchar> > framesWithoutCRCCheck = receiveFrames(18948, false, 5);
+    for(int i = 0; i < 5; i++) {
+        INFO("Frame " << i);
+        CHECK(framesWithoutCRCCheck[i].size() == framesWithCRCCheck[i].size());
+        CHECK(framesWithoutCRCCheck[i] == framesWithCRCCheck[i]);
+    }
+}
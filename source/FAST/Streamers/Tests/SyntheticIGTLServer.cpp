@@ -0,0 +1,132 @@
+#include "SyntheticIGTLServer.hpp"
+#include "FAST/Exception.hpp"
+#include "igtlImageMessage.h"
+#include "igtlTransformMessage.h"
+#include "igtlTimeStamp.h"
+#include <boost/chrono.hpp>
+
+namespace fast {
+
+SyntheticIGTLServer::SyntheticIGTLServer() {
+    mPort = 18946;
+    mFPS = 0;
+    mWidth = 512;
+    mHeight = 512;
+    mDepth = 1;
+    mNrOfFrames = 100;
+    mTransformsPerImage = 0;
+    mNrOfSentImages = 0;
+    mNrOfSentTransforms = 0;
+    mNrOfSentBytes = 0;
+}
+
+SyntheticIGTLServer::~SyntheticIGTLServer() {
+    wait();
+}
+
+void SyntheticIGTLServer::wait() {
+    if(mThread.joinable())
+        mThread.join();
+}
+
+void SyntheticIGTLServer::setPort(uint port) {
+    mPort = port;
+}
+
+void SyntheticIGTLServer::setFramesPerSecond(uint fps) {
+    mFPS = fps;
+}
+
+void SyntheticIGTLServer::setImageSize(uint width, uint height, uint depth) {
+    mWidth = width;
+    mHeight = height;
+    mDepth = depth;
+}
+
+void SyntheticIGTLServer::setNrOfFrames(uint nrOfFrames) {
+    mNrOfFrames = nrOfFrames;
+}
+
+void SyntheticIGTLServer::setTransformsPerImage(uint transforms) {
+    mTransformsPerImage = transforms;
+}
+
+uint SyntheticIGTLServer::getNrOfSentImages() const {
+    return mNrOfSentImages;
+}
+
+uint SyntheticIGTLServer::getNrOfSentTransforms() const {
+    return mNrOfSentTransforms;
+}
+
+std::size_t SyntheticIGTLServer::getNrOfSentBytes() const {
+    return mNrOfSentBytes;
+}
+
+void SyntheticIGTLServer::start() {
+    // Create the server socket before returning, so that clients can connect immediately
+    mServerSocket = igtl::ServerSocket::New();
+    if(mServerSocket->CreateServer(mPort) < 0)
+        throw Exception("Cannot create a server socket.");
+    mThread = boost::thread(boost::bind(&SyntheticIGTLServer::stream, this));
+}
+
+void SyntheticIGTLServer::stream() {
+    // The messages are allocated once and only their time stamps change between frames
+    int size[3] = {(int)mWidth, (int)mHeight, (int)mDepth};
+    float spacing[3] = {1.0f, 1.0f, 1.0f};
+    int svoffset[3] = {0, 0, 0};
+    igtl::ImageMessage::Pointer imageMessage = igtl::ImageMessage::New();
+    imageMessage->SetDimensions(size);
+    imageMessage->SetSpacing(spacing);
+    imageMessage->SetScalarType(igtl::ImageMessage::TYPE_UINT8);
+    imageMessage->SetDeviceName("DummyImage");
+    imageMessage->SetSubVolume(size, svoffset);
+    imageMessage->AllocateScalars();
+    unsigned char* pixels = (unsigned char*)imageMessage->GetScalarPointer();
+    for(std::size_t i = 0; i < (std::size_t)mWidth*mHeight*mDepth; ++i)
+        pixels[i] = (unsigned char)(i % 256);
+
+    igtl::Matrix4x4 matrix;
+    igtl::IdentityMatrix(matrix);
+    igtl::TransformMessage::Pointer transformMessage = igtl::TransformMessage::New();
+    transformMessage->SetDeviceName("DummyTransform");
+    transformMessage->SetMatrix(matrix);
+
+    igtl::TimeStamp::Pointer timestamp = igtl::TimeStamp::New();
+
+    igtl::Socket::Pointer socket;
+    while(socket.IsNull())
+        socket = mServerSocket->WaitForConnection(1000);
+
+    boost::chrono::steady_clock::time_point nextFrame = boost::chrono::steady_clock::now();
+    for(uint frame = 0; frame < mNrOfFrames; ++frame) {
+        timestamp->GetTime();
+        imageMessage->SetTimeStamp(timestamp);
+        imageMessage->Pack();
+        if(socket->Send(imageMessage->GetPackPointer(), imageMessage->GetPackSize()) == 0)
+            break;
+        mNrOfSentBytes += imageMessage->GetPackSize();
+        mNrOfSentImages++;
+
+        for(uint i = 0; i < mTransformsPerImage; ++i) {
+            timestamp->GetTime();
+            transformMessage->SetTimeStamp(timestamp);
+            transformMessage->Pack();
+            if(socket->Send(transformMessage->GetPackPointer(), transformMessage->GetPackSize()) == 0)
+                break;
+            mNrOfSentBytes += transformMessage->GetPackSize();
+            mNrOfSentTransforms++;
+        }
+
+        if(mFPS > 0) {
+            nextFrame += boost::chrono::microseconds(1000000 / mFPS);
+            boost::this_thread::sleep_until(nextFrame);
+        }
+    }
+
+    socket->CloseSocket();
+    mServerSocket->CloseSocket();
+}
+
+}
@@ -0,0 +1,61 @@
+#ifndef SYNTHETIC_IGTL_SERVER_HPP
+#define SYNTHETIC_IGTL_SERVER_HPP
+
+#include <boost/thread.hpp>
+#include <string>
+#include "FAST/Data/DataTypes.hpp"
+#include "igtlServerSocket.h"
+
+namespace fast {
+
+/**
+ * OpenIGTLink server used for benchmarking. It sends synthetic uint8 images of a
+ * given size, optionally followed by a number of transform messages per image,
+ * at a fixed rate to the first client which connects. Each message is time stamped
+ * just before it is sent.
+ */
+class SyntheticIGTLServer {
+    public:
+        SyntheticIGTLServer();
+        ~SyntheticIGTLServer();
+        void setPort(uint port);
+        /**
+         * Set to 0 to send as fast as possible. Default is 0.
+         */
+        void setFramesPerSecond(uint fps);
+        void setImageSize(uint width, uint height, uint depth = 1);
+        void setNrOfFrames(uint nrOfFrames);
+        void setTransformsPerImage(uint transforms);
+        uint getNrOfSentImages() const;
+        uint getNrOfSentTransforms() const;
+        /**
+         * Total number of bytes sent, including the message headers
+         */
+        std::size_t getNrOfSentBytes() const;
+        /**
+         * Start listening for a client, and send the frames in a separate thread
+         */
+        void start();
+        /**
+         * Wait until all frames have been sent
+         */
+        void wait();
+        void stream();
+    private:
+        uint mPort;
+        uint mFPS;
+        uint mWidth;
+        uint mHeight;
+        uint mDepth;
+        uint mNrOfFrames;
+        uint mTransformsPerImage;
+        uint mNrOfSentImages;
+        uint mNrOfSentTransforms;
+        std::size_t mNrOfSentBytes;
+        igtl::ServerSocket::Pointer mServerSocket;
+        boost::thread mThread;
+};
+
+}
+
+#endif
@@ -0,0 +1,71 @@
+#include "catch.hpp"
+#include "FAST/DevicePlacement.hpp"
+#include "FAST/DeviceManager.hpp"
+#include "FAST/Algorithms/GaussianSmoothingFilter/GaussianSmoothingFilter.hpp"
+#include "FAST/Data/Image.hpp"
+
+using namespace fast;
+
+TEST_CASE("DevicePlacement chooses the candidate with the lowest measured runtime", "[fast][DevicePlacement]") {
+    std::vector<ExecutionDevice::pointer> candidates;
+    candidates.push_back(DeviceManager::getInstance().getHostDevice());
+    candidates.push_back(DeviceManager::getInstance().getDefaultComputationDevice());
+    DevicePlacement placement;
+    placement.setCandidates(candidates);
+
+    // Warm-up and measured execution on each candidate
+    CHECK(placement.getDevice("small") == candidates[0]);
+    placement.addMeasurement("small", 100.0);
+    CHECK(placement.getDevice("small") == candidates[0]);
+    placement.addMeasurement("small", 1.0);
+    CHECK(placement.isDecided("small") == false);
+    CHECK(placement.getDevice("small") == candidates[1]);
+    placement.addMeasurement("small", 100.0);
+    CHECK(placement.getDevice("small") == candidates[1]);
+    placement.addMeasurement("small", 2.0);
+    CHECK(placement.isDecided("small") == true);
+    CHECK(placement.getDevice("small") == candidates[0]);
+
+    // Another input signature is profiled again
+    CHECK(placement.isDecided("large") == false);
+    CHECK(placement.getDevice("large") == candidates[0]);
+}
+
+TEST_CASE("DevicePlacement without candidates throws exception", "[fast][DevicePlacement]") {
+    DevicePlacement placement;
+    CHECK_THROWS(placement.getDevice("key"));
+    CHECK_THROWS(placement.setCandidates(std::vector<ExecutionDevice::pointer>()));
+}
+
+TEST_CASE("Process object with automatic device placement gives the same result as without", "[fast][DevicePlacement]") {
+    Image::pointer input = Image::New();
+    float data[64*64];
+    for(int i = 0; i < 64*64; ++i)
+        data[i] = (float)(i % 17);
+    input->create(64, 64, TYPE_FLOAT, 1, Host::getInstance(), data);
+
+    GaussianSmoothingFilter::pointer reference = GaussianSmoothingFilter::New();
+    reference->setInputData(input);
+    reference->setMainDevice(Host::getInstance());
+    reference->update();
+    Image::pointer referenceOutput = reference->getOutputData<Image>();
+    ImageAccess::pointer referenceAccess = referenceOutput->getImageAccess(ACCESS_READ);
+    float* referenceData = (float*)referenceAccess->get();
+
+    GaussianSmoothingFilter::pointer filter = GaussianSmoothingFilter::New();
+    filter->setInputData(input);
+    filter->enableAutomaticDevicePlacement();
+    // Enough executions to profile all candidates and then use the chosen one
+    for(int execution = 0; execution < 6; ++execution) {
+        input->updateModifiedTimestamp();
+        filter->update();
+        Image::pointer output = filter->getOutputData<Image>();
+        ImageAccess::pointer access = output->getImageAccess(ACCESS_READ);
+        float* outputData = (float*)access->get();
+        // The host and OpenCL versions both clamp at the border, so the whole image is compared
+        for(int y = 0; y < 64; ++y) {
+        for(int x = 0; x < 64; ++x) {
+            CHECK(outputData[x+y*64] == Approx(referenceData[x+y*64]).epsilon(0.001));
+        }}
+    }
+}
@@ -0,0 +1,25 @@
+#include "catch.hpp"
+#include "FAST/KernelSourceRegistry.hpp"
+#include "FAST/Paths.hpp"
+
+using namespace fast;
+
+TEST_CASE("FAST OpenCL source files are embedded in the library", "[fast][KernelSourceRegistry]") {
+    std::string filename = std::string(FAST_SOURCE_DIR) + "Algorithms/ImageGradient/ImageGradient.cl";
+    CHECK(KernelSourceRegistry::isEmbedded(filename) == true);
+    CHECK(KernelSourceRegistry::exists(filename) == true);
+    CHECK(KernelSourceRegistry::getEmbeddedSourceHash(filename).size() == 40);
+    CHECK(KernelSourceRegistry::getSource(filename).find("__kernel") != std::string::npos);
+}
+
+TEST_CASE("Embedded OpenCL source files are found when the filename contains duplicate slashes", "[fast][KernelSourceRegistry]") {
+    std::string filename = std::string(FAST_SOURCE_DIR) + "/Algorithms/ImageGradient//ImageGradient.cl";
+    CHECK(KernelSourceRegistry::getRelativePath(filename) == "Algorithms/ImageGradient/ImageGradient.cl");
+    CHECK(KernelSourceRegistry::isEmbedded(filename) == true);
+}
+
+TEST_CASE("Getting a non-existing OpenCL source file throws exception", "[fast][KernelSourceRegistry]") {
+    std::string filename = std::string(FAST_SOURCE_DIR) + "asdasd/asdasd.cl";
+    CHECK(KernelSourceRegistry::exists(filename) == false);
+    CHECK_THROWS(KernelSourceRegistry::getSource(filename));
+}
@@ -0,0 +1,66 @@
+#include "catch.hpp"
+#include "FAST/OpenCLMemoryPool.hpp"
+#include "FAST/DeviceManager.hpp"
+
+using namespace fast;
+
+TEST_CASE("OpenCLMemoryPool reuses released buffers of the same size", "[fast][OpenCLMemoryPool]") {
+    OpenCLDevice::pointer device = DeviceManager::getInstance().getDefaultComputationDevice();
+    OpenCLMemoryPool::pointer pool = OpenCLMemoryPool::getInstance(device);
+    pool->clear();
+
+    cl::Buffer buffer = pool->acquireBuffer(1024);
+    pool->release(buffer);
+    CHECK(pool->getNrOfFreeObjects() == 1);
+    CHECK(pool->getFreeMemory() == 1024);
+
+    cl::Buffer buffer2 = pool->acquireBuffer(1024);
+    CHECK(buffer() == buffer2());
+    CHECK(pool->getNrOfFreeObjects() == 0);
+    CHECK(pool->getFreeMemory() == 0);
+
+    // Other sizes and flags give new buffers
+    cl::Buffer buffer3 = pool->acquireBuffer(2048);
+    CHECK(buffer3() != buffer2());
+    pool->release(buffer2);
+    cl::Buffer buffer4 = pool->acquireBuffer(1024, CL_MEM_READ_ONLY);
+    CHECK(buffer4() != buffer2());
+    pool->clear();
+}
+
+TEST_CASE("OpenCLMemoryPool reuses released images of the same size and format", "[fast][OpenCLMemoryPool]") {
+    OpenCLDevice::pointer device = DeviceManager::getInstance().getDefaultComputationDevice();
+    OpenCLMemoryPool::pointer pool = OpenCLMemoryPool::getInstance(device);
+    pool->clear();
+
+    cl::Image2D image = pool->acquireImage2D(cl::ImageFormat(CL_R, CL_UNSIGNED_INT8), 32, 16);
+    pool->release(image);
+    cl::Image2D image2 = pool->acquireImage2D(cl::ImageFormat(CL_R, CL_UNSIGNED_INT8), 32, 16);
+    CHECK(image() == image2());
+    pool->release(image2);
+    cl::Image2D image3 = pool->acquireImage2D(cl::ImageFormat(CL_R, CL_FLOAT), 32, 16);
+    CHECK(image3() != image2());
+
+    cl::Image3D image4 = pool->acquireImage3D(cl::ImageFormat(CL_R, CL_UNSIGNED_INT8), 8, 8, 8);
+    pool->release(image4);
+    cl::Image3D image5 = pool->acquireImage3D(cl::ImageFormat(CL_R, CL_UNSIGNED_INT8), 8, 8, 8);
+    CHECK(image4() == image5());
+    pool->clear();
+}
+
+TEST_CASE("OpenCLMemoryPool does not keep more free memory than the maximum", "[fast][OpenCLMemoryPool]") {
+    OpenCLDevice::pointer device = DeviceManager::getInstance().getDefaultComputationDevice();
+    OpenCLMemoryPool::pointer pool = OpenCLMemoryPool::getInstance(device);
+    pool->clear();
+    pool->setMaximumFreeMemory(1500);
+
+    cl::Buffer buffer = pool->acquireBuffer(1024);
+    cl::Buffer buffer2 = pool->acquireBuffer(1024);
+    pool->release(buffer);
+    pool->release(buffer2);
+    CHECK(pool->getNrOfFreeObjects() == 1);
+    CHECK(pool->getFreeMemory() == 1024);
+
+    pool->setMaximumFreeMemory(device->getDevice().getInfo<CL_DEVICE_GLOBAL_MEM_SIZE>() / 4);
+    pool->clear();
+}
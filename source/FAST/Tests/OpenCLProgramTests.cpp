@@ -0,0 +1,74 @@
+#include "catch.hpp"
+#include "FAST/OpenCLProgram.hpp"
+#include "FAST/ExecutionDevice.hpp"
+#include "FAST/DeviceManager.hpp"
+
+using namespace fast;
+
+TEST_CASE("OpenCLProgram returns the same kernel object when getting the same kernel again", "[fast][OpenCLProgram]") {
+    OpenCLDevice::pointer device = DeviceManager::getInstance().getDefaultComputationDevice();
+    OpenCLProgram::pointer program = OpenCLProgram::New();
+    program->setSourceFilename(std::string(FAST_SOURCE_DIR) + "Algorithms/ImageGradient/ImageGradient.cl");
+
+    cl::Kernel kernel = program->getKernel(device, "gradient2D");
+    cl::Kernel kernel2 = program->getKernel(device, "gradient2D");
+    CHECK(kernel() == kernel2());
+
+    // Other kernel names and build options give other kernel objects
+    cl::Kernel kernel3 = program->getKernel(device, "gradient3D");
+    CHECK(kernel() != kernel3());
+    cl::Kernel kernel4 = program->getKernel(device, "gradient2D", "-DVECTORS_16BIT");
+    CHECK(kernel() != kernel4());
+}
+
+TEST_CASE("Getting a kernel which doesn't exist from OpenCLProgram throws exception", "[fast][OpenCLProgram]") {
+    OpenCLDevice::pointer device = DeviceManager::getInstance().getDefaultComputationDevice();
+    OpenCLProgram::pointer program = OpenCLProgram::New();
+    program->setSourceFilename(std::string(FAST_SOURCE_DIR) + "Algorithms/ImageGradient/ImageGradient.cl");
+
+    CHECK_THROWS(program->getKernel(device, "asdasd"));
+}
+
+TEST_CASE("OpenCLDefines creates sorted build options", "[fast][OpenCLProgram]") {
+    OpenCLDefines constants;
+    CHECK(constants.getBuildOptions() == "");
+    constants.set("MASK_SIZE", 5).set("TYPE", "float").set("A_FLAG");
+    CHECK(constants.getBuildOptions() == "-DA_FLAG -DMASK_SIZE=5 -DTYPE=float");
+}
+
+TEST_CASE("OpenCLProgram removes the least recently used variant when the maximum number of variants is exceeded", "[fast][OpenCLProgram]") {
+    OpenCLDevice::pointer device = DeviceManager::getInstance().getDefaultComputationDevice();
+    OpenCLProgram::pointer program = OpenCLProgram::New();
+    program->setSourceFilename(std::string(FAST_SOURCE_DIR) + "Algorithms/ImageGradient/ImageGradient.cl");
+    program->setMaximumNumberOfVariants(2);
+
+    cl::Kernel kernel = program->getKernel(device, "gradient2D");
+    program->getKernel(device, "gradient2D", "-DVECTORS_16BIT");
+    CHECK(program->getNumberOfVariants(device) == 2);
+
+    // Using the first variant again makes the 16 bit variant the least recently used
+    cl::Kernel kernel2 = program->getKernel(device, "gradient2D");
+    CHECK(kernel() == kernel2());
+    program->getKernel(device, "gradient2D", "-DUNUSED_CONSTANT=1");
+    CHECK(program->getNumberOfVariants(device) == 2);
+    cl::Kernel kernel3 = program->getKernel(device, "gradient2D");
+    CHECK(kernel() == kernel3());
+}
+
+TEST_CASE("OpenCLProgram does not remove evicted variants from the device", "[fast][OpenCLProgram]") {
+    OpenCLDevice::pointer device = DeviceManager::getInstance().getDefaultComputationDevice();
+    const std::string filename = std::string(FAST_SOURCE_DIR) + "Algorithms/ImageGradient/ImageGradient.cl";
+    OpenCLProgram::pointer program = OpenCLProgram::New();
+    program->setSourceFilename(filename);
+    program->setMaximumNumberOfVariants(1);
+
+    program->getKernel(device, "gradient2D", "-DEVICTED_CONSTANT=1");
+    program->getKernel(device, "gradient2D", "-DEVICTED_CONSTANT=2");
+    CHECK(program->getNumberOfVariants(device) == 1);
+
+    // Other users of the same source and build options still find the compiled program on the device
+    CHECK(device->hasProgram(filename + "-DEVICTED_CONSTANT=1"));
+    OpenCLProgram::pointer otherProgram = OpenCLProgram::New();
+    otherProgram->setSourceFilename(filename);
+    CHECK_NOTHROW(otherProgram->getKernel(device, "gradient2D", "-DEVICTED_CONSTANT=1"));
+}
@@ -0,0 +1,78 @@
+#include "catch.hpp"
+#include "FAST/WorkGroupSizeTuner.hpp"
+#include "FAST/OpenCLProgram.hpp"
+#include "FAST/DeviceManager.hpp"
+#include "FAST/Data/Image.hpp"
+#include <fstream>
+#include <cstring>
+#include <set>
+
+using namespace fast;
+
+TEST_CASE("WorkGroupSizeTuner candidates divide the global size", "[fast][WorkGroupSizeTuner]") {
+    std::vector<std::vector<std::size_t> > candidates = WorkGroupSizeTuner::getCandidates(cl::NDRange(64, 24, 10));
+    CHECK(candidates.size() > 0);
+    for(uint i = 0; i < candidates.size(); ++i) {
+        REQUIRE(candidates[i].size() == 3);
+        CHECK(64 % candidates[i][0] == 0);
+        CHECK(24 % candidates[i][1] == 0);
+        CHECK(10 % candidates[i][2] == 0);
+    }
+
+    // A prime global size leaves only the driver's choice
+    CHECK(WorkGroupSizeTuner::getCandidates(cl::NDRange(31, 31)).size() == 0);
+}
+
+TEST_CASE("WorkGroupSizeTuner size classes group global sizes with the same candidates", "[fast][WorkGroupSizeTuner]") {
+    CHECK(WorkGroupSizeTuner::getSizeClass(cl::NDRange(320, 200)) == "512/64x256/8");
+    CHECK(WorkGroupSizeTuner::getSizeClass(cl::NDRange(448, 232)) == "512/64x256/8");
+    CHECK(WorkGroupSizeTuner::getSizeClass(cl::NDRange(320, 204)) != "512/64x256/8");
+    CHECK(WorkGroupSizeTuner::getSizeClass(cl::NDRange(1024, 1024, 3)) == "1024/256x1024/256x4/1");
+    CHECK(WorkGroupSizeTuner::getCandidates(cl::NDRange(320, 200)) == WorkGroupSizeTuner::getCandidates(cl::NDRange(448, 232)));
+}
+
+TEST_CASE("WorkGroupSizeTuner stores the local size of a tuned kernel", "[fast][WorkGroupSizeTuner]") {
+    OpenCLDevice::pointer device = DeviceManager::getInstance().getDefaultComputationDevice();
+    OpenCLProgram::pointer program = OpenCLProgram::New();
+    program->setSourceFilename(std::string(FAST_SOURCE_DIR) + "Algorithms/ImageGradient/ImageGradient.cl");
+    cl::Kernel kernel = program->getKernel(device, "gradient2D");
+
+    Image::pointer input = Image::New();
+    input->create(64, 32, TYPE_FLOAT, 1);
+    {
+        ImageAccess::pointer access = input->getImageAccess(ACCESS_READ_WRITE);
+        memset(access->get(), 0, sizeof(float)*64*32);
+    }
+    Image::pointer output = Image::New();
+    output->create(64, 32, TYPE_FLOAT, 2);
+    OpenCLImageAccess::pointer inputAccess = input->getOpenCLImageAccess(ACCESS_READ, device);
+    OpenCLImageAccess::pointer outputAccess = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
+    kernel.setArg(0, *inputAccess->get2DImage());
+    kernel.setArg(1, *outputAccess->get2DImage());
+
+    cl::NDRange globalSize(64, 32);
+    cl::NDRange localSize = WorkGroupSizeTuner::getLocalSize(device, kernel, globalSize);
+    for(uint i = 0; i < localSize.dimensions(); ++i)
+        CHECK(globalSize[i] % localSize[i] == 0);
+
+    // The result is reused, and has been written to the file of the device
+    cl::NDRange localSize2 = WorkGroupSizeTuner::getLocalSize(device, kernel, globalSize);
+    REQUIRE(localSize2.dimensions() == localSize.dimensions());
+    for(uint i = 0; i < localSize.dimensions(); ++i)
+        CHECK(localSize2[i] == localSize[i]);
+    std::ifstream file(WorkGroupSizeTuner::getFilename(device).c_str());
+    CHECK(file.good());
+
+    // Each kernel key is stored once
+    std::set<std::string> keys;
+    std::string line;
+    while(std::getline(file, line)) {
+        std::string key = line.substr(0, line.find(' '));
+        CHECK(keys.count(key) == 0);
+        keys.insert(key);
+    }
+    CHECK(keys.size() > 0);
+
+    CHECK_NOTHROW(WorkGroupSizeTuner::enqueueNDRangeKernel(device, kernel, globalSize));
+    device->getCommandQueue().finish();
+}
@@ -49,6 +49,14 @@ unsigned int getPowerOfTwoSize(unsigned int size) {
     return (unsigned int)pow(2,i);
 }
 
+unsigned long long hashString(const std::string& str, unsigned long long hash) {
+    for(std::size_t i = 0; i < str.size(); ++i) {
+        hash ^= (unsigned char)str[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
 void getIntensitySumFromOpenCLImage(OpenCLDevice::pointer device, cl::Image2D image, DataType type, float* sum) {
     // Get power of two size
     unsigned int powerOfTwoSize = getPowerOfTwoSize(std::max(image.getImageInfo<CL_IMAGE_WIDTH>(), image.getImageInfo<CL_IMAGE_HEIGHT>()));
@@ -37,6 +37,11 @@ T sign(T value) {
 }
 
 unsigned int getPowerOfTwoSize(unsigned int size);
+/**
+ * 64 bit FNV-1a hash. Unlike boost::hash, this gives the same value in all processes and builds,
+ * which is needed when the hash is used to name files. Give the previous hash to hash several strings.
+ */
+unsigned long long hashString(const std::string& str, unsigned long long hash = 14695981039346656037ULL);
 void* allocateDataArray(unsigned int voxels, DataType type, unsigned int nrOfComponents);
 template <class T>
 float getSumFromOpenCLImageResult(void* voidData, unsigned int size, unsigned int nrOfComponents) {
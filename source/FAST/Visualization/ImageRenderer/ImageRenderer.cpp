@@ -211,7 +211,7 @@ void ImageRenderer::draw2D(cl::BufferGL PBO, uint width, uint height, Eigen::Tra
         }
 
         if(input->getDimensions() == 2) {
-            cl::Kernel kernel(getOpenCLProgram(device, "2D"), "render2Dimage");
+            cl::Kernel kernel = getOpenCLKernel(device, "render2Dimage", "2D");
             // Run kernel to fill the texture
 
             OpenCLImageAccess::pointer access = input->getOpenCLImageAccess(ACCESS_READ, device);
@@ -250,7 +250,7 @@ void ImageRenderer::draw2D(cl::BufferGL PBO, uint width, uint height, Eigen::Tra
                     transform.data()
             );
 
-             cl::Kernel kernel(getOpenCLProgram(device, "2D"), "render3Dimage");
+            cl::Kernel kernel = getOpenCLKernel(device, "render3Dimage", "2D");
             // Run kernel to fill the texture
 
             OpenCLImageAccess::pointer access = input->getOpenCLImageAccess(ACCESS_READ, device);
@@ -149,7 +149,7 @@ void SegmentationRenderer::draw2D(cl::BufferGL PBO, uint width, uint height,
 
         if(input->getDimensions() == 2) {
             std::string kernelName = "render2D";
-            cl::Kernel kernel(getOpenCLProgram(device), kernelName.c_str());
+            cl::Kernel kernel = getOpenCLKernel(device, kernelName);
             // Run kernel to fill the texture
 
             OpenCLImageAccess::pointer access = input->getOpenCLImageAccess(ACCESS_READ, device);
@@ -172,7 +172,7 @@ void SegmentationRenderer::draw2D(cl::BufferGL PBO, uint width, uint height,
             );
         } else {
             std::string kernelName = "render3D";
-            cl::Kernel kernel(getOpenCLProgram(device), kernelName.c_str());
+            cl::Kernel kernel = getOpenCLKernel(device, kernelName);
 
             // Get transform of the image
             AffineTransformation::pointer dataTransform = SceneGraph::getAffineTransformationFromData(input);
@@ -0,0 +1,251 @@
+#include "FAST/WorkGroupSizeTuner.hpp"
+#include "FAST/Exception.hpp"
+#include "FAST/Reporter.hpp"
+#include "FAST/Paths.hpp"
+#include "FAST/Utility.hpp"
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/chrono.hpp>
+#include <fstream>
+#include <sstream>
+#include <limits>
+
+namespace fast {
+
+typedef boost::unordered_map<std::string, std::vector<std::size_t> > LocalSizeMap;
+
+static boost::mutex tunerMutex; // protects the variables below
+static boost::unordered_map<std::string, LocalSizeMap> localSizes; // Key is the filename of the device
+static boost::unordered_set<std::string> loadedFiles;
+static bool tuningEnabled = true;
+
+// Number of timed runs of each candidate
+static const int nrOfRuns = 3;
+// Largest candidate local size in any dimension
+static const std::size_t maxCandidateSize = 256;
+
+static std::string getKernelKey(OpenCLDevice::pointer device, cl::Kernel kernel, cl::NDRange globalSize) {
+    // The maximum work-group size of the kernel is included to separate kernels with the
+    // same name compiled from different programs or with different build options
+    std::stringstream key;
+    key << kernel.getInfo<CL_KERNEL_FUNCTION_NAME>();
+    key << "_" << kernel.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(device->getDevice());
+    key << "_" << WorkGroupSizeTuner::getSizeClass(globalSize);
+    return key.str();
+}
+
+static void loadFile(std::string filename) {
+    if(loadedFiles.count(filename) > 0)
+        return;
+    loadedFiles.insert(filename);
+
+    // Each line is: kernel key, number of dimensions and local size
+    std::ifstream file(filename.c_str());
+    std::string line;
+    while(std::getline(file, line)) {
+        std::stringstream stream(line);
+        std::string key;
+        uint dimensions;
+        if(!(stream >> key >> dimensions) || dimensions > 3)
+            continue;
+        std::vector<std::size_t> localSize(dimensions);
+        for(uint i = 0; i < dimensions; ++i)
+            stream >> localSize[i];
+        if(!stream.fail())
+            localSizes[filename][key] = localSize;
+    }
+}
+
+static void storeResults(std::string filename) {
+    // The whole file is written again, so that each kernel key is only stored once
+    std::ofstream file(filename.c_str(), std::ios_base::trunc);
+    if(file.fail()) {
+        Reporter::warning() << "Unable to store work-group size in " << filename << Reporter::end;
+        return;
+    }
+    const LocalSizeMap& deviceLocalSizes = localSizes[filename];
+    for(LocalSizeMap::const_iterator it = deviceLocalSizes.begin(); it != deviceLocalSizes.end(); ++it) {
+        file << it->first << " " << it->second.size();
+        for(uint i = 0; i < it->second.size(); ++i)
+            file << " " << it->second[i];
+        file << "\n";
+    }
+}
+
+static cl::NDRange toNDRange(const std::vector<std::size_t>& size) {
+    switch(size.size()) {
+        case 1:
+            return cl::NDRange(size[0]);
+        case 2:
+            return cl::NDRange(size[0], size[1]);
+        case 3:
+            return cl::NDRange(size[0], size[1], size[2]);
+        default:
+            return cl::NullRange;
+    }
+}
+
+std::string WorkGroupSizeTuner::getFilename(OpenCLDevice::pointer device) {
+    // Hash of the platform and device, as for the kernel binaries
+    cl::Device clDevice = device->getDevice();
+    unsigned long long hash = hashString(device->getPlatform().getInfo<CL_PLATFORM_NAME>() +
+            clDevice.getInfo<CL_DEVICE_NAME>() + clDevice.getInfo<CL_DEVICE_VERSION>() + clDevice.getInfo<CL_DRIVER_VERSION>());
+    std::stringstream filename;
+    filename << OUL_OPENCL_KERNEL_BINARY_PATH << "workGroupSizes_" << std::hex << hash << ".txt";
+    return filename.str();
+}
+
+std::string WorkGroupSizeTuner::getSizeClass(cl::NDRange globalSize) {
+    // All candidates are powers of two, so the largest power of two which divides a global size
+    // decides which candidates are valid. The size rounded up to a power of two separates small and large sizes.
+    std::stringstream sizeClass;
+    for(uint i = 0; i < globalSize.dimensions(); ++i) {
+        std::size_t divisor = 1;
+        while(divisor < maxCandidateSize && globalSize[i] % (divisor*2) == 0)
+            divisor *= 2;
+        std::size_t magnitude = 1;
+        while(magnitude < globalSize[i])
+            magnitude *= 2;
+        sizeClass << (i == 0 ? "" : "x") << magnitude << "/" << divisor;
+    }
+    return sizeClass.str();
+}
+
+std::vector<std::vector<std::size_t> > WorkGroupSizeTuner::getCandidates(cl::NDRange globalSize) {
+    static const std::size_t candidates1D[][1] = {{32}, {64}, {128}, {256}};
+    static const std::size_t candidates2D[][2] = {
+            {8,4}, {8,8}, {16,4}, {16,8}, {16,16}, {32,4}, {32,8}, {64,1}, {64,4}, {128,1}, {256,1}
+    };
+    static const std::size_t candidates3D[][3] = {
+            {4,4,4}, {8,4,2}, {8,8,1}, {8,8,2}, {8,8,4}, {16,4,1}, {16,4,4}, {16,8,1},
+            {16,8,2}, {16,16,1}, {32,4,1}, {32,8,1}, {64,1,1}, {64,4,1}, {128,1,1}
+    };
+
+    const uint dimensions = globalSize.dimensions();
+    const std::size_t* sizes;
+    uint nrOfCandidates;
+    if(dimensions == 1) {
+        sizes = candidates1D[0];
+        nrOfCandidates = sizeof(candidates1D)/sizeof(candidates1D[0]);
+    } else if(dimensions == 2) {
+        sizes = candidates2D[0];
+        nrOfCandidates = sizeof(candidates2D)/sizeof(candidates2D[0]);
+    } else if(dimensions == 3) {
+        sizes = candidates3D[0];
+        nrOfCandidates = sizeof(candidates3D)/sizeof(candidates3D[0]);
+    } else {
+        return std::vector<std::vector<std::size_t> >();
+    }
+
+    // The global size must be divisible by the local size in OpenCL 1.x
+    std::vector<std::vector<std::size_t> > result;
+    for(uint i = 0; i < nrOfCandidates; ++i) {
+        std::vector<std::size_t> candidate(sizes + i*dimensions, sizes + (i+1)*dimensions);
+        bool divisible = true;
+        for(uint j = 0; j < dimensions; ++j) {
+            if(globalSize[j] % candidate[j] != 0)
+                divisible = false;
+        }
+        if(divisible)
+            result.push_back(candidate);
+    }
+    return result;
+}
+
+std::vector<std::size_t> WorkGroupSizeTuner::tune(OpenCLDevice::pointer device, cl::Kernel kernel, cl::NDRange globalSize) {
+    cl::Device clDevice = device->getDevice();
+    const std::size_t maxWorkGroupSize = std::min(
+            kernel.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(clDevice),
+            clDevice.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>()
+    );
+    const VECTOR_CLASS< ::size_t> maxWorkItemSizes = clDevice.getInfo<CL_DEVICE_MAX_WORK_ITEM_SIZES>();
+
+    // The driver's choice is the first candidate, and is only replaced by a faster local size
+    std::vector<std::vector<std::size_t> > candidates;
+    candidates.push_back(std::vector<std::size_t>());
+    std::vector<std::vector<std::size_t> > allCandidates = getCandidates(globalSize);
+    for(uint i = 0; i < allCandidates.size(); ++i) {
+        std::size_t workGroupSize = 1;
+        bool valid = true;
+        for(uint j = 0; j < allCandidates[i].size(); ++j) {
+            workGroupSize *= allCandidates[i][j];
+            if(j >= maxWorkItemSizes.size() || allCandidates[i][j] > maxWorkItemSizes[j])
+                valid = false;
+        }
+        if(valid && workGroupSize <= maxWorkGroupSize)
+            candidates.push_back(allCandidates[i]);
+    }
+
+    cl::CommandQueue queue = device->getCommandQueue();
+    queue.finish();
+    std::vector<std::size_t> best;
+    double bestTime = std::numeric_limits<double>::max();
+    for(uint i = 0; i < candidates.size(); ++i) {
+        cl::NDRange localSize = toNDRange(candidates[i]);
+        try {
+            // Warm up run
+            queue.enqueueNDRangeKernel(kernel, cl::NullRange, globalSize, localSize);
+            queue.finish();
+            boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+            for(int run = 0; run < nrOfRuns; ++run)
+                queue.enqueueNDRangeKernel(kernel, cl::NullRange, globalSize, localSize);
+            queue.finish();
+            double time = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+            if(time < bestTime) {
+                bestTime = time;
+                best = candidates[i];
+            }
+        } catch(cl::Error &error) {
+            // E.g. the kernel uses too much local memory for this size
+            continue;
+        }
+    }
+
+    return best;
+}
+
+cl::NDRange WorkGroupSizeTuner::getLocalSize(OpenCLDevice::pointer device, cl::Kernel kernel, cl::NDRange globalSize) {
+    if(globalSize.dimensions() == 0)
+        return cl::NullRange;
+
+    std::string filename = getFilename(device);
+    std::string key = getKernelKey(device, kernel, globalSize);
+
+    // Kernels are tuned while holding the lock, so that two threads never tune at the same time
+    boost::lock_guard<boost::mutex> lock(tunerMutex);
+    loadFile(filename);
+    LocalSizeMap& deviceLocalSizes = localSizes[filename];
+    LocalSizeMap::const_iterator it = deviceLocalSizes.find(key);
+    if(it != deviceLocalSizes.end())
+        return toNDRange(it->second);
+    if(!tuningEnabled)
+        return cl::NullRange;
+
+    std::vector<std::size_t> localSize = tune(device, kernel, globalSize);
+    deviceLocalSizes[key] = localSize;
+    storeResults(filename);
+    return toNDRange(localSize);
+}
+
+void WorkGroupSizeTuner::enqueueNDRangeKernel(OpenCLDevice::pointer device, cl::Kernel kernel, cl::NDRange globalSize) {
+    device->getCommandQueue().enqueueNDRangeKernel(
+            kernel,
+            cl::NullRange,
+            globalSize,
+            getLocalSize(device, kernel, globalSize)
+    );
+}
+
+void WorkGroupSizeTuner::enableTuning() {
+    boost::lock_guard<boost::mutex> lock(tunerMutex);
+    tuningEnabled = true;
+}
+
+void WorkGroupSizeTuner::disableTuning() {
+    boost::lock_guard<boost::mutex> lock(tunerMutex);
+    tuningEnabled = false;
+}
+
+} // end namespace fast
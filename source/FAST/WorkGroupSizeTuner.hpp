@@ -0,0 +1,54 @@
+#ifndef WORK_GROUP_SIZE_TUNER_HPP_
+#define WORK_GROUP_SIZE_TUNER_HPP_
+
+#include "FAST/ExecutionDevice.hpp"
+#include <vector>
+
+namespace fast {
+
+/**
+ * Finds the best work-group (local) size of a kernel for a given global size by
+ * running the kernel once for each candidate size. The results are stored in the
+ * kernel binary directory for each device, so that a kernel is only tuned once.
+ * Global sizes of the same size class (see getSizeClass) share the tuned local size.
+ *
+ * Since the kernel is run several times when it is tuned, only kernels which give the
+ * same result when run again (i.e. which don't update their input in place) should
+ * be enqueued with the tuner.
+ */
+class WorkGroupSizeTuner {
+    public:
+        /**
+         * Enqueue kernel in the command queue of device with the best local size for globalSize
+         */
+        static void enqueueNDRangeKernel(OpenCLDevice::pointer device, cl::Kernel kernel, cl::NDRange globalSize);
+        /**
+         * Get the best local size, tuning the kernel first if it has not been tuned for
+         * the size class of this global size on this device. Returns cl::NullRange if the driver should choose.
+         */
+        static cl::NDRange getLocalSize(OpenCLDevice::pointer device, cl::Kernel kernel, cl::NDRange globalSize);
+        /**
+         * When tuning is disabled, stored results are still used, but new kernels are not tuned
+         */
+        static void enableTuning();
+        static void disableTuning();
+        /**
+         * File where the results of a device are stored
+         */
+        static std::string getFilename(OpenCLDevice::pointer device);
+        /**
+         * Global sizes with the same size class have the same candidates and about the same size,
+         * e.g. 320x200 and 448x232 are both 512/64x256/8: rounded up to a power of two / largest candidate divisor
+         */
+        static std::string getSizeClass(cl::NDRange globalSize);
+        /**
+         * Local sizes which are tried for the given global size, not taking any device limits into account
+         */
+        static std::vector<std::vector<std::size_t> > getCandidates(cl::NDRange globalSize);
+    private:
+        static std::vector<std::size_t> tune(OpenCLDevice::pointer device, cl::Kernel kernel, cl::NDRange globalSize);
+};
+
+} // end namespace fast
+
+#endif